@@ -1,7 +1,14 @@
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #include "texture.h"
 #include "uv.h"
+#include "map.h"
+#include "jobs.h"
+#include "watch.h"
+#include "pak.h"
 
 ///
 /// Atlas Set (AST) is a binary file format for storing several texture atlases and the sub-textures within them.
@@ -11,6 +18,54 @@
 /// and sprites only refer to their containing atlases by a unique identifier.
 /// This is to simplify the retrieval process where the caller does not have to be aware of which atlas a sprite belongs to to retrieve it.
 ///
+/// Atlas sets are read through a memory mapping of their file, which is validated once when the set is initialized.
+/// The sprite table of a set is exposed as a direct view over this mapping, so sprites are never copied or parsed field by field.
+/// Sets can also be read in place from memory which is already mapped, such as an entry within a pack archive, see `ast_init_pak`.
+///
+/// The texture data of each atlas is stored as a "payload" in one of several encodings:
+///  - PNG: A PNG file, which is small but must be fully decoded when loading.
+///  - LZ4: Raw texels in the atlas' format, with rows already ordered bottom-to-top for uploading, compressed with LZ4.
+///         These are typically larger than PNGs, but are several times faster to load as decompressing them is bound by memory bandwidth.
+///  - QOI: A QOI file, which is slightly larger than a PNG but several times faster to decode, see `qoi.h`.
+///  - BC1, BC3, and BC7: Block compressed texels, see `bc.h`, which are uploaded directly from the set's mapping without decoding.
+///         These also stay compressed on the graphics card, using four to eight times less memory than other payloads.
+///         Every atlas within a set must have the same compressed payload, as they share a single array texture.
+///
+/// LZ4 payloads may also store their texels in a compact format, see `texture_format_is_compact`, which are converted when the set is written.
+/// These use a half to a quarter of the memory of RGBA on the graphics card while still being uploaded as they are,
+/// such as `TEXTURE_A8` for glyphs and masks, or `TEXTURE_RGBA4444` for low colour sprites.
+/// Every atlas within a set must have the same compact format, as they share a single array texture.
+/// Version 1 set files only support PNG payloads, and are still read.
+///
+/// The mip levels of the atlas array texture of a set are produced in one of several ways, see `ast_mipmaps_t`.
+/// Sets can store a full mip chain for each atlas, prefiltered offline in linear light, which is uploaded level by level,
+/// or can specify that they need no mip levels at all, as is typical of nearest-filtered pixel art.
+/// Either way the mipmap is not generated while loading, which otherwise costs driver time on every load.
+///
+/// The atlas array texture of a set can either be read synchronously with `ast_get_texture`, or streamed with `ast_stream_t`.
+/// Streams decode atlases on worker threads and upload them through pixel buffer objects over several frames,
+/// so that the calling thread can continue rendering while the set loads.
+/// Sets can also be compiled into a C header with the `astgen` tool, which enumerates the sprites of a set by index,
+/// so that sprites can be resolved with `ast_get_sprite_at` or the generated rect table rather than by identifier.
+/// The header includes the content hash of the set, which should be checked with `ast_verify_content_hash` when loading it.
+///
+/// Large sets can instead be made resident on demand with `ast_residency_t`,
+/// which only uploads the atlases of sprites that are actually requested into a texture sized by a memory budget.
+///
+/// Every layer of an atlas array texture is the size of the largest atlas, so a single large atlas makes every smaller atlas
+/// occupy as much memory as it does. Sets with atlases of differing sizes can instead be split into several array textures
+/// by size class with `ast_arrays_t`, where sprites are placed within the array and layer containing their atlas.
+/// The memory wasted by either layout can be measured up front with `ast_get_texture_wasted_size` and `ast_get_arrays_wasted_size`.
+///
+/// During development a loaded set can be hot reloaded with `ast_reload_t`, which watches its file for changes.
+/// Only the atlases whose payloads changed are decoded and re-uploaded, and are streamed over several frames like `ast_stream_t`.
+/// Set files being hot reloaded should be replaced by moving a new file over them, as the packer does,
+/// so that a partially written file is never read.
+/// Reloaded sets hold an allocated copy of their file rather than a mapping of it, as Windows refuses to replace a mapped file.
+///
+/// Sets may also contain a sprite index; an open-addressed hash table mapping identifier hashes to sprites.
+/// When present, sprites are retrieved in constant time, otherwise the sprite table is scanned.
+///
 
 // MARK: - Macros
 
@@ -19,13 +74,87 @@
 /// This includes the trailing null terminator.
 #define AST_ID_MAX_SIZE (72)
 
+/// The sprite index of an unoccupied slot within an atlas set's sprite index.
+#define AST_SPRITE_INDEX_EMPTY (0xffffffff)
+
+/// The value of a residency slot or atlas which indicates that it has no counterpart.
+#define AST_RESIDENCY_NONE (0xffffffff)
+
+/// The maximum number of atlases which an atlas set stream stages at once.
+///
+/// This bounds both the number of atlases decoding concurrently and the staging memory they are decoded into.
+#define AST_STREAM_MAX_STAGED_LAYERS (4)
+
+// MARK: - Enumerations
+
+/// The encoding of an atlas' texture data within an atlas set file.
+enum ast_payload_t
+{
+    /// A PNG file.
+    AST_PAYLOAD_PNG = 0x0,
+
+    /// Raw texels in the atlas' format with rows ordered bottom-to-top, compressed as a single LZ4 block.
+    AST_PAYLOAD_LZ4 = 0x1,
+
+    /// A QOI file.
+    AST_PAYLOAD_QOI = 0x2,
+
+    /// BC1 blocks with block rows ordered bottom-to-top, which can only store opaque atlases.
+    AST_PAYLOAD_BC1 = 0x3,
+
+    /// BC3 blocks with block rows ordered bottom-to-top.
+    AST_PAYLOAD_BC3 = 0x4,
+
+    /// BC7 blocks with block rows ordered bottom-to-top.
+    AST_PAYLOAD_BC7 = 0x5,
+};
+
+/// How the mip levels of an atlas set's atlas array texture are produced.
+enum ast_mipmaps_t
+{
+    /// The mip levels are generated from the full size level once it has been uploaded.
+    ///
+    /// This is used by sets which do not specify otherwise.
+    /// Compressed payloads cannot have their mip levels generated, so they are written as stored instead.
+    AST_MIPMAPS_GENERATED = 0x0,
+
+    /// The mip levels are stored within the set alongside each atlas, and are uploaded directly.
+    AST_MIPMAPS_STORED = 0x1,
+
+    /// There are no mip levels besides the full size level.
+    AST_MIPMAPS_NONE = 0x2,
+};
+
+/// The outcome of requesting a sprite from an atlas set residency.
+enum ast_residency_result_t
+{
+    /// The sprite was found, and its atlas is resident.
+    AST_RESIDENCY_RESIDENT = 0x0,
+
+    /// There is no sprite matching the requested identifier within the residency's set.
+    AST_RESIDENCY_MISSING = 0x1,
+
+    /// The sprite was found, but its atlas is not resident and every slot is in use within the current frame.
+    ///
+    /// The budget of the residency is too small for the frame, and the request can be retried in a later frame.
+    AST_RESIDENCY_EXHAUSTED = 0x2,
+};
+
 // MARK: - Data Structures
 
 /// An atlas set.
 struct ast_t
 {
-    /// The open handle to this set's file.
-    FILE *file;
+    /// The memory mapping of this set's file.
+    ///
+    /// When this set does not own its mapping this only describes the memory that it was read from.
+    struct map_t map;
+
+    /// Whether or not this set's mapping was created by this set, instead of being a view over memory owned by the caller.
+    bool owns_map;
+
+    /// The version of the format of this set's file.
+    unsigned int version;
 
     /// The width of this set's atlas array texture, in pixels.
     unsigned int atlas_width;
@@ -36,6 +165,12 @@ struct ast_t
     /// The filter used when scaling this set's atlas array texture up and down.
     enum texture_scaling_t atlas_scaling;
 
+    /// How the mip levels of this set's atlas array texture are produced.
+    enum ast_mipmaps_t atlas_mipmaps;
+
+    /// The total number of mip levels of this set's atlas array texture, including the full size level.
+    unsigned int atlas_num_levels;
+
     /// The total number of texture atlases within this set.
     unsigned int num_atlases;
 
@@ -50,23 +185,64 @@ struct ast_t
         /// The height of this atlas' texture, in pixels.
         unsigned int height;
 
-        /// The pointer to this atlas' PNG file within the containing atlas set's file.
-        long png_pointer;
+        /// The encoding of this atlas' payload.
+        enum ast_payload_t payload;
+
+        /// The format of this atlas' texture data, once its payload has been decoded.
+        ///
+        /// This is either `TEXTURE_RGBU8`, `TEXTURE_RGBAU8`, or a compact format for LZ4 payloads.
+        /// Compressed payloads are never decoded, so for these this is the format of the atlas that the blocks were encoded from.
+        enum texture_format_t format;
+
+        /// The first byte of this atlas' payload within the containing atlas set's mapping.
+        const void *payload_data;
+
+        /// The total size of this atlas' payload, in bytes.
+        size_t payload_size;
+
+        /// The stored mip levels of this atlas below the full size level, indexed by level minus one.
+        ///
+        /// Each level is encoded and formatted the same as this atlas' payload.
+        /// This is `NULL` unless the containing set's mip levels are stored.
+        /// Allocated.
+        struct ast_mip_t
+        {
+            /// The width of this mip level, in pixels.
+            unsigned int width;
+
+            /// The height of this mip level, in pixels.
+            unsigned int height;
+
+            /// The first byte of this mip level's payload within the containing atlas set's mapping.
+            const void *payload_data;
+
+            /// The total size of this mip level's payload, in bytes.
+            size_t payload_size;
+        } *mips;
     } *atlases;
 
     /// The total number of sprites within this set.
     unsigned int num_sprites;
 
+    /// Whether or not this set's sprites are allocated, instead of being a view over this set's mapping.
+    ///
+    /// Sprites are only allocated when the sprite table within the set's file is not suitably aligned to be viewed directly.
+    bool owns_sprites;
+
     /// All the sprites within this set.
     ///
-    /// Allocated.
-    struct ast_sprite_t
+    /// The layout of each sprite matches its layout within atlas set files,
+    /// so this is typically a view over this set's mapping rather than an allocation.
+    const struct ast_sprite_t
     {
         /// The unique identifier of this sprite within the containing atlas set.
         char id[AST_ID_MAX_SIZE];
 
         /// The index of the atlas that this sprite belongs to within the containing atlas set.
-        unsigned int atlas_index;
+        uint8_t atlas_index;
+
+        /// The padding between the atlas index and UV coordinates of this sprite, always zero.
+        uint8_t padding[3];
 
         /// The bottom left UV coordinates of this sprite's bounds.
         ///
@@ -83,25 +259,325 @@ struct ast_t
         /// The width of this sprite, in pixels.
         ///
         /// This is unused when this sprite is written, as it is calculated beforehand.
-        unsigned int width;
+        uint16_t width;
 
         /// The height of this sprite, in pixels.
         ///
         /// This is unused when this sprite is written, as it is calculated beforehand.
-        unsigned int height;
+        uint16_t height;
     } *sprites;
+
+    /// The total number of slots within this set's sprite index, if any.
+    ///
+    /// This is always a power of two when there is a sprite index.
+    unsigned int num_sprite_index_slots;
+
+    /// All the slots within this set's sprite index, if any.
+    ///
+    /// This is a view over this set's mapping, or `NULL` if the set has no usable sprite index.
+    const struct ast_sprite_index_slot_t
+    {
+        /// The 64-bit FNV-1a hash of the identifier of this slot's sprite.
+        uint64_t id_hash;
+
+        /// The index of this slot's sprite within the containing atlas set's sprites.
+        ///
+        /// This is `AST_SPRITE_INDEX_EMPTY` if this slot is unoccupied.
+        uint32_t sprite_index;
+
+        /// The padding after the sprite index of this slot, always zero.
+        uint32_t padding;
+    } *sprite_index;
+};
+
+/// The placement of a sprite within an atlas set, without its identifier.
+///
+/// This is used by the headers generated with `astgen` to describe sprites at compile time.
+/// See `ast_sprite_t` for field documentation, all of which match a sprite being read.
+struct ast_sprite_rect_t
+{
+    unsigned int atlas_index;
+    struct uv_t bottom_left;
+    struct uv_t top_right;
+    unsigned int width;
+    unsigned int height;
+};
+
+/// The atlases of an atlas set, split into several atlas array textures by size class.
+///
+/// The size class of an atlas is its size rounded up to a power of two along each axis,
+/// but never beyond the size of the set's atlas array texture.
+/// Atlases of the same size class share an array texture of that size, with one layer for each atlas.
+/// Rounding to a power of two keeps every stored mip level of an atlas within the same level of its array texture.
+struct ast_arrays_t
+{
+    /// The atlas set that these arrays hold the atlases of.
+    const struct ast_t *ast;
+
+    /// The total number of array textures within these arrays.
+    unsigned int num_arrays;
+
+    /// All the array textures within these arrays, ordered by the first atlas within each.
+    ///
+    /// Allocated.
+    struct ast_array_t
+    {
+        /// The width of this array's texture, in pixels.
+        unsigned int width;
+
+        /// The height of this array's texture, in pixels.
+        unsigned int height;
+
+        /// The total number of mip levels of this array's texture, including the full size level.
+        ///
+        /// This is the set's mip level count, clamped to the number of levels that this array's size has.
+        unsigned int num_levels;
+
+        /// The total number of layers of this array's texture, which is the number of atlases within this array.
+        unsigned int num_layers;
+
+        /// The array texture containing the atlases of this array.
+        struct texture_t texture;
+    } *arrays;
+
+    /// The index of the array containing each atlas within these arrays' set, indexed by atlas.
+    ///
+    /// Allocated.
+    unsigned int *atlas_arrays;
+
+    /// The layer of its array's texture containing each atlas within these arrays' set, indexed by atlas.
+    ///
+    /// Allocated.
+    unsigned int *atlas_layers;
+};
+
+/// The placement of a sprite within the array textures of an `ast_arrays_t`.
+struct ast_placement_t
+{
+    /// The array texture containing the sprite's atlas.
+    ///
+    /// This is owned by the arrays that the placement was retrieved from.
+    struct texture_t *texture;
+
+    /// The layer of the texture containing the sprite's atlas.
+    unsigned int layer;
+
+    /// The bottom-left UV coordinates of the sprite within the texture.
+    struct uv_t bottom_left;
+
+    /// The top-right UV coordinates of the sprite within the texture.
+    struct uv_t top_right;
+};
+
+/// An in-progress stream of an atlas set's atlas array texture.
+struct ast_stream_t
+{
+    /// The atlas set that this stream is reading.
+    const struct ast_t *ast;
+
+    /// The atlas array texture that this stream is populating.
+    struct texture_t *texture;
+
+    /// The batch of jobs decoding this stream's atlases.
+    struct jobs_t jobs;
+
+    /// The total number of layers of this stream's texture that this stream uploads.
+    unsigned int num_layers;
+
+    /// The index of the layer, which is also the index of its atlas, that each job of this stream decodes and uploads, indexed by job.
+    ///
+    /// Allocated.
+    unsigned int *layers;
+
+    /// The upload ring that this stream's atlases are staged through, with a slot for each stored mip level of each staged atlas.
+    ///
+    /// At most `AST_STREAM_MAX_STAGED_LAYERS` atlases are staged at once, and each slot is recycled once its level has been uploaded,
+    /// so the staging memory of a stream does not grow with the number of atlases it uploads.
+    struct texture_upload_ring_t ring;
+
+    /// The reservation within `ring` that each stored mip level of each atlas that this stream uploads is decoded into,
+    /// indexed by job and then level.
+    ///
+    /// Jobs decode their atlas directly into these, so that decoded texture data is written once and never copied.
+    /// Each job is only released once its reservations have been made, and they are committed once its atlas is uploaded.
+    /// Allocated.
+    struct texture_upload_t *uploads;
+
+    /// The total number of jobs of this stream which have been staged, and released to decode their atlas.
+    unsigned int num_staged_layers;
+
+    /// Whether or not each layer of this stream's texture has been uploaded, indexed by atlas.
+    ///
+    /// Allocated.
+    bool *is_layer_ready;
+
+    /// The total number of layers of this stream's texture which have been uploaded.
+    unsigned int num_ready_layers;
+
+    /// Whether or not every layer of this stream's texture has been uploaded and its mipmap completed.
+    bool is_complete;
+};
+
+/// A hot reload of an atlas set from its file, keeping the set and its atlas array texture up to date as the file changes.
+///
+/// When the file changes it is read as a new set, and the payloads of its atlases are hashed on worker threads
+/// and compared against those of the current set to find which atlases changed.
+/// Only the changed atlases are then streamed into their layers of the texture, through `ast_stream_t`.
+/// Once every changed layer has been uploaded the new set replaces the current set;
+/// when both sets have the same sprites their records are patched in place, so existing sprite pointers stay valid.
+/// If the new set's atlas array texture cannot be reused, such as when its size or atlas count changed,
+/// then the texture is recreated and every layer is uploaded.
+struct ast_reload_t
+{
+    /// The atlas set that this reload keeps up to date.
+    struct ast_t *ast;
+
+    /// The atlas array texture of this reload's set that this reload keeps up to date.
+    struct texture_t *texture;
+
+    /// The watch on this reload's set file.
+    struct watch_t watch;
+
+    /// The current state of this reload.
+    enum ast_reload_state_t
+    {
+        /// Waiting for the set file to change.
+        AST_RELOAD_WATCHING,
+
+        /// Hashing the atlas payloads of the changed set file to find which atlases changed.
+        AST_RELOAD_DIFFING,
+
+        /// Uploading the changed atlases into their layers.
+        AST_RELOAD_UPLOADING,
+    } state;
+
+    /// The hash of the payloads of each atlas within this reload's set, indexed by atlas.
+    ///
+    /// Allocated.
+    uint64_t *payload_hashes;
+
+    /// The set being read from the changed set file.
+    ///
+    /// This is only initialized while this reload is not watching.
+    struct ast_t next;
+
+    /// The hash of the payloads of each atlas within the set being read, indexed by atlas.
+    ///
+    /// This is only allocated while this reload is not watching.
+    uint64_t *next_payload_hashes;
+
+    /// The batch of jobs hashing the payloads of the set being read.
+    ///
+    /// This is only initialized while this reload is diffing.
+    struct jobs_t jobs;
+
+    /// The stream uploading the changed atlases of the set being read.
+    ///
+    /// This is only initialized while this reload is uploading.
+    struct ast_stream_t stream;
+
+    /// The total number of reloads which have completed.
+    unsigned int num_reloads;
+
+    /// The total number of layers which were uploaded by the last completed reload.
+    unsigned int num_reloaded_layers;
+
+    /// The total number of changes to this reload's set file which were ignored as it could not be read or was invalid.
+    unsigned int num_failed_reloads;
+};
+
+/// The on-demand residency of an atlas set's atlases within a budgeted atlas array texture.
+///
+/// The texture of a residency has a fixed number of layers, referred to as "slots", each of which can hold any one atlas.
+/// Atlases are decoded and uploaded into a slot the first time one of their sprites is requested,
+/// and when every slot is occupied the least recently used atlas is evicted to make room.
+/// Atlases used within the current frame are never evicted, as draws referencing them may not have been submitted yet.
+struct ast_residency_t
+{
+    /// The atlas set that this residency holds the atlases of.
+    const struct ast_t *ast;
+
+    /// The atlas array texture containing the resident atlases, with one layer for each slot.
+    struct texture_t texture;
+
+    /// The size of each layer of this residency's texture, including its mip levels, in bytes.
+    size_t layer_size;
+
+    /// The total number of slots within this residency.
+    unsigned int num_slots;
+
+    /// The index of the atlas within each slot, indexed by slot.
+    ///
+    /// Empty slots are `AST_RESIDENCY_NONE`.
+    /// Allocated.
+    unsigned int *slot_atlases;
+
+    /// The frame in which each slot was last used, indexed by slot.
+    ///
+    /// Allocated.
+    unsigned int *slot_frames;
+
+    /// The index of the slot containing each atlas within this residency's set, indexed by atlas.
+    ///
+    /// Non-resident atlases are `AST_RESIDENCY_NONE`.
+    /// Allocated.
+    unsigned int *atlas_slots;
+
+    /// The current frame of this residency, advanced by `ast_residency_begin_frame`.
+    unsigned int frame;
+
+    /// The total number of sprite requests whose atlas was already resident.
+    unsigned int num_hits;
+
+    /// The total number of sprite requests whose atlas had to be decoded and uploaded.
+    unsigned int num_misses;
+
+    /// The total number of atlases which have been evicted to make room for others.
+    unsigned int num_evictions;
 };
 
 // MARK: - Functions
 
 /// Initialize the given atlas set from the atlas set file at the given filesystem path.
 ///
-/// If the given filesystem path is unable to be opened then the program terminates.
-/// If there is no valid set file within the file at the given filesystem path then an assertion fails.
+/// The file is mapped into memory for the lifetime of the given set, and its bounds are validated once during this function.
+/// If the given filesystem path is unable to be opened or mapped then the program terminates.
+/// If there is no valid set file within the file at the given filesystem path then the program terminates.
 /// @param ast The set to initialize.
 /// @param path The filesystem path of the set file to open.
 void ast_init(struct ast_t *ast, const char *path);
 
+/// Attempt to initialize the given atlas set from the atlas set file at the given filesystem path.
+///
+/// This is identical to `ast_init`, except that a file which cannot be mapped or is not a valid set file
+/// is reported rather than terminating the program, such as one which is still being written.
+/// Payloads are only validated as they are decoded, so a corrupt payload within an otherwise valid set file still terminates the program when it is decoded.
+/// @param ast The set to initialize, which is only initialized if this function succeeds.
+/// @param path The filesystem path of the set file to open.
+/// @param reason The pointer to set the value of to a human readable description of why the set file could not be read, if it could not.
+/// @return Whether or not the given set was initialized.
+bool ast_try_init(struct ast_t *ast, const char *path, const char **reason);
+
+/// Initialize the given atlas set from the atlas set file within the given memory.
+///
+/// The set is a view over the given memory rather than a copy of it, so the memory must outlive the given set.
+/// If there is no valid set file within the given memory then the program terminates.
+/// @param ast The set to initialize.
+/// @param name The name of the given memory, which is only used to describe it within error messages.
+/// @param data The first byte of the set file.
+/// @param size The total size of the set file, in bytes.
+void ast_init_memory(struct ast_t *ast, const char *name, const void *data, size_t size);
+
+/// Initialize the given atlas set from the atlas set file within the entry with the given name in the given pack archive.
+///
+/// The set is a view over the archive's mapping, so the given archive must outlive the given set.
+/// If the given archive does not contain an entry with the given name then the program terminates.
+/// If there is no valid set file within the entry then the program terminates.
+/// @param ast The set to initialize.
+/// @param pak The archive containing the set file.
+/// @param name The null-terminated name of the entry containing the set file.
+void ast_init_pak(struct ast_t *ast, const struct pak_t *pak, const char *name);
+
 /// Deinitialize the given atlas set, releasing all of its allocated resources.
 /// @param ast The set to deinitialize.
 void ast_deinit(struct ast_t *ast);
@@ -110,7 +586,9 @@ void ast_deinit(struct ast_t *ast);
 ///
 /// The given texture is initialized with a 2D array texture containing all the atlas textures from the given set.
 /// Sprites can use these textures by indexing into the array by their `atlas_index` property.
-/// The atlas textures are read from disk, so this should only be called during load time.
+/// The atlas textures are decoded from the given set's mapping, so this should only be called during load time.
+/// Atlases are decoded concurrently on worker threads, while each is uploaded on the calling thread as soon as it has been decoded.
+/// The mipmap of the given texture is then completed according to the given set's `atlas_mipmaps`.
 /// During this function the given texture is initialized, so the caller is responsible for deinitializing it.
 /// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
 /// @param ast The set to get the atlas array texture of.
@@ -118,9 +596,235 @@ void ast_deinit(struct ast_t *ast);
 void ast_get_texture(struct ast_t *ast,
                      struct texture_t *texture);
 
+/// Begin streaming the atlas array texture from the given atlas set into the given texture.
+///
+/// This function returns immediately, having only created the given texture and started decoding the first of the given set's atlases on worker threads.
+/// The given stream must then be updated with `ast_stream_update` once per frame until it is complete.
+/// Until then the layers of the given texture are only populated once `ast_stream_is_layer_ready` reports them as ready,
+/// and the given texture's mipmap is only complete once the stream is complete.
+/// Each stored mip level of each atlas is decoded directly into staging memory from an upload ring, so the texture data is written once and never copied.
+/// At most `AST_STREAM_MAX_STAGED_LAYERS` atlases hold staging memory at once, and each is only decoded once it has been staged,
+/// so staging memory is bounded regardless of the number of atlases.
+/// During this function the given texture is initialized, so the caller is responsible for deinitializing it.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to, and `GL_PIXEL_UNPACK_BUFFER` is bound to and then unbound.
+/// @param stream The stream to initialize.
+/// @param ast The set to stream the atlas array texture of.
+/// It is expected that this set is available for the entire lifetime of the given stream.
+/// @param texture The texture to initialize with the new atlas array texture.
+/// It is expected that this texture is available for the entire lifetime of the given stream.
+void ast_stream_init(struct ast_stream_t *stream,
+                     const struct ast_t *ast,
+                     struct texture_t *texture);
+
+/// Deinitialize the given atlas set stream, releasing all of its allocated resources.
+///
+/// If the given stream is not yet complete then this function waits for the atlases which are currently decoding, discarding them,
+/// and atlases which have not begun decoding are never decoded.
+/// The stream's texture is not deinitialized, and any layers which were not ready remain unpopulated.
+/// @param stream The stream to deinitialize.
+void ast_stream_deinit(struct ast_stream_t *stream);
+
+/// Upload the atlases which have been decoded since the last update of the given atlas set stream.
+///
+/// This should be called once per frame on the thread of the graphics context that the stream's texture was created within.
+/// Each upload is staged through a pixel buffer object, so the driver can transfer it without blocking the calling thread.
+/// Each layer is uploaded along with all of its stored mip levels, if any,
+/// and its staging memory is then recycled for the next atlas, which begins decoding.
+/// Once every atlas has been uploaded the stream's texture has its mipmap generated, if needed, and the stream is complete.
+/// If the given stream is already complete then this function does nothing.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to, and `GL_PIXEL_UNPACK_BUFFER` is bound to and then unbound.
+/// @param stream The stream to update.
+/// @param max_layers The maximum number of layers to upload during this update, to bound the time spent within it.
+void ast_stream_update(struct ast_stream_t *stream,
+                       unsigned int max_layers);
+
+/// Get whether or not the layer at the given index within the given atlas set stream's texture has been uploaded.
+///
+/// If the given index is out of bounds of the given stream's set's atlases then an assertion fails.
+/// @param stream The stream to check.
+/// @param index The index of the layer to check, which is also the index of its atlas.
+/// @return Whether or not the given layer has been uploaded.
+bool ast_stream_is_layer_ready(const struct ast_stream_t *stream,
+                               unsigned int index);
+
+/// Get the overall progress of the given atlas set stream.
+///
+/// Decoding and uploading each account for half of each atlas' progress.
+/// @param stream The stream to get the progress of.
+/// @return The overall progress of the given stream, from `0` (started) to `1` (complete).
+float ast_stream_get_progress(struct ast_stream_t *stream);
+
+/// Get whether or not the given atlas set stream is complete.
+/// @param stream The stream to check.
+/// @return Whether or not every layer of the given stream's texture has been uploaded and its mipmap completed.
+bool ast_stream_is_complete(const struct ast_stream_t *stream);
+
+/// Initialize the given atlas set hot reload, and begin watching the set file at the given filesystem path.
+///
+/// The given set is expected to have been initialized from the given path, or from a pack archive entry built from it,
+/// and the given texture populated from the given set.
+/// The sprites of the given set are copied if they are a view over its mapping, so that they can be patched in place.
+/// If the given set owns a mapping of its file then the mapping is replaced with an allocated copy,
+/// so that the file can be replaced while it is being watched, and changed set files are likewise read as copies.
+/// The payloads of the given set's atlases are hashed during this function, so this should only be called during load time.
+/// @param reload The reload to initialize.
+/// @param ast The set to keep up to date.
+/// It is expected that this set is available for the entire lifetime of the given reload.
+/// @param texture The atlas array texture of the given set to keep up to date.
+/// It is expected that this texture is available for the entire lifetime of the given reload.
+/// @param path The filesystem path of the given set's file.
+void ast_reload_init(struct ast_reload_t *reload,
+                     struct ast_t *ast,
+                     struct texture_t *texture,
+                     const char *path);
+
+/// Deinitialize the given atlas set hot reload, releasing all of its allocated resources.
+///
+/// If a reload is in progress then it is abandoned, leaving the set as it was.
+/// Layers which were already uploaded keep their new contents.
+/// @param reload The reload to deinitialize.
+void ast_reload_deinit(struct ast_reload_t *reload);
+
+/// Check for changes to the given atlas set hot reload's set file, and advance any reload in progress.
+///
+/// This should be called once per frame on the thread of the graphics context that the reload's texture was created within.
+/// The work done within each update is bounded, so a reload is spread over several frames rather than stalling any one of them.
+/// The reload's set and texture are only valid to use between updates.
+/// If the changed set file cannot be read or is invalid then it is reported and the reload's set is kept,
+/// and the next change to the set file is waited for, see `ast_try_init`.
+/// During this function `TEXTURE_INIT_UNIT` may be activated and bound to.
+/// @param reload The reload to update.
+/// @param max_layers The maximum number of layers to upload during this update.
+/// @return Whether or not a reload was completed during this update.
+/// Sprite pointers retrieved from the reload's set before a completed reload are only still valid if the set's sprites did not change identifiers or order.
+bool ast_reload_update(struct ast_reload_t *reload,
+                       unsigned int max_layers);
+
+/// Initialize the given atlas set residency with an empty atlas array texture sized by the given memory budget.
+///
+/// The number of slots is the number of atlases that fit within the given budget,
+/// clamped to between one and the number of atlases within the given set.
+/// Only sets with stored mip levels have mip levels within the new residency's texture, which count towards the given budget.
+/// No atlases are resident until their sprites are requested with `ast_residency_get_sprite`.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param residency The residency to initialize.
+/// @param ast The set to hold the atlases of.
+/// It is expected that this set is available for the entire lifetime of the given residency.
+/// @param budget The maximum size of the new residency's texture, in bytes.
+void ast_residency_init(struct ast_residency_t *residency,
+                        const struct ast_t *ast,
+                        size_t budget);
+
+/// Deinitialize the given atlas set residency, releasing all of its allocated resources.
+///
+/// This includes the residency's texture.
+/// @param residency The residency to deinitialize.
+void ast_residency_deinit(struct ast_residency_t *residency);
+
+/// Begin a new frame within the given atlas set residency.
+///
+/// This should be called once per frame, before any sprites are requested for the frame.
+/// Atlases which were used within previous frames become eligible for eviction.
+/// @param residency The residency to begin a new frame within.
+void ast_residency_begin_frame(struct ast_residency_t *residency);
+
+/// Attempt to get the sprite matching the given identifier from the given atlas set residency, making its atlas resident if it is not already.
+///
+/// If the sprite's atlas is not resident then it is decoded and uploaded on the calling thread,
+/// evicting the least recently used atlas which was not used within the current frame if every slot is occupied.
+/// The UV coordinates of the returned sprite are valid within the given residency's texture,
+/// but its atlas index is not the layer to sample; the given layer pointer is set to that instead.
+/// If the sprite's atlas is not resident and every slot is in use within the current frame, then no atlas is evicted
+/// and `AST_RESIDENCY_EXHAUSTED` is returned, as the budget is too small for the frame; the request can be retried in a later frame.
+/// During this function `TEXTURE_INIT_UNIT` may be activated and bound to.
+/// @param residency The residency to get the sprite from.
+/// @param id The unique identifier of the sprite to get within the given residency's set.
+/// @param sprite The pointer to set the value of to a pointer to the sprite matching the given identifier within the given residency's set.
+/// This is set unless `AST_RESIDENCY_MISSING` is returned.
+/// @param layer The pointer to set the value of to the layer of the given residency's texture containing the sprite's atlas.
+/// This is only set if `AST_RESIDENCY_RESIDENT` is returned.
+/// @return The outcome of the request.
+enum ast_residency_result_t ast_residency_get_sprite(struct ast_residency_t *residency,
+                                                     const char *id,
+                                                     const struct ast_sprite_t **sprite,
+                                                     unsigned int *layer);
+
+/// Initialize the given atlas set arrays with the atlases of the given atlas set, split into array textures by size class.
+///
+/// Atlases are decoded concurrently on worker threads like `ast_get_texture`, and uploaded on the calling thread into their arrays.
+/// The mipmap of each array texture is then completed according to the given set's `atlas_mipmaps`.
+/// Stored mip levels which are smaller than the smallest level of their array's texture are not uploaded.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param arrays The arrays to initialize.
+/// @param ast The set to split the atlases of.
+/// It is expected that this set is available for the entire lifetime of the given arrays.
+void ast_arrays_init(struct ast_arrays_t *arrays,
+                     const struct ast_t *ast);
+
+/// Deinitialize the given atlas set arrays, releasing all of their allocated resources.
+///
+/// This includes the array textures.
+/// @param arrays The arrays to deinitialize.
+void ast_arrays_deinit(struct ast_arrays_t *arrays);
+
+/// Get the placement of the given sprite within the given atlas set arrays.
+///
+/// The UV coordinates of sprites are relative to their set's atlas array texture,
+/// so they are rescaled to the array texture containing the sprite's atlas.
+/// @param arrays The arrays to get the placement of the given sprite within.
+/// @param sprite The sprite to get the placement of, from the given arrays' set.
+/// @param placement The placement to set to the given sprite's placement within the given arrays.
+void ast_arrays_get_placement(const struct ast_arrays_t *arrays,
+                              const struct ast_sprite_t *sprite,
+                              struct ast_placement_t *placement);
+
+/// Get the memory wasted by the atlas array texture of the given atlas set, as read by `ast_get_texture`.
+///
+/// This is the size of every level of every layer of the texture, less the size of the atlas within each.
+/// @param ast The set to get the wasted memory of.
+/// @return The memory wasted by the given set's atlas array texture, in bytes.
+size_t ast_get_texture_wasted_size(const struct ast_t *ast);
+
+/// Get the memory wasted by the array textures of the given atlas set, as split by size class with `ast_arrays_init`.
+///
+/// See `ast_get_texture_wasted_size` for further documentation.
+/// @param ast The set to get the wasted memory of.
+/// @return The memory wasted by the given set's size class array textures, in bytes.
+size_t ast_get_arrays_wasted_size(const struct ast_t *ast);
+
+/// Get the sprite at the given index within the given atlas set.
+///
+/// This is a constant time lookup, intended for indices generated by `astgen`.
+/// If the given index is out of bounds of the given set's sprites then an assertion fails.
+/// @param ast The atlas set to get the sprite from.
+/// @param index The index of the sprite to get within the given atlas set.
+/// @return A pointer to the sprite at the given index within the given atlas set.
+const struct ast_sprite_t *ast_get_sprite_at(const struct ast_t *ast,
+                                             unsigned int index);
+
+/// Get the content hash of the given atlas set.
+///
+/// The content hash covers the atlas array texture size, the atlas count, and the identifier and placement of every sprite,
+/// which is everything that a header generated by `astgen` depends on.
+/// It does not cover atlas payloads, so re-encoding atlases does not change it.
+/// It is computed over the little-endian file encoding of these values, so it is the same on every host.
+/// @param ast The atlas set to get the content hash of.
+/// @return The 64-bit content hash of the given atlas set.
+uint64_t ast_get_content_hash(const struct ast_t *ast);
+
+/// Verify that the content hash of the given atlas set matches the given hash.
+///
+/// If the hashes do not match then the program terminates,
+/// as any sprite indices or rects generated for the expected set would silently refer to the wrong sprites.
+/// @param ast The atlas set to verify the content hash of.
+/// @param expected_hash The expected content hash of the given atlas set, typically from a header generated by `astgen`.
+void ast_verify_content_hash(const struct ast_t *ast,
+                             uint64_t expected_hash);
+
 /// Attempt to get the sprite matching the given identifier from the given atlas set, if any.
 /// @param ast The atlas set to get the sprite from.
 /// @param id The unique identifier of the sprite to get within the given atlas set.
+/// If the given set has a sprite index then this is a constant time lookup, otherwise the set's sprites are scanned.
 /// @return A pointer to the sprite matching the given identifier within the given atlas set, if any.
 /// If multiple sprites within the given set match the given identifier then the first match is returned.
 const struct ast_sprite_t *ast_get_sprite(const struct ast_t *ast,
@@ -128,17 +832,54 @@ const struct ast_sprite_t *ast_get_sprite(const struct ast_t *ast,
 
 /// Write the given atlas set contents to an atlas set file at the current cursor of the given file handle.
 ///
+/// The written set file always contains a sprite index for the given sprites.
+/// The set file is always written in the latest version of the format.
 /// If the atlas index of any of the given sprites is out of bounds of the given atlases then an assertion fails.
+/// If the given payload is BC1 and any of the given atlases has an alpha channel then the program terminates.
+/// If the given format is compact and the given payload is not LZ4 then the program terminates.
 /// During this function the cursor of the given file handle is changed.
 /// @param file The file handle to write the given set contents to.
 /// @param atlas_scaling The filter to use when scaling the new set's atlas array texture up and down.
+/// @param atlas_payload The encoding to store the texture data of each of the given atlases with.
+/// @param atlas_format The compact format to convert the texture data of each of the given atlases into, see `texture_convert_png`.
+/// This is `TEXTURE_RGBAU8` to keep the format of each atlas, as RGB atlases are never expanded.
+/// @param atlas_mipmaps How the mip levels of the new set's atlas array texture are produced.
+/// When these are stored a full mip chain is filtered from each of the given atlases, see `png_init_mipmap`.
 /// @param num_atlases The total number of given atlases.
 /// @param atlases All the atlases to write to the set file.
 /// @param num_sprites The total number of given sprites.
 /// @param sprites All the sprites to write to the set file.
 void ast_write_contents(FILE *file,
                         enum texture_scaling_t atlas_scaling,
+                        enum ast_payload_t atlas_payload,
+                        enum texture_format_t atlas_format,
+                        enum ast_mipmaps_t atlas_mipmaps,
                         unsigned int num_atlases,
                         const struct texture_t *atlases,
                         unsigned int num_sprites,
                         const struct ast_sprite_t *sprites);
+
+/// Write the given atlas set contents to an atlas set file at the current cursor of the given file handle, using PNGs as the atlases.
+///
+/// This is identical to `ast_write_contents`, except that the atlases are supplied as PNGs rather than textures,
+/// so no graphics context is required.
+/// The payloads and mip levels of the given atlases are encoded concurrently.
+/// See `ast_write_contents` for further documentation.
+/// @param file The file handle to write the given set contents to.
+/// @param atlas_scaling The filter to use when scaling the new set's atlas array texture up and down.
+/// @param atlas_payload The encoding to store the texture data of each of the given atlases with.
+/// @param atlas_format The compact format to convert the texture data of each of the given atlases into, or `TEXTURE_RGBAU8`.
+/// @param atlas_mipmaps How the mip levels of the new set's atlas array texture are produced.
+/// @param num_atlases The total number of given atlases.
+/// @param atlases All the atlases to write to the set file.
+/// @param num_sprites The total number of given sprites.
+/// @param sprites All the sprites to write to the set file.
+void ast_write_contents_png(FILE *file,
+                            enum texture_scaling_t atlas_scaling,
+                            enum ast_payload_t atlas_payload,
+                            enum texture_format_t atlas_format,
+                            enum ast_mipmaps_t atlas_mipmaps,
+                            unsigned int num_atlases,
+                            const struct png_t *atlases,
+                            unsigned int num_sprites,
+                            const struct ast_sprite_t *sprites);
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "png.h"
+#include "uv.h"
+#include "texture.h"
+
+///
+/// Dynamic atlases pack images loaded at runtime into the layers of a single array texture.
+///
+/// Images which are not known ahead of time cannot be packed into an atlas set by the packer,
+/// but giving each of them a texture of its own means rebinding for every one drawn.
+/// Instead they can be added to a dynamic atlas, so that they can share a single binding like the sprites of an atlas set.
+///
+/// Each layer is packed with a skyline allocator, which tracks the height of the packed images along each column of the layer
+/// as a list of horizontal segments, and places each new image wherever its top would be lowest.
+/// This is less dense than MaxRects, but each insertion is cheap enough to perform while running.
+///
+/// Removing an image only returns its space to the skyline when nothing is packed above it, otherwise the space is left as a hole.
+/// Holes are reclaimed by defragmenting, which repacks every image from scratch, tallest first,
+/// and moves their pixels into a new array texture entirely within the graphics context.
+///
+/// Dynamic atlases always have a single mip level, as images are uploaded individually.
+/// The format is always `TEXTURE_RGBAU8`, and RGB images are expanded as they are uploaded.
+///
+
+// MARK: - Data Structures
+
+/// A single horizontal segment of the skyline of a dynamic atlas layer.
+struct atlas_segment_t
+{
+    /// The horizontal position of the left of this segment, in pixels from the left of the packable area.
+    unsigned int x;
+
+    /// The height of the skyline along this segment, in pixels from the bottom of the packable area.
+    unsigned int y;
+
+    /// The width of this segment, in pixels.
+    unsigned int width;
+};
+
+/// The skyline of a single dynamic atlas layer.
+struct atlas_skyline_t
+{
+    /// The total number of segments within this skyline.
+    unsigned int num_segments;
+
+    /// All the segments within this skyline, ordered left to right and covering the entire width of the packable area.
+    ///
+    /// There can never be more segments than the width of the packable area, so this is allocated up front.
+    /// Allocated.
+    struct atlas_segment_t *segments;
+};
+
+/// A single image packed within a dynamic atlas.
+struct atlas_entry_t
+{
+    /// Whether or not this entry is in use.
+    ///
+    /// Entries which are not in use are reused by the next image added.
+    bool is_used;
+
+    /// The index of the layer of the atlas' array texture that this entry is packed within.
+    unsigned int layer;
+
+    /// The horizontal position of the left of this entry's image, in pixels.
+    unsigned int x;
+
+    /// The vertical position of the bottom of this entry's image, in pixels.
+    unsigned int y;
+
+    /// The width of this entry's image, in pixels.
+    unsigned int width;
+
+    /// The height of this entry's image, in pixels.
+    unsigned int height;
+};
+
+/// An array texture which images are packed into at runtime.
+struct atlas_t
+{
+    /// The array texture which images are packed into.
+    ///
+    /// Defragmenting replaces the contents of this texture, but never its address, so it can be referenced by attachments.
+    struct texture_t texture;
+
+    /// The total number of layers within this atlas' array texture.
+    unsigned int num_layers;
+
+    /// The number of empty pixels left between each image and around the edges of each layer.
+    unsigned int padding;
+
+    /// The skyline of each layer of this atlas' array texture.
+    ///
+    /// Allocated.
+    struct atlas_skyline_t *skylines;
+
+    /// The total number of entries within this atlas, including those which are not in use.
+    unsigned int num_entries;
+
+    /// All the entries within this atlas.
+    ///
+    /// Allocated.
+    struct atlas_entry_t *entries;
+
+    /// The total area of all the images packed within this atlas, in pixels.
+    uint64_t used_area;
+
+    /// The total number of times that the images within this atlas have been moved by defragmenting.
+    ///
+    /// Placements retrieved before this last changed are stale, and must be retrieved again.
+    unsigned int generation;
+};
+
+/// The placement of an image within the array texture of a dynamic atlas.
+struct atlas_placement_t
+{
+    /// The array texture containing the image.
+    ///
+    /// This is owned by the atlas that the placement was retrieved from.
+    struct texture_t *texture;
+
+    /// The layer of the texture containing the image.
+    unsigned int layer;
+
+    /// The bottom-left UV coordinates of the image within the texture.
+    struct uv_t bottom_left;
+
+    /// The top-right UV coordinates of the image within the texture.
+    struct uv_t top_right;
+};
+
+// MARK: - Functions
+
+/// Initialize the given dynamic atlas with an empty array texture of the given size, cleared to transparent.
+///
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param atlas The atlas to initialize.
+/// @param width The width of the new atlas' array texture, in pixels.
+/// @param height The height of the new atlas' array texture, in pixels.
+/// @param num_layers The total number of layers within the new atlas' array texture.
+/// @param padding The number of empty pixels to leave between each image and around the edges of each layer.
+/// This should be at least one for linearly scaled atlases, so that images do not bleed into each other when sampled.
+/// @param scaling The scaling filter for the new atlas' array texture to use.
+void atlas_init(struct atlas_t *atlas,
+                unsigned int width,
+                unsigned int height,
+                unsigned int num_layers,
+                unsigned int padding,
+                enum texture_scaling_t scaling);
+
+/// Deinitialize the given dynamic atlas, releasing all of its allocated resources.
+/// @param atlas The atlas to deinitialize.
+void atlas_deinit(struct atlas_t *atlas);
+
+/// Pack the given PNG into the given dynamic atlas, uploading it through the given upload ring.
+///
+/// The layers of the given atlas are tried in order, and the PNG is placed within the first that it fits.
+/// The padding around the placed PNG is cleared to transparent, as it may still hold the pixels of removed entries.
+/// If it does not fit within any layer then the given atlas is unchanged, and the caller may defragment it and try again.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to, and `GL_PIXEL_UNPACK_BUFFER` is bound to and then unbound.
+/// @param atlas The atlas to pack the given PNG into.
+/// @param ring The upload ring to stage the given PNG through.
+/// @param png The PNG to pack.
+/// @param entry The pointer to set the value of to the index of the new entry within the given atlas' entries, if it was packed.
+/// @return Whether or not the given PNG could be packed into the given atlas.
+bool atlas_add_png(struct atlas_t *atlas,
+                   struct texture_upload_ring_t *ring,
+                   const struct png_t *png,
+                   unsigned int *entry);
+
+/// Remove the entry at the given index from the given dynamic atlas.
+///
+/// The contents of the entry's image are left within the array texture until they are overwritten.
+/// If the given entry is out of bounds of the given atlas' entries, or is not in use, then an assertion fails.
+/// @param atlas The atlas to remove the entry from.
+/// @param entry The index of the entry to remove within the given atlas' entries.
+void atlas_remove(struct atlas_t *atlas, unsigned int entry);
+
+/// Defragment the given dynamic atlas, repacking every entry from scratch to reclaim the space left by removed entries.
+///
+/// The pixels of every entry are copied into a new array texture cleared to transparent, which then replaces the given atlas' texture.
+/// The indices of entries are unchanged, but their placements are not, so the generation of the given atlas is incremented.
+/// If the entries cannot all be repacked then the given atlas is unchanged.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to, and `GL_FRAMEBUFFER` is bound to and then restored to its previous binding.
+/// @param atlas The atlas to defragment.
+/// @return Whether or not the given atlas was defragmented.
+bool atlas_defragment(struct atlas_t *atlas);
+
+/// Get the placement of the entry at the given index within the given dynamic atlas.
+///
+/// If the given entry is out of bounds of the given atlas' entries, or is not in use, then an assertion fails.
+/// @param atlas The atlas containing the entry.
+/// @param entry The index of the entry within the given atlas' entries.
+/// @param placement The placement to set to the given entry's placement within the given atlas.
+void atlas_get_placement(struct atlas_t *atlas,
+                         unsigned int entry,
+                         struct atlas_placement_t *placement);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "png.h"
+#include "texture.h"
+#include "buffer.h"
+
+///
+/// An offline encoder for the BC1, BC3, and BC7 block compressed texture formats.
+///
+/// Images are split into 4x4 blocks of pixels, each of which is encoded independently into a fixed number of bytes:
+///  - BC1: Two RGB565 endpoint colours, and a 2-bit index per pixel into four colours interpolated between them.
+///  - BC3: A BC1 colour block, preceded by two 8-bit endpoint alphas and a 3-bit index per pixel into alphas interpolated between them.
+///  - BC7: Only mode 6 is encoded, with two RGBA7 endpoints plus a shared low bit each, and a 4-bit index per pixel into sixteen colours.
+///         This interpolates colour and alpha together along a single line, which suits smooth gradients better than BC3.
+/// Endpoints are fitted along the principal axis of each block's pixels and then refined by least squares.
+/// The colour of fully transparent pixels is ignored when fitting BC3 colour endpoints, as it is never visible.
+///
+/// Encoding is several orders of magnitude slower than decoding, which is done by the graphics context when sampling,
+/// so this is intended for packing atlas sets rather than for use while loading.
+/// Images are read from `png_t`, and block rows are written in the same bottom-to-top order, ready to be uploaded.
+/// Images which are not a multiple of four pixels along either axis have their edge pixels repeated to fill the outermost blocks.
+///
+
+// MARK: - Functions
+
+/// Encode the given PNG into blocks of the given compressed texture format.
+///
+/// BC1 blocks are always opaque, so the alpha channel of RGBA PNGs is discarded.
+/// If the given format is not compressed then an assertion fails.
+/// @param png The PNG to encode.
+/// @param format The compressed texture format to encode the given PNG into.
+/// @param destination The first byte of the memory to write the encoded blocks to.
+/// This must be at least `texture_get_data_size` bytes for the given PNG's size and format.
+void bc_encode(const struct png_t *png, enum texture_format_t format, void *destination);
+
+/// Encode the given PNG into blocks of the given compressed texture format, at the end of the given buffer.
+///
+/// This is safe to perform concurrently for different buffers.
+/// See `bc_encode` for further documentation.
+/// @param png The PNG to encode.
+/// @param format The compressed texture format to encode the given PNG into.
+/// @param buffer The buffer to append the encoded blocks to.
+void bc_encode_buffer(const struct png_t *png, enum texture_format_t format, struct buffer_t *buffer);
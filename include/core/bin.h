@@ -1,12 +1,207 @@
 #pragma once
 
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 
 ///
 /// Binary file reading and writing utilities.
 ///
+/// All multi-byte values are stored little-endian, regardless of the byte order of the host.
+///
+/// Binary data within memory is read with a `bin_reader_t` and written with a `bin_writer_t`,
+/// which move a cursor through contiguous memory rather than calling into stdio for every value.
+/// Neither terminates nor asserts when running out of memory, instead they enter a sticky error state
+/// where reads return zero and writes are discarded, so that a whole structure can be read or written and then checked once.
+/// Runs of values can be read and written in bulk, which is a single copy on little-endian hosts.
+///
+/// Individual values can also be read from and written to file handles,
+/// though these perform a stdio call for every value and cannot report short reads.
+///
+
+// MARK: - Macros
+
+/// Whether or not the host stores multi-byte values little-endian, matching binary files.
+///
+/// When this is set structures within binary files can be viewed in place, provided that their layout matches the file.
+#define BIN_HOST_IS_LITTLE_ENDIAN (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+// MARK: - Forward Declarations
+
+struct buffer_t;
+
+// MARK: - Data Structures
+
+/// A cursor for reading binary data from contiguous memory.
+struct bin_reader_t
+{
+    /// The first byte of the memory that this reader is reading from.
+    const unsigned char *data;
+
+    /// The total size of the memory that this reader is reading from, in bytes.
+    size_t size;
+
+    /// The offset, in bytes, of the next byte that this reader will read within its memory.
+    size_t offset;
+
+    /// Whether or not this reader has attempted to read or seek past the end of its memory.
+    ///
+    /// Once this is set it is never cleared, and every following read returns zero.
+    bool error;
+};
+
+/// A cursor for writing binary data to contiguous memory.
+struct bin_writer_t
+{
+    /// The buffer that this writer is appending to, if any.
+    ///
+    /// When this is `NULL` this writer is instead writing to fixed memory.
+    struct buffer_t *buffer;
+
+    /// The first byte of the fixed memory that this writer is writing to, if any.
+    unsigned char *data;
+
+    /// The total size of the fixed memory that this writer is writing to, in bytes.
+    size_t size;
+
+    /// The total number of bytes that this writer has written.
+    size_t offset;
+
+    /// Whether or not this writer has attempted to write past the end of its fixed memory.
+    ///
+    /// Once this is set it is never cleared, and every following write is discarded.
+    /// This is never set for writers which are appending to a buffer.
+    bool error;
+};
+
+// MARK: - Reader Functions
+
+/// Initialize the given reader at the start of the given memory.
+/// @param reader The reader to initialize.
+/// @param data The first byte of the memory to read from.
+/// @param size The total size of the memory to read from, in bytes.
+void bin_reader_init(struct bin_reader_t *reader, const void *data, size_t size);
+
+/// Move the cursor of the given reader to the given offset within its memory.
+///
+/// If the given offset is past the end of the given reader's memory then the reader enters its error state.
+/// @param reader The reader to move the cursor of.
+/// @param offset The offset, in bytes, to move the cursor to.
+void bin_reader_seek(struct bin_reader_t *reader, size_t offset);
+
+/// Move the cursor of the given reader forwards by the given number of bytes, without reading them.
+///
+/// If there are not enough bytes remaining then the reader enters its error state.
+/// @param reader The reader to move the cursor of.
+/// @param size The total number of bytes to skip.
+void bin_reader_skip(struct bin_reader_t *reader, size_t size);
+
+/// Get the given number of bytes at the cursor of the given reader, and move the cursor past them.
+///
+/// The bytes are not copied, so the returned pointer is a view over the given reader's memory.
+/// If there are not enough bytes remaining then the reader enters its error state.
+/// @param reader The reader to read from.
+/// @param size The total number of bytes to read.
+/// @return The first of the read bytes, or `NULL` if the given reader is in its error state.
+const void *bin_reader_read_bytes(struct bin_reader_t *reader, size_t size);
+
+///
+/// Read the given specific sized types as generic types from the cursor of the given reader, and move the cursor past them.
+///
+/// If there are not enough bytes remaining then the reader enters its error state.
+/// @param reader The reader to read the value from.
+/// @return The value from the given reader, or zero if the given reader is in its error state.
+///
+
+int bin_reader_read_s8(struct bin_reader_t *reader);
+int bin_reader_read_s16(struct bin_reader_t *reader);
+int bin_reader_read_s32(struct bin_reader_t *reader);
+
+unsigned int bin_reader_read_u8(struct bin_reader_t *reader);
+unsigned int bin_reader_read_u16(struct bin_reader_t *reader);
+unsigned int bin_reader_read_u32(struct bin_reader_t *reader);
+uint64_t bin_reader_read_u64(struct bin_reader_t *reader);
+
+float bin_reader_read_f32(struct bin_reader_t *reader);
+
+///
+/// Read a run of the given specific sized types from the cursor of the given reader into the given values, and move the cursor past them.
+///
+/// If there are not enough bytes remaining then the reader enters its error state, and the given values are zeroed.
+/// @param reader The reader to read the values from.
+/// @param values The first of the values to read into.
+/// @param count The total number of values to read.
+///
+
+void bin_reader_read_u16s(struct bin_reader_t *reader, uint16_t *values, size_t count);
+void bin_reader_read_u32s(struct bin_reader_t *reader, uint32_t *values, size_t count);
+void bin_reader_read_f32s(struct bin_reader_t *reader, float *values, size_t count);
+
+// MARK: - Writer Functions
+
+/// Initialize the given writer to append to the end of the given buffer.
+///
+/// Writers appending to a buffer never enter their error state, as the buffer grows as needed.
+/// @param writer The writer to initialize.
+/// @param buffer The buffer to append to.
+/// It is expected that this buffer is available for the entire lifetime of the given writer.
+void bin_writer_init_buffer(struct bin_writer_t *writer, struct buffer_t *buffer);
+
+/// Initialize the given writer at the start of the given fixed memory.
+/// @param writer The writer to initialize.
+/// @param data The first byte of the memory to write to.
+/// @param size The total size of the memory to write to, in bytes.
+void bin_writer_init_memory(struct bin_writer_t *writer, void *data, size_t size);
+
+/// Write the given bytes to the cursor of the given writer, and move the cursor past them.
+///
+/// If there is not enough memory remaining then the writer enters its error state.
+/// @param writer The writer to write to.
+/// @param data The first of the bytes to write.
+/// @param size The total number of bytes to write.
+void bin_writer_write_bytes(struct bin_writer_t *writer, const void *data, size_t size);
+
+/// Write the given number of zero bytes to the cursor of the given writer, and move the cursor past them.
+///
+/// If there is not enough memory remaining then the writer enters its error state.
+/// @param writer The writer to write to.
+/// @param size The total number of zero bytes to write.
+void bin_writer_write_zeros(struct bin_writer_t *writer, size_t size);
+
+///
+/// Write the given generic types as specific sized types to the cursor of the given writer, and move the cursor past them.
+///
+/// If there is not enough memory remaining then the writer enters its error state.
+/// @param writer The writer to write the given value to.
+/// @param value The value to write.
+///
+
+void bin_writer_write_s8(struct bin_writer_t *writer, int value);
+void bin_writer_write_s16(struct bin_writer_t *writer, int value);
+void bin_writer_write_s32(struct bin_writer_t *writer, int value);
+
+void bin_writer_write_u8(struct bin_writer_t *writer, unsigned int value);
+void bin_writer_write_u16(struct bin_writer_t *writer, unsigned int value);
+void bin_writer_write_u32(struct bin_writer_t *writer, unsigned int value);
+void bin_writer_write_u64(struct bin_writer_t *writer, uint64_t value);
+
+void bin_writer_write_f32(struct bin_writer_t *writer, float value);
+
+///
+/// Write a run of the given specific sized types to the cursor of the given writer, and move the cursor past them.
+///
+/// If there is not enough memory remaining then the writer enters its error state.
+/// @param writer The writer to write the given values to.
+/// @param values The first of the values to write.
+/// @param count The total number of values to write.
+///
+
+void bin_writer_write_u16s(struct bin_writer_t *writer, const uint16_t *values, size_t count);
+void bin_writer_write_u32s(struct bin_writer_t *writer, const uint32_t *values, size_t count);
+void bin_writer_write_f32s(struct bin_writer_t *writer, const float *values, size_t count);
 
-// MARK: - Functions
+// MARK: - File Functions
 
 ///
 /// Write given generic types as specific sized types to the given files.
@@ -27,7 +222,7 @@ void bin_write_f32(float value, FILE *file);
 ///
 /// Read the given specific sized types as generic types from the given files.
 /// @param file The file to read the value from.
-/// @return The value from the given file.
+/// @return The value from the given file, or zero if the file ended before the value.
 ///
 
 int bin_read_s8(FILE *file);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+///
+/// Buffers are growable blocks of memory which data is appended to.
+///
+/// They are used to assemble files and other serialized data in memory,
+/// so that the result can be emitted with a single sequential write rather than many small seeks and writes.
+/// Buffers grow geometrically, so appending is amortized constant time.
+///
+
+// MARK: - Data Structures
+
+/// A growable block of memory.
+struct buffer_t
+{
+    /// The first byte of this buffer's contents.
+    ///
+    /// This is `NULL` until anything is appended to this buffer.
+    /// Allocated.
+    unsigned char *data;
+
+    /// The total size of this buffer's contents, in bytes.
+    size_t size;
+
+    /// The total size of the allocation of `data`, in bytes.
+    size_t capacity;
+};
+
+// MARK: - Functions
+
+/// Initialize the given buffer as empty.
+/// @param buffer The buffer to initialize.
+void buffer_init(struct buffer_t *buffer);
+
+/// Deinitialize the given buffer, releasing all of its allocated resources.
+/// @param buffer The buffer to deinitialize.
+void buffer_deinit(struct buffer_t *buffer);
+
+/// Ensure that the given buffer can hold at least the given total size without reallocating.
+/// @param buffer The buffer to reserve the capacity of.
+/// @param capacity The minimum total size that the given buffer should be able to hold, in bytes.
+void buffer_reserve(struct buffer_t *buffer, size_t capacity);
+
+/// Append the given number of uninitialized bytes to the end of the given buffer.
+///
+/// The returned pointer is only valid until the given buffer is next appended to, as it may be reallocated.
+/// @param buffer The buffer to append to.
+/// @param size The total number of bytes to append.
+/// @return A pointer to the first of the appended bytes, for the caller to initialize.
+void *buffer_extend(struct buffer_t *buffer, size_t size);
+
+/// Append a copy of the given memory to the end of the given buffer.
+/// @param buffer The buffer to append to.
+/// @param data The first byte of the memory to append.
+/// @param size The total size of the memory to append, in bytes.
+void buffer_append(struct buffer_t *buffer, const void *data, size_t size);
+
+/// Append the given number of zero bytes to the end of the given buffer.
+/// @param buffer The buffer to append to.
+/// @param size The total number of zero bytes to append.
+void buffer_append_zeros(struct buffer_t *buffer, size_t size);
+
+/// Append zero bytes to the end of the given buffer until its size is a multiple of the given alignment.
+/// @param buffer The buffer to align.
+/// @param alignment The alignment to pad the size of the given buffer to, in bytes.
+void buffer_align(struct buffer_t *buffer, size_t alignment);
+
+/// Write the contents of the given buffer to the current cursor of the given file handle.
+/// @param buffer The buffer to write the contents of.
+/// @param file The file handle to write to.
+void buffer_write(const struct buffer_t *buffer, FILE *file);
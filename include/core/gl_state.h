@@ -0,0 +1,186 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gl.h"
+
+///
+/// A cache of the binding state of a graphics context, used to elide calls which would not change anything.
+///
+/// Each window owns the state cache of its graphics context, which becomes current on the calling thread along with the context.
+/// The cached binding functions within this file compare against the current cache before issuing their call,
+/// and issue every call unconditionally when no cache is current, such as in tools without a window.
+///
+/// The cache only knows about bindings made through it, so any code issuing binding calls of its own must invalidate it afterwards.
+/// Bindings start out unknown, so the first call for each after initialization or invalidation is always issued.
+///
+/// Each cache also owns a pool of the sampler objects of its graphics context, one per distinct set of sampling parameters,
+/// which are created on demand and shared by every texture sampled with the same parameters.
+/// Sampler objects are released along with the graphics context, and are unaffected by invalidation.
+///
+
+// MARK: - Macros
+
+/// The maximum number of texture units tracked by a state cache.
+///
+/// This matches `TEXTURE_MAX_UNITS`, binds to units beyond this are always issued.
+#define GL_STATE_MAX_TEXTURE_UNITS (16)
+
+/// The total number of texture targets tracked for each texture unit by a state cache.
+///
+/// These are `GL_TEXTURE_2D` and `GL_TEXTURE_2D_ARRAY`, binds to any other target are always issued.
+#define GL_STATE_NUM_TEXTURE_TARGETS (2)
+
+/// The maximum number of distinct sampler objects pooled by a state cache.
+#define GL_STATE_MAX_SAMPLERS (16)
+
+/// The value of a cached binding which is not known.
+#define GL_STATE_UNKNOWN (0xffffffff)
+
+// MARK: - Data Structures
+
+/// A pooled sampler object of a graphics context.
+struct gl_state_sampler_t
+{
+    /// The minification filter of this sampler.
+    GLenum min_filter;
+
+    /// The magnification filter of this sampler.
+    GLenum mag_filter;
+
+    /// The wrap mode of this sampler along both axes.
+    GLenum wrap;
+
+    /// The unique OpenGL identifier of this sampler.
+    GLuint id;
+};
+
+/// The cached binding state of a graphics context.
+struct gl_state_t
+{
+    /// The unique OpenGL identifier of the program in use.
+    GLuint program_id;
+
+    /// The index of the active texture unit.
+    unsigned int active_unit;
+
+    /// The unique OpenGL identifier of the texture bound to each target of each texture unit, indexed by unit and then target.
+    GLuint texture_ids[GL_STATE_MAX_TEXTURE_UNITS][GL_STATE_NUM_TEXTURE_TARGETS];
+
+    /// The unique OpenGL identifier of the sampler bound to each texture unit, indexed by unit.
+    GLuint sampler_ids[GL_STATE_MAX_TEXTURE_UNITS];
+
+    /// The total number of sampler objects within this cache's pool.
+    unsigned int num_samplers;
+
+    /// All the sampler objects within this cache's pool.
+    struct gl_state_sampler_t samplers[GL_STATE_MAX_SAMPLERS];
+
+    /// The unique OpenGL identifier of the bound vertex array.
+    GLuint vertex_array_id;
+
+    /// The unique OpenGL identifier of the framebuffer bound to `GL_FRAMEBUFFER`.
+    GLuint framebuffer_id;
+
+    /// Whether or not the viewport is known.
+    bool has_viewport;
+
+    /// The X, Y, width, and height of the viewport.
+    GLint viewport[4];
+
+    /// The total number of binding calls which were issued to the graphics context through this cache.
+    uint64_t num_issued_calls;
+
+    /// The total number of binding calls which were elided by this cache, as they would not have changed anything.
+    uint64_t num_elided_calls;
+};
+
+// MARK: - Functions
+
+/// Initialize the given state cache with every binding unknown, an empty sampler pool, and zeroed counters.
+/// @param state The state cache to initialize.
+void gl_state_init(struct gl_state_t *state);
+
+/// Forget every binding within the given state cache, so that the next call for each is issued.
+///
+/// This must be called after binding calls are made outside of the cache, such as by third party renderers.
+/// The counters of the given cache are unaffected.
+/// @param state The state cache to invalidate.
+void gl_state_invalidate(struct gl_state_t *state);
+
+/// Set the state cache of the graphics context which is current on the calling thread.
+/// @param state The state cache to make current, or `NULL` to issue every binding call uncached.
+/// It is expected that this cache belongs to the current graphics context, and is available for as long as it is current.
+void gl_state_set_current(struct gl_state_t *state);
+
+/// Get the state cache of the graphics context which is current on the calling thread, if any.
+/// @return The current state cache, or `NULL` if there is none.
+struct gl_state_t *gl_state_get_current();
+
+/// Use the program with the given identifier within the current graphics context, if it is not already in use.
+/// @param program_id The unique OpenGL identifier of the program to use.
+void gl_state_use_program(GLuint program_id);
+
+/// Activate the texture unit at the given index within the current graphics context, if it is not already active.
+/// @param unit The index of the texture unit to activate.
+void gl_state_activate_unit(unsigned int unit);
+
+/// Bind the texture with the given identifier to the given target of the active texture unit, if it is not already bound.
+/// @param target The OpenGL target to bind the texture to.
+/// @param texture_id The unique OpenGL identifier of the texture to bind.
+void gl_state_bind_texture(GLenum target, GLuint texture_id);
+
+/// Bind the pooled sampler object with the given parameters to the given texture unit, if it is not already bound.
+///
+/// The sampler is created and added to the current cache's pool the first time that its parameters are used.
+/// If there is no current cache then nothing is bound, as there is no pool to take the sampler from,
+/// and textures are sampled with their own parameters instead.
+/// If the current cache's pool is full then an assertion fails.
+/// @param unit The index of the texture unit to bind the sampler to.
+/// @param min_filter The minification filter of the sampler.
+/// @param mag_filter The magnification filter of the sampler.
+/// @param wrap The wrap mode of the sampler along both axes.
+void gl_state_bind_sampler(unsigned int unit, GLenum min_filter, GLenum mag_filter, GLenum wrap);
+
+/// Bind the vertex array with the given identifier within the current graphics context, if it is not already bound.
+/// @param vertex_array_id The unique OpenGL identifier of the vertex array to bind.
+void gl_state_bind_vertex_array(GLuint vertex_array_id);
+
+/// Bind the framebuffer with the given identifier to `GL_FRAMEBUFFER`, if it is not already bound.
+/// @param framebuffer_id The unique OpenGL identifier of the framebuffer to bind, or `0` for the default framebuffer.
+void gl_state_bind_framebuffer(GLuint framebuffer_id);
+
+/// Get the identifier of the framebuffer bound to `GL_FRAMEBUFFER` within the current graphics context.
+///
+/// If the binding is not known by the current cache, or there is no current cache, then it is queried from the graphics context,
+/// and the current cache remembers it.
+/// This is typically used to restore the previous binding after temporarily binding another framebuffer.
+/// @return The unique OpenGL identifier of the bound framebuffer, or `0` for the default framebuffer.
+GLuint gl_state_get_framebuffer();
+
+/// Set the viewport of the current graphics context, if it is not already set.
+/// @param x The X coordinate of the bottom-left corner of the viewport, in pixels.
+/// @param y The Y coordinate of the bottom-left corner of the viewport, in pixels.
+/// @param width The width of the viewport, in pixels.
+/// @param height The height of the viewport, in pixels.
+void gl_state_set_viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+/// Forget the given texture within the current state cache, as it is being deleted.
+///
+/// Deleting a texture reverts any of its bindings within the current graphics context to `0`,
+/// and the identifier of a deleted texture may be reused, so this must be called before the texture is deleted.
+/// @param texture_id The unique OpenGL identifier of the texture being deleted.
+void gl_state_forget_texture(GLuint texture_id);
+
+/// Forget the given program within the current state cache, as it is being deleted.
+/// @param program_id The unique OpenGL identifier of the program being deleted.
+void gl_state_forget_program(GLuint program_id);
+
+/// Forget the given vertex array within the current state cache, as it is being deleted.
+/// @param vertex_array_id The unique OpenGL identifier of the vertex array being deleted.
+void gl_state_forget_vertex_array(GLuint vertex_array_id);
+
+/// Forget the given framebuffer within the current state cache, as it is being deleted.
+/// @param framebuffer_id The unique OpenGL identifier of the framebuffer being deleted.
+void gl_state_forget_framebuffer(GLuint framebuffer_id);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+///
+/// Non-cryptographic hashing utilities.
+///
+/// Hashes are used to quickly identify and look up data such as identifiers and file contents.
+/// They are stable across platforms and runs, so they are safe to store within files.
+///
+
+// MARK: - Macros
+
+/// The initial value of a 64-bit FNV-1a hash.
+#define HASH_FNV1A64_OFFSET_BASIS (0xcbf29ce484222325ull)
+
+// MARK: - Functions
+
+/// Get the 64-bit FNV-1a hash of the given memory.
+/// @param data The first byte of the memory to hash.
+/// @param size The total size of the memory to hash, in bytes.
+/// @return The 64-bit FNV-1a hash of the given memory.
+uint64_t hash_fnv1a64(const void *data, size_t size);
+
+/// Continue the given 64-bit FNV-1a hash with the given memory.
+///
+/// This allows a hash to be built from several separate pieces of memory,
+/// starting from `HASH_FNV1A64_OFFSET_BASIS`.
+/// @param hash The hash to continue.
+/// @param data The first byte of the memory to hash.
+/// @param size The total size of the memory to hash, in bytes.
+/// @return The given hash continued with the given memory.
+uint64_t hash_fnv1a64_continue(uint64_t hash, const void *data, size_t size);
+
+/// Get the 64-bit FNV-1a hash of the given null-terminated string.
+///
+/// The null terminator is not included within the hash.
+/// @param string The string to hash.
+/// @return The 64-bit FNV-1a hash of the given string.
+uint64_t hash_fnv1a64_string(const char *string);
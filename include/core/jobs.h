@@ -0,0 +1,160 @@
+#pragma once
+
+#include <stdbool.h>
+#include <pthread.h>
+
+///
+/// Jobs are used to run a batch of independent, indexed units of work concurrently on worker threads.
+///
+/// When a batch of jobs is initialized its worker threads are started immediately,
+/// and each worker repeatedly takes the next unstarted job until all of the jobs have been started.
+/// As jobs complete their indices are queued in completion order,
+/// so that the creator can consume each result as soon as it is ready rather than waiting for the whole batch.
+/// This is typically used to keep work which must happen on a specific thread, such as uploading to a graphics context,
+/// overlapped with work which can happen on any thread, such as decoding.
+///
+/// A batch can also be initialized with its jobs held, in which case workers only start jobs once the creator releases them.
+/// This bounds the number of jobs in flight, such as when each job needs resources which the creator must prepare first.
+///
+
+// MARK: - Type Definitions
+
+/// A function which is used to run a single job within a batch.
+///
+/// This function is called from worker threads, so it must only access data which is safe to access concurrently.
+/// @param data The user data pointer supplied to the calling batch.
+/// @param index The index of the job to run within the calling batch.
+typedef void (* jobs_function_t)(void *data,
+                                 unsigned int index);
+
+// MARK: - Data Structures
+
+/// A batch of jobs which are run concurrently.
+struct jobs_t
+{
+    /// The function used to run each job within this batch.
+    jobs_function_t function;
+
+    /// The user data pointer to supply to this batch's function.
+    void *data;
+
+    /// The total number of jobs within this batch.
+    unsigned int num_jobs;
+
+    /// The total number of jobs within this batch which have been released, and may be started.
+    ///
+    /// Jobs are started in index order, so only jobs with indices below this are started.
+    unsigned int num_released;
+
+    /// The index of the next job to be started within this batch.
+    unsigned int next_job;
+
+    /// The total number of jobs within this batch which have completed.
+    unsigned int num_completed;
+
+    /// The total number of completed jobs within this batch which have been consumed by the creator.
+    unsigned int num_consumed;
+
+    /// The indices of all the completed jobs within this batch, in completion order.
+    ///
+    /// Only the first `num_completed` elements are set.
+    /// Allocated.
+    unsigned int *completed;
+
+    /// The total number of worker threads running this batch.
+    unsigned int num_threads;
+
+    /// All the worker threads running this batch.
+    ///
+    /// Allocated.
+    pthread_t *threads;
+
+    /// The mutex guarding the state of this batch which is shared with its worker threads.
+    pthread_mutex_t mutex;
+
+    /// The condition which is signalled whenever a job within this batch completes.
+    pthread_cond_t completion;
+
+    /// The condition which is signalled whenever jobs within this batch are released.
+    pthread_cond_t release;
+};
+
+// MARK: - Functions
+
+/// Initialize the given batch of jobs and begin running them.
+///
+/// The jobs begin running on worker threads before this function returns.
+/// @param jobs The batch to initialize.
+/// @param num_jobs The total number of jobs within the new batch.
+/// @param num_threads The maximum number of worker threads to run the new batch's jobs on.
+/// If this is zero then the number of available processors is used.
+/// Regardless of the given value no more threads are created than there are jobs.
+/// @param function The function to call to run each job.
+/// See `jobs_function_t` for further documentation.
+/// @param data The user data pointer to supply to the given function.
+/// This pointer must be able to be accessed from different threads.
+void jobs_init(struct jobs_t *jobs,
+               unsigned int num_jobs,
+               unsigned int num_threads,
+               jobs_function_t function,
+               void *data);
+
+/// Initialize the given batch of jobs with all of its jobs held, so that none of them begin running until they are released.
+///
+/// Jobs are released in index order with `jobs_release`.
+/// See `jobs_init` for further documentation.
+/// @param jobs The batch to initialize.
+/// @param num_jobs The total number of jobs within the new batch.
+/// @param num_threads The maximum number of worker threads to run the new batch's jobs on, or zero to use the number of available processors.
+/// @param function The function to call to run each job.
+/// @param data The user data pointer to supply to the given function.
+void jobs_init_held(struct jobs_t *jobs,
+                    unsigned int num_jobs,
+                    unsigned int num_threads,
+                    jobs_function_t function,
+                    void *data);
+
+/// Release the given number of held jobs within the given batch, in index order, so that they begin running.
+///
+/// Anything written by the calling thread before this function is visible to the released jobs.
+/// If there are fewer held jobs than the given number then an assertion fails.
+/// @param jobs The batch to release the jobs of.
+/// @param num_jobs The total number of jobs to release.
+void jobs_release(struct jobs_t *jobs,
+                  unsigned int num_jobs);
+
+/// Deinitialize the given batch of jobs, releasing all of its allocated resources.
+///
+/// If any of the given batch's released jobs have not yet completed then this function blocks until they have.
+/// Jobs which are still held are never run.
+/// @param jobs The batch to deinitialize.
+void jobs_deinit(struct jobs_t *jobs);
+
+/// Wait for the next job within the given batch to complete, and consume it.
+///
+/// Jobs are consumed in the order that they complete, which is not necessarily their index order.
+/// If a completed job has not yet been consumed then this function returns immediately.
+/// @param jobs The batch to wait on.
+/// @param index The pointer to set the value of to the index of the consumed job.
+/// @return Whether or not a job was consumed.
+/// This is only `false` once every job within the given batch has been consumed.
+bool jobs_wait_next(struct jobs_t *jobs,
+                    unsigned int *index);
+
+/// Attempt to consume the next completed job within the given batch, without waiting.
+/// @param jobs The batch to consume the job from.
+/// @param index The pointer to set the value of to the index of the consumed job.
+/// @return Whether or not a job was consumed.
+/// This is `false` if no completed jobs are waiting to be consumed.
+bool jobs_poll_next(struct jobs_t *jobs,
+                    unsigned int *index);
+
+/// Get the total number of jobs within the given batch which have completed, whether or not they have been consumed.
+/// @param jobs The batch to check.
+/// @return The total number of jobs within the given batch which have completed.
+unsigned int jobs_get_num_completed(struct jobs_t *jobs);
+
+/// Get whether or not every job within the given batch has been consumed.
+/// @param jobs The batch to check.
+/// @return Whether or not every job within the given batch has been consumed.
+bool jobs_is_finished(struct jobs_t *jobs);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+///
+/// A compressor and decompressor for the LZ4 block format.
+///
+/// LZ4 trades compression ratio for speed; decompression is typically limited by memory bandwidth rather than computation.
+/// This makes it suitable for data which is read far more often than it is written, such as texture data within asset files.
+/// Only the block format is implemented, so compressed data has no framing and the decompressed size must be known by the reader.
+///
+
+// MARK: - Functions
+
+/// Get the maximum size that data of the given size can be compressed to, in bytes.
+///
+/// Incompressible data grows slightly when compressed, so destinations must be allocated with this size rather than the source size.
+/// @param size The size of the data to compress, in bytes.
+/// @return The maximum size that data of the given size can be compressed to, in bytes.
+size_t lz4_get_max_compressed_size(size_t size);
+
+/// Compress the given data into the given destination as a single LZ4 block.
+///
+/// If the given destination is smaller than `lz4_get_max_compressed_size(source_size)` then an assertion fails.
+/// @param source The first byte of the data to compress.
+/// @param source_size The total size of the data to compress, in bytes.
+/// @param destination The first byte of the memory to write the compressed block to.
+/// @param destination_size The total size of the given destination, in bytes.
+/// @return The total size of the compressed block, in bytes.
+size_t lz4_compress(const void *source,
+                    size_t source_size,
+                    void *destination,
+                    size_t destination_size);
+
+/// Decompress the given LZ4 block into the given destination.
+///
+/// The given block is fully validated while decompressing, so malformed blocks never read or write out of bounds.
+/// @param source The first byte of the block to decompress.
+/// @param source_size The total size of the block to decompress, in bytes.
+/// @param destination The first byte of the memory to write the decompressed data to.
+/// @param destination_size The exact size of the decompressed data, in bytes.
+/// @return Whether or not the given block was valid and decompressed to exactly the given destination size.
+bool lz4_decompress(const void *source,
+                    size_t source_size,
+                    void *destination,
+                    size_t destination_size);
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+///
+/// Maps provide read-only access to the contents of files through the virtual memory system.
+///
+/// Rather than copying a file into memory, a map exposes the file's pages directly,
+/// so reading any part of a mapped file costs no more than a memory access once the page is resident.
+/// The contents of a map are only available until it is deinitialized.
+///
+/// Mapped files cannot be replaced on every platform while they are mapped, as Windows refuses to replace a file with a mapped view.
+/// Maps can instead hold an allocated copy of a file, which keeps no reference to the file, so that it can be replaced freely.
+///
+
+// MARK: - Data Structures
+
+/// A read-only memory mapping of a single file.
+struct map_t
+{
+    /// The first byte of this map's file contents.
+    ///
+    /// This is `NULL` if the mapped file is empty.
+    const void *data;
+
+    /// The total size of this map's file contents, in bytes.
+    size_t size;
+
+    /// The platform-specific handle to this map's mapping object.
+    ///
+    /// This is only used on Windows, where a view is mapped from a mapping object rather than directly from a file.
+    /// The mapping object holds its own reference to the file, so the file itself is closed once it has been mapped.
+    void *mapping_handle;
+
+    /// Whether or not this map's contents are an allocated copy of its file, rather than a mapping of it.
+    bool is_copy;
+};
+
+// MARK: - Functions
+
+/// Initialize the given map with the contents of the file at the given filesystem path.
+///
+/// If the given filesystem path is unable to be opened or mapped then the program terminates.
+/// @param map The map to initialize.
+/// @param path The filesystem path of the file to map.
+void map_init(struct map_t *map, const char *path);
+
+/// Attempt to initialize the given map with the contents of the file at the given filesystem path.
+///
+/// This is identical to `map_init`, except that failing to open or map the file is reported rather than terminating the program.
+/// @param map The map to initialize, which is only initialized if this function succeeds.
+/// @param path The filesystem path of the file to map.
+/// @return Whether or not the file at the given filesystem path was opened and mapped.
+bool map_try_init(struct map_t *map, const char *path);
+
+/// Attempt to initialize the given map with an allocated copy of the contents of the file at the given filesystem path.
+///
+/// Unlike a mapping, the copy keeps no reference to the file once this function returns,
+/// so the file can be replaced while the given map is in use on every platform.
+/// The file is read with every sharing mode allowed, so that it can even be replaced while it is being read.
+/// @param map The map to initialize, which is only initialized if this function succeeds.
+/// @param path The filesystem path of the file to copy.
+/// @return Whether or not the file at the given filesystem path was opened and read.
+bool map_try_init_copy(struct map_t *map, const char *path);
+
+/// Deinitialize the given map, releasing all of its allocated resources.
+///
+/// Any pointers into the given map's contents are invalid after this function.
+/// @param map The map to deinitialize.
+void map_deinit(struct map_t *map);
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "map.h"
+
+///
+/// Pack archives bundle many asset files into a single file, so that they can all be opened with a single mapping.
+///
+/// A pack file is memory-mapped once for the lifetime of the archive,
+/// and each entry within it is exposed as a read-only range of the mapping rather than being copied out.
+/// Entries are looked up by name through a table of contents which is sorted by the hash of each name,
+/// so finding an entry costs a binary search rather than a directory walk and file open.
+/// Each entry begins on a `PAK_ALIGNMENT` boundary within the file,
+/// so structures within entries are as aligned as they would be within their own mapping.
+///
+/// Pack files are created by the pakgen target from a directory of files.
+///
+
+// MARK: - Macros
+
+/// The alignment, in bytes, of the first byte of each entry within a pack file.
+#define PAK_ALIGNMENT (64)
+
+// MARK: - Data Structures
+
+/// A single named entry within a pack archive.
+struct pak_entry_t
+{
+    /// The 64-bit FNV-1a hash of this entry's name, see `hash_fnv1a64_string`.
+    uint64_t name_hash;
+
+    /// The null-terminated name of this entry.
+    ///
+    /// This points into the containing archive's mapping.
+    const char *name;
+
+    /// The first byte of this entry's contents.
+    ///
+    /// This points into the containing archive's mapping.
+    const void *data;
+
+    /// The total size of this entry's contents, in bytes.
+    size_t size;
+};
+
+/// A pack archive.
+struct pak_t
+{
+    /// The filesystem path of this archive's file.
+    ///
+    /// Allocated.
+    char *path;
+
+    /// The memory mapping of this archive's file.
+    struct map_t map;
+
+    /// The total number of entries within this archive.
+    unsigned int num_entries;
+
+    /// All the entries within this archive, sorted by their name hash and then their name.
+    ///
+    /// Allocated.
+    struct pak_entry_t *entries;
+};
+
+// MARK: - Functions
+
+/// Initialize the given pack archive from the pack file at the given filesystem path.
+///
+/// The file is mapped into memory for the lifetime of the given archive, and its table of contents is validated once during this function.
+/// If the given filesystem path is unable to be opened or mapped then the program terminates.
+/// If there is no valid pack file at the given filesystem path then the program terminates.
+/// @param pak The archive to initialize.
+/// @param path The filesystem path of the pack file to open.
+void pak_init(struct pak_t *pak, const char *path);
+
+/// Deinitialize the given pack archive, releasing all of its allocated resources.
+///
+/// Any pointers into the contents of the given archive's entries are invalid after this function.
+/// @param pak The archive to deinitialize.
+void pak_deinit(struct pak_t *pak);
+
+/// Get the entry with the given name within the given pack archive.
+/// @param pak The archive to get the entry from.
+/// @param name The null-terminated name of the entry to get.
+/// @return The entry with the given name, or `NULL` if the given archive does not contain one.
+const struct pak_entry_t *pak_find(const struct pak_t *pak, const char *name);
+
+/// Get the contents of the entry with the given name within the given pack archive.
+///
+/// If the given archive does not contain an entry with the given name then the program terminates.
+/// @param pak The archive to get the entry from.
+/// @param name The null-terminated name of the entry to get.
+/// @param size The pointer to set the value of to the total size of the entry's contents, in bytes.
+/// @return The first byte of the entry's contents.
+/// This pointer is only valid for the lifetime of the given archive.
+const void *pak_get(const struct pak_t *pak, const char *name, size_t *size);
+
+/// Write a pack file containing the given entries to the current cursor of the given file handle.
+///
+/// The entries do not need to be sorted, and their names do not need to be hashed beforehand.
+/// If any two of the given entries have the same name then the program terminates.
+/// @param file The file handle to write the pack file to.
+/// @param num_entries The total number of entries to write.
+/// @param names All the null-terminated names of the entries to write.
+/// @param data The first byte of the contents of each entry to write.
+/// @param sizes The total size of the contents of each entry to write, in bytes.
+void pak_write(FILE *file,
+               unsigned int num_entries,
+               const char *const *names,
+               const void *const *data,
+               const size_t *sizes);
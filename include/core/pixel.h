@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+///
+/// Kernels for converting and rearranging 8-bit pixel data in memory.
+///
+/// Each kernel has a scalar implementation, and on x86 hosts also SSE2 and AVX2 implementations.
+/// The best implementation supported by the host is selected once, the first time that any kernel is used,
+/// and every implementation produces identical results.
+/// All kernels accept unaligned memory, and any number of pixels or rows.
+///
+/// Packing into compact layouts is the exception, and only has a scalar implementation,
+/// as it is performed when building atlas sets rather than while loading them.
+///
+
+// MARK: - Enumerations
+
+/// A set of kernel implementations.
+enum pixel_kernels_t
+{
+    /// Portable scalar implementations.
+    PIXEL_KERNELS_SCALAR,
+
+    /// 128-bit SSE2 implementations.
+    PIXEL_KERNELS_SSE2,
+
+    /// 256-bit AVX2 implementations.
+    PIXEL_KERNELS_AVX2,
+};
+
+/// The compact layouts which 8-bit RGBA pixels can be packed into.
+///
+/// 16-bit layouts are packed into a single little-endian integer per pixel, with the first channel in the highest bits.
+enum pixel_packing_t
+{
+    /// An 8-bit red channel.
+    PIXEL_PACKING_R8,
+
+    /// An 8-bit alpha channel.
+    PIXEL_PACKING_A8,
+
+    /// 8-bit red and green channels.
+    PIXEL_PACKING_RG8,
+
+    /// 5-bit red, 6-bit green, and 5-bit blue channels.
+    PIXEL_PACKING_RGB565,
+
+    /// 4-bit red, green, blue, and alpha channels.
+    PIXEL_PACKING_RGBA4444,
+
+    /// 5-bit red, green, and blue channels, and a 1-bit alpha channel.
+    PIXEL_PACKING_RGB5A1,
+};
+
+// MARK: - Functions
+
+/// Get whether or not the given kernel implementations are supported by the host.
+/// @param kernels The implementations to check.
+/// @return Whether or not the given implementations are supported by the host.
+bool pixel_kernels_are_supported(enum pixel_kernels_t kernels);
+
+/// Get the kernel implementations which are currently used.
+/// @return The kernel implementations which are currently used.
+enum pixel_kernels_t pixel_get_kernels();
+
+/// Set the kernel implementations to use.
+///
+/// This is intended for benchmarking and verifying implementations against each other,
+/// it must not be called while any kernel is running on another thread.
+/// If the given implementations are not supported by the host then an assertion fails.
+/// @param kernels The implementations to use.
+void pixel_set_kernels(enum pixel_kernels_t kernels);
+
+/// Expand the given 8-bit RGB pixels to 8-bit RGBA pixels with opaque alpha.
+/// @param source The first byte of the RGB pixels to expand.
+/// @param destination The first byte of the memory to write the RGBA pixels to.
+/// This must not overlap the given source.
+/// @param num_pixels The total number of pixels to expand.
+void pixel_rgb_to_rgba(const void *source, void *destination, size_t num_pixels);
+
+/// Multiply the colour channels of the given 8-bit RGBA pixels by their alpha, in place.
+///
+/// Each channel is rounded to the nearest value, so fully opaque pixels are unchanged and fully transparent pixels become zero.
+/// @param data The first byte of the RGBA pixels to premultiply.
+/// @param num_pixels The total number of pixels to premultiply.
+void pixel_premultiply_alpha(void *data, size_t num_pixels);
+
+/// Reverse the order of the given rows, in place.
+///
+/// This converts between rows ordered top-to-bottom and bottom-to-top without a second allocation.
+/// @param data The first byte of the first row to flip.
+/// @param row_size The size of a single row, in bytes.
+/// @param num_rows The total number of rows to flip.
+void pixel_flip_rows(void *data, size_t row_size, size_t num_rows);
+
+/// Rearrange the channels of the given 8-bit four channel pixels.
+///
+/// For example, an order of `{ 2, 1, 0, 3 }` converts between RGBA and BGRA.
+/// @param source The first byte of the pixels to rearrange.
+/// @param destination The first byte of the memory to write the rearranged pixels to.
+/// This may be the given source, but must not otherwise overlap it.
+/// @param num_pixels The total number of pixels to rearrange.
+/// @param order The index of the source channel of each destination channel.
+/// If any index is greater than `3` then an assertion fails.
+void pixel_swizzle(const void *source, void *destination, size_t num_pixels, const unsigned char order[4]);
+
+/// Pack the given 8-bit RGBA pixels into the given compact layout.
+///
+/// Channels are rounded to the nearest value representable by their width,
+/// except for 1-bit alpha which is set for alpha values of at least `128`.
+/// @param source The first byte of the RGBA pixels to pack.
+/// @param destination The first byte of the memory to write the packed pixels to.
+/// This must not overlap the given source.
+/// @param num_pixels The total number of pixels to pack.
+/// @param packing The layout to pack the given pixels into.
+void pixel_pack_rgba(const void *source, void *destination, size_t num_pixels, enum pixel_packing_t packing);
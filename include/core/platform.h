@@ -12,6 +12,38 @@
 char *platform_get_path();
 
 /// Get the absolute filesystem path of the given path relative to the directory containing the running program's executable.
+///
+/// The executable's directory is only resolved on the first call, so this is cheap enough to call for every asset.
 /// @return The null-terminated absolute filesystem path of the given relative path.
 /// This pointer is allocated and must be released by the caller.
 char *platform_get_relative_path(const char *relative_path);
+
+/// Get the total number of logical processors available to the running program.
+/// @return The total number of logical processors available to the running program, always at least one.
+unsigned int platform_get_num_processors();
+
+/// Get the current time of a monotonic clock, in milliseconds.
+///
+/// The clock has an unspecified origin, so this is only meaningful for measuring the time between two calls.
+/// @return The current time of a monotonic clock, in milliseconds.
+double platform_get_time();
+
+/// Get the names of all the regular files directly within the directory at the given filesystem path.
+///
+/// The names are sorted in ascending byte order so that the result is stable across platforms and runs.
+/// If the directory at the given path cannot be opened then the program terminates.
+/// @param path The filesystem path of the directory to list.
+/// @param num_files The pointer to set the value of to the total number of returned file names.
+/// @return All the null-terminated file names within the given directory.
+/// This pointer and each name within it are allocated and must be released by the caller.
+char **platform_get_directory_files(const char *path, unsigned int *num_files);
+
+/// Replace the file at the given destination filesystem path with the file at the given source filesystem path.
+///
+/// The source file is moved over the destination file in a single step, so readers of the destination file
+/// only ever see either its previous contents or its new contents, never a partially written file.
+/// Both paths must be within the same filesystem.
+/// If the file cannot be replaced then the program terminates.
+/// @param source_path The filesystem path of the file to move.
+/// @param destination_path The filesystem path of the file to replace.
+void platform_replace_file(const char *source_path, const char *destination_path);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdio.h>
+#include <stdbool.h>
 
 ///
 /// Utility wrapper around working with PNG images.
@@ -9,6 +10,9 @@
 // MARK: - Forward Declarations
 
 struct texture_t;
+struct texture_readback_t;
+struct buffer_t;
+struct pak_t;
 
 // MARK: - Data Structures
 
@@ -39,8 +43,73 @@ struct png_t
 
 };
 
+/// The options for encoding a PNG file.
+struct png_write_options_t
+{
+    /// The zlib compression level to compress the PNG's data with,
+    /// from `0` for no compression to `9` for the smallest output.
+    ///
+    /// libpng defaults to `6`.
+    int compression_level;
+
+    /// The filter applied to each row before it is compressed.
+    ///
+    /// libpng defaults to `PNG_WRITE_FILTER_ADAPTIVE`.
+    enum png_write_filter_t
+    {
+        /// Each row is filtered with whichever filter minimizes the sum of its absolute filtered bytes.
+        PNG_WRITE_FILTER_ADAPTIVE,
+
+        /// Rows are stored unchanged.
+        PNG_WRITE_FILTER_NONE,
+
+        /// Each byte is stored as the difference from the corresponding byte of the pixel to its left.
+        PNG_WRITE_FILTER_SUB,
+
+        /// Each byte is stored as the difference from the corresponding byte of the pixel above it.
+        PNG_WRITE_FILTER_UP,
+
+        /// Each byte is stored as the difference from the average of the pixels to its left and above it.
+        PNG_WRITE_FILTER_AVERAGE,
+
+        /// Each byte is stored as the difference from whichever of the pixels to its left, above it, or above and to its left
+        /// is closest to the gradient between them.
+        PNG_WRITE_FILTER_PAETH,
+    } filter;
+
+    /// The zlib strategy to compress the PNG's data with.
+    ///
+    /// libpng defaults to `PNG_WRITE_STRATEGY_FILTERED` for filtered rows.
+    enum png_write_strategy_t
+    {
+        /// The default zlib strategy, which is tuned for general data.
+        PNG_WRITE_STRATEGY_DEFAULT,
+
+        /// Favour Huffman coding over string matching, which suits the small values produced by filters.
+        PNG_WRITE_STRATEGY_FILTERED,
+
+        /// Only use Huffman coding, without string matching.
+        PNG_WRITE_STRATEGY_HUFFMAN_ONLY,
+
+        /// Only match runs of the same byte, which is nearly as fast as Huffman coding alone.
+        PNG_WRITE_STRATEGY_RLE,
+    } strategy;
+
+    /// The total number of horizontal strips to filter and compress concurrently on worker threads.
+    ///
+    /// Each strip is compressed independently and the results are joined into a single valid stream,
+    /// which is slightly larger than compressing the whole PNG at once as matches cannot cross strips.
+    /// When this is `0` or `1` the PNG is instead encoded by libpng on the calling thread.
+    unsigned int num_strips;
+};
+
 // MARK: - Functions
 
+/// Get the size of a single pixel in the given format, in bytes.
+/// @param format The format to get the pixel size of.
+/// @return The size of a single pixel in the given format, in bytes.
+size_t png_get_pixel_size(enum png_format_t format);
+
 /// Initialize the given PNG from the PNG file at the current cursor of the given file handle.
 ///
 /// If there is no valid PNG file at the current cursor of the given file handle then the program terminates.
@@ -49,6 +118,72 @@ struct png_t
 /// @param file The file handle to read the PNG file from.
 void png_init_file(struct png_t *png, FILE *file);
 
+/// Initialize the given PNG from the PNG file within the given memory.
+///
+/// The given memory is only read during this function, so it does not need to outlive the given PNG.
+/// If there is no valid PNG file within the given memory then the program terminates.
+/// If the PNG file's colour type cannot be converted to a known format then the program terminates.
+/// @param png The PNG to initialize.
+/// @param data The first byte of the PNG file.
+/// @param size The total size of the PNG file, in bytes.
+void png_init_memory(struct png_t *png, const void *data, size_t size);
+
+/// Initialize the given PNG from the PNG file within the entry with the given name in the given pack archive.
+///
+/// The PNG file is decoded directly from the archive's mapping, without first copying it.
+/// If the given archive does not contain an entry with the given name then the program terminates.
+/// If there is no valid PNG file within the entry then the program terminates.
+/// If the PNG file's colour type cannot be converted to a known format then the program terminates.
+/// @param png The PNG to initialize.
+/// @param pak The archive containing the PNG file.
+/// @param name The null-terminated name of the entry containing the PNG file.
+void png_init_pak(struct png_t *png, const struct pak_t *pak, const char *name);
+
+/// Read the header of the PNG file within the given memory, without decoding its data.
+///
+/// The returned format is the format that the PNG would have if it was initialized from the same memory.
+/// If there is no valid PNG file within the given memory then the program terminates.
+/// If the PNG file's colour type cannot be converted to a known format then the program terminates.
+/// @param data The first byte of the PNG file.
+/// @param size The total size of the PNG file, in bytes.
+/// @param width The pointer to set the value of to the width of the PNG, in pixels.
+/// @param height The pointer to set the value of to the height of the PNG, in pixels.
+/// @param format The pointer to set the value of to the format of the PNG's data.
+void png_read_header_memory(const void *data,
+                            size_t size,
+                            unsigned int *width,
+                            unsigned int *height,
+                            enum png_format_t *format);
+
+/// Attempt to read the header of the PNG file within the given memory, without decoding its data.
+///
+/// This is identical to `png_read_header_memory`, except that an invalid PNG file or unknown format is reported rather than terminating the program.
+/// @param data The first byte of the PNG file.
+/// @param size The total size of the PNG file, in bytes.
+/// @param width The pointer to set the value of to the width of the PNG, in pixels.
+/// @param height The pointer to set the value of to the height of the PNG, in pixels.
+/// @param format The pointer to set the value of to the format of the PNG's data.
+/// @return Whether or not there is a valid PNG file of a known format within the given memory.
+bool png_try_read_header_memory(const void *data,
+                                size_t size,
+                                unsigned int *width,
+                                unsigned int *height,
+                                enum png_format_t *format);
+
+/// Decode the PNG file within the given memory directly into the given destination, without allocating its data.
+///
+/// Rows are written to the given destination ordered bottom-to-top, as within `png_t`, and each row is written once per pass
+/// and never read back, so the destination may be memory that is slow to read from such as a mapped pixel buffer.
+/// The required size of the destination can be found beforehand with `png_read_header_memory` and `png_get_pixel_size`.
+/// If there is no valid PNG file within the given memory then the program terminates.
+/// If the PNG file's colour type cannot be converted to a known format then the program terminates.
+/// If the PNG file's data is not exactly the given destination size then the program terminates.
+/// @param data The first byte of the PNG file.
+/// @param size The total size of the PNG file, in bytes.
+/// @param destination The first byte of the memory to decode the PNG file's data into.
+/// @param destination_size The total size of the given destination, in bytes.
+void png_decode_memory(const void *data, size_t size, void *destination, size_t destination_size);
+
 /// Initialize the given PNG with the contents of the given 2D texture.
 ///
 /// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
@@ -57,11 +192,49 @@ void png_init_file(struct png_t *png, FILE *file);
 /// @param texture The texture to use the contents of for the new PNG.
 void png_init_texture(struct png_t *png, const struct texture_t *texture);
 
+/// Initialize the given PNG with the contents of the given texture readback.
+///
+/// If the contents of the given readback are not yet ready then this function waits for them, see `texture_readback_is_ready`.
+/// The given readback is left mapped, and must still be deinitialized by the caller.
+/// During this function `GL_PIXEL_PACK_BUFFER` is bound to and then unbound.
+/// @param png The PNG to initialize.
+/// @param readback The readback to copy the contents of into the new PNG.
+void png_init_readback(struct png_t *png, struct texture_readback_t *readback);
+
+/// Initialize the given PNG with the next mip level of the given PNG.
+///
+/// Each pixel of the new PNG is filtered from the 2x2 block of pixels at twice its coordinates within the given PNG,
+/// ignoring any of the block which lies outside of the given PNG.
+/// Colours are averaged in linear light rather than sRGB, and are weighted by alpha when there is an alpha channel,
+/// so that filtered edges neither darken nor pick up the colour of transparent pixels.
+/// If the given size is larger than half of the given PNG's size, rounded up, then an assertion fails.
+/// @param png The PNG to initialize.
+/// @param source The PNG to filter the new PNG from.
+/// @param width The width of the new PNG, in pixels.
+/// @param height The height of the new PNG, in pixels.
+void png_init_mipmap(struct png_t *png,
+                     const struct png_t *source,
+                     unsigned int width,
+                     unsigned int height);
+
 /// Deinitialize the given PNG, releasing all of its allocated resources.
 /// @param png The PNG to deinitialize.
 void png_deinit(struct png_t *png);
 
 /// Write the given PNG to the current cursor of the given file handle.
 /// @param png The PNG to write.
+/// @param options The options to encode the PNG file with, or `NULL` to use the libpng defaults.
 /// @param file The file handle to write the PNG file to.
-void png_write(struct png_t *png, FILE *file);
+void png_write(const struct png_t *png,
+               const struct png_write_options_t *options,
+               FILE *file);
+
+/// Write the given PNG to the end of the given buffer.
+///
+/// Unlike file handles this is safe to perform concurrently for different PNGs and buffers.
+/// @param png The PNG to write.
+/// @param options The options to encode the PNG file with, or `NULL` to use the libpng defaults.
+/// @param buffer The buffer to append the PNG file to.
+void png_write_buffer(const struct png_t *png,
+                      const struct png_write_options_t *options,
+                      struct buffer_t *buffer);
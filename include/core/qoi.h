@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "png.h"
+
+///
+/// An encoder and decoder for the Quite OK Image (QOI) format.
+///
+/// QOI is a lossless image format which encodes each pixel as a run, an index into a small table of recently seen pixels,
+/// or a small difference from the previous pixel, in a single pass with no entropy coding.
+/// This makes both encoding and decoding several times faster than PNG, at the cost of slightly larger files.
+///
+/// Images are read into and written from `png_t`, so they share its formats and its rows being ordered bottom-to-top.
+/// QOI files store their rows top-to-bottom, so rows are flipped while encoding and decoding rather than afterwards.
+///
+
+// MARK: - Functions
+
+/// Get the maximum size of the QOI file of an image with the given size and format, in bytes.
+/// @param width The width of the image, in pixels.
+/// @param height The height of the image, in pixels.
+/// @param format The format of the image's data.
+/// @return The maximum size of the QOI file of an image with the given size and format, in bytes.
+size_t qoi_get_max_size(unsigned int width, unsigned int height, enum png_format_t format);
+
+/// Initialize the given PNG from the QOI file at the current cursor of the given file handle.
+///
+/// QOI files do not store their size, so the given file handle is read to its end.
+/// If there is no valid QOI file at the current cursor of the given file handle then the program terminates.
+/// @param png The PNG to initialize.
+/// @param file The file handle to read the QOI file from.
+void qoi_init_file(struct png_t *png, FILE *file);
+
+/// Initialize the given PNG from the QOI file within the given memory.
+///
+/// The given memory is only read during this function, so it does not need to outlive the given PNG.
+/// If there is no valid QOI file within the given memory then the program terminates.
+/// @param png The PNG to initialize.
+/// @param data The first byte of the QOI file.
+/// @param size The total size of the QOI file, in bytes.
+void qoi_init_memory(struct png_t *png, const void *data, size_t size);
+
+/// Read the header of the QOI file within the given memory, without decoding its data.
+///
+/// If there is no valid QOI header within the given memory then the program terminates.
+/// @param data The first byte of the QOI file.
+/// @param size The total size of the QOI file, in bytes.
+/// @param width The pointer to set the value of to the width of the image, in pixels.
+/// @param height The pointer to set the value of to the height of the image, in pixels.
+/// @param format The pointer to set the value of to the format of the image's data.
+void qoi_read_header_memory(const void *data,
+                            size_t size,
+                            unsigned int *width,
+                            unsigned int *height,
+                            enum png_format_t *format);
+
+/// Decode the QOI file within the given memory directly into the given destination, without allocating its data.
+///
+/// Rows are written to the given destination ordered bottom-to-top, as within `png_t`, and each pixel is written once and never read back,
+/// so the destination may be memory that is slow to read from such as a mapped pixel buffer.
+/// If there is no valid QOI file within the given memory then the program terminates.
+/// If the QOI file's data is not exactly the given destination size then the program terminates.
+/// @param data The first byte of the QOI file.
+/// @param size The total size of the QOI file, in bytes.
+/// @param destination The first byte of the memory to decode the QOI file's data into.
+/// @param destination_size The total size of the given destination, in bytes.
+void qoi_decode_memory(const void *data, size_t size, void *destination, size_t destination_size);
+
+/// Write the given PNG as a QOI file to the current cursor of the given file handle.
+/// @param png The PNG to write.
+/// @param file The file handle to write the QOI file to.
+void qoi_write(const struct png_t *png, FILE *file);
+
+/// Write the given PNG as a QOI file to the end of the given buffer.
+///
+/// This is safe to perform concurrently for different PNGs and buffers.
+/// @param png The PNG to write.
+/// @param buffer The buffer to append the QOI file to.
+void qoi_write_buffer(const struct png_t *png, struct buffer_t *buffer);
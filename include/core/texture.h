@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdbool.h>
+
 #include "gl.h"
 #include "png.h"
 
@@ -15,6 +17,18 @@
 ///              UV coordinates are normalized to the array texture's size, and textures are placed within this size from UV 0,0.
 ///              For this reason it is generally recommended, though not required, to have all textures within a texture array be the same size.
 ///
+/// Textures can also have a block compressed format, where each 4x4 block of pixels is stored in a fixed number of bytes.
+/// These use four to eight times less memory and upload bandwidth than uncompressed formats, at the cost of some quality.
+/// Compressed textures are populated with pre-encoded blocks, see `bc.h`, and cannot have their mipmap generated.
+///
+/// The storage of every level of a texture is allocated once when it is created, and is immutable where `ARB_texture_storage` is available.
+/// The number of levels is decided by the texture's mip policy, see `texture_mipmaps_t`,
+/// so nearest scaled pixel art which is never minified allocates and generates no mip levels at all.
+///
+/// How a texture is sampled is not stored within the texture itself, but within a sampler object bound alongside it.
+/// Sampler objects are pooled per graphics context by its state cache, see `gl_state.h`,
+/// so every texture with the same scaling, wrap mode, and mip policy shares a single sampler.
+///
 /// When binding a texture a texture unit is specified.
 /// Using different units allows multiple textures to be used simultaneously in a single draw call or across multiple without re-binding.
 /// It is generally recommended to reserve a number of texture units to be "dynamic units" that will be re-bound many times.
@@ -63,6 +77,18 @@ struct texture_t
         TEXTURE_LINEAR = 0x1,
     } scaling;
 
+    /// How this texture is sampled outside of its bounds.
+    ///
+    /// This is `TEXTURE_REPEAT` unless it is changed with `texture_set_wrap`.
+    enum texture_wrap_t
+    {
+        /// The texture repeats infinitely.
+        TEXTURE_REPEAT = 0x0,
+
+        /// The edges of the texture extend infinitely.
+        TEXTURE_CLAMP = 0x1,
+    } wrap;
+
     /// The format of this texture's data.
     enum texture_format_t
     {
@@ -71,16 +97,225 @@ struct texture_t
 
         /// 8-bit unsigned red, green, blue, and alpha channels.
         TEXTURE_RGBAU8,
+
+        /// BC1 (DXT1) compressed opaque red, green, and blue channels, at 8 bytes per block.
+        TEXTURE_BC1,
+
+        /// BC3 (DXT5) compressed red, green, blue, and alpha channels, at 16 bytes per block.
+        TEXTURE_BC3,
+
+        /// BC7 (BPTC) compressed red, green, blue, and alpha channels, at 16 bytes per block.
+        ///
+        /// This is higher quality than BC3 at the same size, but is slower to encode.
+        TEXTURE_BC7,
+
+        /// An 8-bit unsigned red channel.
+        ///
+        /// Green and blue are sampled as zero, and alpha as one.
+        TEXTURE_R8,
+
+        /// An 8-bit unsigned alpha channel, such as for glyphs and masks.
+        ///
+        /// This is stored as a single red channel which is swizzled into alpha, so red, green, and blue are sampled as one.
+        TEXTURE_A8,
+
+        /// 8-bit unsigned red and green channels.
+        ///
+        /// Blue is sampled as zero, and alpha as one.
+        TEXTURE_RG8,
+
+        /// 5-bit red, 6-bit green, and 5-bit blue channels, packed into 16 bits.
+        TEXTURE_RGB565,
+
+        /// 4-bit red, green, blue, and alpha channels, packed into 16 bits.
+        TEXTURE_RGBA4444,
+
+        /// 5-bit red, green, and blue channels, and a 1-bit alpha channel, packed into 16 bits.
+        TEXTURE_RGB5A1,
     } format;
 
+    /// How the mip levels of this texture below the full size level are produced.
+    enum texture_mipmaps_t
+    {
+        /// There are no mip levels besides the full size level, and none are allocated.
+        ///
+        /// This is typical of nearest scaled pixel art, which is never drawn minified.
+        TEXTURE_MIPMAPS_NONE = 0x0,
+
+        /// The mip levels are generated from the full size level with `texture_generate_mipmap`.
+        TEXTURE_MIPMAPS_GENERATED = 0x1,
+
+        /// The mip levels are populated individually by the creator of the texture, such as from prefiltered data.
+        TEXTURE_MIPMAPS_STORED = 0x2,
+    } mipmaps;
+
+    /// The total number of mip levels of this texture, including the full size level.
+    ///
+    /// When this is greater than one the texture is minified by sampling its mip levels.
+    /// This is always one when this texture has no mip levels.
+    unsigned int num_levels;
+
     /// The unique OpenGL identifier of this texture.
     GLuint id;
 };
 
+/// An asynchronous read of the contents of a 2D texture back from the graphics context.
+///
+/// The texture is copied into a pixel buffer object on the graphics context's own timeline, followed by a fence,
+/// so issuing a readback returns immediately rather than stalling until all previously submitted work has completed.
+/// The copied pixels can then be mapped once the fence has been passed, typically a frame or two later.
+struct texture_readback_t
+{
+    /// The width of the texture being read, in pixels.
+    unsigned int width;
+
+    /// The height of the texture being read, in pixels.
+    unsigned int height;
+
+    /// The format of the contents of this readback, which is always uncompressed.
+    enum texture_format_t format;
+
+    /// The unique OpenGL identifier of the pixel buffer object that the texture is copied into.
+    GLuint pixel_buffer_id;
+
+    /// The fence which is signalled once the texture has been copied into this readback's pixel buffer.
+    ///
+    /// This is `NULL` once the fence has been passed.
+    GLsync fence;
+
+    /// The mapped contents of this readback's pixel buffer, or `NULL` if it has not been mapped.
+    const void *data;
+};
+
+/// A ring of pixel buffer objects used to stage uploads into textures, so that they are transferred asynchronously.
+///
+/// Uploads are made by reserving staging memory from the ring, filling it, and then committing it into a region of any texture.
+/// Committing only issues the transfer from the staging memory, so the render thread does not block on a driver copy,
+/// and the transfer overlaps with rendering.
+/// Each slot of the ring is fenced once its transfer is issued, and the fence is waited for before the slot is reserved again,
+/// so the staging memory of a slot is never overwritten while the graphics context may still be reading from it.
+/// Given enough slots to cover the uploads in flight, reserving never waits.
+///
+/// Staging memory can be filled from any thread, but reserving and committing must be done on the thread of the ring's graphics context.
+struct texture_upload_ring_t
+{
+    /// The total number of slots within this ring.
+    unsigned int num_slots;
+
+    /// All the slots within this ring.
+    struct texture_upload_slot_t
+    {
+        /// The unique OpenGL identifier of the pixel buffer object of this slot.
+        GLuint pixel_buffer_id;
+
+        /// The size of the storage of this slot's pixel buffer, in bytes.
+        ///
+        /// The storage grows to fit the largest upload staged through this slot.
+        size_t capacity;
+
+        /// The fence which is signalled once the last transfer from this slot has completed.
+        ///
+        /// This is `NULL` if this slot has never been committed, or once the fence has been passed.
+        GLsync fence;
+
+        /// Whether or not this slot is currently reserved, and is waiting to be committed.
+        bool is_reserved;
+    } *slots;
+
+    /// The index of the slot within `slots` to try reserving first, which is the least recently committed slot.
+    unsigned int next_slot;
+
+    /// The total number of reservations which had to wait for the previous transfer from their slot to complete.
+    ///
+    /// If this keeps increasing then the ring needs more slots.
+    unsigned int num_waits;
+};
+
+/// A reservation of staging memory within a texture upload ring.
+struct texture_upload_t
+{
+    /// The index of the slot within the ring which this reservation was made from.
+    unsigned int slot;
+
+    /// The size of the reserved staging memory, in bytes.
+    size_t size;
+
+    /// The first byte of the reserved staging memory.
+    ///
+    /// This memory is write-only and may be slow to read from, so it should be filled sequentially and never read.
+    void *data;
+};
+
 // MARK: - Functions
 
+/// Get the total number of mip levels in a full mip chain for a texture of the given size.
+///
+/// This includes the full size level, and each following level halves the size rounded down until both axes are one pixel.
+/// @param width The width of the texture, in pixels.
+/// @param height The height of the texture, in pixels.
+/// @return The total number of mip levels in a full mip chain for the given size.
+unsigned int texture_get_num_levels(unsigned int width, unsigned int height);
+
+/// Get the default mip policy of textures with the given scaling filter.
+///
+/// Nearest scaled textures are typically pixel art which is never drawn minified, so they have no mip levels,
+/// while linearly scaled textures have their mip levels generated.
+/// @param scaling The scaling filter of the texture.
+/// @return The default mip policy of textures with the given scaling filter.
+enum texture_mipmaps_t texture_get_default_mipmaps(enum texture_scaling_t scaling);
+
+/// Get the size of the given mip level of a texture along a single axis.
+/// @param size The size of the full size level along the axis, in pixels.
+/// @param level The mip level to get the size of.
+/// @return The size of the given mip level along the axis, in pixels.
+unsigned int texture_get_level_size(unsigned int size, unsigned int level);
+
+/// Get whether or not the given texture format is block compressed.
+/// @param format The format to check.
+/// @return Whether or not the given format is block compressed.
+bool texture_format_is_compressed(enum texture_format_t format);
+
+/// Get whether or not the given texture format is compact.
+///
+/// Compact formats are uncompressed, but store fewer channels or fewer bits per channel than `TEXTURE_RGBAU8`.
+/// Their texture data is packed from 8-bit RGBA pixels with `texture_convert_png`, with 16-bit texels stored little-endian regardless of the byte order of the host.
+/// @param format The format to check.
+/// @return Whether or not the given format is compact.
+bool texture_format_is_compact(enum texture_format_t format);
+
+/// Get whether or not the given texture format is supported by the current graphics context.
+///
+/// Uncompressed formats are always supported, while compressed formats depend on the extensions available.
+/// @param format The format to check.
+/// @return Whether or not the given format is supported by the current graphics context.
+bool texture_format_is_supported(enum texture_format_t format);
+
+/// Get the size of the texture data of an image with the given size in the given format, with no padding between rows.
+///
+/// Compressed formats are rounded up to whole blocks along each axis.
+/// @param format The format of the texture data.
+/// @param width The width of the image, in pixels.
+/// @param height The height of the image, in pixels.
+/// @return The size of the texture data of the given image, in bytes.
+size_t texture_get_data_size(enum texture_format_t format, unsigned int width, unsigned int height);
+
+/// Convert the given PNG's texture data into the given uncompressed format.
+///
+/// RGB PNGs are expanded to RGBA first, so compact formats with alpha are opaque.
+/// The exception is `TEXTURE_A8`, which takes the red channel of RGB PNGs so that greyscale masks can be stored without alpha.
+/// If the given format is compressed, or is `TEXTURE_RGBU8` while the given PNG is RGBA, then an assertion fails.
+/// @param png The PNG to convert the texture data of.
+/// @param format The format to convert the given PNG's texture data into.
+/// @param destination The first byte of the memory to write the converted texture data to.
+/// This must be exactly `texture_get_data_size` bytes for the given PNG's size.
+void texture_convert_png(const struct png_t *png,
+                         enum texture_format_t format,
+                         void *destination);
+
 /// Initialize the given texture with a 2D texture from the given PNG and parameters.
 ///
+/// The given PNG is uploaded synchronously, see `texture_upload_ring_t` for uploading without blocking.
+/// The new texture has the default mip policy for the given scaling filter, see `texture_get_default_mipmaps`.
 /// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
 /// @param texture The texture to initialize.
 /// @param scaling The scaling filter for the new texture to use.
@@ -89,8 +324,27 @@ void texture_init_png(struct texture_t *texture,
                       enum texture_scaling_t scaling,
                       const struct png_t *png);
 
+/// Initialize the given texture with a 2D texture in the given format and mip policy from the given PNG and parameters.
+///
+/// The given PNG is converted into the given format with `texture_convert_png` before it is uploaded,
+/// and when the given mip policy is `TEXTURE_MIPMAPS_GENERATED` the full mip chain is generated from it.
+/// Otherwise this behaves identically to `texture_init_png`.
+/// If the given format is compressed, or the given mip policy is `TEXTURE_MIPMAPS_STORED`, then an assertion fails.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param texture The texture to initialize.
+/// @param scaling The scaling filter for the new texture to use.
+/// @param mipmaps The mip policy of the new texture.
+/// @param png The PNG to create the new texture from.
+/// @param format The format of the new texture's data.
+void texture_init_png_format(struct texture_t *texture,
+                             enum texture_scaling_t scaling,
+                             enum texture_mipmaps_t mipmaps,
+                             const struct png_t *png,
+                             enum texture_format_t format);
+
 /// Initialize the given texture with an array texture from the given parameters, populated with 2D textures from the given PNGs.
 ///
+/// Mip levels are handled the same as `texture_init_png`.
 /// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
 /// @param texture The texture to initialize.
 /// @param width The width of the new array texture, in pixels.
@@ -106,11 +360,182 @@ void texture_init_png_array(struct texture_t *texture,
                             unsigned int num_pngs,
                             const struct png_t *pngs);
 
+/// Initialize the given texture with an empty array texture from the given parameters.
+///
+/// The elements of the new array texture can then be populated individually with `texture_set_array_png`.
+/// Every mip level is allocated, so each level can either be populated individually or generated with `texture_generate_mipmap`,
+/// as specified by the given mip policy.
+/// Compressed array textures are populated with `texture_set_array_blocks` instead, and are undefined until they are populated.
+/// Note that the appearance of empty elements varies depending on the format, see `texture_init_empty`.
+/// If the given format is not supported by the current graphics context then the program terminates.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param texture The texture to initialize.
+/// @param width The width of the new array texture, in pixels.
+/// @param height The height of the new array texture, in pixels.
+/// @param num_layers The total number of elements within the new array texture.
+/// @param num_levels The total number of mip levels of the new array texture, including the full size level.
+/// This must be between one and `texture_get_num_levels` for the given size, and must be one if the given mip policy has none.
+/// @param mipmaps The mip policy of the new array texture.
+/// @param scaling The scaling filter for the new array texture to use.
+/// @param format The format of the new array texture's data.
+void texture_init_empty_array(struct texture_t *texture,
+                              unsigned int width,
+                              unsigned int height,
+                              unsigned int num_layers,
+                              unsigned int num_levels,
+                              enum texture_mipmaps_t mipmaps,
+                              enum texture_scaling_t scaling,
+                              enum texture_format_t format);
+
+/// Populate the given mip level of the element at the given index within the given array texture with the given PNG.
+///
+/// The given PNG is placed at the bottom-left of the element, and must fit within the given mip level's size.
+/// Once all the elements of an array texture are populated the caller should either populate the remaining mip levels,
+/// or generate them with `texture_generate_mipmap`.
+/// RGB PNGs within RGBA array textures are expanded to RGBA with `pixel_rgb_to_rgba` before they are uploaded,
+/// and PNGs within compact array textures are converted with `texture_convert_png`.
+/// If the given texture is not an array texture, or the given mip level is out of bounds, then an assertion fails.
+/// If the given texture is compressed then an assertion fails, see `texture_set_array_blocks` instead.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param texture The array texture to populate the element of.
+/// @param index The index of the element to populate within the given array texture.
+/// @param level The mip level of the element to populate, where `0` is the full size level.
+/// @param png The PNG to populate the element with.
+void texture_set_array_png(struct texture_t *texture,
+                           unsigned int index,
+                           unsigned int level,
+                           const struct png_t *png);
+
+/// Populate the given mip level of the element at the given index within the given array texture with the given texture data.
+///
+/// The given texture data is placed at the bottom-left of the element, and must fit within the given mip level's size.
+/// The given format must either be the given texture's own format, or `TEXTURE_RGBU8` within a `TEXTURE_RGBAU8` array texture,
+/// in which case the given texture data is expanded to RGBA with `pixel_rgb_to_rgba` before it is uploaded.
+/// If the given texture is not an array texture, or the given mip level is out of bounds, then an assertion fails.
+/// If the given texture is compressed then an assertion fails, see `texture_set_array_blocks` instead.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param texture The array texture to populate the element of.
+/// @param index The index of the element to populate within the given array texture.
+/// @param level The mip level of the element to populate, where `0` is the full size level.
+/// @param width The width of the given texture data, in pixels.
+/// @param height The height of the given texture data, in pixels.
+/// @param format The format of the given texture data.
+/// @param data The first byte of the texture data to populate the element with, with rows ordered bottom-to-top.
+void texture_set_array_data(struct texture_t *texture,
+                            unsigned int index,
+                            unsigned int level,
+                            unsigned int width,
+                            unsigned int height,
+                            enum texture_format_t format,
+                            const void *data);
+
+/// Clear a region of the given mip level of the element at the given index within the given array texture to zero,
+/// which is transparent black for formats with alpha.
+///
+/// This is cleared within the graphics context where `glClearTexSubImage` is supported, otherwise zeros are uploaded.
+/// If the given texture is not an uncompressed array texture, or the region is not within the given mip level, then an assertion fails.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param texture The array texture to clear the region of.
+/// @param index The index of the element to clear the region of within the given array texture.
+/// @param level The mip level of the element to clear the region of, where `0` is the full size level.
+/// @param x The horizontal position of the region's left edge, in pixels.
+/// @param y The vertical position of the region's bottom edge, in pixels.
+/// @param width The width of the region, in pixels.
+/// @param height The height of the region, in pixels.
+void texture_clear_array_region(struct texture_t *texture,
+                                unsigned int index,
+                                unsigned int level,
+                                unsigned int x,
+                                unsigned int y,
+                                unsigned int width,
+                                unsigned int height);
+
+/// Populate the given mip level of the element at the given index within the given compressed array texture with the given blocks.
+///
+/// The given blocks are placed at the bottom-left of the element, and must fit within the given mip level's size.
+/// Compressed textures cannot have their mipmap generated, so every mip level of every element should be populated.
+/// If the given texture is not a compressed array texture, or the given mip level is out of bounds, then an assertion fails.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param texture The compressed array texture to populate the element of.
+/// @param index The index of the element to populate within the given array texture.
+/// @param level The mip level of the element to populate, where `0` is the full size level.
+/// @param width The width of the image that the given blocks encode, in pixels.
+/// @param height The height of the image that the given blocks encode, in pixels.
+/// @param data The first byte of the blocks to populate the element with, in the given texture's format.
+/// Block rows are ordered bottom-to-top, and this must be exactly `texture_get_data_size` bytes.
+void texture_set_array_blocks(struct texture_t *texture,
+                              unsigned int index,
+                              unsigned int level,
+                              unsigned int width,
+                              unsigned int height,
+                              const void *data);
+
+/// Orphan the storage of the given pixel buffer object with new storage of the given size, and map it for writing.
+///
+/// The returned memory is write-only and may be slow to read from, so it should be filled sequentially and never read.
+/// It may be filled from any thread, but must be unmapped on the thread that mapped it, such as by `texture_set_array_pixel_buffer`.
+/// During this function `GL_PIXEL_UNPACK_BUFFER` is bound to and then unbound.
+/// @param pixel_buffer_id The unique OpenGL identifier of the pixel buffer object to map.
+/// @param size The size of the new storage, in bytes.
+/// @return The first byte of the mapped storage of the given pixel buffer.
+void *texture_map_pixel_buffer(GLuint pixel_buffer_id, size_t size);
+
+/// Unmap the given pixel buffer object and populate the element at the given index within the given array texture from its contents.
+///
+/// The given pixel buffer must have been mapped with `texture_map_pixel_buffer` and filled with texture data of the given size and format,
+/// with rows ordered bottom-to-top.
+/// Compressed texture data must be in the given texture's own format, while uncompressed texture data is converted by the driver.
+/// The upload is issued from the pixel buffer, so the driver can perform the transfer asynchronously.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to, and `GL_PIXEL_UNPACK_BUFFER` is bound to and then unbound.
+/// @param texture The array texture to populate the element of.
+/// @param index The index of the element to populate within the given array texture.
+/// @param level The mip level of the element to populate, where `0` is the full size level.
+/// @param width The width of the texture data within the given pixel buffer, in pixels.
+/// @param height The height of the texture data within the given pixel buffer, in pixels.
+/// @param format The format of the texture data within the given pixel buffer.
+/// @param pixel_buffer_id The unique OpenGL identifier of the pixel buffer object to populate the element from.
+void texture_set_array_pixel_buffer(struct texture_t *texture,
+                                    unsigned int index,
+                                    unsigned int level,
+                                    unsigned int width,
+                                    unsigned int height,
+                                    enum texture_format_t format,
+                                    GLuint pixel_buffer_id);
+
+/// Populate the element at the given index within the given array texture with the given PNG, staged through the given pixel buffer object.
+///
+/// The given pixel buffer's storage is orphaned and refilled with the given PNG's data before the upload is issued,
+/// so the driver can perform the transfer asynchronously rather than blocking until the previous use of the buffer has completed.
+/// Otherwise this behaves identically to `texture_set_array_png`.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to, and `GL_PIXEL_UNPACK_BUFFER` is bound to and then unbound.
+/// @param texture The array texture to populate the element of.
+/// @param index The index of the element to populate within the given array texture.
+/// @param level The mip level of the element to populate, where `0` is the full size level.
+/// @param png The PNG to populate the element with.
+/// @param pixel_buffer_id The unique OpenGL identifier of the pixel buffer object to stage the given PNG's data through.
+void texture_set_array_png_buffered(struct texture_t *texture,
+                                    unsigned int index,
+                                    unsigned int level,
+                                    const struct png_t *png,
+                                    GLuint pixel_buffer_id);
+
+/// Generate the mipmap of the given texture from its current contents.
+///
+/// Every mip level of the given texture below the full size level is regenerated.
+/// If the given texture is compressed, or its mip policy is not `TEXTURE_MIPMAPS_GENERATED`, then an assertion fails.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param texture The texture to generate the mipmap of.
+void texture_generate_mipmap(struct texture_t *texture);
+
 /// Initialize the given texture with an empty 2D texture from the given parameters.
 ///
+/// The new texture has no mip levels.
 /// Note that the appearance of an empty texture varies depending on the format:
-///  - `TEXTURE_RGBU8`: Solid black.
-///  - `TEXTURE_RGBAU8`: Transparent.
+///  - `TEXTURE_RGBU8`, `TEXTURE_R8`, `TEXTURE_RG8`, and `TEXTURE_RGB565`: Solid black.
+///  - `TEXTURE_RGBAU8`, `TEXTURE_RGBA4444`, and `TEXTURE_RGB5A1`: Transparent.
+///  - `TEXTURE_A8`: Transparent white.
+///  - Compressed formats: Undefined.
+/// If the given format is not supported by the current graphics context then the program terminates.
 /// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
 /// @param texture The texture to initialize.
 /// @param width The width of the new texture, in pixels.
@@ -129,12 +554,141 @@ void texture_init_empty(struct texture_t *texture,
 /// @param texture The texture to deinitialize.
 void texture_deinit(struct texture_t *texture);
 
+/// Set how the given texture is sampled outside of its bounds.
+///
+/// This only changes which sampler object is bound alongside the given texture, so it takes effect the next time it is bound.
+/// @param texture The texture to set the wrap mode of.
+/// @param wrap The wrap mode for the given texture to use.
+void texture_set_wrap(struct texture_t *texture, enum texture_wrap_t wrap);
+
 /// Bind the given texture to the given texture within the current graphics context.
 ///
 /// This function must be called at least once before the given texture can be used for drawing.
 /// This overwrites any previously bound texture within the given unit.
+/// The pooled sampler object matching the given texture's scaling, wrap mode, and mip levels is bound to the given unit alongside it,
+/// see `gl_state_bind_sampler`.
 /// If the given unit is greater than or equal to `TEXTURE_MAX_UNITS` then an assertion fails.
 /// During this function the given unit is activated and bound to.
 /// @param texture The texture to bind.
 /// @param unit The unit to bind the given texture to.
 void texture_bind(const struct texture_t *texture, unsigned int unit);
+
+/// Begin reading the contents of the given 2D texture back from the graphics context.
+///
+/// This function returns immediately, having only issued the copy and its fence.
+/// The contents are read as they are at the time of this function, later changes to the given texture are not included.
+/// Compressed textures are decompressed as they are read, into `TEXTURE_RGBU8` for BC1 and `TEXTURE_RGBAU8` otherwise.
+/// Compact textures are widened as they are read, into `TEXTURE_RGBAU8` for those which store alpha and `TEXTURE_RGBU8` otherwise.
+/// Swizzles are not applied when reading, so `TEXTURE_A8` textures are read into the red channel of `TEXTURE_RGBU8`.
+/// If the given texture is not a 2D texture then an assertion fails.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to, and `GL_PIXEL_PACK_BUFFER` is bound to and then unbound.
+/// @param readback The readback to initialize.
+/// @param texture The texture to read the contents of.
+void texture_readback_init(struct texture_readback_t *readback,
+                           const struct texture_t *texture);
+
+/// Deinitialize the given readback, releasing all of its allocated resources.
+///
+/// Readbacks may be deinitialized whether or not they are ready, discarding their contents.
+/// @param readback The readback to deinitialize.
+void texture_readback_deinit(struct texture_readback_t *readback);
+
+/// Get whether or not the contents of the given readback are ready, without waiting for them.
+///
+/// Once this returns `true` mapping the given readback does not stall.
+/// @param readback The readback to check.
+/// @return Whether or not the contents of the given readback are ready.
+bool texture_readback_is_ready(struct texture_readback_t *readback);
+
+/// Map the contents of the given readback for reading, waiting for them to be ready if needed.
+///
+/// The contents are laid out as with `png_t`, with tightly packed rows ordered bottom-to-top.
+/// Mapping an already mapped readback returns the same contents.
+/// During this function `GL_PIXEL_PACK_BUFFER` is bound to and then unbound.
+/// @param readback The readback to map.
+/// @return The first byte of the contents of the given readback.
+/// This pointer is only valid until the given readback is deinitialized.
+const void *texture_readback_map(struct texture_readback_t *readback);
+
+/// Initialize the given upload ring with the given number of slots.
+///
+/// Each slot starts out with storage for the given number of bytes, which grows as needed.
+/// Staging memory is only reserved on demand, so these only need to be as large as typical uploads.
+/// @param ring The upload ring to initialize.
+/// @param num_slots The total number of slots within the new upload ring.
+/// This is the maximum number of reservations which can be outstanding at once, and must be at least one.
+/// @param slot_size The initial size of the storage of each slot, in bytes.
+void texture_upload_ring_init(struct texture_upload_ring_t *ring,
+                              unsigned int num_slots,
+                              size_t slot_size);
+
+/// Deinitialize the given upload ring, releasing all of its allocated resources.
+///
+/// Any outstanding reservations are discarded.
+/// @param ring The upload ring to deinitialize.
+void texture_upload_ring_deinit(struct texture_upload_ring_t *ring);
+
+/// Reserve the given amount of staging memory from the given upload ring.
+///
+/// The least recently committed slot which is not reserved is used,
+/// waiting for the previous transfer from it to complete if needed.
+/// Every reservation must then be committed with `texture_upload_ring_commit`.
+/// If every slot within the given ring is already reserved then an assertion fails.
+/// During this function `GL_PIXEL_UNPACK_BUFFER` is bound to and then unbound.
+/// @param ring The upload ring to reserve staging memory from.
+/// @param size The amount of staging memory to reserve, in bytes.
+/// @param upload The reservation to initialize.
+void texture_upload_ring_reserve(struct texture_upload_ring_t *ring,
+                                 size_t size,
+                                 struct texture_upload_t *upload);
+
+/// Commit the given reservation as an upload into a region of the given mip level of the given layer within the given texture.
+///
+/// The staging memory of the given reservation must have been filled with texture data of the given size and format,
+/// laid out as with `png_t`, with tightly packed rows ordered bottom-to-top.
+/// Compressed texture data must be in the given texture's own format, and regions must start on block boundaries,
+/// while uncompressed texture data is converted by the driver.
+/// Once this function returns the staging memory of the given reservation is no longer available.
+/// If the region is not within the given mip level, or the given texture has no such layer, then an assertion fails.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to, and `GL_PIXEL_UNPACK_BUFFER` is bound to and then unbound.
+/// @param ring The upload ring which the given reservation was made from.
+/// @param upload The reservation to commit.
+/// @param texture The texture to upload into.
+/// @param layer The index of the element to upload into within the given texture, which must be `0` for 2D textures.
+/// @param level The mip level to upload into, where `0` is the full size level.
+/// @param x The X offset of the region from the left of the given mip level, in pixels.
+/// @param y The Y offset of the region from the bottom of the given mip level, in pixels.
+/// @param width The width of the texture data within the given reservation, in pixels.
+/// @param height The height of the texture data within the given reservation, in pixels.
+/// @param format The format of the texture data within the given reservation.
+void texture_upload_ring_commit(struct texture_upload_ring_t *ring,
+                                const struct texture_upload_t *upload,
+                                struct texture_t *texture,
+                                unsigned int layer,
+                                unsigned int level,
+                                unsigned int x,
+                                unsigned int y,
+                                unsigned int width,
+                                unsigned int height,
+                                enum texture_format_t format);
+
+/// Upload the given PNG into a region of the given mip level of the given layer within the given uncompressed texture,
+/// staged through the given upload ring.
+///
+/// RGB PNGs uploaded into RGBA textures are expanded to RGBA with `pixel_rgb_to_rgba` as they are staged.
+/// See `texture_upload_ring_commit` for further documentation.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to, and `GL_PIXEL_UNPACK_BUFFER` is bound to and then unbound.
+/// @param ring The upload ring to stage the given PNG through.
+/// @param texture The uncompressed texture to upload into.
+/// @param layer The index of the element to upload into within the given texture, which must be `0` for 2D textures.
+/// @param level The mip level to upload into, where `0` is the full size level.
+/// @param x The X offset of the region from the left of the given mip level, in pixels.
+/// @param y The Y offset of the region from the bottom of the given mip level, in pixels.
+/// @param png The PNG to upload.
+void texture_upload_ring_png(struct texture_upload_ring_t *ring,
+                             struct texture_t *texture,
+                             unsigned int layer,
+                             unsigned int level,
+                             unsigned int x,
+                             unsigned int y,
+                             const struct png_t *png);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+///
+/// Watches notify when a single file is changed on disk, so that it can be reloaded while the program is running.
+///
+/// Rather than the file itself, watches observe the directory containing the file,
+/// so that files which are replaced by renaming a new file over them are still noticed.
+/// Watches are polled without blocking, so they can be checked once per frame.
+///
+
+// MARK: - Data Structures
+
+/// A watch on a single file.
+struct watch_t
+{
+    /// The filesystem path of the file that this watch is observing.
+    ///
+    /// Allocated.
+    char *path;
+
+    /// The name of the file that this watch is observing within its directory.
+    ///
+    /// Allocated.
+    char *name;
+
+    /// The inotify instance of this watch.
+    ///
+    /// This is only used on Linux.
+    int descriptor;
+
+    /// The platform-specific handle to this watch's change notification.
+    ///
+    /// This is only used on Windows, where notifications are for the whole directory rather than individual files.
+    void *notification_handle;
+
+    /// The last write time of this watch's file, as of the last time that it was checked.
+    ///
+    /// This is only used on Windows, to tell which directory changes affected this watch's file.
+    uint64_t write_time;
+};
+
+// MARK: - Functions
+
+/// Initialize the given watch on the file at the given filesystem path.
+///
+/// The file does not need to exist yet, but its directory does.
+/// If the directory of the given path is unable to be watched then the program terminates.
+/// @param watch The watch to initialize.
+/// @param path The filesystem path of the file to watch.
+void watch_init(struct watch_t *watch, const char *path);
+
+/// Deinitialize the given watch, releasing all of its allocated resources.
+/// @param watch The watch to deinitialize.
+void watch_deinit(struct watch_t *watch);
+
+/// Get whether or not the given watch's file has changed since the last poll, without blocking.
+///
+/// Changes are only reported once the file has been closed after writing or moved into place,
+/// so the file is complete when this returns `true`.
+/// Several changes between polls are reported as a single change.
+/// @param watch The watch to poll.
+/// @return Whether or not the given watch's file has changed since the last poll.
+bool watch_poll(struct watch_t *watch);
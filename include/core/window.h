@@ -5,6 +5,7 @@
 #include "gl.h"
 #include "colour.h"
 #include "texture.h"
+#include "gl_state.h"
 
 ///
 /// Windows are independent desktop windows which contain a graphics context.
@@ -36,6 +37,11 @@ struct window_t
 
     /// The backing GLFW window of this window.
     GLFWwindow *backing;
+
+    /// The binding state cache of this window's graphics context.
+    ///
+    /// This is made current along with the graphics context by `window_set_current(struct window_t *)`.
+    struct gl_state_t state;
 };
 
 // MARK: - Functions
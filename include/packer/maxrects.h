@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+///
+/// A MaxRects bin packer, for placing rectangles within a fixed-size bin.
+///
+/// MaxRects tracks the free space of a bin as a list of maximal free rectangles, which may overlap.
+/// Each inserted rectangle is placed within whichever free rectangle scores best for the chosen heuristic,
+/// then every free rectangle that it intersects is split around it and any free rectangles contained by another are pruned.
+/// This typically achieves a much denser packing than shelf or skyline packers, at a higher cost per insertion.
+///
+/// Rectangles are never rotated, as sprites within atlases have no way to represent a rotation.
+///
+
+// MARK: - Data Structures
+
+/// A rectangle within a MaxRects bin, in pixels from the bottom left of the bin.
+struct maxrects_rect_t
+{
+    /// The horizontal position of this rectangle's bottom left corner.
+    unsigned int x;
+
+    /// The vertical position of this rectangle's bottom left corner.
+    unsigned int y;
+
+    /// The width of this rectangle.
+    unsigned int width;
+
+    /// The height of this rectangle.
+    unsigned int height;
+};
+
+/// The heuristics available for choosing where to place a rectangle within a MaxRects bin.
+enum maxrects_heuristic_t
+{
+    /// Place within the free rectangle which leaves the smallest leftover on its shorter side.
+    MAXRECTS_BEST_SHORT_SIDE_FIT,
+
+    /// Place within the free rectangle which leaves the smallest leftover on its longer side.
+    MAXRECTS_BEST_LONG_SIDE_FIT,
+
+    /// Place within the smallest free rectangle that fits.
+    MAXRECTS_BEST_AREA_FIT,
+
+    /// Place as close to the bottom, then left, of the bin as possible.
+    MAXRECTS_BOTTOM_LEFT,
+};
+
+/// The total number of available MaxRects heuristics.
+#define MAXRECTS_NUM_HEURISTICS (4)
+
+/// A single fixed-size bin which rectangles are packed into.
+struct maxrects_t
+{
+    /// The width of this bin.
+    unsigned int width;
+
+    /// The height of this bin.
+    unsigned int height;
+
+    /// The total area of all the rectangles placed within this bin.
+    uint64_t used_area;
+
+    /// The total number of free rectangles within this bin.
+    unsigned int num_free_rects;
+
+    /// The total number of free rectangles that `free_rects` can hold before it must be reallocated.
+    unsigned int free_rects_capacity;
+
+    /// All the maximal free rectangles within this bin.
+    ///
+    /// Allocated.
+    struct maxrects_rect_t *free_rects;
+};
+
+// MARK: - Functions
+
+/// Initialize the given MaxRects bin as empty, with the given size.
+/// @param bin The bin to initialize.
+/// @param width The width of the new bin.
+/// @param height The height of the new bin.
+void maxrects_init(struct maxrects_t *bin,
+                   unsigned int width,
+                   unsigned int height);
+
+/// Deinitialize the given MaxRects bin, releasing all of its allocated resources.
+/// @param bin The bin to deinitialize.
+void maxrects_deinit(struct maxrects_t *bin);
+
+/// Attempt to place a rectangle of the given size within the given MaxRects bin.
+/// @param bin The bin to place the rectangle within.
+/// @param width The width of the rectangle to place.
+/// @param height The height of the rectangle to place.
+/// @param heuristic The heuristic to use to choose where to place the rectangle.
+/// @param rect The pointer to set the value of to the placed rectangle, if it was placed.
+/// @return Whether or not the rectangle could be placed within the given bin.
+bool maxrects_insert(struct maxrects_t *bin,
+                     unsigned int width,
+                     unsigned int height,
+                     enum maxrects_heuristic_t heuristic,
+                     struct maxrects_rect_t *rect);
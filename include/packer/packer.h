@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+///
+/// Packers place a set of rectangles into as few fixed-size atlases as possible.
+///
+/// Packing is attempted with every combination of MaxRects heuristic and rectangle ordering concurrently,
+/// and the attempt using the fewest atlases, then the least total atlas area, is kept.
+/// Each atlas is then shrunk to the bounds of its contents, optionally rounded up to a power of two.
+///
+
+// MARK: - Data Structures
+
+/// The options used to pack rectangles with a packer.
+struct packer_options_t
+{
+    /// The maximum width and height of each atlas, in pixels.
+    ///
+    /// If `power_of_two` is set then the largest power of two not above this is used instead.
+    unsigned int max_size;
+
+    /// The number of empty pixels to leave between each rectangle and around the edges of each atlas.
+    unsigned int padding;
+
+    /// Whether or not the width and height of each atlas should be rounded up to a power of two.
+    bool power_of_two;
+};
+
+/// The result of packing a set of rectangles into atlases.
+struct packer_t
+{
+    /// The total number of atlases that the rectangles were packed into.
+    unsigned int num_atlases;
+
+    /// All the atlases that the rectangles were packed into.
+    ///
+    /// Allocated.
+    struct packer_atlas_t
+    {
+        /// The width of this atlas, in pixels.
+        unsigned int width;
+
+        /// The height of this atlas, in pixels.
+        unsigned int height;
+    } *atlases;
+
+    /// The total number of packed rectangles.
+    unsigned int num_rects;
+
+    /// All the packed rectangles, in the order that they were given.
+    ///
+    /// Allocated.
+    struct packer_rect_t
+    {
+        /// The width of this rectangle, in pixels.
+        unsigned int width;
+
+        /// The height of this rectangle, in pixels.
+        unsigned int height;
+
+        /// The index of the atlas that this rectangle was placed within.
+        unsigned int atlas_index;
+
+        /// The horizontal position of this rectangle's bottom left corner within its atlas, in pixels.
+        unsigned int x;
+
+        /// The vertical position of this rectangle's bottom left corner within its atlas, in pixels.
+        unsigned int y;
+    } *rects;
+
+    /// The total area of all the packed rectangles, in pixels.
+    uint64_t used_area;
+
+    /// The total area of all the atlases, in pixels.
+    uint64_t atlas_area;
+};
+
+// MARK: - Functions
+
+/// Get the largest size that a rectangle can have and still be packed with the given options.
+///
+/// This accounts for the padding around the rectangle, and is the same for both width and height.
+/// @param options The options to get the maximum rectangle size for.
+/// @return The largest width and height that a rectangle can have with the given options, in pixels.
+unsigned int packer_get_max_rect_size(const struct packer_options_t *options);
+
+/// Initialize the given packer by packing rectangles of the given sizes with the given options.
+///
+/// If any of the given sizes do not fit within `packer_get_max_rect_size(options)` then an assertion fails.
+/// @param packer The packer to initialize.
+/// @param num_rects The total number of rectangles to pack.
+/// @param widths The width of each rectangle to pack, in pixels.
+/// @param heights The height of each rectangle to pack, in pixels.
+/// @param options The options to pack the rectangles with.
+void packer_init(struct packer_t *packer,
+                 unsigned int num_rects,
+                 const unsigned int *widths,
+                 const unsigned int *heights,
+                 const struct packer_options_t *options);
+
+/// Deinitialize the given packer, releasing all of its allocated resources.
+/// @param packer The packer to deinitialize.
+void packer_deinit(struct packer_t *packer);
+
+/// Get the packing efficiency of the given packer.
+/// @param packer The packer to get the efficiency of.
+/// @return The fraction of the total atlas area of the given packer which is used by its rectangles, from `0` to `1`.
+float packer_get_efficiency(const struct packer_t *packer);
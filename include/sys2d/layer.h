@@ -6,6 +6,8 @@
 #include <core/uv.h>
 #include <core/mesh.h>
 #include <core/matrix.h>
+#include <core/ast.h>
+#include <core/atlas.h>
 
 ///
 /// Layers are the core of Sys2D; defining scene graphs, their contents, rendering state, and providing drawing information.
@@ -247,6 +249,27 @@ void layer_set_size(struct layer_t *layer,
 void layer_add_attachment(struct layer_t *layer,
                           struct layer_attachment_t attachment);
 
+/// Create a texture attachment which samples the given sprite from the array texture containing its atlas within the given atlas set arrays.
+///
+/// Drawers bind the texture of each attachment when drawing it, so sprites from different size class arrays can be drawn alongside each other.
+/// @param arrays The arrays containing the given sprite's atlas.
+/// It is expected that these arrays are available for the entire lifetime of the new attachment.
+/// @param sprite The sprite to sample, from the given arrays' set.
+/// @return The new texture attachment sampling the given sprite.
+struct layer_attachment_t layer_attachment_sprite(const struct ast_arrays_t *arrays,
+                                                  const struct ast_sprite_t *sprite);
+
+/// Create a texture attachment which samples the given entry from the array texture of the given dynamic atlas.
+///
+/// Attachments sampling the same dynamic atlas share its texture, so they can be drawn alongside each other without rebinding.
+/// Defragmenting the given atlas moves its entries, so the new attachment must be recreated once the atlas' generation changes.
+/// @param atlas The dynamic atlas containing the given entry.
+/// It is expected that this atlas is available for the entire lifetime of the new attachment.
+/// @param entry The index of the entry to sample within the given atlas' entries.
+/// @return The new texture attachment sampling the given entry.
+struct layer_attachment_t layer_attachment_atlas_entry(struct atlas_t *atlas,
+                                                       unsigned int entry);
+
 /// Remove the attachment at the given index from the given layer.
 ///
 /// If the given index is out of bounds of the given layer's attachments then an assertion fails.
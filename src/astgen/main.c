@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "ast.h"
+
+///
+/// The atlas set header generator, which compiles the sprites of an atlas set file into a C header.
+///
+/// Usage: `astgen <input file> <output file> <prefix>`
+///
+/// The generated header contains, where `PREFIX` is the given prefix in upper case:
+///  - `PREFIX_CONTENT_HASH`: The content hash of the set, to check with `ast_verify_content_hash` when loading it.
+///  - `enum prefix_sprite_t`: The index of each sprite within the set, as `PREFIX_SPRITE_<ID>`, followed by `PREFIX_NUM_SPRITES`.
+///  - `prefix_sprite_rects`: A static table of the placement of each sprite, indexed by the enumeration.
+/// Sprite identifiers are converted to upper case with any characters which are not valid within C identifiers replaced by underscores.
+///
+
+// MARK: - Functions
+
+/// Print the usage of the generator and terminate.
+void astgen_print_usage()
+{
+    fprintf(stderr, "usage: astgen <input file> <output file> <prefix>\n");
+    exit(EXIT_FAILURE);
+}
+
+/// Convert the given string to a C identifier fragment in the given case.
+/// @param string The null-terminated string to convert.
+/// @param is_upper Whether the converted fragment should be upper case, otherwise it is lower case.
+/// @return The null-terminated converted fragment.
+/// This pointer is allocated and must be released by the caller.
+char *astgen_get_identifier(const char *string, bool is_upper)
+{
+    size_t length = strlen(string);
+    char *identifier = malloc(length + 1);
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned char c = (unsigned char)string[i];
+        if (isalnum(c))
+            identifier[i] = (is_upper) ? toupper(c) : tolower(c);
+        else
+            identifier[i] = '_';
+    }
+
+    identifier[length] = '\0';
+    return identifier;
+}
+
+int main(int argc, char **argv)
+{
+    // parse the arguments
+    if (argc != 4)
+        astgen_print_usage();
+
+    const char *input_path = argv[1];
+    const char *output_path = argv[2];
+    char *prefix_upper = astgen_get_identifier(argv[3], true);
+    char *prefix_lower = astgen_get_identifier(argv[3], false);
+    if (prefix_lower[0] == '\0' || isdigit((unsigned char)prefix_lower[0]))
+        astgen_print_usage();
+
+    // read the set
+    struct ast_t ast;
+    ast_init(&ast, input_path);
+
+    // get the enumeration constant of each sprite,
+    // ensuring that no two sprites convert to the same constant
+    char **constants = malloc(ast.num_sprites * sizeof(char *));
+    for (unsigned int i = 0; i < ast.num_sprites; i++)
+    {
+        constants[i] = astgen_get_identifier(ast.sprites[i].id, true);
+        for (unsigned int j = 0; j < i; j++)
+        {
+            if (strcmp(constants[i], constants[j]) == 0)
+            {
+                fprintf(stderr, "ASTGEN ERROR: sprites \"%s\" and \"%s\" both convert to the constant %s_SPRITE_%s\n", ast.sprites[j].id, ast.sprites[i].id, prefix_upper, constants[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    // open the header
+    FILE *file = fopen(output_path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ASTGEN ERROR: unable to open output file at \"%s\"\n", output_path);
+        exit(EXIT_FAILURE);
+    }
+
+    // write the preamble and content hash
+    fprintf(file, "#pragma once\n\n");
+    fprintf(file, "#include \"ast.h\"\n\n");
+    fprintf(file, "///\n");
+    fprintf(file, "/// The sprites of the atlas set at \"%s\".\n", input_path);
+    fprintf(file, "///\n");
+    fprintf(file, "/// This file is generated by astgen and should not be edited.\n");
+    fprintf(file, "///\n\n");
+    fprintf(file, "// MARK: - Macros\n\n");
+    fprintf(file, "/// The content hash of the atlas set that this header was generated from.\n");
+    fprintf(file, "#define %s_CONTENT_HASH (0x%016llxull)\n\n", prefix_upper, (unsigned long long)ast_get_content_hash(&ast));
+
+    // write the sprite enumeration
+    fprintf(file, "// MARK: - Enumerations\n\n");
+    fprintf(file, "/// The index of each sprite within the atlas set.\n");
+    fprintf(file, "enum %s_sprite_t\n{\n", prefix_lower);
+    for (unsigned int i = 0; i < ast.num_sprites; i++)
+        fprintf(file, "    %s_SPRITE_%s = %u,\n", prefix_upper, constants[i], i);
+    fprintf(file, "    %s_NUM_SPRITES = %u,\n", prefix_upper, ast.num_sprites);
+    fprintf(file, "};\n\n");
+
+    // write the sprite rect table
+    // the coordinates are written with enough digits to round-trip exactly
+    // arrays cannot be empty, so sets without sprites have no table
+    if (ast.num_sprites > 0)
+    {
+        fprintf(file, "// MARK: - Constants\n\n");
+        fprintf(file, "/// The placement of each sprite within the atlas set, indexed by `enum %s_sprite_t`.\n", prefix_lower);
+        fprintf(file, "static const struct ast_sprite_rect_t %s_sprite_rects[%s_NUM_SPRITES] =\n{\n", prefix_lower, prefix_upper);
+        for (unsigned int i = 0; i < ast.num_sprites; i++)
+        {
+            const struct ast_sprite_t *sprite = &ast.sprites[i];
+            fprintf(file,
+                    "    [%s_SPRITE_%s] = { %u, { %.9ef, %.9ef }, { %.9ef, %.9ef }, %u, %u },\n",
+                    prefix_upper,
+                    constants[i],
+                    sprite->atlas_index,
+                    sprite->bottom_left.u,
+                    sprite->bottom_left.v,
+                    sprite->top_right.u,
+                    sprite->top_right.v,
+                    sprite->width,
+                    sprite->height);
+        }
+
+        fprintf(file, "};\n");
+    }
+
+    fclose(file);
+
+    printf("generated %u sprites into \"%s\"\n", ast.num_sprites, output_path);
+
+    // release everything
+    for (unsigned int i = 0; i < ast.num_sprites; i++)
+        free(constants[i]);
+
+    free(constants);
+    free(prefix_lower);
+    free(prefix_upper);
+    ast_deinit(&ast);
+    return EXIT_SUCCESS;
+}
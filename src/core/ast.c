@@ -3,36 +3,99 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
-#include <errno.h>
-
-#ifdef WINDOWS
-#include <fileapi.h>
-#endif
 
+#include "buffer.h"
 #include "bin.h"
 #include "png.h"
+#include "hash.h"
+#include "jobs.h"
+#include "lz4.h"
+#include "qoi.h"
+#include "bc.h"
 
 // MARK: - Macros
 
+/// The version of the atlas set file format that is written.
+///
+/// Version 1 files predate versioning, and have a version of `0x00` in their signature.
+#define AST_VERSION (2)
+
 /// The size of the header within an atlas set file, in bytes.
 ///
-///  - ASCII `AST\0` signature.
+///  - ASCII `AST` signature.
+///  - U8 version, `0x00` for version 1.
 ///  - U16 atlas array texture width.
 ///  - U16 atlas array texture height.
 ///  - U8 atlas array texture scaling.
-///  - U8 `0x00` padding. (x3)
+///  - U8 flags.
+///  - U8 `0x00` padding. (x2)
 ///  - U32 atlas count.
 ///  - U32 atlases pointer.
 ///  - U32 sprite count.
 ///  - U32 sprites pointer.
+///
+/// The header is followed by the fields of each optional section that is enabled in the flags, in flag order.
 #define AST_HEADER_SIZE (28)
 
+/// The size of the sprite index fields following the header within an atlas set file, in bytes.
+///
+///  - U32 sprite index slot count.
+///  - U32 sprite index pointer.
+#define AST_SPRITE_INDEX_HEADER_SIZE (8)
+
+/// The size of the mip level fields following the sprite index fields within an atlas set file, in bytes.
+///
+///  - U32 mip level count, including the full size level.
+///  - U32 mip table pointer.
+#define AST_MIPMAPS_HEADER_SIZE (8)
+
+/// The size of a sprite index slot within an atlas set file, in bytes.
+///
+///  - U64 identifier FNV-1a hash.
+///  - U32 sprite index, or `AST_SPRITE_INDEX_EMPTY`.
+///  - U8 `0x00` padding. (x4)
+#define AST_SPRITE_INDEX_SLOT_SIZE (16)
+
+/// The header flag indicating that an atlas set file contains a sprite index.
+#define AST_FLAG_SPRITE_INDEX (1 << 0)
+
+/// The header flag indicating that an atlas set file contains stored mip levels for each atlas.
+#define AST_FLAG_MIPMAPS (1 << 1)
+
+/// The header flag indicating that an atlas set file's atlas array texture has no mip levels besides the full size level.
+#define AST_FLAG_NO_MIPMAPS (1 << 2)
+
+/// All the header flags that are understood by the reader.
+#define AST_FLAGS_KNOWN (AST_FLAG_SPRITE_INDEX | AST_FLAG_MIPMAPS | AST_FLAG_NO_MIPMAPS)
+
 /// The size of an atlas within an atlas set file, in bytes.
 ///
 ///  - U16 texture width.
 ///  - U16 texture height.
+///  - U8 payload encoding.
+///  - U8 payload format.
+///  - U8 `0x00` padding. (x2)
+///  - U32 payload pointer.
+///  - U32 payload size.
+#define AST_ATLAS_SIZE (16)
+
+/// The size of an atlas within a version 1 atlas set file, in bytes.
+///
+///  - U16 texture width.
+///  - U16 texture height.
 ///  - U32 PNG pointer.
-#define AST_ATLAS_SIZE (8)
+///
+/// PNGs are stored back-to-back, so the size of each is implied by the pointer of the following PNG.
+#define AST_ATLAS_SIZE_V1 (8)
+
+/// The size of a stored mip level within an atlas set file, in bytes.
+///
+///  - U32 payload pointer.
+///  - U32 payload size.
+///
+/// The mip table contains every level below the full size level of the first atlas, then those of the next atlas, and so on.
+/// Each level is encoded and formatted the same as its atlas, and its size is derived from its atlas' size with `ast_get_mip_size`.
+#define AST_MIP_SIZE (8)
 
 /// The size of a sprite within an atlas set file, in bytes.
 ///
@@ -47,292 +110,2429 @@
 ///  - U16 pixel height.
 #define AST_SPRITE_SIZE (AST_ID_MAX_SIZE + 24)
 
+// MARK: - Data Structures
+
+/// The shared state of the jobs decoding the atlases of an atlas set.
+struct ast_decode_t
+{
+    /// The atlas set being decoded.
+    const struct ast_t *ast;
+
+    /// The decoded texture data of each stored mip level of each atlas, indexed by atlas and then level.
+    void **levels;
+};
+
+/// The shared state of the jobs hashing the atlas payloads of an atlas set.
+struct ast_hash_t
+{
+    /// The atlas set being hashed.
+    const struct ast_t *ast;
+
+    /// The hash to set for the payloads of each atlas, indexed by atlas.
+    uint64_t *hashes;
+};
+
+/// The shared state of the jobs encoding the atlas payloads of an atlas set being written.
+struct ast_encode_t
+{
+    /// The atlases being encoded.
+    const struct png_t *atlases;
+
+    /// The encoding to store the texture data of each atlas with.
+    enum ast_payload_t payload;
+
+    /// The compact format to convert the texture data of each atlas into before encoding it, if any.
+    ///
+    /// This is `TEXTURE_RGBAU8` when each atlas keeps its own format.
+    enum texture_format_t format;
+
+    /// The width of the atlas array texture of the atlas set being written, in pixels.
+    unsigned int atlas_width;
+
+    /// The height of the atlas array texture of the atlas set being written, in pixels.
+    unsigned int atlas_height;
+
+    /// The total number of mip levels to store for each atlas, including the full size level.
+    unsigned int num_levels;
+
+    /// The buffers to encode the payload of each stored mip level of each atlas into, indexed by atlas and then level.
+    struct buffer_t *payloads;
+};
+
+// MARK: - Assertions
+
+// sprites and sprite index slots are viewed directly from the mapping, so their layouts must match the file
+_Static_assert(sizeof(struct ast_sprite_t) == AST_SPRITE_SIZE, "ast_sprite_t must match the atlas set file sprite layout");
+_Static_assert(sizeof(struct ast_sprite_index_slot_t) == AST_SPRITE_INDEX_SLOT_SIZE, "ast_sprite_index_slot_t must match the atlas set file sprite index slot layout");
+
 // MARK: - Functions
 
-void ast_init(struct ast_t *ast, const char *path)
+/// Get whether or not the given range is within the bounds of memory of the given size.
+/// @param offset The offset, in bytes, of the range.
+/// @param size The size, in bytes, of the range.
+/// @param bounds The total size, in bytes, of the memory to check the given range against.
+/// @return Whether or not the given range is within the given bounds.
+bool ast_range_is_valid(size_t offset, size_t size, size_t bounds)
+{
+    return offset <= bounds && size <= bounds - offset;
+}
+
+/// Get the format represented by the given atlas payload format within an atlas set file.
+/// @param value The payload format within the set file.
+/// @param format The pointer to set the value of to the represented format.
+/// @return Whether or not the given value represents a known format.
+bool ast_format_from_file(unsigned int value, enum texture_format_t *format)
 {
-    // open the given file
-    FILE *file = fopen(path, "rb");
-    if (file == NULL)
+    switch (value)
     {
-        // the given path could not be opened, print the details and terminate
-        fprintf(stderr, "AST ERROR: unable to open ast file at \"%s\" (%s)\n", path, strerror(errno));
-        exit(EXIT_FAILURE);
+        case 0x0: *format = TEXTURE_RGBU8; return true;
+        case 0x1: *format = TEXTURE_RGBAU8; return true;
+        case 0x2: *format = TEXTURE_R8; return true;
+        case 0x3: *format = TEXTURE_A8; return true;
+        case 0x4: *format = TEXTURE_RG8; return true;
+        case 0x5: *format = TEXTURE_RGB565; return true;
+        case 0x6: *format = TEXTURE_RGBA4444; return true;
+        case 0x7: *format = TEXTURE_RGB5A1; return true;
+        default:  return false;
+    }
+}
+
+/// Get the representation of the given format as an atlas payload format within an atlas set file.
+/// @param format The uncompressed format to get the representation of.
+/// @return The representation of the given format within a set file.
+unsigned int ast_format_to_file(enum texture_format_t format)
+{
+    switch (format)
+    {
+        case TEXTURE_RGBU8:    return 0x0;
+        case TEXTURE_RGBAU8:   return 0x1;
+        case TEXTURE_R8:       return 0x2;
+        case TEXTURE_A8:       return 0x3;
+        case TEXTURE_RG8:      return 0x4;
+        case TEXTURE_RGB565:   return 0x5;
+        case TEXTURE_RGBA4444: return 0x6;
+        case TEXTURE_RGB5A1:   return 0x7;
+        default:
+            assert(false);
+            return 0x0;
+    }
+}
+
+/// Get the atlas format of texture data decoded from a PNG or QOI of the given format.
+/// @param format The format of the PNG or QOI.
+/// @return The atlas format of the given PNG or QOI's texture data.
+enum texture_format_t ast_format_from_png(enum png_format_t format)
+{
+    switch (format)
+    {
+        case PNG_RGBU8:  return TEXTURE_RGBU8;
+        case PNG_RGBAU8: return TEXTURE_RGBAU8;
+        default:
+            fprintf(stderr, "AST ERROR: unknown png format %i\n", format);
+            exit(EXIT_FAILURE);
+    }
+}
+
+/// Get the compressed texture format of the blocks within the given atlas payload encoding, if there is one.
+/// @param payload The payload encoding to get the compressed format of.
+/// @param format The pointer to set the value of to the compressed format of the given encoding.
+/// @return Whether or not the given encoding stores compressed blocks.
+bool ast_payload_get_compressed_format(enum ast_payload_t payload, enum texture_format_t *format)
+{
+    switch (payload)
+    {
+        case AST_PAYLOAD_BC1: *format = TEXTURE_BC1; return true;
+        case AST_PAYLOAD_BC3: *format = TEXTURE_BC3; return true;
+        case AST_PAYLOAD_BC7: *format = TEXTURE_BC7; return true;
+        default:              return false;
+    }
+}
+
+/// Get the size of the given stored mip level of an atlas along a single axis.
+///
+/// Each level is half the size of the previous level rounded up, so that no texels are dropped,
+/// but it is never larger than the same level of the atlas array texture, which is rounded down.
+/// @param size The size of the atlas along the axis, in pixels.
+/// @param atlas_size The size of the atlas array texture along the axis, in pixels.
+/// @param level The mip level to get the size of.
+/// @return The size of the given mip level of the atlas along the axis, in pixels.
+unsigned int ast_get_mip_size(unsigned int size, unsigned int atlas_size, unsigned int level)
+{
+    for (unsigned int i = 1; i <= level; i++)
+    {
+        size = (size + 1) / 2;
+        unsigned int atlas_level_size = texture_get_level_size(atlas_size, i);
+        if (size > atlas_level_size)
+            size = atlas_level_size;
+    }
+
+    return size;
+}
+
+/// Get the total number of mip levels which are stored for each atlas within the given atlas set, including the full size level.
+/// @param ast The set to get the stored mip level count of.
+/// @return The total number of stored mip levels for each atlas within the given set.
+unsigned int ast_get_num_stored_levels(const struct ast_t *ast)
+{
+    return (ast->atlas_mipmaps == AST_MIPMAPS_STORED) ? ast->atlas_num_levels : 1;
+}
+
+/// Terminate the program due to the given atlas set file at the given filesystem path being invalid.
+/// @param path The filesystem path of the invalid set file.
+/// @param reason A human readable description of why the set file is invalid.
+void ast_throw_invalid(const char *path, const char *reason)
+{
+    fprintf(stderr, "AST ERROR: invalid ast file at \"%s\" (%s)\n", path, reason);
+    exit(EXIT_FAILURE);
+}
+
+/// Read the payload format and encoding of the given version 1 atlas.
+///
+/// Version 1 atlases are always PNGs stored back-to-back, so each extends to the start of the closest following PNG.
+/// The closest PNG is searched for rather than assuming any ordering.
+/// @param atlas The atlas to read the payload of, which already has its size set.
+/// @param reader The reader of the set file being read, with its cursor after the given atlas' size.
+/// @param atlases_pointer The pointer to the atlas table within the set file.
+/// @param num_atlases The total number of atlases within the set file.
+/// @return A human readable description of why the given atlas is invalid, or `NULL` if it is valid.
+const char *ast_read_atlas_v1(struct ast_atlas_t *atlas,
+                              struct bin_reader_t *reader,
+                              size_t atlases_pointer,
+                              unsigned int num_atlases)
+{
+    const unsigned char *data = reader->data;
+    size_t size = reader->size;
+    size_t png_pointer = bin_reader_read_u32(reader);
+    if (png_pointer >= size)
+        return "atlas png out of bounds";
+
+    size_t png_end = size;
+    for (int i = 0; i < num_atlases; i++)
+    {
+        bin_reader_seek(reader, atlases_pointer + (i * AST_ATLAS_SIZE_V1) + 4);
+        size_t other_png_pointer = bin_reader_read_u32(reader);
+        if (other_png_pointer > png_pointer && other_png_pointer < png_end)
+            png_end = other_png_pointer;
+    }
+
+    // version 1 atlases do not store their format, so read it from the png header
+    unsigned int png_width, png_height;
+    enum png_format_t format;
+    if (!png_try_read_header_memory(data + png_pointer, png_end - png_pointer, &png_width, &png_height, &format))
+        return "invalid atlas png";
+
+    atlas->payload = AST_PAYLOAD_PNG;
+    atlas->format = ast_format_from_png(format);
+    atlas->payload_data = data + png_pointer;
+    atlas->payload_size = png_end - png_pointer;
+    return NULL;
+}
+
+/// Read the payload format and encoding of the given atlas.
+/// @param atlas The atlas to read the payload of, which already has its size set.
+/// @param reader The reader of the set file being read, with its cursor after the given atlas' size.
+/// @return A human readable description of why the given atlas is invalid, or `NULL` if it is valid.
+const char *ast_read_atlas(struct ast_atlas_t *atlas,
+                           struct bin_reader_t *reader)
+{
+    // read the rest of the atlas
+    enum ast_payload_t payload = bin_reader_read_u8(reader);
+    unsigned int format_value = bin_reader_read_u8(reader);
+    unsigned int padding = bin_reader_read_u16(reader);
+    size_t payload_pointer = bin_reader_read_u32(reader);
+    size_t payload_size = bin_reader_read_u32(reader);
+
+    if (padding != 0x0)
+        return "invalid atlas padding";
+
+    // encoding
+    switch (payload)
+    {
+        case AST_PAYLOAD_PNG:
+        case AST_PAYLOAD_LZ4:
+        case AST_PAYLOAD_QOI:
+        case AST_PAYLOAD_BC1:
+        case AST_PAYLOAD_BC3:
+        case AST_PAYLOAD_BC7:
+            break;
+        default:
+            return "unknown atlas payload encoding";
+    }
+
+    // format
+    // compact texels are only ever stored raw, the other encodings can only represent rgb and rgba
+    enum texture_format_t format;
+    if (!ast_format_from_file(format_value, &format))
+        return "unknown atlas payload format";
+    if (payload == AST_PAYLOAD_BC1 && format == TEXTURE_RGBAU8)
+        return "bc1 atlas payload with an alpha channel";
+    if (payload != AST_PAYLOAD_LZ4 && texture_format_is_compact(format))
+        return "compact atlas format without an lz4 payload";
+
+    // range
+    bin_reader_seek(reader, payload_pointer);
+    const void *payload_data = bin_reader_read_bytes(reader, payload_size);
+    if (reader->error)
+        return "atlas payload out of bounds";
+
+    atlas->payload = payload;
+    atlas->format = format;
+    atlas->payload_data = payload_data;
+    atlas->payload_size = payload_size;
+    return NULL;
+}
+
+/// Read the stored mip levels of the given atlas.
+///
+/// The mip levels of the given atlas are only set if they are all valid.
+/// @param atlas The atlas to read the mip levels of, which already has its size and payload set.
+/// @param reader The reader of the set file being read.
+/// @param mips_pointer The pointer to the given atlas' first mip level within the set file's mip table.
+/// @param num_levels The total number of mip levels of the set, including the full size level.
+/// @param atlas_width The width of the set's atlas array texture, in pixels.
+/// @param atlas_height The height of the set's atlas array texture, in pixels.
+/// @return A human readable description of why the given atlas' mip levels are invalid, or `NULL` if they are valid.
+const char *ast_read_mips(struct ast_atlas_t *atlas,
+                          struct bin_reader_t *reader,
+                          size_t mips_pointer,
+                          unsigned int num_levels,
+                          unsigned int atlas_width,
+                          unsigned int atlas_height)
+{
+    struct ast_mip_t *mips = malloc((num_levels - 1) * sizeof(struct ast_mip_t));
+    for (unsigned int level = 1; level < num_levels; level++)
+    {
+        bin_reader_seek(reader, mips_pointer + ((level - 1) * AST_MIP_SIZE));
+        size_t payload_pointer = bin_reader_read_u32(reader);
+        size_t payload_size = bin_reader_read_u32(reader);
+        bin_reader_seek(reader, payload_pointer);
+        const void *payload_data = bin_reader_read_bytes(reader, payload_size);
+        if (reader->error)
+        {
+            free(mips);
+            return "atlas mip level payload out of bounds";
+        }
+
+        struct ast_mip_t *mip = &mips[level - 1];
+        mip->width = ast_get_mip_size(atlas->width, atlas_width, level);
+        mip->height = ast_get_mip_size(atlas->height, atlas_height, level);
+        mip->payload_data = payload_data;
+        mip->payload_size = payload_size;
+    }
+
+    atlas->mips = mips;
+    return NULL;
+}
+
+/// Read the sprite table of an atlas set file into an allocation.
+///
+/// This is used when the sprite table cannot be viewed in place.
+/// The table's bounds are expected to have already been validated.
+/// @param reader The reader of the set file being read.
+/// @param sprites_pointer The pointer to the sprite table within the set file.
+/// @param num_sprites The total number of sprites within the set file.
+/// @return All the sprites within the set file.
+/// This pointer is allocated and must be released by the caller.
+struct ast_sprite_t *ast_read_sprites(struct bin_reader_t *reader, size_t sprites_pointer, unsigned int num_sprites)
+{
+    struct ast_sprite_t *sprites = malloc(num_sprites * sizeof(struct ast_sprite_t));
+    bin_reader_seek(reader, sprites_pointer);
+    for (unsigned int i = 0; i < num_sprites; i++)
+    {
+        struct ast_sprite_t *sprite = &sprites[i];
+        memcpy(sprite->id, bin_reader_read_bytes(reader, AST_ID_MAX_SIZE), AST_ID_MAX_SIZE);
+        sprite->atlas_index = bin_reader_read_u8(reader);
+        bin_reader_skip(reader, 3);
+        memset(sprite->padding, 0, sizeof(sprite->padding));
+        sprite->bottom_left.u = bin_reader_read_f32(reader);
+        sprite->bottom_left.v = bin_reader_read_f32(reader);
+        sprite->top_right.u = bin_reader_read_f32(reader);
+        sprite->top_right.v = bin_reader_read_f32(reader);
+        sprite->width = bin_reader_read_u16(reader);
+        sprite->height = bin_reader_read_u16(reader);
+    }
+
+    return sprites;
+}
+
+/// Release the given atlases, along with their mip levels.
+/// @param atlases The atlases to release.
+/// @param num_atlases The total number of given atlases.
+void ast_free_atlases(struct ast_atlas_t *atlases, unsigned int num_atlases)
+{
+    for (int i = 0; i < num_atlases; i++)
+        free(atlases[i].mips);
+
+    free(atlases);
+}
+
+/// Validate that the given atlases, which have all been read, can share the atlas array texture of their set.
+/// @param atlases All the atlases within the set.
+/// @param num_atlases The total number of atlases within the set.
+/// @param atlas_mipmaps How the mip levels of the set's atlas array texture are produced.
+/// @param atlas_num_levels The total number of mip levels of the set, including the full size level.
+/// @return A human readable description of why the given atlases are invalid, or `NULL` if they are valid.
+const char *ast_validate_atlases(const struct ast_atlas_t *atlases,
+                                 unsigned int num_atlases,
+                                 enum ast_mipmaps_t atlas_mipmaps,
+                                 unsigned int atlas_num_levels)
+{
+    // compressed atlases share a single compressed array texture, so they must all have the same payload,
+    // and that texture cannot have its mipmap generated
+    enum texture_format_t compressed_format;
+    bool is_compressed = num_atlases > 0 && ast_payload_get_compressed_format(atlases[0].payload, &compressed_format);
+    for (int i = 1; i < num_atlases; i++)
+    {
+        bool is_atlas_compressed = ast_payload_get_compressed_format(atlases[i].payload, &compressed_format);
+        if ((is_compressed || is_atlas_compressed) && atlases[i].payload != atlases[0].payload)
+            return "mixed compressed atlas payloads";
+    }
+
+    if (is_compressed && atlas_mipmaps == AST_MIPMAPS_GENERATED && atlas_num_levels > 1)
+        return "generated mip levels for compressed atlas payloads";
+
+    // compact atlases are never expanded, so they also share a single array texture of their format
+    for (int i = 1; i < num_atlases; i++)
+    {
+        bool is_compact = texture_format_is_compact(atlases[0].format) || texture_format_is_compact(atlases[i].format);
+        if (is_compact && atlases[i].format != atlases[0].format)
+            return "mixed compact atlas formats";
+    }
+
+    return NULL;
+}
+
+/// Validate the given sprites of a set.
+/// @param sprites All the sprites within the set.
+/// @param num_sprites The total number of sprites within the set.
+/// @param num_atlases The total number of atlases within the set.
+/// @return A human readable description of why the given sprites are invalid, or `NULL` if they are valid.
+const char *ast_validate_sprites(const struct ast_sprite_t *sprites,
+                                 unsigned int num_sprites,
+                                 unsigned int num_atlases)
+{
+    for (int i = 0; i < num_sprites; i++)
+    {
+        const struct ast_sprite_t *sprite = &sprites[i];
+        if (sprite->atlas_index >= num_atlases)
+            return "sprite atlas index out of bounds";
+        if (memchr(sprite->id, '\0', AST_ID_MAX_SIZE) == NULL)
+            return "sprite identifier is not null-terminated";
+    }
+
+    return NULL;
+}
+
+/// Validate the given sprite index of a set, so that lookups within it always terminate.
+///
+/// Lookups probe until they reach an empty slot, so there must be at least one,
+/// and every occupied slot must be reachable from the home slot of its sprite without crossing one.
+/// @param sprite_index All the slots of the sprite index within the set.
+/// @param num_sprite_index_slots The total number of slots within the given sprite index, which is a power of two.
+/// @param sprites All the sprites within the set, which have already been validated.
+/// @param num_sprites The total number of sprites within the set.
+/// @return A human readable description of why the given sprite index is invalid, or `NULL` if it is valid.
+const char *ast_validate_sprite_index(const struct ast_sprite_index_slot_t *sprite_index,
+                                      unsigned int num_sprite_index_slots,
+                                      const struct ast_sprite_t *sprites,
+                                      unsigned int num_sprites)
+{
+    unsigned int empty_slot = num_sprite_index_slots;
+    for (int i = 0; i < num_sprite_index_slots; i++)
+    {
+        uint32_t sprite_index_value = sprite_index[i].sprite_index;
+        if (sprite_index_value == AST_SPRITE_INDEX_EMPTY)
+            empty_slot = i;
+        else if (sprite_index_value >= num_sprites)
+            return "sprite index slot out of bounds";
     }
 
+    if (num_sprite_index_slots > 0 && empty_slot == num_sprite_index_slots)
+        return "sprite index has no empty slots";
+
+    // walk every chain once, starting after an empty slot so that no chain wraps past the start
+    unsigned int mask = num_sprite_index_slots - 1;
+    unsigned int chain_start = 0;
+    for (unsigned int offset = 1; offset <= num_sprite_index_slots; offset++)
+    {
+        unsigned int i = (empty_slot + offset) & mask;
+        const struct ast_sprite_index_slot_t *slot = &sprite_index[i];
+        if (slot->sprite_index == AST_SPRITE_INDEX_EMPTY)
+        {
+            chain_start = (i + 1) & mask;
+            continue;
+        }
+
+        const struct ast_sprite_t *sprite = &sprites[slot->sprite_index];
+        if (slot->id_hash != hash_fnv1a64_string(sprite->id))
+            return "sprite index slot hash mismatch";
+
+        unsigned int home = slot->id_hash & mask;
+        if (((i - home) & mask) > ((i - chain_start) & mask))
+            return "sprite index slot outside of its chain";
+    }
+
+    return NULL;
+}
+
+/// Attempt to initialize the given atlas set from the atlas set file within the given mapping.
+///
+/// The entire structure of the set file is validated, so that it can be accessed freely afterwards.
+/// Payloads are not decoded, so they are only validated when they are decoded.
+/// @param ast The set to initialize, which is only initialized if the set file is valid.
+/// @param map The mapping containing the set file.
+/// @param owns_map Whether or not the given set takes ownership of the given mapping, if the set file is valid.
+/// @return A human readable description of why the set file is invalid, or `NULL` if it is valid.
+const char *ast_load_map(struct ast_t *ast, struct map_t map, bool owns_map)
+{
+    const unsigned char *data = map.data;
+    size_t size = map.size;
+    struct bin_reader_t reader;
+    bin_reader_init(&reader, data, size);
+
     // read the header
-    // signature
-    assert(fgetc(file) == 'A');
-    assert(fgetc(file) == 'S');
-    assert(fgetc(file) == 'T');
-    assert(fgetc(file) == 0x0);
-
-    // atlas array texture width, height, and scaling
-    unsigned int atlas_width = bin_read_u16(file);
-    unsigned int atlas_height = bin_read_u16(file);
-    enum texture_scaling_t atlas_scaling = bin_read_u8(file);
-    assert(bin_read_u8(file) == 0x0);
-    assert(bin_read_u8(file) == 0x0);
-    assert(bin_read_u8(file) == 0x0);
-
-    // atlas count and pointer
-    unsigned int num_atlases = bin_read_u32(file);
-    unsigned int atlases_pointer = bin_read_u32(file);
-
-    // sprite count and pointer
-    unsigned int num_sprites = bin_read_u32(file);
-    unsigned int sprites_pointer = bin_read_u32(file);
+    // the whole header is read before it is checked, as reading past the end of the file only reads zeros
+    const unsigned char *signature = bin_reader_read_bytes(&reader, 3);
+    unsigned int version = bin_reader_read_u8(&reader);
+    unsigned int atlas_width = bin_reader_read_u16(&reader);
+    unsigned int atlas_height = bin_reader_read_u16(&reader);
+    enum texture_scaling_t atlas_scaling = bin_reader_read_u8(&reader);
+    unsigned int flags = bin_reader_read_u8(&reader);
+    unsigned int padding = bin_reader_read_u16(&reader);
+    unsigned int num_atlases = bin_reader_read_u32(&reader);
+    unsigned int atlases_pointer = bin_reader_read_u32(&reader);
+    unsigned int num_sprites = bin_reader_read_u32(&reader);
+    unsigned int sprites_pointer = bin_reader_read_u32(&reader);
+
+    // signature and version
+    if (reader.error || memcmp(signature, "AST", 3) != 0)
+        return "invalid signature";
+
+    version = (version == 0x0) ? 1 : version;
+    if (version != 1 && version != AST_VERSION)
+        return "unsupported version";
+
+    size_t atlas_size = (version == 1) ? AST_ATLAS_SIZE_V1 : AST_ATLAS_SIZE;
+
+    // flags
+    if ((flags & ~AST_FLAGS_KNOWN) != 0)
+        return "unknown header flags";
+    if (padding != 0x0)
+        return "invalid header padding";
+
+    // scaling
+    if (atlas_scaling != TEXTURE_NEAREST && atlas_scaling != TEXTURE_LINEAR)
+        return "unknown atlas scaling";
+
+    // optional sections
+    // these directly follow the header, in the order of their flags
+    unsigned int num_sprite_index_slots = 0;
+    unsigned int sprite_index_pointer = 0;
+    if (flags & AST_FLAG_SPRITE_INDEX)
+    {
+        num_sprite_index_slots = bin_reader_read_u32(&reader);
+        sprite_index_pointer = bin_reader_read_u32(&reader);
+        if (reader.error)
+            return "sprite index header out of bounds";
+    }
+
+    // sets which do not specify their mip levels have them generated
+    enum ast_mipmaps_t atlas_mipmaps = AST_MIPMAPS_GENERATED;
+    unsigned int atlas_num_levels = texture_get_num_levels(atlas_width, atlas_height);
+    unsigned int mips_pointer = 0;
+    if ((flags & AST_FLAG_MIPMAPS) && (flags & AST_FLAG_NO_MIPMAPS))
+        return "conflicting mipmap flags";
+
+    if (flags & AST_FLAG_MIPMAPS)
+    {
+        unsigned int num_levels = bin_reader_read_u32(&reader);
+        mips_pointer = bin_reader_read_u32(&reader);
+        if (reader.error)
+            return "mipmaps header out of bounds";
+        if (num_levels < 1 || num_levels > atlas_num_levels)
+            return "mip level count out of range";
+
+        atlas_mipmaps = AST_MIPMAPS_STORED;
+        atlas_num_levels = num_levels;
+    }
+    else if (flags & AST_FLAG_NO_MIPMAPS)
+    {
+        atlas_mipmaps = AST_MIPMAPS_NONE;
+        atlas_num_levels = 1;
+    }
+
+    size_t num_atlas_mips = (atlas_mipmaps == AST_MIPMAPS_STORED) ? atlas_num_levels - 1 : 0;
+
+    // validate the bounds of the tables up front, so they can be accessed freely afterwards
+    if (!ast_range_is_valid(atlases_pointer, (size_t)num_atlases * atlas_size, size))
+        return "atlas table out of bounds";
+    if (!ast_range_is_valid(mips_pointer, (size_t)num_atlases * num_atlas_mips * AST_MIP_SIZE, size))
+        return "mip table out of bounds";
+    if (!ast_range_is_valid(sprites_pointer, (size_t)num_sprites * AST_SPRITE_SIZE, size))
+        return "sprite table out of bounds";
+    if (!ast_range_is_valid(sprite_index_pointer, (size_t)num_sprite_index_slots * AST_SPRITE_INDEX_SLOT_SIZE, size))
+        return "sprite index out of bounds";
+    if ((num_sprite_index_slots & (num_sprite_index_slots - 1)) != 0)
+        return "sprite index slot count is not a power of two";
 
     // read the atlases
+    // the mip levels of every atlas are cleared up front, so that the atlases can be released if any are invalid
     struct ast_atlas_t *atlases = malloc(num_atlases * sizeof(struct ast_atlas_t));
     for (int i = 0; i < num_atlases; i++)
-    {
-        // read the current atlas
-        fseek(file, atlases_pointer + (i * AST_ATLAS_SIZE), SEEK_SET);
-        unsigned int width = bin_read_u16(file);
-        unsigned int height = bin_read_u16(file);
-        long png_pointer = (long)bin_read_u32(file);
+        atlases[i].mips = NULL;
 
-        // initialize the current atlas
+    const char *reason = NULL;
+    for (int i = 0; i < num_atlases && reason == NULL; i++)
+    {
         struct ast_atlas_t *atlas = &atlases[i];
-        atlas->width = width;
-        atlas->height = height;
-        atlas->png_pointer = png_pointer;
+        bin_reader_seek(&reader, atlases_pointer + (i * atlas_size));
+        atlas->width = bin_reader_read_u16(&reader);
+        atlas->height = bin_reader_read_u16(&reader);
+
+        // atlases are uploaded into layers of the atlas array texture, so they must fit within it
+        if (atlas->width == 0 || atlas->height == 0)
+            reason = "empty atlas";
+        else if (atlas->width > atlas_width || atlas->height > atlas_height)
+            reason = "atlas larger than the atlas array texture";
+        else if (version == 1)
+            reason = ast_read_atlas_v1(atlas, &reader, atlases_pointer, num_atlases);
+        else
+            reason = ast_read_atlas(atlas, &reader);
+
+        if (reason == NULL && num_atlas_mips > 0)
+            reason = ast_read_mips(atlas, &reader, mips_pointer + (i * num_atlas_mips * AST_MIP_SIZE), atlas_num_levels, atlas_width, atlas_height);
     }
 
-    // read the sprites
-    struct ast_sprite_t *sprites = malloc(num_sprites * sizeof(struct ast_sprite_t));
-    for (int i = 0; i < num_sprites; i++)
+    if (reason == NULL)
+        reason = ast_validate_atlases(atlases, num_atlases, atlas_mipmaps, atlas_num_levels);
+
+    if (reason != NULL)
     {
-        // read the current sprite
-        fseek(file, sprites_pointer + (i * AST_SPRITE_SIZE), SEEK_SET);
-        char id[AST_ID_MAX_SIZE];
-        fread(id, AST_ID_MAX_SIZE, 1, file);
-        unsigned int atlas_index = bin_read_u8(file);
-        assert(bin_read_u8(file) == 0x0);
-        assert(bin_read_u8(file) == 0x0);
-        assert(bin_read_u8(file) == 0x0);
-        float bottom_left_u = bin_read_f32(file);
-        float bottom_left_v = bin_read_f32(file);
-        float top_right_u = bin_read_f32(file);
-        float top_right_v = bin_read_f32(file);
-        unsigned int width = bin_read_u16(file);
-        unsigned int height = bin_read_u16(file);
-
-        // initialize the current sprite
-        struct ast_sprite_t *sprite = &sprites[i];
-        memcpy(sprite->id, id, AST_ID_MAX_SIZE * sizeof(char));
-        sprite->atlas_index = atlas_index;
-        sprite->bottom_left.u = bottom_left_u;
-        sprite->bottom_left.v = bottom_left_v;
-        sprite->top_right.u = top_right_u;
-        sprite->top_right.v = top_right_v;
-        sprite->width = width;
-        sprite->height = height;
+        ast_free_atlases(atlases, num_atlases);
+        return reason;
+    }
+
+    // view the sprites
+    // the sprite table is used in place when it is suitably aligned within the mapping and the host byte order matches the file,
+    // otherwise it is read into an allocation
+    const struct ast_sprite_t *sprites;
+    bool owns_sprites;
+    if (BIN_HOST_IS_LITTLE_ENDIAN && (uintptr_t)(data + sprites_pointer) % _Alignof(struct ast_sprite_t) == 0)
+    {
+        sprites = (const struct ast_sprite_t *)(data + sprites_pointer);
+        owns_sprites = false;
+    }
+    else
+    {
+        sprites = ast_read_sprites(&reader, sprites_pointer, num_sprites);
+        owns_sprites = true;
+    }
+
+    // view the sprite index, if there is one
+    // unlike sprites the index is only an optimization, so if it is not suitably aligned then the sprites are scanned instead
+    const struct ast_sprite_index_slot_t *sprite_index = NULL;
+    if (BIN_HOST_IS_LITTLE_ENDIAN &&
+        num_sprite_index_slots > 0 &&
+        (uintptr_t)(data + sprite_index_pointer) % _Alignof(struct ast_sprite_index_slot_t) == 0)
+    {
+        sprite_index = (const struct ast_sprite_index_slot_t *)(data + sprite_index_pointer);
+    }
+    else
+    {
+        num_sprite_index_slots = 0;
+    }
+
+    // validate the sprites and sprite index
+    // the sprites must be validated first, as validating the index hashes their identifiers
+    reason = ast_validate_sprites(sprites, num_sprites, num_atlases);
+    if (reason == NULL)
+        reason = ast_validate_sprite_index(sprite_index, num_sprite_index_slots, sprites, num_sprites);
+
+    if (reason != NULL)
+    {
+        if (owns_sprites)
+            free((void *)sprites);
+
+        ast_free_atlases(atlases, num_atlases);
+        return reason;
     }
 
     // initialize the given set
-    ast->file = file;
+    ast->map = map;
+    ast->owns_map = owns_map;
+    ast->version = version;
     ast->atlas_width = atlas_width;
     ast->atlas_height = atlas_height;
     ast->atlas_scaling = atlas_scaling;
+    ast->atlas_mipmaps = atlas_mipmaps;
+    ast->atlas_num_levels = atlas_num_levels;
     ast->num_atlases = num_atlases;
     ast->atlases = atlases;
     ast->num_sprites = num_sprites;
+    ast->owns_sprites = owns_sprites;
     ast->sprites = sprites;
+    ast->num_sprite_index_slots = num_sprite_index_slots;
+    ast->sprite_index = sprite_index;
+    return NULL;
 }
 
-void ast_deinit(struct ast_t *ast)
+/// Initialize the given atlas set from the atlas set file within the given mapping.
+///
+/// If there is no valid set file within the given mapping then the program terminates.
+/// @param ast The set to initialize.
+/// @param path The filesystem path or name of the set file, which is only used within error messages.
+/// @param map The mapping containing the set file.
+/// @param owns_map Whether or not the given set takes ownership of the given mapping.
+void ast_init_map(struct ast_t *ast, const char *path, struct map_t map, bool owns_map)
 {
-    free(ast->sprites);
-    free(ast->atlases);
-    fclose(ast->file);
+    const char *reason = ast_load_map(ast, map, owns_map);
+    if (reason != NULL)
+        ast_throw_invalid(path, reason);
 }
 
-void ast_get_texture(struct ast_t *ast,
-                     struct texture_t *texture)
+void ast_init(struct ast_t *ast, const char *path)
 {
-    // read all the pngs
-    struct png_t pngs[ast->num_atlases];
-    for (int i = 0; i < ast->num_atlases; i++)
+    // map the given file
+    struct map_t map;
+    map_init(&map, path);
+    ast_init_map(ast, path, map, true);
+}
+
+/// Attempt to initialize the given atlas set from the atlas set file within the given map, taking ownership of it.
+///
+/// If the set file within the given map is invalid then the given map is deinitialized.
+/// @param ast The set to initialize, which is only initialized if the set file is valid.
+/// @param map The map containing the set file.
+/// @param reason The pointer to set the value of to a human readable description of why the set file is invalid,
+/// if this function fails.
+/// @return Whether or not the given set was initialized.
+bool ast_try_init_owned_map(struct ast_t *ast, struct map_t map, const char **reason)
+{
+    // release the map if the set file within it is invalid, as the set does not take ownership of it
+    *reason = ast_load_map(ast, map, true);
+    if (*reason != NULL)
     {
-        struct ast_atlas_t *atlas = &ast->atlases[i];
-        fseek(ast->file, atlas->png_pointer, SEEK_SET);
-        png_init_file(&pngs[i], ast->file);
+        map_deinit(&map);
+        return false;
     }
 
-    // initialize the given texture
-    texture_init_png_array(texture,
-                           ast->atlas_width,
-                           ast->atlas_height,
-                           ast->atlas_scaling,
-                           ast->num_atlases,
-                           pngs);
-
-    // deinitialize all the pngs as theyve now been uploaded
-    for (int i = 0; i < ast->num_atlases; i++)
-        png_deinit(&pngs[i]);
+    return true;
 }
 
-const struct ast_sprite_t *ast_get_sprite(const struct ast_t *ast,
-                                          const char *id)
+bool ast_try_init(struct ast_t *ast, const char *path, const char **reason)
 {
-    // attempt to return the first sprite matching the given id within the given set
-    for (int i = 0; i < ast->num_sprites; i++)
+    // map the given file, which may be missing or unreadable
+    struct map_t map;
+    if (!map_try_init(&map, path))
     {
-        const struct ast_sprite_t *sprite = &ast->sprites[i];
-        if (strcmp(sprite->id, id) == 0)
-            return sprite;
+        *reason = "unable to map file";
+        return false;
     }
 
-    // if this point has been reached then no matching sprite was found
-    return NULL;
+    return ast_try_init_owned_map(ast, map, reason);
 }
 
-void ast_write_contents(FILE *file,
-                        enum texture_scaling_t atlas_scaling,
-                        unsigned int num_atlases,
-                        const struct texture_t *atlases,
-                        unsigned int num_sprites,
-                        const struct ast_sprite_t *sprites)
+/// Attempt to initialize the given atlas set from an allocated copy of the atlas set file at the given filesystem path.
+///
+/// Unlike `ast_try_init` the new set keeps no reference to the set file, so the file can be replaced on every platform.
+/// See `ast_try_init` for further documentation.
+/// @param ast The set to initialize, which is only initialized if the set file is valid.
+/// @param path The filesystem path of the set file to copy.
+/// @param reason The pointer to set the value of to a human readable description of why the set file could not be read,
+/// if this function fails.
+/// @return Whether or not the given set was initialized.
+bool ast_try_init_copy(struct ast_t *ast, const char *path, const char **reason)
 {
-    // calculate the atlas array texture size
-    unsigned int atlas_width = 0, atlas_height = 0;
-    for (int i = 0; i < num_atlases; i++)
+    // copy the given file, which may be missing or unreadable
+    struct map_t map;
+    if (!map_try_init_copy(&map, path))
     {
-        const struct texture_t *atlas = &atlases[i];
-        if (atlas->width > atlas_width)
-            atlas_width = atlas->width;
-        if (atlas->height > atlas_height)
-            atlas_height = atlas->height;
+        *reason = "unable to read file";
+        return false;
     }
 
-    // calculate fixed pointers
-    uint32_t header_pointer = (uint32_t)ftell(file);
-    uint32_t atlases_pointer = header_pointer + AST_HEADER_SIZE;
-    uint32_t sprites_pointer = atlases_pointer + (num_atlases * AST_ATLAS_SIZE);
-    uint32_t stream_pointer = sprites_pointer + (num_sprites * AST_SPRITE_SIZE);
-
-    // open the data stream
-    // this stream is used to write dynamically-sized data, such as pngs,
-    // in a block below statically-sized data
-    // this allows pointers to be easily calculated while writing the file
-    // memstreams are only available on linux, so use a temp file on windows
-    // TODO: memstream replacement to share functionality with other file formats
-    #ifdef WINDOWS
-    // tmpfile_s would be more desirable, but it seems to always fail,
-    // so perform a similar operation manually
-    // get the path of the temp directory
-    char stream_path[MAX_PATH];
-    GetTempPath(MAX_PATH, stream_path);
-
-    // get the path of the temp file, with an "ast" prefix
-    char stream_filename[MAX_PATH];
-    GetTempFileName(stream_path,
-                    TEXT("ast"),
-                    0,
-                    stream_filename);
-
-    // open the temp file
-    FILE *stream_file = fopen(stream_filename, "wb+");
-    #elif LINUX
-    // open the memstream
-    char *stream;
-    size_t stream_size = 0;
-    FILE *stream_file = open_memstream(&stream, &stream_size);
-    #endif
-
-    // write the header
-    fprintf(file, "AST");
-    bin_write_u8(0x0, file);
-    bin_write_u16(atlas_width, file);
-    bin_write_u16(atlas_height, file);
-    bin_write_u8(atlas_scaling, file);
-    bin_write_u8(0x0, file);
-    bin_write_u8(0x0, file);
-    bin_write_u8(0x0, file);
-    bin_write_u32(num_atlases, file);
-    bin_write_u32(atlases_pointer, file);
-    bin_write_u32(num_sprites, file);
-    bin_write_u32(sprites_pointer, file);
+    return ast_try_init_owned_map(ast, map, reason);
+}
 
-    // write the atlases
-    for (int i = 0; i < num_atlases; i++)
+void ast_init_memory(struct ast_t *ast, const char *name, const void *data, size_t size)
+{
+    // describe the given memory as a mapping that the set does not own
+    struct map_t map =
     {
-        // seek to this atlas in the file and get its source
-        fseek(file, atlases_pointer + (i * AST_ATLAS_SIZE), SEEK_SET);
-        const struct texture_t *atlas = &atlases[i];
+        .data = data,
+        .size = size,
+        .mapping_handle = NULL,
+        .is_copy = false,
+    };
 
-        // write the atlas
-        uint32_t png_pointer = stream_pointer + ftell(stream_file);
-        bin_write_u16(atlas->width, file);
-        bin_write_u16(atlas->height, file);
-        bin_write_u32(png_pointer, file);
+    ast_init_map(ast, name, map, false);
+}
 
-        // write the png
-        struct png_t png;
-        png_init_texture(&png, atlas);
-        png_write(&png, stream_file);
-        png_deinit(&png);
-    }
+void ast_init_pak(struct ast_t *ast, const struct pak_t *pak, const char *name)
+{
+    size_t size;
+    const void *data = pak_get(pak, name, &size);
+    ast_init_memory(ast, name, data, size);
+}
 
-    // write the sprites
-    for (int i = 0; i < num_sprites; i++)
-    {
-        // seek to the sprite in the file and get its source
-        fseek(file, sprites_pointer + (i * AST_SPRITE_SIZE), SEEK_SET);
-        const struct ast_sprite_t *sprite = &sprites[i];
+void ast_deinit(struct ast_t *ast)
+{
+    if (ast->owns_sprites)
+        free((void *)ast->sprites);
 
-        // write the sprite
-        fwrite(sprite->id, sizeof(char), AST_ID_MAX_SIZE, file);
-        bin_write_u8(sprite->atlas_index, file);
-        bin_write_u8(0x0, file);
-        bin_write_u8(0x0, file);
-        bin_write_u8(0x0, file);
+    ast_free_atlases(ast->atlases, ast->num_atlases);
+    if (ast->owns_map)
+        map_deinit(&ast->map);
+}
 
-        // normalize the uv coordinates to the atlas array textures size before writing them
-        // this allows the reader to not have to do any work
-        assert(sprite->atlas_index < num_atlases);
-        const struct texture_t *atlas = &atlases[i];
+/// Get the size and payload of the given mip level of the given atlas.
+/// @param atlas The atlas to get the mip level of.
+/// @param level The mip level to get, where `0` is the full size level.
+/// This must be a level which is stored within the containing atlas set.
+/// @param width The pointer to set the value of to the width of the given level, in pixels.
+/// @param height The pointer to set the value of to the height of the given level, in pixels.
+/// @param payload_data The pointer to set the value of to the first byte of the given level's payload.
+/// @param payload_size The pointer to set the value of to the total size of the given level's payload, in bytes.
+void ast_atlas_get_level(const struct ast_atlas_t *atlas,
+                         unsigned int level,
+                         unsigned int *width,
+                         unsigned int *height,
+                         const void **payload_data,
+                         size_t *payload_size)
+{
+    if (level > 0)
+    {
+        const struct ast_mip_t *mip = &atlas->mips[level - 1];
+        *width = mip->width;
+        *height = mip->height;
+        *payload_data = mip->payload_data;
+        *payload_size = mip->payload_size;
+    }
+    else
+    {
+        *width = atlas->width;
+        *height = atlas->height;
+        *payload_data = atlas->payload_data;
+        *payload_size = atlas->payload_size;
+    }
+}
+
+/// Get the format of the decoded texture data of the given atlas.
+///
+/// Compressed payloads are uploaded as they are, so this is their compressed format.
+/// @param atlas The atlas to get the decoded format of.
+/// @return The format of the decoded texture data of the given atlas.
+enum texture_format_t ast_atlas_get_data_format(const struct ast_atlas_t *atlas)
+{
+    enum texture_format_t format;
+    if (ast_payload_get_compressed_format(atlas->payload, &format))
+        return format;
+
+    return atlas->format;
+}
+
+/// Get the size of the decoded texture data of the given mip level of the given atlas.
+/// @param atlas The atlas to get the decoded size of.
+/// @param level The mip level to get the decoded size of, where `0` is the full size level.
+/// This must be a level which is stored within the containing atlas set.
+/// @return The size of the decoded texture data of the given level, in bytes.
+size_t ast_atlas_get_level_size(const struct ast_atlas_t *atlas, unsigned int level)
+{
+    unsigned int width, height;
+    const void *payload_data;
+    size_t payload_size;
+    ast_atlas_get_level(atlas, level, &width, &height, &payload_data, &payload_size);
+    return texture_get_data_size(ast_atlas_get_data_format(atlas), width, height);
+}
+
+/// Terminate the program due to a corrupt atlas payload.
+/// @param reason A human readable description of why the payload is corrupt.
+void ast_throw_corrupt_payload(const char *reason)
+{
+    fprintf(stderr, "AST ERROR: corrupt atlas payload (%s)\n", reason);
+    exit(EXIT_FAILURE);
+}
+
+/// Decode the payload of the given mip level of the given atlas directly into the given destination.
+///
+/// The destination is written sequentially and never read, so it may be memory that is slow to read from such as a mapped pixel buffer.
+/// LZ4 payloads refer back to their own decompressed output, so they are decompressed into an intermediate allocation
+/// and then copied, rather than reading back from the destination.
+/// If the given atlas' payload is corrupt, or does not decode to the size of the given level, then the program terminates.
+/// @param atlas The atlas to decode the payload of.
+/// @param level The mip level to decode the payload of, where `0` is the full size level.
+/// This must be a level which is stored within the containing atlas set.
+/// @param destination The first byte of the memory to decode the texture data into, with rows ordered bottom-to-top.
+/// This must be exactly `ast_atlas_get_level_size` bytes.
+void ast_atlas_decode_into(const struct ast_atlas_t *atlas, unsigned int level, void *destination)
+{
+    unsigned int width, height;
+    const void *payload_data;
+    size_t payload_size;
+    ast_atlas_get_level(atlas, level, &width, &height, &payload_data, &payload_size);
+    size_t data_size = ast_atlas_get_level_size(atlas, level);
+
+    switch (atlas->payload)
+    {
+        case AST_PAYLOAD_PNG:
+        {
+            // ensure the png matches the level before decoding, so it cannot write anything unexpected
+            unsigned int png_width, png_height;
+            enum png_format_t png_format;
+            png_read_header_memory(payload_data, payload_size, &png_width, &png_height, &png_format);
+            if (png_width != width || png_height != height || ast_format_from_png(png_format) != atlas->format)
+                ast_throw_corrupt_payload("png does not match its atlas");
+
+            png_decode_memory(payload_data, payload_size, destination, data_size);
+            break;
+        }
+        case AST_PAYLOAD_QOI:
+        {
+            unsigned int qoi_width, qoi_height;
+            enum png_format_t qoi_format;
+            qoi_read_header_memory(payload_data, payload_size, &qoi_width, &qoi_height, &qoi_format);
+            if (qoi_width != width || qoi_height != height || ast_format_from_png(qoi_format) != atlas->format)
+                ast_throw_corrupt_payload("qoi does not match its atlas");
+
+            qoi_decode_memory(payload_data, payload_size, destination, data_size);
+            break;
+        }
+        case AST_PAYLOAD_LZ4:
+        {
+            void *data = malloc(data_size);
+            if (!lz4_decompress(payload_data, payload_size, data, data_size))
+                ast_throw_corrupt_payload("invalid lz4 block");
+
+            memcpy(destination, data, data_size);
+            free(data);
+            break;
+        }
+        case AST_PAYLOAD_BC1:
+        case AST_PAYLOAD_BC3:
+        case AST_PAYLOAD_BC7:
+            // blocks are already in upload order, so they are only copied
+            if (payload_size != data_size)
+                ast_throw_corrupt_payload("blocks do not match their atlas");
+
+            memcpy(destination, payload_data, data_size);
+            break;
+    }
+}
+
+/// Decode the payload of the given mip level of the given atlas into a new allocation.
+///
+/// The decoded texture data is in the format given by `ast_atlas_get_data_format`, with rows ordered bottom-to-top.
+/// If the given atlas' payload is corrupt then the program terminates.
+/// If the given atlas' payload is compressed then an assertion fails, as blocks are uploaded without decoding.
+/// @param atlas The atlas to decode the payload of.
+/// @param level The mip level to decode the payload of, where `0` is the full size level.
+/// This must be a level which is stored within the containing atlas set.
+/// @return The first byte of the decoded texture data, which must be freed by the caller.
+void *ast_atlas_decode(const struct ast_atlas_t *atlas, unsigned int level)
+{
+    assert(!texture_format_is_compressed(ast_atlas_get_data_format(atlas)));
+
+    unsigned int width, height;
+    const void *payload_data;
+    size_t payload_size;
+    ast_atlas_get_level(atlas, level, &width, &height, &payload_data, &payload_size);
+
+    // the texels of every payload are already in upload order,
+    // so they are decoded once into their own allocation
+    size_t data_size = ast_atlas_get_level_size(atlas, level);
+    void *data = malloc(data_size);
+    switch (atlas->payload)
+    {
+        case AST_PAYLOAD_PNG:
+        case AST_PAYLOAD_QOI:
+            ast_atlas_decode_into(atlas, level, data);
+            break;
+        case AST_PAYLOAD_LZ4:
+            // decompress directly, the intermediate allocation is only needed for slow to read destinations
+            if (!lz4_decompress(payload_data, payload_size, data, data_size))
+                ast_throw_corrupt_payload("invalid lz4 block");
+            break;
+        case AST_PAYLOAD_BC1:
+        case AST_PAYLOAD_BC3:
+        case AST_PAYLOAD_BC7:
+            break;
+    }
+
+    return data;
+}
+
+/// Decode the payloads of every stored mip level of the given atlas.
+///
+/// Compressed payloads need no decoding, so the given levels are left unset for them.
+/// @param ast The atlas set containing the given atlas.
+/// @param atlas The atlas to decode the payloads of.
+/// @param levels The pointers to set to the decoded texture data of each level, indexed by level, see `ast_atlas_decode`.
+void ast_atlas_decode_levels(const struct ast_t *ast,
+                             const struct ast_atlas_t *atlas,
+                             void **levels)
+{
+    if (texture_format_is_compressed(ast_atlas_get_data_format(atlas)))
+        return;
+
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    for (unsigned int level = 0; level < num_levels; level++)
+        levels[level] = ast_atlas_decode(atlas, level);
+}
+
+/// Upload the given decoded mip levels of the given atlas into the given layer of the given texture, then free them.
+///
+/// Compressed payloads are uploaded directly from the set's mapping instead, and the given levels are unused.
+/// Levels beyond the mip levels of the given texture are not uploaded, but are still freed.
+/// @param ast The atlas set containing the given atlas.
+/// @param atlas The atlas to upload the mip levels of.
+/// @param texture The atlas array texture to upload into.
+/// @param layer The layer of the given texture to upload into.
+/// @param levels The decoded texture data of each mip level of the given atlas, indexed by level.
+void ast_upload_levels(const struct ast_t *ast,
+                       const struct ast_atlas_t *atlas,
+                       struct texture_t *texture,
+                       unsigned int layer,
+                       void **levels)
+{
+    bool is_compressed = texture_format_is_compressed(ast_atlas_get_data_format(atlas));
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    for (unsigned int level = 0; level < num_levels; level++)
+    {
+        if (is_compressed)
+        {
+            if (level >= texture->num_levels)
+                continue;
+
+            unsigned int width, height;
+            const void *payload_data;
+            size_t payload_size;
+            ast_atlas_get_level(atlas, level, &width, &height, &payload_data, &payload_size);
+            if (payload_size != ast_atlas_get_level_size(atlas, level))
+                ast_throw_corrupt_payload("blocks do not match their atlas");
+
+            texture_set_array_blocks(texture, layer, level, width, height, payload_data);
+        }
+        else
+        {
+            if (level < texture->num_levels)
+            {
+                unsigned int width, height;
+                const void *payload_data;
+                size_t payload_size;
+                ast_atlas_get_level(atlas, level, &width, &height, &payload_data, &payload_size);
+                texture_set_array_data(texture, layer, level, width, height, atlas->format, levels[level]);
+            }
+
+            free(levels[level]);
+        }
+    }
+}
+
+/// Complete the mipmap of the given atlas array texture for the given atlas set, once all of its layers have been uploaded.
+///
+/// Only sets whose mip levels are generated need anything done, stored levels have already been uploaded.
+/// @param ast The set that the given texture was populated from.
+/// @param texture The atlas array texture to complete the mipmap of.
+void ast_complete_texture(const struct ast_t *ast,
+                          struct texture_t *texture)
+{
+    if (ast->atlas_mipmaps == AST_MIPMAPS_GENERATED)
+        texture_generate_mipmap(texture);
+}
+
+/// Decode the payload of the atlas at the given index within an atlas set.
+///
+/// This is the job function used to decode atlases concurrently,
+/// each job only reads its own atlas' byte ranges within the set's mapping.
+/// @param data The pointer to the `ast_decode_t` of the atlas set being decoded.
+/// @param index The index of the atlas to decode.
+void ast_decode_atlas(void *data, unsigned int index)
+{
+    struct ast_decode_t *decode = (struct ast_decode_t *)data;
+    unsigned int num_levels = ast_get_num_stored_levels(decode->ast);
+    ast_atlas_decode_levels(decode->ast, &decode->ast->atlases[index], &decode->levels[index * num_levels]);
+}
+
+/// Get the format of the atlas array texture for the given atlas set.
+/// @param ast The set to get the atlas array texture format of.
+/// @return The format of the given set's atlas array texture.
+enum texture_format_t ast_get_texture_format(const struct ast_t *ast)
+{
+    // compressed and compact atlases all share the same format, which is validated when the set is read
+    if (ast->num_atlases > 0)
+    {
+        enum texture_format_t format = ast_atlas_get_data_format(&ast->atlases[0]);
+        if (texture_format_is_compressed(format) || texture_format_is_compact(format))
+            return format;
+    }
+
+    // get whether or not any of the atlases has an alpha channel,
+    // to determine the format of the array texture before anything is decoded
+    bool any_has_alpha = false;
+    for (int i = 0; i < ast->num_atlases; i++)
+        if (ast->atlases[i].format == TEXTURE_RGBAU8)
+            any_has_alpha = true;
+
+    return (any_has_alpha) ? TEXTURE_RGBAU8 : TEXTURE_RGBU8;
+}
+
+/// Get the mip policy of the atlas array texture for the given atlas set.
+/// @param ast The set to get the atlas array texture mip policy of.
+/// @return The mip policy of the given set's atlas array texture.
+enum texture_mipmaps_t ast_get_texture_mipmaps(const struct ast_t *ast)
+{
+    switch (ast->atlas_mipmaps)
+    {
+        case AST_MIPMAPS_GENERATED: return TEXTURE_MIPMAPS_GENERATED;
+        case AST_MIPMAPS_STORED:    return TEXTURE_MIPMAPS_STORED;
+        case AST_MIPMAPS_NONE:      return TEXTURE_MIPMAPS_NONE;
+        default:
+            fprintf(stderr, "AST ERROR: unknown atlas mip policy %i\n", ast->atlas_mipmaps);
+            exit(EXIT_FAILURE);
+    }
+}
+
+/// Initialize the given texture with an empty atlas array texture for the given atlas set.
+///
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param ast The set to initialize the atlas array texture for.
+/// @param texture The texture to initialize.
+void ast_init_texture(const struct ast_t *ast,
+                      struct texture_t *texture)
+{
+    texture_init_empty_array(texture,
+                             ast->atlas_width,
+                             ast->atlas_height,
+                             ast->num_atlases,
+                             ast->atlas_num_levels,
+                             ast_get_texture_mipmaps(ast),
+                             ast->atlas_scaling,
+                             ast_get_texture_format(ast));
+}
+
+void ast_get_texture(struct ast_t *ast,
+                     struct texture_t *texture)
+{
+    // initialize the given texture
+    ast_init_texture(ast, texture);
+
+    // decode all the payloads concurrently
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    void **levels = malloc(ast->num_atlases * num_levels * sizeof(void *));
+    struct ast_decode_t decode =
+    {
+        .ast = ast,
+        .levels = levels,
+    };
+
+    struct jobs_t jobs;
+    jobs_init(&jobs, ast->num_atlases, 0, ast_decode_atlas, &decode);
+
+    // upload each atlas on this thread as soon as it has been decoded,
+    // then free it as it is no longer needed
+    unsigned int index;
+    while (jobs_wait_next(&jobs, &index))
+        ast_upload_levels(ast, &ast->atlases[index], texture, index, &levels[index * num_levels]);
+
+    jobs_deinit(&jobs);
+    free(levels);
+
+    // complete the mipmap now that the array texture is populated
+    ast_complete_texture(ast, texture);
+}
+
+/// Decode the payload of the atlas for the job at the given index within an atlas set stream.
+///
+/// This is the job function used to decode the atlases of a stream.
+/// Each level is decoded directly into its reserved staging memory, which is only committed once the job has finished.
+/// @param data The pointer to the `ast_stream_t` being decoded.
+/// @param index The index of the job decoding the atlas.
+void ast_stream_decode_atlas(void *data, unsigned int index)
+{
+    struct ast_stream_t *stream = (struct ast_stream_t *)data;
+    const struct ast_atlas_t *atlas = &stream->ast->atlases[stream->layers[index]];
+    unsigned int num_levels = ast_get_num_stored_levels(stream->ast);
+    for (unsigned int level = 0; level < num_levels; level++)
+        ast_atlas_decode_into(atlas, level, stream->uploads[index * num_levels + level].data);
+}
+
+/// Stage the next atlases of the given atlas set stream, reserving their staging memory and releasing their jobs to decode into it.
+///
+/// Atlases are staged in job order until `AST_STREAM_MAX_STAGED_LAYERS` of them are staged but not yet uploaded.
+/// Reserving has to happen on the thread of the stream's graphics context, so it is done here and the memory handed to the jobs.
+/// @param stream The stream to stage the next atlases of.
+void ast_stream_stage_layers(struct ast_stream_t *stream)
+{
+    const struct ast_t *ast = stream->ast;
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    unsigned int num_staged = 0;
+    while (stream->num_staged_layers < stream->num_layers &&
+           stream->num_staged_layers - stream->num_ready_layers < AST_STREAM_MAX_STAGED_LAYERS)
+    {
+        unsigned int index = stream->num_staged_layers++;
+        const struct ast_atlas_t *atlas = &ast->atlases[stream->layers[index]];
+        for (unsigned int level = 0; level < num_levels; level++)
+            texture_upload_ring_reserve(&stream->ring,
+                                        ast_atlas_get_level_size(atlas, level),
+                                        &stream->uploads[index * num_levels + level]);
+
+        num_staged++;
+    }
+
+    jobs_release(&stream->jobs, num_staged);
+}
+
+/// Begin streaming the given layers of the atlas array texture from the given atlas set into the given texture.
+///
+/// Unlike `ast_stream_init` the given texture is not initialized, it must already be an atlas array texture for the given set.
+/// Layers which are not given are left untouched, and are never reported as ready.
+/// See `ast_stream_init` for further documentation.
+/// @param stream The stream to initialize.
+/// @param ast The set to stream the atlas array texture of.
+/// @param texture The atlas array texture to populate.
+/// @param num_layers The total number of given layers.
+/// @param layers The indices of all the layers to populate, which are also the indices of their atlases.
+/// These are copied, so they do not need to outlive the given stream.
+void ast_stream_init_layers(struct ast_stream_t *stream,
+                            const struct ast_t *ast,
+                            struct texture_t *texture,
+                            unsigned int num_layers,
+                            const unsigned int *layers)
+{
+    // initialize the given stream
+    // this must be done before starting the jobs as they immediately access it
+    stream->ast = ast;
+    stream->texture = texture;
+    stream->num_layers = num_layers;
+    stream->layers = malloc(num_layers * sizeof(unsigned int));
+    memcpy(stream->layers, layers, num_layers * sizeof(unsigned int));
+    stream->is_layer_ready = calloc(ast->num_atlases, sizeof(bool));
+    stream->num_ready_layers = 0;
+    stream->num_staged_layers = 0;
+    stream->is_complete = false;
+
+    // create a ring with a slot for every level of every atlas which can be staged at once
+    // slots are reserved and committed a whole atlas at a time, so each slot keeps staging the same level and grows to fit it
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    unsigned int num_ring_layers = (num_layers < AST_STREAM_MAX_STAGED_LAYERS) ? num_layers : AST_STREAM_MAX_STAGED_LAYERS;
+    unsigned int num_slots = (num_ring_layers > 0) ? num_ring_layers * num_levels : 1;
+    texture_upload_ring_init(&stream->ring, num_slots, 0);
+    stream->uploads = malloc(num_layers * num_levels * sizeof(struct texture_upload_t));
+
+    // begin decoding the first atlases, each job is released once its staging memory is reserved
+    jobs_init_held(&stream->jobs, num_layers, AST_STREAM_MAX_STAGED_LAYERS, ast_stream_decode_atlas, stream);
+    ast_stream_stage_layers(stream);
+
+    // streams without layers have nothing to stream
+    if (num_layers == 0)
+        ast_stream_update(stream, 0);
+}
+
+void ast_stream_init(struct ast_stream_t *stream,
+                     const struct ast_t *ast,
+                     struct texture_t *texture)
+{
+    // initialize the given texture
+    ast_init_texture(ast, texture);
+
+    // stream every layer
+    unsigned int *layers = malloc(ast->num_atlases * sizeof(unsigned int));
+    for (unsigned int i = 0; i < ast->num_atlases; i++)
+        layers[i] = i;
+
+    ast_stream_init_layers(stream, ast, texture, ast->num_atlases, layers);
+    free(layers);
+}
+
+void ast_stream_deinit(struct ast_stream_t *stream)
+{
+    // wait for the atlases which are decoding, as they are still writing into their staging memory,
+    // and discard those which have not begun decoding
+    // complete streams have already finished their jobs and released their staging memory
+    if (!stream->is_complete)
+    {
+        jobs_deinit(&stream->jobs);
+        texture_upload_ring_deinit(&stream->ring);
+    }
+
+    free(stream->uploads);
+    free(stream->is_layer_ready);
+    free(stream->layers);
+}
+
+void ast_stream_update(struct ast_stream_t *stream,
+                       unsigned int max_layers)
+{
+    if (stream->is_complete)
+        return;
+
+    // upload the atlases which have been decoded since the last update, up to the given limit
+    // each level is committed straight from the staging memory it was decoded into, which frees its slot for the next atlas
+    const struct ast_t *ast = stream->ast;
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    unsigned int index;
+    for (unsigned int i = 0; i < max_layers && jobs_poll_next(&stream->jobs, &index); i++)
+    {
+        const struct ast_atlas_t *atlas = &ast->atlases[stream->layers[index]];
+        for (unsigned int level = 0; level < num_levels; level++)
+        {
+            unsigned int width, height;
+            const void *payload_data;
+            size_t payload_size;
+            ast_atlas_get_level(atlas, level, &width, &height, &payload_data, &payload_size);
+            texture_upload_ring_commit(&stream->ring,
+                                       &stream->uploads[index * num_levels + level],
+                                       stream->texture,
+                                       stream->layers[index],
+                                       level,
+                                       0,
+                                       0,
+                                       width,
+                                       height,
+                                       ast_atlas_get_data_format(atlas));
+        }
+
+        stream->is_layer_ready[stream->layers[index]] = true;
+        stream->num_ready_layers++;
+    }
+
+    // stage the next atlases into the slots which were just committed
+    ast_stream_stage_layers(stream);
+
+    // complete the stream once every layer is ready
+    if (stream->num_ready_layers >= stream->num_layers)
+    {
+        jobs_deinit(&stream->jobs);
+        texture_upload_ring_deinit(&stream->ring);
+        ast_complete_texture(stream->ast, stream->texture);
+        stream->is_complete = true;
+    }
+}
+
+bool ast_stream_is_layer_ready(const struct ast_stream_t *stream,
+                               unsigned int index)
+{
+    assert(index < stream->ast->num_atlases);
+    return stream->is_layer_ready[index];
+}
+
+float ast_stream_get_progress(struct ast_stream_t *stream)
+{
+    if (stream->is_complete)
+        return 1;
+
+    unsigned int num_decoded = jobs_get_num_completed(&stream->jobs);
+    return (float)(num_decoded + stream->num_ready_layers) / (float)(stream->num_layers * 2);
+}
+
+bool ast_stream_is_complete(const struct ast_stream_t *stream)
+{
+    return stream->is_complete;
+}
+
+/// Get the hash of the payloads of the given atlas, including all of its stored mip levels.
+///
+/// The properties of the payloads are hashed along with the payloads themselves,
+/// so that atlases whose payloads have the same bytes but are interpreted differently are not considered equal.
+/// @param ast The atlas set containing the given atlas.
+/// @param atlas The atlas to get the payload hash of.
+/// @return The 64-bit hash of the given atlas' payloads.
+uint64_t ast_atlas_get_payload_hash(const struct ast_t *ast,
+                                    const struct ast_atlas_t *atlas)
+{
+    uint32_t properties[] =
+    {
+        atlas->width,
+        atlas->height,
+        atlas->payload,
+        atlas->format,
+    };
+
+    uint64_t hash = hash_fnv1a64(properties, sizeof(properties));
+    hash = hash_fnv1a64_continue(hash, atlas->payload_data, atlas->payload_size);
+
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    for (unsigned int level = 1; level < num_levels; level++)
+        hash = hash_fnv1a64_continue(hash, atlas->mips[level - 1].payload_data, atlas->mips[level - 1].payload_size);
+
+    return hash;
+}
+
+/// Hash the payloads of the atlas at the given index within an atlas set.
+///
+/// This is the job function used to hash atlases concurrently.
+/// @param data The pointer to the `ast_hash_t` of the atlas set being hashed.
+/// @param index The index of the atlas to hash.
+void ast_hash_atlas(void *data, unsigned int index)
+{
+    struct ast_hash_t *hash = (struct ast_hash_t *)data;
+    hash->hashes[index] = ast_atlas_get_payload_hash(hash->ast, &hash->ast->atlases[index]);
+}
+
+/// Hash the payloads of the atlas at the given index within the set being read by an atlas set hot reload.
+///
+/// This is the job function used to hash the atlases of a changed set file.
+/// @param data The pointer to the `ast_reload_t` reading the set.
+/// @param index The index of the atlas to hash.
+void ast_reload_hash_atlas(void *data, unsigned int index)
+{
+    struct ast_reload_t *reload = (struct ast_reload_t *)data;
+    reload->next_payload_hashes[index] = ast_atlas_get_payload_hash(&reload->next, &reload->next.atlases[index]);
+}
+
+/// Get whether or not the atlas array texture of the given atlas set can be reused for the given new atlas set.
+/// @param ast The set that the atlas array texture was created for.
+/// @param next The set to check the atlas array texture against.
+/// @return Whether or not the given new set can be uploaded into the given set's atlas array texture.
+bool ast_reload_is_texture_reusable(const struct ast_t *ast,
+                                    const struct ast_t *next)
+{
+    return next->atlas_width == ast->atlas_width &&
+           next->atlas_height == ast->atlas_height &&
+           next->atlas_scaling == ast->atlas_scaling &&
+           next->atlas_num_levels == ast->atlas_num_levels &&
+           next->num_atlases == ast->num_atlases &&
+           ast_get_texture_format(next) == ast_get_texture_format(ast);
+}
+
+/// Replace the set of the given atlas set hot reload with the set that it has read.
+///
+/// This should only be called once every changed layer has been uploaded.
+/// @param reload The reload to complete.
+void ast_reload_complete(struct ast_reload_t *reload)
+{
+    struct ast_t *ast = reload->ast;
+    struct ast_t *next = &reload->next;
+
+    // patch the sprites in place if the new set has the same sprites in the same order,
+    // so that any existing pointers to them stay valid, otherwise replace them
+    bool is_same_sprites = next->num_sprites == ast->num_sprites;
+    for (unsigned int i = 0; i < next->num_sprites && is_same_sprites; i++)
+        if (strcmp(next->sprites[i].id, ast->sprites[i].id) != 0)
+            is_same_sprites = false;
+
+    struct ast_sprite_t *sprites = (struct ast_sprite_t *)ast->sprites;
+    if (!is_same_sprites)
+    {
+        free(sprites);
+        sprites = malloc(next->num_sprites * sizeof(struct ast_sprite_t));
+    }
+
+    memcpy(sprites, next->sprites, next->num_sprites * sizeof(struct ast_sprite_t));
+    if (next->owns_sprites)
+        free((void *)next->sprites);
+
+    // release the previous atlases and mapping, then take everything else from the new set
+    for (int i = 0; i < ast->num_atlases; i++)
+        free(ast->atlases[i].mips);
+
+    free(ast->atlases);
+    if (ast->owns_map)
+        map_deinit(&ast->map);
+
+    *ast = *next;
+    ast->sprites = sprites;
+    ast->owns_sprites = true;
+
+    free(reload->payload_hashes);
+    reload->payload_hashes = reload->next_payload_hashes;
+    reload->next_payload_hashes = NULL;
+    reload->num_reloads++;
+    reload->state = AST_RELOAD_WATCHING;
+}
+
+/// Replace the mapping owned by the given atlas set with an allocated copy of its contents,
+/// so that the set keeps no reference to its file.
+///
+/// Every view over the mapping is moved to the same offset within the copy, which preserves its alignment.
+/// @param ast The set to copy the mapping of.
+void ast_copy_map(struct ast_t *ast)
+{
+    const unsigned char *previous_data = ast->map.data;
+    unsigned char *data = malloc(ast->map.size);
+    memcpy(data, previous_data, ast->map.size);
+
+    // move every view over the previous mapping into the copy
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    for (unsigned int i = 0; i < ast->num_atlases; i++)
+    {
+        struct ast_atlas_t *atlas = &ast->atlases[i];
+        atlas->payload_data = data + ((const unsigned char *)atlas->payload_data - previous_data);
+        for (unsigned int level = 1; level < num_levels; level++)
+        {
+            struct ast_mip_t *mip = &atlas->mips[level - 1];
+            mip->payload_data = data + ((const unsigned char *)mip->payload_data - previous_data);
+        }
+    }
+
+    if (!ast->owns_sprites)
+        ast->sprites = (const struct ast_sprite_t *)(data + ((const unsigned char *)ast->sprites - previous_data));
+    if (ast->sprite_index != NULL)
+        ast->sprite_index = (const struct ast_sprite_index_slot_t *)(data + ((const unsigned char *)ast->sprite_index - previous_data));
+
+    // release the previous mapping now that nothing refers to it
+    map_deinit(&ast->map);
+    ast->map.data = data;
+    ast->map.mapping_handle = NULL;
+    ast->map.is_copy = true;
+}
+
+void ast_reload_init(struct ast_reload_t *reload,
+                     struct ast_t *ast,
+                     struct texture_t *texture,
+                     const char *path)
+{
+    // begin watching first, so that changes made while hashing are not missed
+    watch_init(&reload->watch, path);
+
+    // copy the sprites if they are a view over the mapping, as they are patched in place
+    if (!ast->owns_sprites)
+    {
+        struct ast_sprite_t *sprites = malloc(ast->num_sprites * sizeof(struct ast_sprite_t));
+        memcpy(sprites, ast->sprites, ast->num_sprites * sizeof(struct ast_sprite_t));
+        ast->sprites = sprites;
+        ast->owns_sprites = true;
+    }
+
+    // copy the mapping of the given set if it owns one, so that its file can be replaced while it is being reloaded
+    // windows refuses to replace a file with a mapped view, which would otherwise fail the packer on the first repack
+    if (ast->owns_map && !ast->map.is_copy)
+        ast_copy_map(ast);
+
+    // hash the payloads of the given set to compare changed sets against
+    uint64_t *payload_hashes = malloc(ast->num_atlases * sizeof(uint64_t));
+    struct ast_hash_t hash =
+    {
+        .ast = ast,
+        .hashes = payload_hashes,
+    };
+
+    struct jobs_t jobs;
+    jobs_init(&jobs, ast->num_atlases, 0, ast_hash_atlas, &hash);
+    jobs_deinit(&jobs);
+
+    // initialize the given reload
+    reload->ast = ast;
+    reload->texture = texture;
+    reload->state = AST_RELOAD_WATCHING;
+    reload->payload_hashes = payload_hashes;
+    reload->next_payload_hashes = NULL;
+    reload->num_reloads = 0;
+    reload->num_reloaded_layers = 0;
+    reload->num_failed_reloads = 0;
+}
+
+void ast_reload_deinit(struct ast_reload_t *reload)
+{
+    // abandon any reload in progress
+    switch (reload->state)
+    {
+        case AST_RELOAD_WATCHING:
+            break;
+        case AST_RELOAD_DIFFING:
+            jobs_deinit(&reload->jobs);
+            break;
+        case AST_RELOAD_UPLOADING:
+            ast_stream_deinit(&reload->stream);
+            break;
+    }
+
+    if (reload->state != AST_RELOAD_WATCHING)
+    {
+        ast_deinit(&reload->next);
+        free(reload->next_payload_hashes);
+    }
+
+    free(reload->payload_hashes);
+    watch_deinit(&reload->watch);
+}
+
+bool ast_reload_update(struct ast_reload_t *reload,
+                       unsigned int max_layers)
+{
+    switch (reload->state)
+    {
+        case AST_RELOAD_WATCHING:
+        {
+            if (!watch_poll(&reload->watch))
+                return false;
+
+            // read the changed set and begin hashing its payloads
+            // the file is copied rather than mapped, so that it can be replaced again while the reload is in progress
+            // the file may be partially written or invalid, in which case the current set is kept until the next change
+            const char *reason;
+            if (!ast_try_init_copy(&reload->next, reload->watch.path, &reason))
+            {
+                fprintf(stderr, "AST ERROR: unable to reload ast file at \"%s\" (%s)\n", reload->watch.path, reason);
+                reload->num_failed_reloads++;
+                return false;
+            }
+
+            reload->next_payload_hashes = malloc(reload->next.num_atlases * sizeof(uint64_t));
+            jobs_init(&reload->jobs, reload->next.num_atlases, 0, ast_reload_hash_atlas, reload);
+            reload->state = AST_RELOAD_DIFFING;
+            return false;
+        }
+        case AST_RELOAD_DIFFING:
+        {
+            // wait for every payload to be hashed
+            if (jobs_get_num_completed(&reload->jobs) < reload->next.num_atlases)
+                return false;
+
+            jobs_deinit(&reload->jobs);
+
+            // find the layers to upload
+            // if the texture cannot be reused then it is recreated for the new set and every layer is uploaded,
+            // otherwise only the layers whose payloads changed are uploaded
+            unsigned int num_layers = 0;
+            unsigned int *layers = malloc(reload->next.num_atlases * sizeof(unsigned int));
+            bool is_texture_reusable = ast_reload_is_texture_reusable(reload->ast, &reload->next);
+            if (!is_texture_reusable)
+            {
+                texture_deinit(reload->texture);
+                ast_init_texture(&reload->next, reload->texture);
+            }
+
+            for (unsigned int i = 0; i < reload->next.num_atlases; i++)
+                if (!is_texture_reusable || reload->next_payload_hashes[i] != reload->payload_hashes[i])
+                    layers[num_layers++] = i;
+
+            reload->num_reloaded_layers = num_layers;
+            if (num_layers == 0)
+            {
+                free(layers);
+                ast_reload_complete(reload);
+                return true;
+            }
+
+            ast_stream_init_layers(&reload->stream, &reload->next, reload->texture, num_layers, layers);
+            free(layers);
+            reload->state = AST_RELOAD_UPLOADING;
+            return false;
+        }
+        case AST_RELOAD_UPLOADING:
+        {
+            // upload the changed layers, completing the reload once they are all uploaded
+            ast_stream_update(&reload->stream, max_layers);
+            if (!ast_stream_is_complete(&reload->stream))
+                return false;
+
+            ast_stream_deinit(&reload->stream);
+            ast_reload_complete(reload);
+            return true;
+        }
+    }
+}
+
+void ast_residency_init(struct ast_residency_t *residency,
+                        const struct ast_t *ast,
+                        size_t budget)
+{
+    // get the number of slots which fit within the given budget
+    // only stored mip levels are used, as generating levels would touch every layer on every miss
+    enum texture_format_t format = ast_get_texture_format(ast);
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    size_t layer_size = 0;
+    for (unsigned int level = 0; level < num_levels; level++)
+        layer_size += texture_get_data_size(format, texture_get_level_size(ast->atlas_width, level), texture_get_level_size(ast->atlas_height, level));
+    size_t num_slots = (layer_size > 0) ? budget / layer_size : 0;
+    if (num_slots > ast->num_atlases)
+        num_slots = ast->num_atlases;
+    if (num_slots < 1)
+        num_slots = 1;
+
+    // initialize the given residency with every slot empty
+    texture_init_empty_array(&residency->texture,
+                             ast->atlas_width,
+                             ast->atlas_height,
+                             num_slots,
+                             num_levels,
+                             (num_levels > 1) ? TEXTURE_MIPMAPS_STORED : TEXTURE_MIPMAPS_NONE,
+                             ast->atlas_scaling,
+                             format);
+
+    residency->ast = ast;
+    residency->layer_size = layer_size;
+    residency->num_slots = num_slots;
+    residency->slot_atlases = malloc(num_slots * sizeof(unsigned int));
+    residency->slot_frames = malloc(num_slots * sizeof(unsigned int));
+    residency->atlas_slots = malloc(ast->num_atlases * sizeof(unsigned int));
+    residency->frame = 1;
+    residency->num_hits = 0;
+    residency->num_misses = 0;
+    residency->num_evictions = 0;
+
+    for (int i = 0; i < num_slots; i++)
+    {
+        residency->slot_atlases[i] = AST_RESIDENCY_NONE;
+        residency->slot_frames[i] = 0;
+    }
+
+    for (int i = 0; i < ast->num_atlases; i++)
+        residency->atlas_slots[i] = AST_RESIDENCY_NONE;
+}
+
+void ast_residency_deinit(struct ast_residency_t *residency)
+{
+    texture_deinit(&residency->texture);
+    free(residency->atlas_slots);
+    free(residency->slot_frames);
+    free(residency->slot_atlases);
+}
+
+void ast_residency_begin_frame(struct ast_residency_t *residency)
+{
+    residency->frame++;
+}
+
+enum ast_residency_result_t ast_residency_get_sprite(struct ast_residency_t *residency,
+                                                     const char *id,
+                                                     const struct ast_sprite_t **sprite,
+                                                     unsigned int *layer)
+{
+    const struct ast_sprite_t *found_sprite = ast_get_sprite(residency->ast, id);
+    if (found_sprite == NULL)
+        return AST_RESIDENCY_MISSING;
+
+    *sprite = found_sprite;
+
+    // use the sprites atlas if it is already resident
+    unsigned int slot = residency->atlas_slots[found_sprite->atlas_index];
+    if (slot != AST_RESIDENCY_NONE)
+    {
+        residency->num_hits++;
+        residency->slot_frames[slot] = residency->frame;
+        *layer = slot;
+        return AST_RESIDENCY_RESIDENT;
+    }
+
+    // find the slot to make the atlas resident within
+    // empty slots are preferred, followed by the least recently used slot which has not been used this frame
+    unsigned int best_slot = AST_RESIDENCY_NONE;
+    for (unsigned int i = 0; i < residency->num_slots; i++)
+    {
+        if (residency->slot_atlases[i] == AST_RESIDENCY_NONE)
+        {
+            best_slot = i;
+            break;
+        }
+
+        if (residency->slot_frames[i] == residency->frame)
+            continue;
+
+        if (best_slot == AST_RESIDENCY_NONE || residency->slot_frames[i] < residency->slot_frames[best_slot])
+            best_slot = i;
+    }
+
+    // every slot is in use this frame, so the atlas cannot be made resident without corrupting pending draws
+    if (best_slot == AST_RESIDENCY_NONE)
+        return AST_RESIDENCY_EXHAUSTED;
+
+    // evict the slots current atlas, if any
+    unsigned int evicted_atlas = residency->slot_atlases[best_slot];
+    if (evicted_atlas != AST_RESIDENCY_NONE)
+    {
+        residency->atlas_slots[evicted_atlas] = AST_RESIDENCY_NONE;
+        residency->num_evictions++;
+    }
+
+    // decode and upload the atlas into the slot, along with its stored mip levels
+    void *levels[ast_get_num_stored_levels(residency->ast)];
+    ast_atlas_decode_levels(residency->ast, &residency->ast->atlases[found_sprite->atlas_index], levels);
+    ast_upload_levels(residency->ast, &residency->ast->atlases[found_sprite->atlas_index], &residency->texture, best_slot, levels);
+
+    residency->num_misses++;
+    residency->slot_atlases[best_slot] = found_sprite->atlas_index;
+    residency->slot_frames[best_slot] = residency->frame;
+    residency->atlas_slots[found_sprite->atlas_index] = best_slot;
+    *layer = best_slot;
+    return AST_RESIDENCY_RESIDENT;
+}
+
+/// Get the size class of an atlas along a single axis.
+/// @param size The size of the atlas along the axis, in pixels.
+/// @param atlas_size The size of the containing atlas set's atlas array texture along the axis, in pixels.
+/// @return The size class of the atlas along the axis, in pixels.
+unsigned int ast_get_size_class(unsigned int size, unsigned int atlas_size)
+{
+    unsigned int size_class = 1;
+    while (size_class < size)
+        size_class *= 2;
+
+    return (size_class < atlas_size) ? size_class : atlas_size;
+}
+
+/// Group the atlases of the given atlas set into arrays by size class.
+///
+/// Only the size, mip level count, and layer count of each array are set, their textures are not initialized.
+/// @param ast The set to group the atlases of.
+/// @param arrays The arrays to set the properties of each array within, which must have room for one array per atlas.
+/// @param atlas_arrays The array to write the index of the array containing each atlas to, indexed by atlas.
+/// @param atlas_layers The array to write the layer containing each atlas within its array to, indexed by atlas.
+/// @return The total number of arrays that the given set's atlases were grouped into.
+unsigned int ast_group_size_classes(const struct ast_t *ast,
+                                    struct ast_array_t *arrays,
+                                    unsigned int *atlas_arrays,
+                                    unsigned int *atlas_layers)
+{
+    unsigned int num_arrays = 0;
+    for (unsigned int i = 0; i < ast->num_atlases; i++)
+    {
+        unsigned int width = ast_get_size_class(ast->atlases[i].width, ast->atlas_width);
+        unsigned int height = ast_get_size_class(ast->atlases[i].height, ast->atlas_height);
+
+        // find the array of the atlas' size class, adding it if this is the first atlas within it
+        unsigned int index = 0;
+        while (index < num_arrays && (arrays[index].width != width || arrays[index].height != height))
+            index++;
+
+        if (index == num_arrays)
+        {
+            unsigned int num_levels = texture_get_num_levels(width, height);
+            struct ast_array_t *array = &arrays[num_arrays++];
+            array->width = width;
+            array->height = height;
+            array->num_levels = (ast->atlas_num_levels < num_levels) ? ast->atlas_num_levels : num_levels;
+            array->num_layers = 0;
+        }
+
+        atlas_arrays[i] = index;
+        atlas_layers[i] = arrays[index].num_layers++;
+    }
+
+    return num_arrays;
+}
+
+/// Get the memory wasted by the given atlas within a layer of an array texture of the given size.
+/// @param atlas The atlas within the layer.
+/// @param format The format of the array texture.
+/// @param width The width of the array texture, in pixels.
+/// @param height The height of the array texture, in pixels.
+/// @param num_levels The total number of mip levels of the array texture, including the full size level.
+/// @return The size of every level of the layer less the size of the given atlas within each, in bytes.
+size_t ast_get_layer_wasted_size(const struct ast_atlas_t *atlas,
+                                 enum texture_format_t format,
+                                 unsigned int width,
+                                 unsigned int height,
+                                 unsigned int num_levels)
+{
+    size_t wasted_size = 0;
+    for (unsigned int level = 0; level < num_levels; level++)
+    {
+        wasted_size += texture_get_data_size(format,
+                                             texture_get_level_size(width, level),
+                                             texture_get_level_size(height, level));
+
+        wasted_size -= texture_get_data_size(format,
+                                             ast_get_mip_size(atlas->width, width, level),
+                                             ast_get_mip_size(atlas->height, height, level));
+    }
+
+    return wasted_size;
+}
+
+void ast_arrays_init(struct ast_arrays_t *arrays,
+                     const struct ast_t *ast)
+{
+    // group the atlases by size class
+    // arrays are allocated for the worst case of every atlas being within its own size class
+    struct ast_array_t *set_arrays = malloc(ast->num_atlases * sizeof(struct ast_array_t));
+    unsigned int *atlas_arrays = malloc(ast->num_atlases * sizeof(unsigned int));
+    unsigned int *atlas_layers = malloc(ast->num_atlases * sizeof(unsigned int));
+    unsigned int num_arrays = ast_group_size_classes(ast, set_arrays, atlas_arrays, atlas_layers);
+
+    // initialize the array textures
+    enum texture_format_t format = ast_get_texture_format(ast);
+    for (unsigned int i = 0; i < num_arrays; i++)
+    {
+        struct ast_array_t *array = &set_arrays[i];
+        texture_init_empty_array(&array->texture,
+                                 array->width,
+                                 array->height,
+                                 array->num_layers,
+                                 array->num_levels,
+                                 ast_get_texture_mipmaps(ast),
+                                 ast->atlas_scaling,
+                                 format);
+    }
+
+    // decode all the payloads concurrently,
+    // uploading each atlas into its array on this thread as soon as it has been decoded
+    unsigned int num_levels = ast_get_num_stored_levels(ast);
+    void **levels = malloc(ast->num_atlases * num_levels * sizeof(void *));
+    struct ast_decode_t decode =
+    {
+        .ast = ast,
+        .levels = levels,
+    };
+
+    struct jobs_t jobs;
+    jobs_init(&jobs, ast->num_atlases, 0, ast_decode_atlas, &decode);
+
+    unsigned int index;
+    while (jobs_wait_next(&jobs, &index))
+    {
+        ast_upload_levels(ast,
+                          &ast->atlases[index],
+                          &set_arrays[atlas_arrays[index]].texture,
+                          atlas_layers[index],
+                          &levels[index * num_levels]);
+    }
+
+    jobs_deinit(&jobs);
+    free(levels);
+
+    // complete the mipmaps now that the array textures are populated
+    for (unsigned int i = 0; i < num_arrays; i++)
+        ast_complete_texture(ast, &set_arrays[i].texture);
+
+    // initialize the given arrays
+    arrays->ast = ast;
+    arrays->num_arrays = num_arrays;
+    arrays->arrays = set_arrays;
+    arrays->atlas_arrays = atlas_arrays;
+    arrays->atlas_layers = atlas_layers;
+}
+
+void ast_arrays_deinit(struct ast_arrays_t *arrays)
+{
+    for (unsigned int i = 0; i < arrays->num_arrays; i++)
+        texture_deinit(&arrays->arrays[i].texture);
+
+    free(arrays->atlas_layers);
+    free(arrays->atlas_arrays);
+    free(arrays->arrays);
+}
+
+void ast_arrays_get_placement(const struct ast_arrays_t *arrays,
+                              const struct ast_sprite_t *sprite,
+                              struct ast_placement_t *placement)
+{
+    // rescale the sprites coordinates from the sets array texture to its atlas' array texture,
+    // which is never larger so the coordinates stay within bounds
+    struct ast_array_t *array = &arrays->arrays[arrays->atlas_arrays[sprite->atlas_index]];
+    float u_scale = (float)arrays->ast->atlas_width / (float)array->width;
+    float v_scale = (float)arrays->ast->atlas_height / (float)array->height;
+    placement->texture = &array->texture;
+    placement->layer = arrays->atlas_layers[sprite->atlas_index];
+    placement->bottom_left = uv(sprite->bottom_left.u * u_scale, sprite->bottom_left.v * v_scale);
+    placement->top_right = uv(sprite->top_right.u * u_scale, sprite->top_right.v * v_scale);
+}
+
+size_t ast_get_texture_wasted_size(const struct ast_t *ast)
+{
+    enum texture_format_t format = ast_get_texture_format(ast);
+    size_t wasted_size = 0;
+    for (unsigned int i = 0; i < ast->num_atlases; i++)
+    {
+        wasted_size += ast_get_layer_wasted_size(&ast->atlases[i],
+                                                 format,
+                                                 ast->atlas_width,
+                                                 ast->atlas_height,
+                                                 ast->atlas_num_levels);
+    }
+
+    return wasted_size;
+}
+
+size_t ast_get_arrays_wasted_size(const struct ast_t *ast)
+{
+    struct ast_array_t *arrays = malloc(ast->num_atlases * sizeof(struct ast_array_t));
+    unsigned int *atlas_arrays = malloc(ast->num_atlases * sizeof(unsigned int));
+    unsigned int *atlas_layers = malloc(ast->num_atlases * sizeof(unsigned int));
+    ast_group_size_classes(ast, arrays, atlas_arrays, atlas_layers);
+
+    enum texture_format_t format = ast_get_texture_format(ast);
+    size_t wasted_size = 0;
+    for (unsigned int i = 0; i < ast->num_atlases; i++)
+    {
+        const struct ast_array_t *array = &arrays[atlas_arrays[i]];
+        wasted_size += ast_get_layer_wasted_size(&ast->atlases[i],
+                                                 format,
+                                                 array->width,
+                                                 array->height,
+                                                 array->num_levels);
+    }
+
+    free(atlas_layers);
+    free(atlas_arrays);
+    free(arrays);
+    return wasted_size;
+}
+
+const struct ast_sprite_t *ast_get_sprite_at(const struct ast_t *ast,
+                                             unsigned int index)
+{
+    assert(index < ast->num_sprites);
+    return &ast->sprites[index];
+}
+
+uint64_t ast_get_content_hash(const struct ast_t *ast)
+{
+    // everything is hashed in its canonical little-endian file encoding with zeroed padding,
+    // so the hash depends only on the file, not on the host byte order or whether the sprites are viewed or copied
+    unsigned char header[16];
+    struct bin_writer_t writer;
+    bin_writer_init_memory(&writer, header, sizeof(header));
+    bin_writer_write_u32(&writer, ast->atlas_width);
+    bin_writer_write_u32(&writer, ast->atlas_height);
+    bin_writer_write_u32(&writer, ast->num_atlases);
+    bin_writer_write_u32(&writer, ast->num_sprites);
+    assert(!writer.error);
+
+    uint64_t hash = hash_fnv1a64(header, sizeof(header));
+    for (unsigned int i = 0; i < ast->num_sprites; i++)
+    {
+        const struct ast_sprite_t *sprite = &ast->sprites[i];
+        unsigned char encoded[AST_SPRITE_SIZE];
+        bin_writer_init_memory(&writer, encoded, sizeof(encoded));
+        bin_writer_write_bytes(&writer, sprite->id, AST_ID_MAX_SIZE);
+        bin_writer_write_u8(&writer, sprite->atlas_index);
+        bin_writer_write_zeros(&writer, 3);
+        bin_writer_write_f32(&writer, sprite->bottom_left.u);
+        bin_writer_write_f32(&writer, sprite->bottom_left.v);
+        bin_writer_write_f32(&writer, sprite->top_right.u);
+        bin_writer_write_f32(&writer, sprite->top_right.v);
+        bin_writer_write_u16(&writer, sprite->width);
+        bin_writer_write_u16(&writer, sprite->height);
+        assert(!writer.error && writer.offset == sizeof(encoded));
+
+        hash = hash_fnv1a64_continue(hash, encoded, sizeof(encoded));
+    }
+
+    return hash;
+}
+
+void ast_verify_content_hash(const struct ast_t *ast,
+                             uint64_t expected_hash)
+{
+    uint64_t hash = ast_get_content_hash(ast);
+    if (hash != expected_hash)
+    {
+        // the set does not match, print the details and terminate
+        fprintf(stderr, "AST ERROR: content hash mismatch (expected 0x%016llx, found 0x%016llx), the generated sprite header is out of date\n", (unsigned long long)expected_hash, (unsigned long long)hash);
+        exit(EXIT_FAILURE);
+    }
+}
+
+const struct ast_sprite_t *ast_get_sprite(const struct ast_t *ast,
+                                          const char *id)
+{
+    // use the sprite index if there is one
+    if (ast->sprite_index != NULL)
+    {
+        // probe linearly from the home slot of the given ids hash until an empty slot is reached
+        // the slot count is a power of two and there is always an empty slot, but the probe is still bounded by the slot count
+        uint64_t id_hash = hash_fnv1a64_string(id);
+        unsigned int mask = ast->num_sprite_index_slots - 1;
+        for (unsigned int n = 0, i = id_hash & mask; n < ast->num_sprite_index_slots; n++, i = (i + 1) & mask)
+        {
+            const struct ast_sprite_index_slot_t *slot = &ast->sprite_index[i];
+            if (slot->sprite_index == AST_SPRITE_INDEX_EMPTY)
+                return NULL;
+
+            const struct ast_sprite_t *sprite = &ast->sprites[slot->sprite_index];
+            if (slot->id_hash == id_hash && strcmp(sprite->id, id) == 0)
+                return sprite;
+        }
+
+        return NULL;
+    }
+
+    // attempt to return the first sprite matching the given id within the given set
+    for (int i = 0; i < ast->num_sprites; i++)
+    {
+        const struct ast_sprite_t *sprite = &ast->sprites[i];
+        if (strcmp(sprite->id, id) == 0)
+            return sprite;
+    }
+
+    // if this point has been reached then no matching sprite was found
+    return NULL;
+}
+
+/// Encode the given texture data into the given payload buffer.
+/// @param png The texture data to encode.
+/// @param encoding The encoding to store the given texture data with.
+/// @param format The compact format to convert the given texture data into before encoding it,
+/// or `TEXTURE_RGBAU8` to keep the given texture data's own format.
+/// Compact formats can only be encoded as LZ4 payloads.
+/// @param payload The buffer to append the encoded payload to.
+void ast_encode_payload(const struct png_t *png,
+                        enum ast_payload_t encoding,
+                        enum texture_format_t format,
+                        struct buffer_t *payload)
+{
+    switch (encoding)
+    {
+        case AST_PAYLOAD_PNG:
+            png_write_buffer(png, NULL, payload);
+            break;
+        case AST_PAYLOAD_QOI:
+            qoi_write_buffer(png, payload);
+            break;
+        case AST_PAYLOAD_LZ4:
+        {
+            // pngs are stored bottom-to-top, so the texels are already in upload order
+            // compact formats are converted here, so that the reader uploads the texels exactly as they are stored
+            const void *data = png->data;
+            size_t data_size = (size_t)png->width * png->height * png_get_pixel_size(png->format);
+            void *converted_data = NULL;
+            if (texture_format_is_compact(format))
+            {
+                data_size = texture_get_data_size(format, png->width, png->height);
+                converted_data = malloc(data_size);
+                texture_convert_png(png, format, converted_data);
+                data = converted_data;
+            }
+
+            // compress into the worst case size, then shrink the payload to the compressed size
+            size_t compressed_capacity = lz4_get_max_compressed_size(data_size);
+            void *compressed = buffer_extend(payload, compressed_capacity);
+            payload->size -= compressed_capacity - lz4_compress(data, data_size, compressed, compressed_capacity);
+            free(converted_data);
+            break;
+        }
+        case AST_PAYLOAD_BC1:
+        case AST_PAYLOAD_BC3:
+        case AST_PAYLOAD_BC7:
+        {
+            enum texture_format_t format;
+            ast_payload_get_compressed_format(encoding, &format);
+            bc_encode_buffer(png, format, payload);
+            break;
+        }
+    }
+}
+
+/// Encode the payloads of the atlas at the given index within an atlas set being written.
+///
+/// This is the job function used to encode atlases concurrently,
+/// each job only writes its own atlas' payloads.
+/// Each stored mip level is filtered from the level before it, so the levels of an atlas are encoded in order.
+/// @param data The pointer to the `ast_encode_t` of the atlas set being written.
+/// @param index The index of the atlas to encode.
+void ast_encode_atlas(void *data, unsigned int index)
+{
+    struct ast_encode_t *encode = (struct ast_encode_t *)data;
+    const struct png_t *atlas = &encode->atlases[index];
+    struct buffer_t *payloads = &encode->payloads[index * encode->num_levels];
+    ast_encode_payload(atlas, encode->payload, encode->format, &payloads[0]);
+
+    // each filtered level is only kept until the next level has been filtered from it
+    const struct png_t *previous = atlas;
+    struct png_t previous_mip;
+    for (unsigned int level = 1; level < encode->num_levels; level++)
+    {
+        struct png_t mip;
+        png_init_mipmap(&mip,
+                        previous,
+                        ast_get_mip_size(atlas->width, encode->atlas_width, level),
+                        ast_get_mip_size(atlas->height, encode->atlas_height, level));
+
+        ast_encode_payload(&mip, encode->payload, encode->format, &payloads[level]);
+        if (previous != atlas)
+            png_deinit(&previous_mip);
+
+        previous_mip = mip;
+        previous = &previous_mip;
+    }
+
+    if (previous != atlas)
+        png_deinit(&previous_mip);
+}
+
+void ast_write_contents(FILE *file,
+                        enum texture_scaling_t atlas_scaling,
+                        enum ast_payload_t atlas_payload,
+                        enum texture_format_t atlas_format,
+                        enum ast_mipmaps_t atlas_mipmaps,
+                        unsigned int num_atlases,
+                        const struct texture_t *atlases,
+                        unsigned int num_sprites,
+                        const struct ast_sprite_t *sprites)
+{
+    // read the texture data of each atlas
+    // every readback is issued before any is mapped, so the gpu copies all the atlases in one go rather than stalling for each
+    struct texture_readback_t *readbacks = malloc(num_atlases * sizeof(struct texture_readback_t));
+    for (int i = 0; i < num_atlases; i++)
+        texture_readback_init(&readbacks[i], &atlases[i]);
+
+    struct png_t *pngs = malloc(num_atlases * sizeof(struct png_t));
+    for (int i = 0; i < num_atlases; i++)
+    {
+        png_init_readback(&pngs[i], &readbacks[i]);
+        texture_readback_deinit(&readbacks[i]);
+    }
+
+    free(readbacks);
+
+    // write the set
+    ast_write_contents_png(file,
+                           atlas_scaling,
+                           atlas_payload,
+                           atlas_format,
+                           atlas_mipmaps,
+                           num_atlases,
+                           pngs,
+                           num_sprites,
+                           sprites);
+
+    for (int i = 0; i < num_atlases; i++)
+        png_deinit(&pngs[i]);
+
+    free(pngs);
+}
+
+void ast_write_contents_png(FILE *file,
+                            enum texture_scaling_t atlas_scaling,
+                            enum ast_payload_t atlas_payload,
+                            enum texture_format_t atlas_format,
+                            enum ast_mipmaps_t atlas_mipmaps,
+                            unsigned int num_atlases,
+                            const struct png_t *atlases,
+                            unsigned int num_sprites,
+                            const struct ast_sprite_t *sprites)
+{
+    // calculate the atlas array texture size
+    unsigned int atlas_width = 0, atlas_height = 0;
+    for (int i = 0; i < num_atlases; i++)
+    {
+        const struct png_t *atlas = &atlases[i];
+        if (atlas->width > atlas_width)
+            atlas_width = atlas->width;
+        if (atlas->height > atlas_height)
+            atlas_height = atlas->height;
+    }
+
+    // bc1 blocks are always opaque, so atlases with an alpha channel cannot be stored as them
+    for (int i = 0; i < num_atlases; i++)
+    {
+        if (atlas_payload == AST_PAYLOAD_BC1 && atlases[i].format == PNG_RGBAU8)
+        {
+            fprintf(stderr, "AST ERROR: cannot write atlases with an alpha channel as bc1 payloads\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // compact texels are converted before they are compressed, the other encodings can only represent rgb and rgba
+    bool is_compact = texture_format_is_compact(atlas_format);
+    assert(is_compact || atlas_format == TEXTURE_RGBAU8);
+    if (is_compact && atlas_payload != AST_PAYLOAD_LZ4)
+    {
+        fprintf(stderr, "AST ERROR: compact atlas formats can only be written with lz4 payloads\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // compressed array textures cannot have their mipmap generated, so the mip levels are stored instead
+    enum texture_format_t compressed_format;
+    if (atlas_mipmaps == AST_MIPMAPS_GENERATED && ast_payload_get_compressed_format(atlas_payload, &compressed_format))
+        atlas_mipmaps = AST_MIPMAPS_STORED;
+
+    // get the number of mip levels to store for each atlas, and the header flags for them
+    unsigned int num_levels = 1;
+    uint8_t flags = AST_FLAG_SPRITE_INDEX;
+    switch (atlas_mipmaps)
+    {
+        case AST_MIPMAPS_GENERATED:
+            break;
+        case AST_MIPMAPS_STORED:
+            num_levels = texture_get_num_levels(atlas_width, atlas_height);
+            flags |= AST_FLAG_MIPMAPS;
+            break;
+        case AST_MIPMAPS_NONE:
+            flags |= AST_FLAG_NO_MIPMAPS;
+            break;
+    }
+
+    // begin encoding all the atlas payloads concurrently
+    // this is the bulk of the work, so everything else is built while it runs
+    unsigned int num_payloads = num_atlases * num_levels;
+    struct buffer_t *payloads = malloc(num_payloads * sizeof(struct buffer_t));
+    for (int i = 0; i < num_payloads; i++)
+        buffer_init(&payloads[i]);
+
+    struct ast_encode_t encode =
+    {
+        .atlases = atlases,
+        .payload = atlas_payload,
+        .format = atlas_format,
+        .atlas_width = atlas_width,
+        .atlas_height = atlas_height,
+        .num_levels = num_levels,
+        .payloads = payloads,
+    };
+
+    struct jobs_t jobs;
+    jobs_init(&jobs, num_atlases, 0, ast_encode_atlas, &encode);
+
+    // calculate the sprite index size
+    // the slot count is kept to at least double the sprite count to keep probe sequences short,
+    // and is a power of two so that slots can be found by masking
+    uint32_t num_sprite_index_slots = 1;
+    while (num_sprite_index_slots < num_sprites * 2)
+        num_sprite_index_slots *= 2;
+
+    // calculate fixed pointers
+    // the sprite index is aligned to its slots so that it can be viewed directly by the reader
+    // payloads follow everything else as their sizes are only known once they have been encoded
+    uint32_t header_pointer = (uint32_t)ftell(file);
+    uint32_t sections_size = AST_SPRITE_INDEX_HEADER_SIZE + ((flags & AST_FLAG_MIPMAPS) ? AST_MIPMAPS_HEADER_SIZE : 0);
+    uint32_t atlases_pointer = header_pointer + AST_HEADER_SIZE + sections_size;
+    uint32_t mips_pointer = atlases_pointer + (num_atlases * AST_ATLAS_SIZE);
+    uint32_t sprites_pointer = mips_pointer + (num_atlases * (num_levels - 1) * AST_MIP_SIZE);
+    uint32_t sprite_index_pointer = (sprites_pointer + (num_sprites * AST_SPRITE_SIZE) + 7) & ~7;
+    uint32_t payloads_pointer = sprite_index_pointer + (num_sprite_index_slots * AST_SPRITE_INDEX_SLOT_SIZE);
+
+    // build the sprites, followed by the sprite index
+    struct buffer_t tables;
+    buffer_init(&tables);
+    buffer_reserve(&tables, payloads_pointer - sprites_pointer);
+
+    struct bin_writer_t tables_writer;
+    bin_writer_init_buffer(&tables_writer, &tables);
+    for (int i = 0; i < num_sprites; i++)
+    {
+        const struct ast_sprite_t *sprite = &sprites[i];
+        // normalize the uv coordinates to the atlas array textures size before writing them
+        // this allows the reader to not have to do any work
+        assert(sprite->atlas_index < num_atlases);
+        const struct png_t *atlas = &atlases[sprite->atlas_index];
         float u_multiplier = (float)atlas->width / (float)atlas_width;
         float v_multiplier = (float)atlas->height / (float)atlas_height;
-        float bl_u = sprite->bottom_left.u * u_multiplier;
-        float bl_v = sprite->bottom_left.v * v_multiplier;
-        float tr_u = sprite->top_right.u * u_multiplier;
-        float tr_v = sprite->top_right.v * v_multiplier;
-
-        bin_write_f32(bl_u, file);
-        bin_write_f32(bl_v, file);
-        bin_write_f32(tr_u, file);
-        bin_write_f32(tr_v, file);
-
-        // calculate and write the pixel size
-        bin_write_u16(atlas->width * (sprite->top_right.u - sprite->bottom_left.u), file);
-        bin_write_u16(atlas->height * (sprite->top_right.v - sprite->bottom_left.v), file);
-    }
-
-    // write and close the data stream
-    fflush(stream_file);
-    #ifdef WINDOWS
-    // read the contents of the temp file
-    fseek(stream_file, 0, SEEK_END);
-    unsigned int stream_size = ftell(stream_file);
-    unsigned char *stream = malloc(stream_size);
-    fseek(stream_file, 0, SEEK_SET);
-    fread(stream, stream_size, 1, stream_file);
-
-    // write the contents of the temp file to the given file
-    fwrite(stream, stream_size, 1, file);
-    free(stream);
-    #elif LINUX
-    // write the contents of the memstream
-    fwrite(stream, stream_size, 1, file);
-    #endif
-
-    fclose(stream_file);
-
-    // if a temp file was used for the data stream then remove it
-    #ifdef WINDOWS
-    remove(stream_filename);
-    #endif
+        float uvs[4] =
+        {
+            sprite->bottom_left.u * u_multiplier,
+            sprite->bottom_left.v * v_multiplier,
+            sprite->top_right.u * u_multiplier,
+            sprite->top_right.v * v_multiplier,
+        };
+
+        // calculate the pixel size
+        // round to the nearest pixel as the uv coordinates may not be exactly representable
+        unsigned int width = atlas->width * (sprite->top_right.u - sprite->bottom_left.u) + 0.5f;
+        unsigned int height = atlas->height * (sprite->top_right.v - sprite->bottom_left.v) + 0.5f;
+
+        bin_writer_write_bytes(&tables_writer, sprite->id, AST_ID_MAX_SIZE);
+        bin_writer_write_u8(&tables_writer, sprite->atlas_index);
+        bin_writer_write_zeros(&tables_writer, 3);
+        bin_writer_write_f32s(&tables_writer, uvs, 4);
+        bin_writer_write_u16(&tables_writer, width);
+        bin_writer_write_u16(&tables_writer, height);
+    }
+
+    // build the sprite index
+    // sprites are inserted in order so that the first of any duplicate identifiers is found first when probing
+    // the slots are probed out of order, so the index is built separately and then written in order
+    struct ast_sprite_index_slot_t *sprite_index = malloc(num_sprite_index_slots * sizeof(struct ast_sprite_index_slot_t));
+    for (int i = 0; i < num_sprite_index_slots; i++)
+    {
+        sprite_index[i].id_hash = 0;
+        sprite_index[i].sprite_index = AST_SPRITE_INDEX_EMPTY;
+        sprite_index[i].padding = 0;
+    }
+
+    uint32_t mask = num_sprite_index_slots - 1;
+    for (int i = 0; i < num_sprites; i++)
+    {
+        uint64_t id_hash = hash_fnv1a64_string(sprites[i].id);
+        uint32_t slot_index = id_hash & mask;
+        while (sprite_index[slot_index].sprite_index != AST_SPRITE_INDEX_EMPTY)
+            slot_index = (slot_index + 1) & mask;
+
+        sprite_index[slot_index].id_hash = id_hash;
+        sprite_index[slot_index].sprite_index = i;
+    }
+
+    bin_writer_write_zeros(&tables_writer, sprite_index_pointer - (sprites_pointer + tables.size));
+    for (int i = 0; i < num_sprite_index_slots; i++)
+    {
+        bin_writer_write_u64(&tables_writer, sprite_index[i].id_hash);
+        bin_writer_write_u32(&tables_writer, sprite_index[i].sprite_index);
+        bin_writer_write_u32(&tables_writer, 0x0);
+    }
+
+    free(sprite_index);
+
+    // wait for the payloads to be encoded
+    jobs_deinit(&jobs);
+
+    // get the pointer of each payload now that their sizes are known
+    // payloads are joined in order, so each follows the one before it
+    uint32_t *payload_pointers = malloc(num_payloads * sizeof(uint32_t));
+    uint32_t payload_pointer = payloads_pointer;
+    for (int i = 0; i < num_payloads; i++)
+    {
+        payload_pointers[i] = payload_pointer;
+        payload_pointer += payloads[i].size;
+    }
+
+    // build the header, atlases, and mip levels
+    struct buffer_t buffer;
+    buffer_init(&buffer);
+    buffer_reserve(&buffer, sprites_pointer - header_pointer);
+
+    struct bin_writer_t writer;
+    bin_writer_init_buffer(&writer, &buffer);
+
+    // write the header
+    bin_writer_write_bytes(&writer, "AST", 3);
+    bin_writer_write_u8(&writer, AST_VERSION);
+    bin_writer_write_u16(&writer, atlas_width);
+    bin_writer_write_u16(&writer, atlas_height);
+    bin_writer_write_u8(&writer, atlas_scaling);
+    bin_writer_write_u8(&writer, flags);
+    bin_writer_write_zeros(&writer, 2);
+    bin_writer_write_u32(&writer, num_atlases);
+    bin_writer_write_u32(&writer, atlases_pointer);
+    bin_writer_write_u32(&writer, num_sprites);
+    bin_writer_write_u32(&writer, sprites_pointer);
+
+    // write the sprite index header
+    bin_writer_write_u32(&writer, num_sprite_index_slots);
+    bin_writer_write_u32(&writer, sprite_index_pointer);
+
+    // write the mipmaps header
+    if (flags & AST_FLAG_MIPMAPS)
+    {
+        bin_writer_write_u32(&writer, num_levels);
+        bin_writer_write_u32(&writer, mips_pointer);
+    }
+
+    // write the atlases
+    for (int i = 0; i < num_atlases; i++)
+    {
+        const struct png_t *atlas = &atlases[i];
+        bin_writer_write_u16(&writer, atlas->width);
+        bin_writer_write_u16(&writer, atlas->height);
+        bin_writer_write_u8(&writer, atlas_payload);
+        bin_writer_write_u8(&writer, ast_format_to_file((is_compact) ? atlas_format : ast_format_from_png(atlas->format)));
+        bin_writer_write_zeros(&writer, 2);
+        bin_writer_write_u32(&writer, payload_pointers[i * num_levels]);
+        bin_writer_write_u32(&writer, payloads[i * num_levels].size);
+    }
+
+    // write the mip levels
+    for (int i = 0; i < num_atlases; i++)
+    {
+        for (int level = 1; level < num_levels; level++)
+        {
+            bin_writer_write_u32(&writer, payload_pointers[i * num_levels + level]);
+            bin_writer_write_u32(&writer, payloads[i * num_levels + level].size);
+        }
+    }
+
+    // write everything sequentially, joining the payloads in order
+    buffer_write(&buffer, file);
+    buffer_write(&tables, file);
+    buffer_deinit(&buffer);
+    buffer_deinit(&tables);
+    for (int i = 0; i < num_payloads; i++)
+    {
+        buffer_write(&payloads[i], file);
+        buffer_deinit(&payloads[i]);
+    }
+
+    free(payload_pointers);
+    free(payloads);
 }
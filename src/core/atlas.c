@@ -0,0 +1,565 @@
+#include "atlas.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "gl_state.h"
+
+// MARK: - Data Structures
+
+/// An entry of a dynamic atlas which is being repacked while defragmenting.
+struct atlas_repack_t
+{
+    /// The index of the entry within the atlas' entries.
+    unsigned int entry;
+
+    /// The width of the entry's allocation, including padding, in pixels.
+    unsigned int width;
+
+    /// The height of the entry's allocation, including padding, in pixels.
+    unsigned int height;
+};
+
+// MARK: - Functions
+
+/// Initialize the given skyline as empty, spanning the given width.
+/// @param skyline The skyline to initialize.
+/// @param width The width of the packable area that the new skyline spans, in pixels.
+void atlas_skyline_init(struct atlas_skyline_t *skyline, unsigned int width)
+{
+    skyline->num_segments = 1;
+    // raising inserts a segment before trimming those it covers, so there can briefly be one more than the width
+    skyline->segments = malloc((width + 1) * sizeof(struct atlas_segment_t));
+    skyline->segments[0] = (struct atlas_segment_t)
+    {
+        .x = 0,
+        .y = 0,
+        .width = width,
+    };
+}
+
+/// Deinitialize the given skyline, releasing all of its allocated resources.
+/// @param skyline The skyline to deinitialize.
+void atlas_skyline_deinit(struct atlas_skyline_t *skyline)
+{
+    free(skyline->segments);
+}
+
+/// Insert a segment into the given skyline at the given index.
+/// @param skyline The skyline to insert the segment into.
+/// @param index The index to insert the segment at.
+/// @param segment The segment to insert.
+void atlas_skyline_insert_segment(struct atlas_skyline_t *skyline,
+                                  unsigned int index,
+                                  struct atlas_segment_t segment)
+{
+    memmove(&skyline->segments[index + 1],
+            &skyline->segments[index],
+            (skyline->num_segments - index) * sizeof(struct atlas_segment_t));
+
+    skyline->segments[index] = segment;
+    skyline->num_segments++;
+}
+
+/// Remove the segment at the given index from the given skyline.
+/// @param skyline The skyline to remove the segment from.
+/// @param index The index of the segment to remove.
+void atlas_skyline_remove_segment(struct atlas_skyline_t *skyline, unsigned int index)
+{
+    memmove(&skyline->segments[index],
+            &skyline->segments[index + 1],
+            (skyline->num_segments - (index + 1)) * sizeof(struct atlas_segment_t));
+
+    skyline->num_segments--;
+}
+
+/// Merge every pair of adjacent segments at the same height within the given skyline.
+/// @param skyline The skyline to merge the segments of.
+void atlas_skyline_merge(struct atlas_skyline_t *skyline)
+{
+    unsigned int i = 0;
+    while (i + 1 < skyline->num_segments)
+    {
+        struct atlas_segment_t *segment = &skyline->segments[i];
+        struct atlas_segment_t *next = &skyline->segments[i + 1];
+        if (segment->y == next->y)
+        {
+            segment->width += next->width;
+            atlas_skyline_remove_segment(skyline, i + 1);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+/// Ensure that a segment within the given skyline begins at the given horizontal position, splitting a segment if needed.
+/// @param skyline The skyline to split.
+/// @param x The horizontal position to split at, in pixels from the left of the packable area.
+/// @return The index of the segment beginning at the given position, or the total number of segments if it is at the right edge.
+unsigned int atlas_skyline_split(struct atlas_skyline_t *skyline, unsigned int x)
+{
+    for (unsigned int i = 0; i < skyline->num_segments; i++)
+    {
+        struct atlas_segment_t *segment = &skyline->segments[i];
+        if (segment->x == x)
+            return i;
+
+        if (segment->x + segment->width > x)
+        {
+            struct atlas_segment_t right =
+            {
+                .x = x,
+                .y = segment->y,
+                .width = segment->x + segment->width - x,
+            };
+
+            segment->width = x - segment->x;
+            atlas_skyline_insert_segment(skyline, i + 1, right);
+            return i + 1;
+        }
+    }
+
+    return skyline->num_segments;
+}
+
+/// Find the position within the given skyline where a rectangle of the given size would have the lowest top.
+///
+/// Ties are broken by the narrowest segment, which leaves wider segments for wider rectangles.
+/// @param skyline The skyline to find the position within.
+/// @param width The width of the packable area that the given skyline spans, in pixels.
+/// @param height The height of the packable area that the given skyline spans, in pixels.
+/// @param rect_width The width of the rectangle to place, in pixels.
+/// @param rect_height The height of the rectangle to place, in pixels.
+/// @param index The pointer to set the value of to the index of the segment which the rectangle's left edge is placed on.
+/// @param y The pointer to set the value of to the vertical position of the rectangle's bottom edge.
+/// @return Whether or not the rectangle fits anywhere within the given skyline.
+bool atlas_skyline_find(const struct atlas_skyline_t *skyline,
+                        unsigned int width,
+                        unsigned int height,
+                        unsigned int rect_width,
+                        unsigned int rect_height,
+                        unsigned int *index,
+                        unsigned int *y)
+{
+    unsigned int best_top = UINT_MAX;
+    unsigned int best_width = UINT_MAX;
+    for (unsigned int i = 0; i < skyline->num_segments; i++)
+    {
+        // segments are ordered left to right, so no later segment fits either
+        const struct atlas_segment_t *segment = &skyline->segments[i];
+        if (segment->x + rect_width > width)
+            break;
+
+        // the rectangle rests on the highest segment beneath it
+        unsigned int rect_y = 0;
+        unsigned int remaining_width = rect_width;
+        for (unsigned int j = i; remaining_width > 0; j++)
+        {
+            const struct atlas_segment_t *beneath = &skyline->segments[j];
+            if (beneath->y > rect_y)
+                rect_y = beneath->y;
+
+            remaining_width -= (beneath->width < remaining_width) ? beneath->width : remaining_width;
+        }
+
+        if (rect_y + rect_height > height)
+            continue;
+
+        unsigned int top = rect_y + rect_height;
+        if (top < best_top || (top == best_top && segment->width < best_width))
+        {
+            best_top = top;
+            best_width = segment->width;
+            *index = i;
+            *y = rect_y;
+        }
+    }
+
+    return best_top != UINT_MAX;
+}
+
+/// Raise the given skyline to cover a rectangle placed on the segment at the given index.
+/// @param skyline The skyline to raise.
+/// @param index The index of the segment which the rectangle's left edge is placed on.
+/// @param rect_width The width of the placed rectangle, in pixels.
+/// @param top The vertical position of the placed rectangle's top edge, in pixels.
+void atlas_skyline_raise(struct atlas_skyline_t *skyline,
+                         unsigned int index,
+                         unsigned int rect_width,
+                         unsigned int top)
+{
+    // insert the new segment, then trim or remove every segment which it now covers
+    unsigned int x = skyline->segments[index].x;
+    atlas_skyline_insert_segment(skyline, index, (struct atlas_segment_t){ .x = x, .y = top, .width = rect_width });
+    unsigned int right = x + rect_width;
+    while (index + 1 < skyline->num_segments)
+    {
+        struct atlas_segment_t *segment = &skyline->segments[index + 1];
+        if (segment->x >= right)
+            break;
+
+        unsigned int overlap = right - segment->x;
+        if (segment->width <= overlap)
+        {
+            atlas_skyline_remove_segment(skyline, index + 1);
+        }
+        else
+        {
+            segment->x += overlap;
+            segment->width -= overlap;
+            break;
+        }
+    }
+
+    atlas_skyline_merge(skyline);
+}
+
+/// Lower the given skyline back to the bottom of a removed rectangle, if nothing is placed above it.
+/// @param skyline The skyline to lower.
+/// @param x The horizontal position of the removed rectangle's left edge, in pixels.
+/// @param y The vertical position of the removed rectangle's bottom edge, in pixels.
+/// @param rect_width The width of the removed rectangle, in pixels.
+/// @param rect_height The height of the removed rectangle, in pixels.
+void atlas_skyline_lower(struct atlas_skyline_t *skyline,
+                         unsigned int x,
+                         unsigned int y,
+                         unsigned int rect_width,
+                         unsigned int rect_height)
+{
+    // ensure that the skyline is exactly at the top of the rectangle along its entire width
+    unsigned int right = x + rect_width;
+    for (unsigned int i = 0; i < skyline->num_segments; i++)
+    {
+        const struct atlas_segment_t *segment = &skyline->segments[i];
+        if (segment->x + segment->width <= x || segment->x >= right)
+            continue;
+
+        if (segment->y != y + rect_height)
+            return;
+    }
+
+    // lower the segments along the rectangle
+    unsigned int first = atlas_skyline_split(skyline, x);
+    unsigned int last = atlas_skyline_split(skyline, right);
+    for (unsigned int i = first; i < last; i++)
+        skyline->segments[i].y = y;
+
+    atlas_skyline_merge(skyline);
+}
+
+/// Clear every layer of the given atlas array texture to transparent.
+///
+/// Array textures are created with undefined contents, which would otherwise show through the padding around entries.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param texture The array texture to clear.
+/// @param num_layers The total number of layers within the given array texture.
+void atlas_clear_layers(struct texture_t *texture, unsigned int num_layers)
+{
+    for (unsigned int i = 0; i < num_layers; i++)
+        texture_clear_array_region(texture, i, 0, 0, 0, texture->width, texture->height);
+}
+
+/// Clear the padding surrounding the given entry within the given atlas to transparent.
+///
+/// The padding may still hold the pixels of a removed entry which was previously placed there,
+/// which linear scaling would otherwise blend into the edges of the given entry.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param atlas The atlas containing the given entry.
+/// @param entry The entry to clear the padding surrounding.
+void atlas_clear_padding(struct atlas_t *atlas, const struct atlas_entry_t *entry)
+{
+    // the padding of every entry is within the layer, as the packable area is inset by the padding
+    unsigned int padding = atlas->padding;
+    unsigned int left = entry->x - padding;
+    unsigned int bottom = entry->y - padding;
+    unsigned int padded_width = entry->width + (padding * 2);
+    texture_clear_array_region(&atlas->texture, entry->layer, 0, left, bottom, padded_width, padding);
+    texture_clear_array_region(&atlas->texture, entry->layer, 0, left, entry->y + entry->height, padded_width, padding);
+    texture_clear_array_region(&atlas->texture, entry->layer, 0, left, entry->y, padding, entry->height);
+    texture_clear_array_region(&atlas->texture, entry->layer, 0, entry->x + entry->width, entry->y, padding, entry->height);
+}
+
+void atlas_init(struct atlas_t *atlas,
+                unsigned int width,
+                unsigned int height,
+                unsigned int num_layers,
+                unsigned int padding,
+                enum texture_scaling_t scaling)
+{
+    // ensure the padding leaves space to pack into
+    assert(padding < width && padding < height);
+
+    // create the array texture and a skyline for each of its layers
+    // the packable area of each layer is inset by the padding along its bottom and left edges,
+    // and each allocation includes padding along its top and right edges
+    texture_init_empty_array(&atlas->texture, width, height, num_layers, 1, TEXTURE_MIPMAPS_NONE, scaling, TEXTURE_RGBAU8);
+    atlas_clear_layers(&atlas->texture, num_layers);
+    atlas->skylines = malloc(num_layers * sizeof(struct atlas_skyline_t));
+    for (unsigned int i = 0; i < num_layers; i++)
+        atlas_skyline_init(&atlas->skylines[i], width - padding);
+
+    // initialize the given atlas
+    atlas->num_layers = num_layers;
+    atlas->padding = padding;
+    atlas->num_entries = 0;
+    atlas->entries = NULL;
+    atlas->used_area = 0;
+    atlas->generation = 0;
+}
+
+void atlas_deinit(struct atlas_t *atlas)
+{
+    for (unsigned int i = 0; i < atlas->num_layers; i++)
+        atlas_skyline_deinit(&atlas->skylines[i]);
+
+    free(atlas->skylines);
+    free(atlas->entries);
+    texture_deinit(&atlas->texture);
+}
+
+bool atlas_add_png(struct atlas_t *atlas,
+                   struct texture_upload_ring_t *ring,
+                   const struct png_t *png,
+                   unsigned int *entry)
+{
+    // find the first layer that the png fits within
+    unsigned int allocation_width = png->width + atlas->padding;
+    unsigned int allocation_height = png->height + atlas->padding;
+    unsigned int bin_width = atlas->texture.width - atlas->padding;
+    unsigned int bin_height = atlas->texture.height - atlas->padding;
+    unsigned int layer, index, y;
+    for (layer = 0; layer < atlas->num_layers; layer++)
+    {
+        if (atlas_skyline_find(&atlas->skylines[layer],
+                               bin_width,
+                               bin_height,
+                               allocation_width,
+                               allocation_height,
+                               &index,
+                               &y))
+        {
+            break;
+        }
+    }
+
+    if (layer >= atlas->num_layers)
+        return false;
+
+    // place the png within the layer
+    struct atlas_skyline_t *skyline = &atlas->skylines[layer];
+    unsigned int x = skyline->segments[index].x;
+    atlas_skyline_raise(skyline, index, allocation_width, y + allocation_height);
+
+    // reuse the first entry which is not in use, or append a new one
+    unsigned int entry_index;
+    for (entry_index = 0; entry_index < atlas->num_entries; entry_index++)
+        if (!atlas->entries[entry_index].is_used)
+            break;
+
+    if (entry_index >= atlas->num_entries)
+    {
+        atlas->num_entries++;
+        atlas->entries = realloc(atlas->entries, atlas->num_entries * sizeof(struct atlas_entry_t));
+    }
+
+    atlas->entries[entry_index] = (struct atlas_entry_t)
+    {
+        .is_used = true,
+        .layer = layer,
+        .x = x + atlas->padding,
+        .y = y + atlas->padding,
+        .width = png->width,
+        .height = png->height,
+    };
+
+    atlas->used_area += (uint64_t)png->width * png->height;
+
+    // upload the png into its placement, clearing the padding around it first
+    struct atlas_entry_t *placed = &atlas->entries[entry_index];
+    atlas_clear_padding(atlas, placed);
+    texture_upload_ring_png(ring, &atlas->texture, placed->layer, 0, placed->x, placed->y, png);
+    *entry = entry_index;
+    return true;
+}
+
+void atlas_remove(struct atlas_t *atlas, unsigned int entry)
+{
+    // ensure the given entry is valid
+    assert(entry < atlas->num_entries);
+    assert(atlas->entries[entry].is_used);
+
+    // return the entries allocation to its layers skyline, if possible
+    struct atlas_entry_t *removed = &atlas->entries[entry];
+    atlas_skyline_lower(&atlas->skylines[removed->layer],
+                        removed->x - atlas->padding,
+                        removed->y - atlas->padding,
+                        removed->width + atlas->padding,
+                        removed->height + atlas->padding);
+
+    atlas->used_area -= (uint64_t)removed->width * removed->height;
+    removed->is_used = false;
+}
+
+/// Compare the given entries being repacked, ordering them tallest and then widest first.
+/// @param a The first entry to compare.
+/// @param b The second entry to compare.
+/// @return The comparison of the given entries, for `qsort`.
+int atlas_repack_compare(const void *a, const void *b)
+{
+    const struct atlas_repack_t *repack_a = a;
+    const struct atlas_repack_t *repack_b = b;
+    if (repack_a->height != repack_b->height)
+        return (repack_a->height > repack_b->height) ? -1 : 1;
+    if (repack_a->width != repack_b->width)
+        return (repack_a->width > repack_b->width) ? -1 : 1;
+
+    // fall back to the entry index so that the order is stable
+    return (repack_a->entry < repack_b->entry) ? -1 : 1;
+}
+
+bool atlas_defragment(struct atlas_t *atlas)
+{
+    // gather every entry in use, tallest first, as skylines pack best when heights decrease
+    unsigned int num_repacks = 0;
+    struct atlas_repack_t *repacks = malloc(atlas->num_entries * sizeof(struct atlas_repack_t));
+    for (unsigned int i = 0; i < atlas->num_entries; i++)
+    {
+        struct atlas_entry_t *entry = &atlas->entries[i];
+        if (!entry->is_used)
+            continue;
+
+        repacks[num_repacks++] = (struct atlas_repack_t)
+        {
+            .entry = i,
+            .width = entry->width + atlas->padding,
+            .height = entry->height + atlas->padding,
+        };
+    }
+
+    qsort(repacks, num_repacks, sizeof(struct atlas_repack_t), atlas_repack_compare);
+
+    // repack every entry into fresh skylines, leaving the atlas untouched until every entry has been placed
+    unsigned int bin_width = atlas->texture.width - atlas->padding;
+    unsigned int bin_height = atlas->texture.height - atlas->padding;
+    struct atlas_skyline_t *skylines = malloc(atlas->num_layers * sizeof(struct atlas_skyline_t));
+    struct atlas_entry_t *entries = malloc(atlas->num_entries * sizeof(struct atlas_entry_t));
+    memcpy(entries, atlas->entries, atlas->num_entries * sizeof(struct atlas_entry_t));
+    for (unsigned int i = 0; i < atlas->num_layers; i++)
+        atlas_skyline_init(&skylines[i], bin_width);
+
+    bool is_repacked = true;
+    for (unsigned int i = 0; i < num_repacks && is_repacked; i++)
+    {
+        struct atlas_repack_t *repack = &repacks[i];
+        unsigned int layer, index, y;
+        for (layer = 0; layer < atlas->num_layers; layer++)
+            if (atlas_skyline_find(&skylines[layer], bin_width, bin_height, repack->width, repack->height, &index, &y))
+                break;
+
+        if (layer >= atlas->num_layers)
+        {
+            is_repacked = false;
+            break;
+        }
+
+        struct atlas_entry_t *entry = &entries[repack->entry];
+        entry->layer = layer;
+        entry->x = skylines[layer].segments[index].x + atlas->padding;
+        entry->y = y + atlas->padding;
+        atlas_skyline_raise(&skylines[layer], index, repack->width, y + repack->height);
+    }
+
+    if (!is_repacked)
+    {
+        for (unsigned int i = 0; i < atlas->num_layers; i++)
+            atlas_skyline_deinit(&skylines[i]);
+
+        free(skylines);
+        free(entries);
+        free(repacks);
+        return false;
+    }
+
+    // copy every entry from the current array texture into a new, cleared, one
+    // each layer of the current texture is read through a framebuffer, so the pixels never leave the graphics context
+    struct texture_t texture;
+    texture_init_empty_array(&texture,
+                             atlas->texture.width,
+                             atlas->texture.height,
+                             atlas->num_layers,
+                             1,
+                             TEXTURE_MIPMAPS_NONE,
+                             atlas->texture.scaling,
+                             TEXTURE_RGBAU8);
+
+    texture_set_wrap(&texture, atlas->texture.wrap);
+    atlas_clear_layers(&texture, atlas->num_layers);
+
+    // the destination texture is bound explicitly, as glCopyTexSubImage3D copies into whichever texture is bound
+    texture_bind(&texture, TEXTURE_INIT_UNIT);
+
+    GLuint previous_framebuffer_id = gl_state_get_framebuffer();
+    GLuint framebuffer_id;
+    glGenFramebuffers(1, &framebuffer_id);
+    gl_state_bind_framebuffer(framebuffer_id);
+    for (unsigned int layer = 0; layer < atlas->num_layers; layer++)
+    {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, atlas->texture.id, 0, layer);
+        for (unsigned int i = 0; i < num_repacks; i++)
+        {
+            const struct atlas_entry_t *source = &atlas->entries[repacks[i].entry];
+            const struct atlas_entry_t *destination = &entries[repacks[i].entry];
+            if (source->layer != layer)
+                continue;
+
+            glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+                                0,
+                                destination->x,
+                                destination->y,
+                                destination->layer,
+                                source->x,
+                                source->y,
+                                source->width,
+                                source->height);
+        }
+    }
+
+    gl_state_bind_framebuffer(previous_framebuffer_id);
+    gl_state_forget_framebuffer(framebuffer_id);
+    glDeleteFramebuffers(1, &framebuffer_id);
+
+    // replace the atlas' texture, skylines, and entries with the repacked ones
+    texture_deinit(&atlas->texture);
+    atlas->texture = texture;
+    for (unsigned int i = 0; i < atlas->num_layers; i++)
+        atlas_skyline_deinit(&atlas->skylines[i]);
+
+    free(atlas->skylines);
+    free(atlas->entries);
+    free(repacks);
+    atlas->skylines = skylines;
+    atlas->entries = entries;
+    atlas->generation++;
+    return true;
+}
+
+void atlas_get_placement(struct atlas_t *atlas,
+                         unsigned int entry,
+                         struct atlas_placement_t *placement)
+{
+    // ensure the given entry is valid
+    assert(entry < atlas->num_entries);
+    assert(atlas->entries[entry].is_used);
+
+    const struct atlas_entry_t *placed = &atlas->entries[entry];
+    float width = atlas->texture.width;
+    float height = atlas->texture.height;
+    placement->texture = &atlas->texture;
+    placement->layer = placed->layer;
+    placement->bottom_left = uv(placed->x / width, placed->y / height);
+    placement->top_right = uv((placed->x + placed->width) / width, (placed->y + placed->height) / height);
+}
@@ -0,0 +1,703 @@
+#include "bc.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <math.h>
+#include <assert.h>
+
+// MARK: - Macros
+
+/// The total number of pixels within a single block.
+#define BC_NUM_PIXELS (16)
+
+/// The number of power iterations used to find the principal axis of the pixels within a block.
+#define BC_NUM_AXIS_ITERATIONS (8)
+
+/// The number of times that the endpoints of a block are fitted, including the initial fit along the principal axis.
+///
+/// Each fit after the first refines the endpoints by least squares from the indices chosen for the previous fit.
+#define BC_NUM_FITS (3)
+
+// MARK: - Data Structures
+
+/// The bits of a BC7 block being written, least significant bit first.
+struct bc_bits_t
+{
+    /// The low and high 64 bits of the block.
+    uint64_t words[2];
+
+    /// The total number of bits which have been written.
+    unsigned int position;
+};
+
+// MARK: - Variables
+
+/// The position of each BC1 colour index between the first and second endpoints, from `0` to `1`.
+static const float bc_colour_weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+/// The weight of the second endpoint for each 4-bit BC7 index, out of 64.
+static const unsigned int bc_bc7_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// MARK: - Functions
+
+/// Read the pixels of the block at the given position within the given PNG.
+///
+/// Pixels beyond the edges of the given PNG repeat the nearest edge pixel, and RGB pixels are given opaque alpha.
+/// @param png The PNG to read the block from.
+/// @param block_x The horizontal index of the block to read.
+/// @param block_y The vertical index of the block to read, ordered bottom-to-top as with the PNG's rows.
+/// @param pixels The array to write the RGBA pixels of the block to, ordered by row and then column.
+void bc_read_block(const struct png_t *png,
+                   unsigned int block_x,
+                   unsigned int block_y,
+                   uint8_t pixels[BC_NUM_PIXELS][4])
+{
+    size_t pixel_size = png_get_pixel_size(png->format);
+    const uint8_t *data = png->data;
+    for (unsigned int y = 0; y < 4; y++)
+    {
+        unsigned int png_y = block_y * 4 + y;
+        if (png_y >= png->height)
+            png_y = png->height - 1;
+
+        for (unsigned int x = 0; x < 4; x++)
+        {
+            unsigned int png_x = block_x * 4 + x;
+            if (png_x >= png->width)
+                png_x = png->width - 1;
+
+            const uint8_t *pixel = data + ((size_t)png_y * png->width + png_x) * pixel_size;
+            uint8_t *block_pixel = pixels[y * 4 + x];
+            block_pixel[0] = pixel[0];
+            block_pixel[1] = pixel[1];
+            block_pixel[2] = pixel[2];
+            block_pixel[3] = (pixel_size == 4) ? pixel[3] : 255;
+        }
+    }
+}
+
+/// Clamp the given channel value to the range of an 8-bit channel.
+/// @param value The channel value to clamp.
+/// @return The given value clamped to between `0` and `255`.
+float bc_clamp_channel(float value)
+{
+    if (value < 0)
+        return 0;
+    if (value > 255)
+        return 255;
+
+    return value;
+}
+
+/// Fit a line through the given pixels along their principal axis, spanning the extent of the pixels along it.
+///
+/// The principal axis is found by power iteration on the covariance of the pixels,
+/// and the endpoints are the projections of the outermost pixels onto it.
+/// @param pixels The pixels of the block to fit the line through.
+/// @param included Whether or not each of the given pixels is used to fit the line, at least one of which must be.
+/// @param num_channels The total number of channels of each pixel to fit the line in, either `3` or `4`.
+/// @param start The array to write the first endpoint of the line to.
+/// @param end The array to write the second endpoint of the line to.
+void bc_fit_line(const uint8_t pixels[BC_NUM_PIXELS][4],
+                 const bool included[BC_NUM_PIXELS],
+                 unsigned int num_channels,
+                 float start[4],
+                 float end[4])
+{
+    // get the mean of the included pixels
+    float mean[4] = { 0, 0, 0, 0 };
+    unsigned int num_included = 0;
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+    {
+        if (!included[i])
+            continue;
+
+        for (unsigned int c = 0; c < num_channels; c++)
+            mean[c] += pixels[i][c];
+
+        num_included++;
+    }
+
+    for (unsigned int c = 0; c < num_channels; c++)
+        mean[c] /= num_included;
+
+    // get the covariance of the included pixels
+    float covariance[4][4] = { { 0 } };
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+    {
+        if (!included[i])
+            continue;
+
+        float difference[4];
+        for (unsigned int c = 0; c < num_channels; c++)
+            difference[c] = pixels[i][c] - mean[c];
+
+        for (unsigned int a = 0; a < num_channels; a++)
+            for (unsigned int b = 0; b < num_channels; b++)
+                covariance[a][b] += difference[a] * difference[b];
+    }
+
+    // find the principal axis
+    // starting from the row of the channel with the greatest variance avoids starting orthogonal to the axis
+    unsigned int widest_channel = 0;
+    for (unsigned int c = 1; c < num_channels; c++)
+        if (covariance[c][c] > covariance[widest_channel][widest_channel])
+            widest_channel = c;
+
+    float axis[4];
+    for (unsigned int c = 0; c < num_channels; c++)
+        axis[c] = covariance[widest_channel][c];
+
+    for (unsigned int iteration = 0; iteration < BC_NUM_AXIS_ITERATIONS; iteration++)
+    {
+        float next[4] = { 0, 0, 0, 0 };
+        float largest = 0;
+        for (unsigned int a = 0; a < num_channels; a++)
+        {
+            for (unsigned int b = 0; b < num_channels; b++)
+                next[a] += covariance[a][b] * axis[b];
+
+            if (fabsf(next[a]) > largest)
+                largest = fabsf(next[a]);
+        }
+
+        if (largest == 0)
+            break;
+
+        for (unsigned int c = 0; c < num_channels; c++)
+            axis[c] = next[c] / largest;
+    }
+
+    float length = 0;
+    for (unsigned int c = 0; c < num_channels; c++)
+        length += axis[c] * axis[c];
+
+    length = sqrtf(length);
+    for (unsigned int c = 0; c < num_channels; c++)
+        axis[c] = (length > 0) ? axis[c] / length : 0;
+
+    // span the included pixels along the principal axis
+    float minimum = 0, maximum = 0;
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+    {
+        if (!included[i])
+            continue;
+
+        float projection = 0;
+        for (unsigned int c = 0; c < num_channels; c++)
+            projection += (pixels[i][c] - mean[c]) * axis[c];
+
+        if (projection < minimum)
+            minimum = projection;
+        if (projection > maximum)
+            maximum = projection;
+    }
+
+    for (unsigned int c = 0; c < num_channels; c++)
+    {
+        start[c] = bc_clamp_channel(mean[c] + axis[c] * minimum);
+        end[c] = bc_clamp_channel(mean[c] + axis[c] * maximum);
+    }
+}
+
+/// Refine the endpoints of a line through the given pixels by least squares, given the index chosen for each pixel.
+/// @param pixels The pixels of the block to refine the line through.
+/// @param included Whether or not each of the given pixels is used to refine the line.
+/// @param num_channels The total number of channels of each pixel to refine the line in, either `3` or `4`.
+/// @param indices The index chosen for each of the given pixels.
+/// @param weights The position of each index between the first and second endpoints, from `0` to `1`.
+/// @param start The first endpoint of the line to refine.
+/// @param end The second endpoint of the line to refine.
+/// @return Whether or not the endpoints could be refined, which they cannot when every pixel has the same index.
+bool bc_refine_line(const uint8_t pixels[BC_NUM_PIXELS][4],
+                    const bool included[BC_NUM_PIXELS],
+                    unsigned int num_channels,
+                    const uint8_t indices[BC_NUM_PIXELS],
+                    const float *weights,
+                    float start[4],
+                    float end[4])
+{
+    // solve the normal equations for both endpoints of each channel at once
+    // they share the same matrix, as every channel of a pixel has the same weight
+    float start_start = 0, start_end = 0, end_end = 0;
+    float start_pixel[4] = { 0, 0, 0, 0 }, end_pixel[4] = { 0, 0, 0, 0 };
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+    {
+        if (!included[i])
+            continue;
+
+        float end_weight = weights[indices[i]];
+        float start_weight = 1.0f - end_weight;
+        start_start += start_weight * start_weight;
+        start_end += start_weight * end_weight;
+        end_end += end_weight * end_weight;
+        for (unsigned int c = 0; c < num_channels; c++)
+        {
+            start_pixel[c] += start_weight * pixels[i][c];
+            end_pixel[c] += end_weight * pixels[i][c];
+        }
+    }
+
+    float determinant = start_start * end_end - start_end * start_end;
+    if (fabsf(determinant) < 1e-6f)
+        return false;
+
+    for (unsigned int c = 0; c < num_channels; c++)
+    {
+        start[c] = bc_clamp_channel((start_pixel[c] * end_end - end_pixel[c] * start_end) / determinant);
+        end[c] = bc_clamp_channel((end_pixel[c] * start_start - start_pixel[c] * start_end) / determinant);
+    }
+
+    return true;
+}
+
+/// Get the squared distance between the given pixel and colour, across the given number of channels.
+/// @param pixel The pixel to get the distance from.
+/// @param colour The colour to get the distance to.
+/// @param num_channels The total number of channels to measure the distance across.
+/// @return The squared distance between the given pixel and colour.
+unsigned int bc_get_distance(const uint8_t pixel[4], const int colour[4], unsigned int num_channels)
+{
+    unsigned int distance = 0;
+    for (unsigned int c = 0; c < num_channels; c++)
+    {
+        int difference = (int)pixel[c] - colour[c];
+        distance += difference * difference;
+    }
+
+    return distance;
+}
+
+/// Choose the closest colour within the given palette for each of the given pixels.
+/// @param pixels The pixels to choose the colours of.
+/// @param included Whether or not the error of each of the given pixels is counted.
+/// @param num_channels The total number of channels of each pixel to compare.
+/// @param palette The colours to choose from.
+/// @param palette_size The total number of colours within the given palette.
+/// @param indices The array to write the index of the chosen colour of each pixel to.
+/// @return The total squared error of the included pixels.
+unsigned int bc_choose_indices(const uint8_t pixels[BC_NUM_PIXELS][4],
+                               const bool included[BC_NUM_PIXELS],
+                               unsigned int num_channels,
+                               const int palette[][4],
+                               unsigned int palette_size,
+                               uint8_t indices[BC_NUM_PIXELS])
+{
+    unsigned int error = 0;
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+    {
+        unsigned int best_index = 0;
+        unsigned int best_distance = UINT_MAX;
+        for (unsigned int index = 0; index < palette_size; index++)
+        {
+            unsigned int distance = bc_get_distance(pixels[i], palette[index], num_channels);
+            if (distance < best_distance)
+            {
+                best_index = index;
+                best_distance = distance;
+            }
+        }
+
+        indices[i] = best_index;
+        if (included[i])
+            error += best_distance;
+    }
+
+    return error;
+}
+
+/// Quantize the given colour to RGB565.
+/// @param colour The RGB colour to quantize.
+/// @return The given colour as RGB565.
+uint16_t bc_pack_565(const float colour[3])
+{
+    unsigned int r = (unsigned int)(colour[0] * 31.0f / 255.0f + 0.5f);
+    unsigned int g = (unsigned int)(colour[1] * 63.0f / 255.0f + 0.5f);
+    unsigned int b = (unsigned int)(colour[2] * 31.0f / 255.0f + 0.5f);
+    return (r << 11) | (g << 5) | b;
+}
+
+/// Expand the given RGB565 colour to 8-bit channels, as it is when decoded.
+/// @param value The RGB565 colour to expand.
+/// @param colour The array to write the expanded RGB colour to.
+void bc_unpack_565(uint16_t value, int colour[4])
+{
+    unsigned int r = (value >> 11) & 0x1f;
+    unsigned int g = (value >> 5) & 0x3f;
+    unsigned int b = value & 0x1f;
+    colour[0] = (r << 3) | (r >> 2);
+    colour[1] = (g << 2) | (g >> 4);
+    colour[2] = (b << 3) | (b >> 2);
+    colour[3] = 255;
+}
+
+/// Encode the colour of the given pixels as a four colour BC1 block.
+///
+/// The first endpoint is always greater than the second, which selects four colours rather than three and transparent black.
+/// @param pixels The pixels of the block to encode.
+/// @param included Whether or not the colour of each of the given pixels is visible, at least one of which must be.
+/// @param block The first byte of the 8-byte block to write.
+void bc_encode_colour_block(const uint8_t pixels[BC_NUM_PIXELS][4],
+                            const bool included[BC_NUM_PIXELS],
+                            uint8_t *block)
+{
+    float start[4], end[4];
+    bc_fit_line(pixels, included, 3, start, end);
+
+    uint16_t best_colours[2] = { 0, 0 };
+    uint8_t best_indices[BC_NUM_PIXELS] = { 0 };
+    unsigned int best_error = UINT_MAX;
+    for (unsigned int fit = 0; fit < BC_NUM_FITS; fit++)
+    {
+        // order the endpoints so that the block has four colours
+        uint16_t colours[2] = { bc_pack_565(start), bc_pack_565(end) };
+        if (colours[0] < colours[1])
+        {
+            uint16_t colour = colours[0];
+            colours[0] = colours[1];
+            colours[1] = colour;
+            for (unsigned int c = 0; c < 3; c++)
+            {
+                float value = start[c];
+                start[c] = end[c];
+                end[c] = value;
+            }
+        }
+
+        // equal endpoints select three colours, so only the first endpoint can be used
+        int palette[4][4];
+        bc_unpack_565(colours[0], palette[0]);
+        bc_unpack_565(colours[1], palette[1]);
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+
+        uint8_t indices[BC_NUM_PIXELS];
+        unsigned int error = bc_choose_indices(pixels, included, 3, palette, (colours[0] == colours[1]) ? 1 : 4, indices);
+        if (error < best_error)
+        {
+            best_colours[0] = colours[0];
+            best_colours[1] = colours[1];
+            best_error = error;
+            for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+                best_indices[i] = indices[i];
+        }
+
+        if (best_error == 0 || !bc_refine_line(pixels, included, 3, indices, bc_colour_weights, start, end))
+            break;
+    }
+
+    // write the block
+    //  - U16 first endpoint colour.
+    //  - U16 second endpoint colour.
+    //  - U32 2-bit indices, the first pixel in the lowest bits.
+    uint32_t indices = 0;
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+        indices |= (uint32_t)best_indices[i] << (i * 2);
+
+    block[0] = best_colours[0] & 0xff;
+    block[1] = best_colours[0] >> 8;
+    block[2] = best_colours[1] & 0xff;
+    block[3] = best_colours[1] >> 8;
+    for (unsigned int i = 0; i < 4; i++)
+        block[4 + i] = (indices >> (i * 8)) & 0xff;
+}
+
+/// Choose the closest alpha within the palette of the given BC3 alpha endpoints for each of the given pixels.
+///
+/// When the first endpoint is greater than the second there are eight alphas interpolated between them,
+/// otherwise there are six interpolated alphas followed by fully transparent and fully opaque.
+/// @param pixels The pixels to choose the alphas of.
+/// @param alpha0 The first endpoint alpha.
+/// @param alpha1 The second endpoint alpha.
+/// @param indices The array to write the index of the chosen alpha of each pixel to.
+/// @return The total squared error of the given pixels.
+unsigned int bc_choose_alpha_indices(const uint8_t pixels[BC_NUM_PIXELS][4],
+                                     unsigned int alpha0,
+                                     unsigned int alpha1,
+                                     uint8_t indices[BC_NUM_PIXELS])
+{
+    int palette[8][4] = { { 0 } };
+    palette[0][0] = alpha0;
+    palette[1][0] = alpha1;
+    if (alpha0 > alpha1)
+    {
+        for (unsigned int i = 2; i < 8; i++)
+            palette[i][0] = ((8 - i) * alpha0 + (i - 1) * alpha1 + 3) / 7;
+    }
+    else
+    {
+        for (unsigned int i = 2; i < 6; i++)
+            palette[i][0] = ((6 - i) * alpha0 + (i - 1) * alpha1 + 2) / 5;
+
+        palette[6][0] = 0;
+        palette[7][0] = 255;
+    }
+
+    // compare only the alpha of each pixel, by moving it into the first channel
+    uint8_t alphas[BC_NUM_PIXELS][4];
+    bool included[BC_NUM_PIXELS];
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+    {
+        alphas[i][0] = pixels[i][3];
+        included[i] = true;
+    }
+
+    return bc_choose_indices(alphas, included, 1, palette, 8, indices);
+}
+
+/// Encode the alpha of the given pixels as a BC3 alpha block.
+///
+/// Both palettes are tried; one spanning every alpha, and one spanning only the partially transparent alphas with exact
+/// fully transparent and fully opaque alphas, which suits the hard edges of sprites.
+/// @param pixels The pixels of the block to encode.
+/// @param block The first byte of the 8-byte block to write.
+void bc_encode_alpha_block(const uint8_t pixels[BC_NUM_PIXELS][4],
+                           uint8_t *block)
+{
+    unsigned int minimum = 255, maximum = 0;
+    unsigned int inner_minimum = 255, inner_maximum = 0;
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+    {
+        unsigned int alpha = pixels[i][3];
+        if (alpha < minimum)
+            minimum = alpha;
+        if (alpha > maximum)
+            maximum = alpha;
+
+        if (alpha == 0 || alpha == 255)
+            continue;
+
+        if (alpha < inner_minimum)
+            inner_minimum = alpha;
+        if (alpha > inner_maximum)
+            inner_maximum = alpha;
+    }
+
+    if (inner_minimum > inner_maximum)
+        inner_minimum = inner_maximum = 0;
+
+    uint8_t indices[BC_NUM_PIXELS], inner_indices[BC_NUM_PIXELS];
+    unsigned int alpha0 = maximum, alpha1 = minimum;
+    unsigned int error = bc_choose_alpha_indices(pixels, alpha0, alpha1, indices);
+    unsigned int inner_error = bc_choose_alpha_indices(pixels, inner_minimum, inner_maximum, inner_indices);
+    if (inner_error < error)
+    {
+        alpha0 = inner_minimum;
+        alpha1 = inner_maximum;
+        for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+            indices[i] = inner_indices[i];
+    }
+
+    // write the block
+    //  - U8 first endpoint alpha.
+    //  - U8 second endpoint alpha.
+    //  - U48 3-bit indices, the first pixel in the lowest bits.
+    uint64_t packed_indices = 0;
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+        packed_indices |= (uint64_t)indices[i] << (i * 3);
+
+    block[0] = alpha0;
+    block[1] = alpha1;
+    for (unsigned int i = 0; i < 6; i++)
+        block[2 + i] = (packed_indices >> (i * 8)) & 0xff;
+}
+
+/// Quantize the given endpoint of a BC7 mode 6 block to 7-bit channels and a shared low bit.
+///
+/// Both low bits are tried, keeping whichever is closer to the given endpoint.
+/// @param endpoint The RGBA endpoint to quantize.
+/// @param channels The array to write the 7-bit channels of the quantized endpoint to.
+/// @param low_bit The pointer to set the value of to the shared low bit of the quantized endpoint.
+void bc_quantize_bc7_endpoint(const float endpoint[4], unsigned int channels[4], unsigned int *low_bit)
+{
+    float best_error = INFINITY;
+    for (unsigned int bit = 0; bit < 2; bit++)
+    {
+        unsigned int quantized[4];
+        float error = 0;
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            float value = (endpoint[c] - bit) / 2.0f + 0.5f;
+            quantized[c] = (value < 0) ? 0 : (value > 127) ? 127 : (unsigned int)value;
+
+            float difference = (float)((quantized[c] << 1) | bit) - endpoint[c];
+            error += difference * difference;
+        }
+
+        if (error < best_error)
+        {
+            best_error = error;
+            *low_bit = bit;
+            for (unsigned int c = 0; c < 4; c++)
+                channels[c] = quantized[c];
+        }
+    }
+}
+
+/// Write the given number of low bits of the given value to the given BC7 block bits.
+/// @param bits The block bits to write to.
+/// @param value The value to write the low bits of.
+/// @param num_bits The total number of bits to write.
+void bc_write_bits(struct bc_bits_t *bits, uint64_t value, unsigned int num_bits)
+{
+    for (unsigned int i = 0; i < num_bits; i++, bits->position++)
+        if ((value >> i) & 1)
+            bits->words[bits->position / 64] |= (uint64_t)1 << (bits->position % 64);
+}
+
+/// Encode the given pixels as a BC7 mode 6 block.
+/// @param pixels The pixels of the block to encode.
+/// @param block The first byte of the 16-byte block to write.
+void bc_encode_bc7_block(const uint8_t pixels[BC_NUM_PIXELS][4],
+                         uint8_t *block)
+{
+    bool included[BC_NUM_PIXELS];
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+        included[i] = true;
+
+    float start[4], end[4];
+    bc_fit_line(pixels, included, 4, start, end);
+
+    float weights[16];
+    for (unsigned int i = 0; i < 16; i++)
+        weights[i] = bc_bc7_weights[i] / 64.0f;
+
+    unsigned int best_channels[2][4] = { { 0 } };
+    unsigned int best_low_bits[2] = { 0, 0 };
+    uint8_t best_indices[BC_NUM_PIXELS] = { 0 };
+    unsigned int best_error = UINT_MAX;
+    for (unsigned int fit = 0; fit < BC_NUM_FITS; fit++)
+    {
+        unsigned int channels[2][4], low_bits[2];
+        bc_quantize_bc7_endpoint(start, channels[0], &low_bits[0]);
+        bc_quantize_bc7_endpoint(end, channels[1], &low_bits[1]);
+
+        int palette[16][4];
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            int start_value = (channels[0][c] << 1) | low_bits[0];
+            int end_value = (channels[1][c] << 1) | low_bits[1];
+            for (unsigned int i = 0; i < 16; i++)
+                palette[i][c] = ((64 - bc_bc7_weights[i]) * start_value + bc_bc7_weights[i] * end_value + 32) >> 6;
+        }
+
+        uint8_t indices[BC_NUM_PIXELS];
+        unsigned int error = bc_choose_indices(pixels, included, 4, palette, 16, indices);
+        if (error < best_error)
+        {
+            best_error = error;
+            for (unsigned int e = 0; e < 2; e++)
+            {
+                best_low_bits[e] = low_bits[e];
+                for (unsigned int c = 0; c < 4; c++)
+                    best_channels[e][c] = channels[e][c];
+            }
+
+            for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+                best_indices[i] = indices[i];
+        }
+
+        if (best_error == 0 || !bc_refine_line(pixels, included, 4, indices, weights, start, end))
+            break;
+    }
+
+    // the most significant bit of the first pixel's index is implied to be zero,
+    // so swap the endpoints and invert the indices if it is set
+    if (best_indices[0] & 0x8)
+    {
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            unsigned int channel = best_channels[0][c];
+            best_channels[0][c] = best_channels[1][c];
+            best_channels[1][c] = channel;
+        }
+
+        unsigned int low_bit = best_low_bits[0];
+        best_low_bits[0] = best_low_bits[1];
+        best_low_bits[1] = low_bit;
+        for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+            best_indices[i] = 15 - best_indices[i];
+    }
+
+    // write the block
+    //  - 7-bit mode, six zero bits followed by a one bit.
+    //  - 7-bit first and second endpoint red, then green, then blue, then alpha.
+    //  - 1-bit first and second endpoint low bits.
+    //  - 3-bit first pixel index, then 4-bit indices for every other pixel.
+    struct bc_bits_t bits = { { 0, 0 }, 0 };
+    bc_write_bits(&bits, 1 << 6, 7);
+    for (unsigned int c = 0; c < 4; c++)
+    {
+        bc_write_bits(&bits, best_channels[0][c], 7);
+        bc_write_bits(&bits, best_channels[1][c], 7);
+    }
+
+    bc_write_bits(&bits, best_low_bits[0], 1);
+    bc_write_bits(&bits, best_low_bits[1], 1);
+    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+        bc_write_bits(&bits, best_indices[i], (i == 0) ? 3 : 4);
+
+    for (unsigned int i = 0; i < 16; i++)
+        block[i] = (bits.words[i / 8] >> ((i % 8) * 8)) & 0xff;
+}
+
+void bc_encode(const struct png_t *png, enum texture_format_t format, void *destination)
+{
+    // ensure the given format is compressed
+    assert(texture_format_is_compressed(format));
+
+    // encode each block in order, bottom-to-top as with the given pngs rows
+    size_t block_size = texture_get_data_size(format, 4, 4);
+    unsigned int num_blocks_x = (png->width + 3) / 4;
+    unsigned int num_blocks_y = (png->height + 3) / 4;
+    uint8_t *block = destination;
+    for (unsigned int block_y = 0; block_y < num_blocks_y; block_y++)
+    {
+        for (unsigned int block_x = 0; block_x < num_blocks_x; block_x++, block += block_size)
+        {
+            uint8_t pixels[BC_NUM_PIXELS][4];
+            bc_read_block(png, block_x, block_y, pixels);
+
+            bool included[BC_NUM_PIXELS];
+            bool any_included = false;
+            switch (format)
+            {
+                case TEXTURE_BC1:
+                    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+                        included[i] = true;
+
+                    bc_encode_colour_block(pixels, included, block);
+                    break;
+                case TEXTURE_BC3:
+                    // fit the colour to the visible pixels, unless there are none to fit to
+                    for (unsigned int i = 0; i < BC_NUM_PIXELS; i++)
+                    {
+                        included[i] = pixels[i][3] > 0;
+                        any_included |= included[i];
+                    }
+
+                    for (unsigned int i = 0; i < BC_NUM_PIXELS && !any_included; i++)
+                        included[i] = true;
+
+                    bc_encode_alpha_block(pixels, block);
+                    bc_encode_colour_block(pixels, included, block + 8);
+                    break;
+                case TEXTURE_BC7:
+                    bc_encode_bc7_block(pixels, block);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+void bc_encode_buffer(const struct png_t *png, enum texture_format_t format, struct buffer_t *buffer)
+{
+    void *destination = buffer_extend(buffer, texture_get_data_size(format, png->width, png->height));
+    bc_encode(png, format, destination);
+}
@@ -1,95 +1,468 @@
 #include "bin.h"
 
-#include <stdint.h>
+#include <string.h>
+
+#include "buffer.h"
 
 // MARK: - Macros
 
-/// Cast the given value to the given type and write it to the current cursor of the given file handle.
-/// @param value The value to cast.
-/// @param type The type to cast the given value to.
-/// @param file The file handle to write the given value to once it has been casted.
-#define BIN_WRITE_CAST(value, type, file) \
-    type write_value = (type)value; \
-    fwrite(&write_value, sizeof(write_value), 1, file);
+/// Write the given value to the current cursor of the given file handle as a little-endian value of the given size.
+/// @param value The value to write, already converted to an unsigned 64-bit integer.
+/// @param size The size of the value to write, in bytes.
+/// @param file The file handle to write the given value to.
+#define BIN_WRITE_FILE(value, size, file) \
+    unsigned char bytes[size]; \
+    bin_encode(bytes, value, size); \
+    fwrite(bytes, size, 1, file);
 
-/// Read and return the value of the given type from the current cursor of the given file handle, casted to the given type.
-/// @param read_type The type to read from the given file handle.
+/// Read and return a little-endian value of the given size from the current cursor of the given file handle, casted to the given type.
+///
+/// If the file ends before the value then zero is returned.
+/// @param size The size of the value to read, in bytes.
 /// @param cast_type The type to cast the read value to before returning it.
 /// @param file The file handle to read the value from.
 /// @return The value read from the given file handle, casted to the given type.
-#define BIN_READ_CAST(read_type, cast_type, file) \
-    read_type value; \
-    fread(&value, sizeof(value), 1, file); \
-    return (cast_type)value;
+#define BIN_READ_FILE(size, cast_type, file) \
+    unsigned char bytes[size]; \
+    if (fread(bytes, size, 1, file) != 1) \
+        return (cast_type)0; \
+    return (cast_type)bin_decode(bytes, size);
 
 // MARK: - Functions
 
+/// Decode the little-endian unsigned integer of the given size from the given bytes.
+/// @param bytes The first byte of the integer to decode.
+/// @param size The size of the integer to decode, in bytes.
+/// @return The decoded integer.
+uint64_t bin_decode(const unsigned char *bytes, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++)
+        value |= (uint64_t)bytes[i] << (i * 8);
+
+    return value;
+}
+
+/// Encode the given unsigned integer into the given bytes as a little-endian unsigned integer of the given size.
+/// @param bytes The first byte to encode the integer into.
+/// @param value The integer to encode, which is truncated to the given size.
+/// @param size The size of the integer to encode, in bytes.
+void bin_encode(unsigned char *bytes, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        bytes[i] = (unsigned char)(value >> (i * 8));
+}
+
+/// Get the bit pattern of the given 32-bit float.
+/// @param value The float to get the bit pattern of.
+/// @return The bit pattern of the given float.
+uint32_t bin_f32_to_bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/// Get the 32-bit float with the given bit pattern.
+/// @param bits The bit pattern of the float to get.
+/// @return The float with the given bit pattern.
+float bin_f32_from_bits(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// MARK: - Reader Functions
+
+void bin_reader_init(struct bin_reader_t *reader, const void *data, size_t size)
+{
+    reader->data = data;
+    reader->size = size;
+    reader->offset = 0;
+    reader->error = false;
+}
+
+void bin_reader_seek(struct bin_reader_t *reader, size_t offset)
+{
+    if (offset > reader->size)
+    {
+        reader->error = true;
+        return;
+    }
+
+    reader->offset = offset;
+}
+
+const void *bin_reader_read_bytes(struct bin_reader_t *reader, size_t size)
+{
+    if (reader->error || size > reader->size - reader->offset)
+    {
+        reader->error = true;
+        return NULL;
+    }
+
+    const unsigned char *bytes = reader->data + reader->offset;
+    reader->offset += size;
+    return bytes;
+}
+
+void bin_reader_skip(struct bin_reader_t *reader, size_t size)
+{
+    bin_reader_read_bytes(reader, size);
+}
+
+/// Read a little-endian unsigned integer of the given size from the cursor of the given reader, and move the cursor past it.
+///
+/// If there are not enough bytes remaining then the reader enters its error state.
+/// @param reader The reader to read the integer from.
+/// @param size The size of the integer to read, in bytes.
+/// @return The read integer, or zero if the given reader is in its error state.
+uint64_t bin_reader_read(struct bin_reader_t *reader, size_t size)
+{
+    const unsigned char *bytes = bin_reader_read_bytes(reader, size);
+    return (bytes != NULL) ? bin_decode(bytes, size) : 0;
+}
+
+int bin_reader_read_s8(struct bin_reader_t *reader)
+{
+    return (int8_t)bin_reader_read(reader, 1);
+}
+
+int bin_reader_read_s16(struct bin_reader_t *reader)
+{
+    return (int16_t)bin_reader_read(reader, 2);
+}
+
+int bin_reader_read_s32(struct bin_reader_t *reader)
+{
+    return (int32_t)bin_reader_read(reader, 4);
+}
+
+unsigned int bin_reader_read_u8(struct bin_reader_t *reader)
+{
+    return (uint8_t)bin_reader_read(reader, 1);
+}
+
+unsigned int bin_reader_read_u16(struct bin_reader_t *reader)
+{
+    return (uint16_t)bin_reader_read(reader, 2);
+}
+
+unsigned int bin_reader_read_u32(struct bin_reader_t *reader)
+{
+    return (uint32_t)bin_reader_read(reader, 4);
+}
+
+uint64_t bin_reader_read_u64(struct bin_reader_t *reader)
+{
+    return bin_reader_read(reader, 8);
+}
+
+float bin_reader_read_f32(struct bin_reader_t *reader)
+{
+    return bin_f32_from_bits(bin_reader_read(reader, 4));
+}
+
+/// Get the bytes of a run of values of the given size at the cursor of the given reader, and move the cursor past them.
+///
+/// If there are not enough bytes remaining then the reader enters its error state.
+/// @param reader The reader to read from.
+/// @param value_size The size of each value within the run, in bytes.
+/// @param count The total number of values within the run.
+/// @return The first byte of the run, or `NULL` if the given reader is in its error state.
+const unsigned char *bin_reader_read_run(struct bin_reader_t *reader, size_t value_size, size_t count)
+{
+    if (count > SIZE_MAX / value_size)
+    {
+        reader->error = true;
+        return NULL;
+    }
+
+    return bin_reader_read_bytes(reader, count * value_size);
+}
+
+void bin_reader_read_u16s(struct bin_reader_t *reader, uint16_t *values, size_t count)
+{
+    const unsigned char *bytes = bin_reader_read_run(reader, sizeof(uint16_t), count);
+    if (bytes == NULL)
+        memset(values, 0, count * sizeof(uint16_t));
+    else if (BIN_HOST_IS_LITTLE_ENDIAN)
+        memcpy(values, bytes, count * sizeof(uint16_t));
+    else
+        for (size_t i = 0; i < count; i++)
+            values[i] = bin_decode(bytes + (i * sizeof(uint16_t)), sizeof(uint16_t));
+}
+
+void bin_reader_read_u32s(struct bin_reader_t *reader, uint32_t *values, size_t count)
+{
+    const unsigned char *bytes = bin_reader_read_run(reader, sizeof(uint32_t), count);
+    if (bytes == NULL)
+        memset(values, 0, count * sizeof(uint32_t));
+    else if (BIN_HOST_IS_LITTLE_ENDIAN)
+        memcpy(values, bytes, count * sizeof(uint32_t));
+    else
+        for (size_t i = 0; i < count; i++)
+            values[i] = bin_decode(bytes + (i * sizeof(uint32_t)), sizeof(uint32_t));
+}
+
+void bin_reader_read_f32s(struct bin_reader_t *reader, float *values, size_t count)
+{
+    const unsigned char *bytes = bin_reader_read_run(reader, sizeof(float), count);
+    if (bytes == NULL)
+        memset(values, 0, count * sizeof(float));
+    else if (BIN_HOST_IS_LITTLE_ENDIAN)
+        memcpy(values, bytes, count * sizeof(float));
+    else
+        for (size_t i = 0; i < count; i++)
+            values[i] = bin_f32_from_bits(bin_decode(bytes + (i * sizeof(float)), sizeof(float)));
+}
+
+// MARK: - Writer Functions
+
+void bin_writer_init_buffer(struct bin_writer_t *writer, struct buffer_t *buffer)
+{
+    writer->buffer = buffer;
+    writer->data = NULL;
+    writer->size = 0;
+    writer->offset = 0;
+    writer->error = false;
+}
+
+void bin_writer_init_memory(struct bin_writer_t *writer, void *data, size_t size)
+{
+    writer->buffer = NULL;
+    writer->data = data;
+    writer->size = size;
+    writer->offset = 0;
+    writer->error = false;
+}
+
+/// Get the memory for the given number of bytes at the cursor of the given writer, and move the cursor past them.
+///
+/// If there is not enough memory remaining then the writer enters its error state.
+/// @param writer The writer to get the memory of.
+/// @param size The total number of bytes to get.
+/// @return The first of the bytes to write to, or `NULL` if the given writer is in its error state or no bytes were requested.
+unsigned char *bin_writer_extend(struct bin_writer_t *writer, size_t size)
+{
+    if (writer->buffer != NULL)
+    {
+        if (size == 0)
+            return NULL;
+
+        writer->offset += size;
+        return buffer_extend(writer->buffer, size);
+    }
+
+    if (writer->error || size > writer->size - writer->offset)
+    {
+        writer->error = true;
+        return NULL;
+    }
+
+    unsigned char *bytes = writer->data + writer->offset;
+    writer->offset += size;
+    return (size > 0) ? bytes : NULL;
+}
+
+void bin_writer_write_bytes(struct bin_writer_t *writer, const void *data, size_t size)
+{
+    unsigned char *bytes = bin_writer_extend(writer, size);
+    if (bytes != NULL)
+        memcpy(bytes, data, size);
+}
+
+void bin_writer_write_zeros(struct bin_writer_t *writer, size_t size)
+{
+    unsigned char *bytes = bin_writer_extend(writer, size);
+    if (bytes != NULL)
+        memset(bytes, 0, size);
+}
+
+/// Write the given unsigned integer to the cursor of the given writer as a little-endian unsigned integer of the given size,
+/// and move the cursor past it.
+///
+/// If there is not enough memory remaining then the writer enters its error state.
+/// @param writer The writer to write to.
+/// @param value The integer to write, which is truncated to the given size.
+/// @param size The size of the integer to write, in bytes.
+void bin_writer_write(struct bin_writer_t *writer, uint64_t value, size_t size)
+{
+    unsigned char *bytes = bin_writer_extend(writer, size);
+    if (bytes != NULL)
+        bin_encode(bytes, value, size);
+}
+
+void bin_writer_write_s8(struct bin_writer_t *writer, int value)
+{
+    bin_writer_write(writer, (uint8_t)value, 1);
+}
+
+void bin_writer_write_s16(struct bin_writer_t *writer, int value)
+{
+    bin_writer_write(writer, (uint16_t)value, 2);
+}
+
+void bin_writer_write_s32(struct bin_writer_t *writer, int value)
+{
+    bin_writer_write(writer, (uint32_t)value, 4);
+}
+
+void bin_writer_write_u8(struct bin_writer_t *writer, unsigned int value)
+{
+    bin_writer_write(writer, value, 1);
+}
+
+void bin_writer_write_u16(struct bin_writer_t *writer, unsigned int value)
+{
+    bin_writer_write(writer, value, 2);
+}
+
+void bin_writer_write_u32(struct bin_writer_t *writer, unsigned int value)
+{
+    bin_writer_write(writer, value, 4);
+}
+
+void bin_writer_write_u64(struct bin_writer_t *writer, uint64_t value)
+{
+    bin_writer_write(writer, value, 8);
+}
+
+void bin_writer_write_f32(struct bin_writer_t *writer, float value)
+{
+    bin_writer_write(writer, bin_f32_to_bits(value), 4);
+}
+
+/// Get the memory for a run of values of the given size at the cursor of the given writer, and move the cursor past them.
+///
+/// If there is not enough memory remaining then the writer enters its error state.
+/// @param writer The writer to get the memory of.
+/// @param value_size The size of each value within the run, in bytes.
+/// @param count The total number of values within the run.
+/// @return The first byte of the run, or `NULL` if the given writer is in its error state or the run is empty.
+unsigned char *bin_writer_extend_run(struct bin_writer_t *writer, size_t value_size, size_t count)
+{
+    if (count > SIZE_MAX / value_size)
+    {
+        writer->error = true;
+        return NULL;
+    }
+
+    return bin_writer_extend(writer, count * value_size);
+}
+
+void bin_writer_write_u16s(struct bin_writer_t *writer, const uint16_t *values, size_t count)
+{
+    unsigned char *bytes = bin_writer_extend_run(writer, sizeof(uint16_t), count);
+    if (bytes == NULL)
+        return;
+
+    if (BIN_HOST_IS_LITTLE_ENDIAN)
+        memcpy(bytes, values, count * sizeof(uint16_t));
+    else
+        for (size_t i = 0; i < count; i++)
+            bin_encode(bytes + (i * sizeof(uint16_t)), values[i], sizeof(uint16_t));
+}
+
+void bin_writer_write_u32s(struct bin_writer_t *writer, const uint32_t *values, size_t count)
+{
+    unsigned char *bytes = bin_writer_extend_run(writer, sizeof(uint32_t), count);
+    if (bytes == NULL)
+        return;
+
+    if (BIN_HOST_IS_LITTLE_ENDIAN)
+        memcpy(bytes, values, count * sizeof(uint32_t));
+    else
+        for (size_t i = 0; i < count; i++)
+            bin_encode(bytes + (i * sizeof(uint32_t)), values[i], sizeof(uint32_t));
+}
+
+void bin_writer_write_f32s(struct bin_writer_t *writer, const float *values, size_t count)
+{
+    unsigned char *bytes = bin_writer_extend_run(writer, sizeof(float), count);
+    if (bytes == NULL)
+        return;
+
+    if (BIN_HOST_IS_LITTLE_ENDIAN)
+        memcpy(bytes, values, count * sizeof(float));
+    else
+        for (size_t i = 0; i < count; i++)
+            bin_encode(bytes + (i * sizeof(float)), bin_f32_to_bits(values[i]), sizeof(float));
+}
+
+// MARK: - File Functions
+
 void bin_write_s8(int value, FILE *file)
 {
-    BIN_WRITE_CAST(value, int8_t, file);
+    BIN_WRITE_FILE((uint8_t)value, 1, file);
 }
 
 void bin_write_s16(int value, FILE *file)
 {
-    BIN_WRITE_CAST(value, int16_t, file);
+    BIN_WRITE_FILE((uint16_t)value, 2, file);
 }
 
 void bin_write_s32(int value, FILE *file)
 {
-    BIN_WRITE_CAST(value, int32_t, file);
+    BIN_WRITE_FILE((uint32_t)value, 4, file);
 }
 
 void bin_write_u8(unsigned int value, FILE *file)
 {
-    BIN_WRITE_CAST(value, uint8_t, file);
+    BIN_WRITE_FILE(value, 1, file);
 }
 
 void bin_write_u16(unsigned int value, FILE *file)
 {
-    BIN_WRITE_CAST(value, uint16_t, file);
+    BIN_WRITE_FILE(value, 2, file);
 }
 
 void bin_write_u32(unsigned int value, FILE *file)
 {
-    BIN_WRITE_CAST(value, uint32_t, file);
+    BIN_WRITE_FILE(value, 4, file);
 }
 
 void bin_write_f32(float value, FILE *file)
 {
-    BIN_WRITE_CAST(value, float, file);
+    BIN_WRITE_FILE(bin_f32_to_bits(value), 4, file);
 }
 
 int bin_read_s8(FILE *file)
 {
-    BIN_READ_CAST(int8_t, int, file);
+    BIN_READ_FILE(1, int8_t, file);
 }
 
 int bin_read_s16(FILE *file)
 {
-    BIN_READ_CAST(int16_t, int, file);
+    BIN_READ_FILE(2, int16_t, file);
 }
 
 int bin_read_s32(FILE *file)
 {
-    BIN_READ_CAST(int32_t, int, file);
+    BIN_READ_FILE(4, int32_t, file);
 }
 
 unsigned int bin_read_u8(FILE *file)
 {
-    BIN_READ_CAST(uint8_t, unsigned int, file);
+    BIN_READ_FILE(1, uint8_t, file);
 }
 
 unsigned int bin_read_u16(FILE *file)
 {
-    BIN_READ_CAST(uint16_t, unsigned int, file);
+    BIN_READ_FILE(2, uint16_t, file);
 }
 
 unsigned int bin_read_u32(FILE *file)
 {
-    BIN_READ_CAST(uint32_t, unsigned int, file);
+    BIN_READ_FILE(4, uint32_t, file);
 }
 
 float bin_read_f32(FILE *file)
 {
-    BIN_READ_CAST(float, float, file);
+    unsigned char bytes[4];
+    if (fread(bytes, sizeof(bytes), 1, file) != 1)
+        return 0.0f;
+
+    return bin_f32_from_bits(bin_decode(bytes, sizeof(bytes)));
 }
@@ -0,0 +1,70 @@
+#include "buffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// MARK: - Macros
+
+/// The capacity that buffers are first allocated with, in bytes.
+#define BUFFER_INITIAL_CAPACITY (4096)
+
+// MARK: - Functions
+
+void buffer_init(struct buffer_t *buffer)
+{
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+}
+
+void buffer_deinit(struct buffer_t *buffer)
+{
+    free(buffer->data);
+}
+
+void buffer_reserve(struct buffer_t *buffer, size_t capacity)
+{
+    if (capacity <= buffer->capacity)
+        return;
+
+    // grow geometrically so that repeated appends are amortized constant time
+    size_t new_capacity = (buffer->capacity > 0) ? buffer->capacity : BUFFER_INITIAL_CAPACITY;
+    while (new_capacity < capacity)
+        new_capacity *= 2;
+
+    buffer->data = realloc(buffer->data, new_capacity);
+    buffer->capacity = new_capacity;
+}
+
+void *buffer_extend(struct buffer_t *buffer, size_t size)
+{
+    buffer_reserve(buffer, buffer->size + size);
+    void *extension = buffer->data + buffer->size;
+    buffer->size += size;
+    return extension;
+}
+
+void buffer_append(struct buffer_t *buffer, const void *data, size_t size)
+{
+    if (size > 0)
+        memcpy(buffer_extend(buffer, size), data, size);
+}
+
+void buffer_append_zeros(struct buffer_t *buffer, size_t size)
+{
+    if (size > 0)
+        memset(buffer_extend(buffer, size), 0, size);
+}
+
+void buffer_align(struct buffer_t *buffer, size_t alignment)
+{
+    size_t remainder = buffer->size % alignment;
+    if (remainder != 0)
+        buffer_append_zeros(buffer, alignment - remainder);
+}
+
+void buffer_write(const struct buffer_t *buffer, FILE *file)
+{
+    if (buffer->size > 0)
+        fwrite(buffer->data, buffer->size, 1, file);
+}
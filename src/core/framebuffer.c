@@ -1,5 +1,7 @@
 #include "framebuffer.h"
 
+#include "gl_state.h"
+
 // MARK: - Functions
 
 void framebuffer_init(struct framebuffer_t *framebuffer,
@@ -8,7 +10,7 @@ void framebuffer_init(struct framebuffer_t *framebuffer,
 {
     // create the framebuffer
     glGenFramebuffers(1, &framebuffer->id);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->id);
+    gl_state_bind_framebuffer(framebuffer->id);
 
     // create and bind the texture
     // framebuffers cant have an alpha component, and should always linear scale
@@ -26,7 +28,7 @@ void framebuffer_init(struct framebuffer_t *framebuffer,
                            0);
 
     // unbind the new framebuffer to ensure nothing is accidentally rendered to it
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl_state_bind_framebuffer(0);
 
     // initialize the background
     framebuffer->has_background = false;
@@ -35,6 +37,7 @@ void framebuffer_init(struct framebuffer_t *framebuffer,
 void framebuffer_deinit(struct framebuffer_t *framebuffer)
 {
     texture_deinit(&framebuffer->texture);
+    gl_state_forget_framebuffer(framebuffer->id);
     glDeleteFramebuffers(1, &framebuffer->id);
 }
 
@@ -46,8 +49,8 @@ void framebuffer_set_background(struct framebuffer_t *framebuffer, struct colour
 
 void framebuffer_use(struct framebuffer_t *framebuffer)
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->id);
-    glViewport(0, 0, framebuffer->texture.width, framebuffer->texture.height);
+    gl_state_bind_framebuffer(framebuffer->id);
+    gl_state_set_viewport(0, 0, framebuffer->texture.width, framebuffer->texture.height);
     glClear(GL_COLOR_BUFFER_BIT);
 
     if (framebuffer->has_background)
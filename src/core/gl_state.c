@@ -0,0 +1,270 @@
+#include "gl_state.h"
+
+#include <stddef.h>
+#include <assert.h>
+
+// MARK: - Variables
+
+/// The state cache of the graphics context which is current on the calling thread, if any.
+static _Thread_local struct gl_state_t *gl_state_current = NULL;
+
+// MARK: - Functions
+
+/// Record a binding call within the given state cache, if there is one.
+/// @param state The state cache to record the call within, or `NULL` if there is none.
+/// @param is_elided Whether or not the call was elided, rather than issued.
+void gl_state_count_call(struct gl_state_t *state, bool is_elided)
+{
+    if (state == NULL)
+        return;
+
+    if (is_elided)
+        state->num_elided_calls++;
+    else
+        state->num_issued_calls++;
+}
+
+/// Get the index of the given texture target within the texture bindings of a state cache.
+/// @param target The OpenGL texture target to get the index of.
+/// @param index The pointer to set the value of to the index of the given target.
+/// @return Whether or not the given target is tracked by state caches.
+bool gl_state_get_target_index(GLenum target, unsigned int *index)
+{
+    switch (target)
+    {
+        case GL_TEXTURE_2D:       *index = 0; return true;
+        case GL_TEXTURE_2D_ARRAY: *index = 1; return true;
+        default:                  return false;
+    }
+}
+
+/// Get the pooled sampler object with the given parameters within the given state cache, creating it if there is none.
+/// @param state The state cache to get the sampler from.
+/// @param min_filter The minification filter of the sampler.
+/// @param mag_filter The magnification filter of the sampler.
+/// @param wrap The wrap mode of the sampler along both axes.
+/// @return The unique OpenGL identifier of the sampler.
+GLuint gl_state_get_sampler(struct gl_state_t *state, GLenum min_filter, GLenum mag_filter, GLenum wrap)
+{
+    for (unsigned int i = 0; i < state->num_samplers; i++)
+    {
+        const struct gl_state_sampler_t *sampler = &state->samplers[i];
+        if (sampler->min_filter == min_filter && sampler->mag_filter == mag_filter && sampler->wrap == wrap)
+            return sampler->id;
+    }
+
+    // there is no matching sampler, create one
+    assert(state->num_samplers < GL_STATE_MAX_SAMPLERS);
+    struct gl_state_sampler_t *sampler = &state->samplers[state->num_samplers++];
+    sampler->min_filter = min_filter;
+    sampler->mag_filter = mag_filter;
+    sampler->wrap = wrap;
+    glGenSamplers(1, &sampler->id);
+    glSamplerParameteri(sampler->id, GL_TEXTURE_MIN_FILTER, min_filter);
+    glSamplerParameteri(sampler->id, GL_TEXTURE_MAG_FILTER, mag_filter);
+    glSamplerParameteri(sampler->id, GL_TEXTURE_WRAP_S, wrap);
+    glSamplerParameteri(sampler->id, GL_TEXTURE_WRAP_T, wrap);
+    return sampler->id;
+}
+
+void gl_state_init(struct gl_state_t *state)
+{
+    gl_state_invalidate(state);
+    state->num_samplers = 0;
+    state->num_issued_calls = 0;
+    state->num_elided_calls = 0;
+}
+
+void gl_state_invalidate(struct gl_state_t *state)
+{
+    state->program_id = GL_STATE_UNKNOWN;
+    state->active_unit = GL_STATE_UNKNOWN;
+    for (unsigned int unit = 0; unit < GL_STATE_MAX_TEXTURE_UNITS; unit++)
+        for (unsigned int target = 0; target < GL_STATE_NUM_TEXTURE_TARGETS; target++)
+            state->texture_ids[unit][target] = GL_STATE_UNKNOWN;
+
+    for (unsigned int unit = 0; unit < GL_STATE_MAX_TEXTURE_UNITS; unit++)
+        state->sampler_ids[unit] = GL_STATE_UNKNOWN;
+
+    state->vertex_array_id = GL_STATE_UNKNOWN;
+    state->framebuffer_id = GL_STATE_UNKNOWN;
+    state->has_viewport = false;
+}
+
+void gl_state_set_current(struct gl_state_t *state)
+{
+    gl_state_current = state;
+}
+
+struct gl_state_t *gl_state_get_current()
+{
+    return gl_state_current;
+}
+
+void gl_state_use_program(GLuint program_id)
+{
+    struct gl_state_t *state = gl_state_current;
+    bool is_elided = state != NULL && state->program_id == program_id;
+    gl_state_count_call(state, is_elided);
+    if (is_elided)
+        return;
+
+    glUseProgram(program_id);
+    if (state != NULL)
+        state->program_id = program_id;
+}
+
+void gl_state_activate_unit(unsigned int unit)
+{
+    struct gl_state_t *state = gl_state_current;
+    bool is_elided = state != NULL && state->active_unit == unit;
+    gl_state_count_call(state, is_elided);
+    if (is_elided)
+        return;
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    if (state != NULL)
+        state->active_unit = unit;
+}
+
+void gl_state_bind_texture(GLenum target, GLuint texture_id)
+{
+    // bindings are only tracked for known targets on known units
+    struct gl_state_t *state = gl_state_current;
+    GLuint *binding = NULL;
+    unsigned int target_index;
+    if (state != NULL &&
+        state->active_unit < GL_STATE_MAX_TEXTURE_UNITS &&
+        gl_state_get_target_index(target, &target_index))
+    {
+        binding = &state->texture_ids[state->active_unit][target_index];
+    }
+
+    bool is_elided = binding != NULL && *binding == texture_id;
+    gl_state_count_call(state, is_elided);
+    if (is_elided)
+        return;
+
+    glBindTexture(target, texture_id);
+    if (binding != NULL)
+        *binding = texture_id;
+}
+
+void gl_state_bind_sampler(unsigned int unit, GLenum min_filter, GLenum mag_filter, GLenum wrap)
+{
+    struct gl_state_t *state = gl_state_current;
+    if (state == NULL)
+        return;
+
+    // bindings are only tracked for known units
+    GLuint sampler_id = gl_state_get_sampler(state, min_filter, mag_filter, wrap);
+    GLuint *binding = (unit < GL_STATE_MAX_TEXTURE_UNITS) ? &state->sampler_ids[unit] : NULL;
+    bool is_elided = binding != NULL && *binding == sampler_id;
+    gl_state_count_call(state, is_elided);
+    if (is_elided)
+        return;
+
+    glBindSampler(unit, sampler_id);
+    if (binding != NULL)
+        *binding = sampler_id;
+}
+
+void gl_state_bind_vertex_array(GLuint vertex_array_id)
+{
+    struct gl_state_t *state = gl_state_current;
+    bool is_elided = state != NULL && state->vertex_array_id == vertex_array_id;
+    gl_state_count_call(state, is_elided);
+    if (is_elided)
+        return;
+
+    glBindVertexArray(vertex_array_id);
+    if (state != NULL)
+        state->vertex_array_id = vertex_array_id;
+}
+
+void gl_state_bind_framebuffer(GLuint framebuffer_id)
+{
+    struct gl_state_t *state = gl_state_current;
+    bool is_elided = state != NULL && state->framebuffer_id == framebuffer_id;
+    gl_state_count_call(state, is_elided);
+    if (is_elided)
+        return;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+    if (state != NULL)
+        state->framebuffer_id = framebuffer_id;
+}
+
+GLuint gl_state_get_framebuffer()
+{
+    struct gl_state_t *state = gl_state_current;
+    if (state != NULL && state->framebuffer_id != GL_STATE_UNKNOWN)
+        return state->framebuffer_id;
+
+    // query the binding, as it was never made through the cache or has since been invalidated
+    GLint framebuffer_id;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer_id);
+    if (state != NULL)
+        state->framebuffer_id = framebuffer_id;
+
+    return framebuffer_id;
+}
+
+void gl_state_set_viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    struct gl_state_t *state = gl_state_current;
+    bool is_elided = state != NULL &&
+                     state->has_viewport &&
+                     state->viewport[0] == x &&
+                     state->viewport[1] == y &&
+                     state->viewport[2] == width &&
+                     state->viewport[3] == height;
+
+    gl_state_count_call(state, is_elided);
+    if (is_elided)
+        return;
+
+    glViewport(x, y, width, height);
+    if (state != NULL)
+    {
+        state->has_viewport = true;
+        state->viewport[0] = x;
+        state->viewport[1] = y;
+        state->viewport[2] = width;
+        state->viewport[3] = height;
+    }
+}
+
+void gl_state_forget_texture(GLuint texture_id)
+{
+    struct gl_state_t *state = gl_state_current;
+    if (state == NULL)
+        return;
+
+    for (unsigned int unit = 0; unit < GL_STATE_MAX_TEXTURE_UNITS; unit++)
+        for (unsigned int target = 0; target < GL_STATE_NUM_TEXTURE_TARGETS; target++)
+            if (state->texture_ids[unit][target] == texture_id)
+                state->texture_ids[unit][target] = 0;
+}
+
+void gl_state_forget_program(GLuint program_id)
+{
+    // a deleted program stays in use until another is used, so its binding is unknown rather than reverted
+    struct gl_state_t *state = gl_state_current;
+    if (state != NULL && state->program_id == program_id)
+        state->program_id = GL_STATE_UNKNOWN;
+}
+
+void gl_state_forget_vertex_array(GLuint vertex_array_id)
+{
+    struct gl_state_t *state = gl_state_current;
+    if (state != NULL && state->vertex_array_id == vertex_array_id)
+        state->vertex_array_id = 0;
+}
+
+void gl_state_forget_framebuffer(GLuint framebuffer_id)
+{
+    struct gl_state_t *state = gl_state_current;
+    if (state != NULL && state->framebuffer_id == framebuffer_id)
+        state->framebuffer_id = 0;
+}
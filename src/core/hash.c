@@ -0,0 +1,37 @@
+#include "hash.h"
+
+// MARK: - Macros
+
+/// The value that a 64-bit FNV-1a hash is multiplied by for each byte.
+#define HASH_FNV1A64_PRIME (0x100000001b3ull)
+
+// MARK: - Functions
+
+uint64_t hash_fnv1a64(const void *data, size_t size)
+{
+    return hash_fnv1a64_continue(HASH_FNV1A64_OFFSET_BASIS, data, size);
+}
+
+uint64_t hash_fnv1a64_continue(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= HASH_FNV1A64_PRIME;
+    }
+
+    return hash;
+}
+
+uint64_t hash_fnv1a64_string(const char *string)
+{
+    uint64_t hash = HASH_FNV1A64_OFFSET_BASIS;
+    for (const unsigned char *c = (const unsigned char *)string; *c != '\0'; c++)
+    {
+        hash ^= *c;
+        hash *= HASH_FNV1A64_PRIME;
+    }
+
+    return hash;
+}
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 
 #include "platform.h"
+#include "gl_state.h"
 
 // MARK: - Functions
 
@@ -47,4 +48,9 @@ void imgui_end_frame(struct imgui_t *imgui)
 {
     igRender();
     ImGui_ImplOpenGL3_RenderDrawData(igGetDrawData());
+
+    // the imgui renderer binds its own program, vertex array, and textures
+    struct gl_state_t *state = gl_state_get_current();
+    if (state != NULL)
+        gl_state_invalidate(state);
 }
@@ -0,0 +1,183 @@
+#include "jobs.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "platform.h"
+
+// MARK: - Functions
+
+/// Run jobs from the given batch on the current thread until there are none left to start.
+///
+/// This is the entry point of each worker thread of a batch.
+/// @param argument The pointer to the batch to run the jobs of.
+void *jobs_run_worker(void *argument)
+{
+    struct jobs_t *jobs = (struct jobs_t *)argument;
+    while (true)
+    {
+        // take the next job, if there are any left, waiting for it to be released if it is held
+        pthread_mutex_lock(&jobs->mutex);
+        while (jobs->next_job < jobs->num_jobs && jobs->next_job >= jobs->num_released)
+            pthread_cond_wait(&jobs->release, &jobs->mutex);
+
+        if (jobs->next_job >= jobs->num_jobs)
+        {
+            pthread_mutex_unlock(&jobs->mutex);
+            break;
+        }
+
+        unsigned int index = jobs->next_job++;
+        pthread_mutex_unlock(&jobs->mutex);
+
+        // run the job outside of the lock so that other workers can proceed
+        jobs->function(jobs->data, index);
+
+        // queue the job as completed and wake any waiting consumer
+        pthread_mutex_lock(&jobs->mutex);
+        jobs->completed[jobs->num_completed++] = index;
+        pthread_cond_broadcast(&jobs->completion);
+        pthread_mutex_unlock(&jobs->mutex);
+    }
+
+    return NULL;
+}
+
+/// Initialize the given batch of jobs with the given number of its jobs released, and begin running them.
+/// @param jobs The batch to initialize.
+/// @param num_jobs The total number of jobs within the new batch.
+/// @param num_released The total number of jobs within the new batch which may be started immediately.
+/// @param num_threads The maximum number of worker threads to run the new batch's jobs on, or zero to use the number of available processors.
+/// @param function The function to call to run each job.
+/// @param data The user data pointer to supply to the given function.
+void jobs_start(struct jobs_t *jobs,
+                unsigned int num_jobs,
+                unsigned int num_released,
+                unsigned int num_threads,
+                jobs_function_t function,
+                void *data)
+{
+    // get the number of threads to run the jobs on
+    if (num_threads == 0)
+        num_threads = platform_get_num_processors();
+    if (num_threads > num_jobs)
+        num_threads = num_jobs;
+
+    // initialize the given batch
+    // this must be done before starting the workers as they immediately access it
+    jobs->function = function;
+    jobs->data = data;
+    jobs->num_jobs = num_jobs;
+    jobs->num_released = num_released;
+    jobs->next_job = 0;
+    jobs->num_completed = 0;
+    jobs->num_consumed = 0;
+    jobs->completed = malloc(num_jobs * sizeof(unsigned int));
+    jobs->num_threads = num_threads;
+    jobs->threads = malloc(num_threads * sizeof(pthread_t));
+    pthread_mutex_init(&jobs->mutex, NULL);
+    pthread_cond_init(&jobs->completion, NULL);
+    pthread_cond_init(&jobs->release, NULL);
+
+    // start the workers
+    // pthreads are used directly rather than through a wrapper, as the batch already exposes its mutex and condition,
+    // and every supported platform provides them
+    for (int i = 0; i < num_threads; i++)
+        pthread_create(&jobs->threads[i], NULL, jobs_run_worker, jobs);
+}
+
+void jobs_init(struct jobs_t *jobs,
+               unsigned int num_jobs,
+               unsigned int num_threads,
+               jobs_function_t function,
+               void *data)
+{
+    jobs_start(jobs, num_jobs, num_jobs, num_threads, function, data);
+}
+
+void jobs_init_held(struct jobs_t *jobs,
+                    unsigned int num_jobs,
+                    unsigned int num_threads,
+                    jobs_function_t function,
+                    void *data)
+{
+    jobs_start(jobs, num_jobs, 0, num_threads, function, data);
+}
+
+void jobs_release(struct jobs_t *jobs,
+                  unsigned int num_jobs)
+{
+    pthread_mutex_lock(&jobs->mutex);
+    assert(num_jobs <= jobs->num_jobs - jobs->num_released);
+    jobs->num_released += num_jobs;
+    pthread_cond_broadcast(&jobs->release);
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+void jobs_deinit(struct jobs_t *jobs)
+{
+    // abandon any jobs which are still held, so that workers waiting on them finish
+    pthread_mutex_lock(&jobs->mutex);
+    jobs->num_jobs = jobs->num_released;
+    pthread_cond_broadcast(&jobs->release);
+    pthread_mutex_unlock(&jobs->mutex);
+
+    // wait for all the workers to finish
+    for (int i = 0; i < jobs->num_threads; i++)
+        pthread_join(jobs->threads[i], NULL);
+
+    pthread_cond_destroy(&jobs->release);
+    pthread_cond_destroy(&jobs->completion);
+    pthread_mutex_destroy(&jobs->mutex);
+    free(jobs->threads);
+    free(jobs->completed);
+}
+
+bool jobs_wait_next(struct jobs_t *jobs,
+                    unsigned int *index)
+{
+    pthread_mutex_lock(&jobs->mutex);
+
+    // if everything has been consumed then there is nothing to wait for
+    if (jobs->num_consumed >= jobs->num_jobs)
+    {
+        pthread_mutex_unlock(&jobs->mutex);
+        return false;
+    }
+
+    // wait for the next job to complete, if it hasnt already
+    while (jobs->num_consumed >= jobs->num_completed)
+        pthread_cond_wait(&jobs->completion, &jobs->mutex);
+
+    *index = jobs->completed[jobs->num_consumed++];
+    pthread_mutex_unlock(&jobs->mutex);
+    return true;
+}
+
+bool jobs_poll_next(struct jobs_t *jobs,
+                    unsigned int *index)
+{
+    pthread_mutex_lock(&jobs->mutex);
+    bool is_available = jobs->num_consumed < jobs->num_completed;
+    if (is_available)
+        *index = jobs->completed[jobs->num_consumed++];
+
+    pthread_mutex_unlock(&jobs->mutex);
+    return is_available;
+}
+
+unsigned int jobs_get_num_completed(struct jobs_t *jobs)
+{
+    pthread_mutex_lock(&jobs->mutex);
+    unsigned int num_completed = jobs->num_completed;
+    pthread_mutex_unlock(&jobs->mutex);
+    return num_completed;
+}
+
+bool jobs_is_finished(struct jobs_t *jobs)
+{
+    pthread_mutex_lock(&jobs->mutex);
+    bool is_finished = jobs->num_consumed >= jobs->num_jobs;
+    pthread_mutex_unlock(&jobs->mutex);
+    return is_finished;
+}
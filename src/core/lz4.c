@@ -0,0 +1,284 @@
+#include "lz4.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+// MARK: - Macros
+
+/// The minimum length of a match within a block, in bytes.
+#define LZ4_MIN_MATCH (4)
+
+/// The number of bytes at the end of a block which must always be literals.
+#define LZ4_LAST_LITERALS (5)
+
+/// The number of bytes at the end of a block within which no match may start.
+#define LZ4_MATCH_FIND_LIMIT (12)
+
+/// The maximum distance between a match and its reference, in bytes.
+#define LZ4_MAX_DISTANCE (65535)
+
+/// The value of a token's length nibble which indicates that the length continues in additional bytes.
+#define LZ4_RUN_MASK (15)
+
+/// The number of bits used to index the match finder's hash table.
+#define LZ4_HASH_BITS (16)
+
+// MARK: - Functions
+
+/// Read the unaligned 32-bit word at the given pointer.
+/// @param pointer The pointer to read the word at.
+/// @return The 32-bit word at the given pointer.
+uint32_t lz4_read_u32(const uint8_t *pointer)
+{
+    uint32_t value;
+    memcpy(&value, pointer, sizeof(value));
+    return value;
+}
+
+/// Get the index within the match finder's hash table of the given 32-bit word.
+/// @param word The word to hash.
+/// @return The index within the match finder's hash table of the given word.
+uint32_t lz4_hash(uint32_t word)
+{
+    return (word * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+/// Write the given length as continuation bytes, after its token nibble has been saturated.
+/// @param length The remaining length to write, after subtracting the saturated nibble.
+/// @param output The pointer to write the continuation bytes at.
+/// @return The pointer after the written continuation bytes.
+uint8_t *lz4_write_length(size_t length, uint8_t *output)
+{
+    while (length >= 255)
+    {
+        *output++ = 255;
+        length -= 255;
+    }
+
+    *output++ = (uint8_t)length;
+    return output;
+}
+
+/// Write a single sequence of the given literals, optionally followed by a match, to the given output.
+/// @param literals The first byte of the literals of the sequence.
+/// @param num_literals The total number of literals within the sequence.
+/// @param offset The distance back from the end of the literals to the match, in bytes.
+/// This is ignored if there is no match.
+/// @param match_length The length of the match, in bytes, or zero if the sequence has no match.
+/// @param output The pointer to write the sequence at.
+/// @return The pointer after the written sequence.
+uint8_t *lz4_write_sequence(const uint8_t *literals,
+                            size_t num_literals,
+                            size_t offset,
+                            size_t match_length,
+                            uint8_t *output)
+{
+    // literals
+    uint8_t *token = output++;
+    if (num_literals >= LZ4_RUN_MASK)
+    {
+        *token = LZ4_RUN_MASK << 4;
+        output = lz4_write_length(num_literals - LZ4_RUN_MASK, output);
+    }
+    else
+    {
+        *token = (uint8_t)(num_literals << 4);
+    }
+
+    memcpy(output, literals, num_literals);
+    output += num_literals;
+
+    // the final sequence of a block has no match
+    if (match_length == 0)
+        return output;
+
+    // match
+    *output++ = (uint8_t)(offset & 0xff);
+    *output++ = (uint8_t)(offset >> 8);
+
+    size_t length = match_length - LZ4_MIN_MATCH;
+    if (length >= LZ4_RUN_MASK)
+    {
+        *token |= LZ4_RUN_MASK;
+        output = lz4_write_length(length - LZ4_RUN_MASK, output);
+    }
+    else
+    {
+        *token |= (uint8_t)length;
+    }
+
+    return output;
+}
+
+size_t lz4_get_max_compressed_size(size_t size)
+{
+    return size + (size / 255) + 16;
+}
+
+size_t lz4_compress(const void *source,
+                    size_t source_size,
+                    void *destination,
+                    size_t destination_size)
+{
+    // ensure the destination can hold the worst case
+    assert(destination_size >= lz4_get_max_compressed_size(source_size));
+
+    const uint8_t *base = source;
+    const uint8_t *anchor = base;
+    uint8_t *output = destination;
+
+    // find and write matches
+    // blocks shorter than the match find limit are written entirely as literals
+    if (source_size > LZ4_MATCH_FIND_LIMIT)
+    {
+        // the hash table maps the hash of each 4-byte word to its last seen position
+        // unset entries point to the start of the source, which is harmless as matches are always verified
+        uint32_t *table = calloc(1 << LZ4_HASH_BITS, sizeof(uint32_t));
+        const uint8_t *match_find_limit = base + source_size - LZ4_MATCH_FIND_LIMIT;
+        const uint8_t *match_end_limit = base + source_size - LZ4_LAST_LITERALS;
+        const uint8_t *input = base + 1;
+        while (input < match_find_limit)
+        {
+            // look up and replace the last position of the current word
+            uint32_t hash = lz4_hash(lz4_read_u32(input));
+            const uint8_t *reference = base + table[hash];
+            table[hash] = (uint32_t)(input - base);
+
+            // skip ahead faster the longer no match has been found, as the data is likely incompressible
+            if (reference >= input ||
+                input - reference > LZ4_MAX_DISTANCE ||
+                lz4_read_u32(reference) != lz4_read_u32(input))
+            {
+                input += 1 + ((input - anchor) >> 6);
+                continue;
+            }
+
+            // extend the match backwards into the pending literals, then forwards as far as possible
+            while (input > anchor && reference > base && input[-1] == reference[-1])
+            {
+                input--;
+                reference--;
+            }
+
+            const uint8_t *match_end = input + LZ4_MIN_MATCH;
+            const uint8_t *reference_end = reference + LZ4_MIN_MATCH;
+            while (match_end < match_end_limit && *match_end == *reference_end)
+            {
+                match_end++;
+                reference_end++;
+            }
+
+            // write the sequence up to and including the match
+            output = lz4_write_sequence(anchor,
+                                        input - anchor,
+                                        input - reference,
+                                        match_end - input,
+                                        output);
+
+            // continue after the match, recording a position within it to improve following matches
+            input = match_end;
+            anchor = input;
+            if (input < match_find_limit)
+                table[lz4_hash(lz4_read_u32(input - 2))] = (uint32_t)(input - 2 - base);
+        }
+
+        free(table);
+    }
+
+    // write the remaining literals as the final sequence
+    output = lz4_write_sequence(anchor, (base + source_size) - anchor, 0, 0, output);
+    return output - (uint8_t *)destination;
+}
+
+/// Read a length which continues in additional bytes after its token nibble was saturated.
+/// @param input The pointer to the pointer to read the continuation bytes at, which is advanced past them.
+/// @param input_end The end of the block being read.
+/// @param length The pointer to the length to add the continuation bytes to.
+/// @return Whether or not the length was read without reaching the end of the block.
+bool lz4_read_length(const uint8_t **input, const uint8_t *input_end, size_t *length)
+{
+    uint8_t byte;
+    do
+    {
+        if (*input >= input_end)
+            return false;
+
+        byte = *(*input)++;
+        *length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+bool lz4_decompress(const void *source,
+                    size_t source_size,
+                    void *destination,
+                    size_t destination_size)
+{
+    const uint8_t *input = source;
+    const uint8_t *input_end = input + source_size;
+    uint8_t *output = destination;
+    uint8_t *output_end = output + destination_size;
+    while (true)
+    {
+        // token
+        if (input >= input_end)
+            return false;
+
+        uint8_t token = *input++;
+
+        // literals
+        size_t num_literals = token >> 4;
+        if (num_literals == LZ4_RUN_MASK && !lz4_read_length(&input, input_end, &num_literals))
+            return false;
+        if (num_literals > (size_t)(input_end - input) || num_literals > (size_t)(output_end - output))
+            return false;
+
+        memcpy(output, input, num_literals);
+        input += num_literals;
+        output += num_literals;
+
+        // the final sequence ends at the end of the block and has no match
+        if (input == input_end)
+            break;
+
+        // match
+        if (input_end - input < 2)
+            return false;
+
+        size_t offset = input[0] | (input[1] << 8);
+        input += 2;
+        if (offset == 0 || offset > (size_t)(output - (uint8_t *)destination))
+            return false;
+
+        size_t match_length = token & LZ4_RUN_MASK;
+        if (match_length == LZ4_RUN_MASK && !lz4_read_length(&input, input_end, &match_length))
+            return false;
+
+        match_length += LZ4_MIN_MATCH;
+        if (match_length > (size_t)(output_end - output))
+            return false;
+
+        // copy the match
+        // overlapping matches repeat the bytes between the reference and output,
+        // so copy in chunks which double in size as more of the repetition becomes available
+        size_t distance = offset;
+        size_t num_copied = 0;
+        while (num_copied < match_length)
+        {
+            size_t chunk = distance;
+            if (chunk > match_length - num_copied)
+                chunk = match_length - num_copied;
+
+            memcpy(output + num_copied, output + num_copied - distance, chunk);
+            num_copied += chunk;
+            distance *= 2;
+        }
+
+        output += match_length;
+    }
+
+    return output == output_end;
+}
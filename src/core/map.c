@@ -0,0 +1,237 @@
+#include "map.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef WINDOWS
+#include <windows.h>
+#elif LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// MARK: - Functions
+
+bool map_try_init(struct map_t *map, const char *path)
+{
+    const void *data = NULL;
+    size_t size = 0;
+    void *mapping_handle = NULL;
+
+    // windows
+    #ifdef WINDOWS
+    // open the given file
+    HANDLE file = CreateFileA(path,
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    // get the size of the file
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    size = (size_t)file_size.QuadPart;
+
+    // map the file
+    // empty files cannot be mapped, so leave them without a mapping
+    if (size > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL)
+        {
+            // keep the error of the failed mapping rather than that of closing the file
+            DWORD error = GetLastError();
+            CloseHandle(file);
+            SetLastError(error);
+            return false;
+        }
+
+        data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        mapping_handle = mapping;
+    }
+
+    // the mapping holds its own reference to the file, so the handle can be closed immediately
+    CloseHandle(file);
+    // linux
+    #elif LINUX
+    // open the given file
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    // get the size of the file
+    struct stat file_stat;
+    fstat(file, &file_stat);
+    size = (size_t)file_stat.st_size;
+
+    // map the file
+    // empty files cannot be mapped, so leave them without a mapping
+    // the mapping holds its own reference to the file, so the descriptor can be closed immediately
+    if (size > 0)
+    {
+        void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping == MAP_FAILED)
+        {
+            // keep the error of the failed mapping rather than that of closing the file
+            int error = errno;
+            close(file);
+            errno = error;
+            return false;
+        }
+
+        data = mapping;
+    }
+
+    close(file);
+    #endif
+
+    // initialize the given map
+    map->data = data;
+    map->size = size;
+    map->mapping_handle = mapping_handle;
+    map->is_copy = false;
+    return true;
+}
+
+bool map_try_init_copy(struct map_t *map, const char *path)
+{
+    unsigned char *data = NULL;
+    size_t size = 0;
+
+    // windows
+    #ifdef WINDOWS
+    // open the given file, allowing it to be replaced or deleted while it is being read
+    HANDLE file = CreateFileA(path,
+                              GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    // get the size of the file
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    size = (size_t)file_size.QuadPart;
+
+    // read the entire file
+    // empty files have nothing to read, so leave them without contents
+    if (size > 0)
+    {
+        data = malloc(size);
+        size_t num_read = 0;
+        while (num_read < size)
+        {
+            DWORD chunk_size = (size - num_read > 0x40000000) ? 0x40000000 : (DWORD)(size - num_read);
+            DWORD chunk_read = 0;
+            BOOL is_read = ReadFile(file, data + num_read, chunk_size, &chunk_read, NULL);
+            if (!is_read || chunk_read == 0)
+            {
+                // keep the error of the failed read rather than that of closing the file
+                // a file which shrinks while it is being read reports no error, so it is reported as reaching the end of the file
+                DWORD error = is_read ? ERROR_HANDLE_EOF : GetLastError();
+                free(data);
+                CloseHandle(file);
+                SetLastError(error);
+                return false;
+            }
+
+            num_read += chunk_read;
+        }
+    }
+
+    CloseHandle(file);
+    // linux
+    #elif LINUX
+    // open the given file
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    // get the size of the file
+    struct stat file_stat;
+    fstat(file, &file_stat);
+    size = (size_t)file_stat.st_size;
+
+    // read the entire file
+    // empty files have nothing to read, so leave them without contents
+    if (size > 0)
+    {
+        data = malloc(size);
+        size_t num_read = 0;
+        while (num_read < size)
+        {
+            ssize_t chunk_read = read(file, data + num_read, size - num_read);
+            if (chunk_read <= 0)
+            {
+                // keep the error of the failed read rather than that of closing the file
+                // a file which shrinks while it is being read reports no error, so it is reported as an i/o error
+                int error = (chunk_read == 0) ? EIO : errno;
+                free(data);
+                close(file);
+                errno = error;
+                return false;
+            }
+
+            num_read += chunk_read;
+        }
+    }
+
+    close(file);
+    #endif
+
+    // initialize the given map
+    map->data = data;
+    map->size = size;
+    map->mapping_handle = NULL;
+    map->is_copy = true;
+    return true;
+}
+
+void map_init(struct map_t *map, const char *path)
+{
+    if (!map_try_init(map, path))
+    {
+        // the given path could not be opened or mapped, print the details and terminate
+        #ifdef WINDOWS
+        fprintf(stderr, "MAP ERROR: unable to map file at \"%s\" (0x%08lx)\n", path, GetLastError());
+        #elif LINUX
+        fprintf(stderr, "MAP ERROR: unable to map file at \"%s\" (%s)\n", path, strerror(errno));
+        #endif
+        exit(EXIT_FAILURE);
+    }
+}
+
+void map_deinit(struct map_t *map)
+{
+    // copies are allocated the same on every platform
+    if (map->is_copy)
+    {
+        free((void *)map->data);
+        return;
+    }
+
+    // windows
+    #ifdef WINDOWS
+    if (map->data != NULL)
+        UnmapViewOfFile(map->data);
+    if (map->mapping_handle != NULL)
+        CloseHandle(map->mapping_handle);
+    // linux
+    #elif LINUX
+    if (map->data != NULL)
+        munmap((void *)map->data, map->size);
+    #endif
+}
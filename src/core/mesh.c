@@ -1,5 +1,7 @@
 #include "mesh.h"
 
+#include "gl_state.h"
+
 // MARK: - Functions
 
 void mesh_init(struct mesh_t *mesh,
@@ -13,7 +15,7 @@ void mesh_init(struct mesh_t *mesh,
     // create the vertex array
     GLuint vertex_array_id;
     glGenVertexArrays(1, &vertex_array_id);
-    glBindVertexArray(vertex_array_id);
+    gl_state_bind_vertex_array(vertex_array_id);
 
     // create the vertex buffer
     GLuint vertex_buffer_id;
@@ -87,12 +89,13 @@ void mesh_deinit(struct mesh_t *mesh)
 {
     glDeleteBuffers(1, &mesh->vertex_buffer_id);
     glDeleteBuffers(1, &mesh->index_buffer_id);
+    gl_state_forget_vertex_array(mesh->vertex_array_id);
     glDeleteVertexArrays(1, &mesh->vertex_array_id);
 }
 
 void mesh_draw(const struct mesh_t *mesh)
 {
     // bind and draw all the vertices within the given mesh
-    glBindVertexArray(mesh->vertex_array_id);
+    gl_state_bind_vertex_array(mesh->vertex_array_id);
     glDrawElements(GL_TRIANGLES, mesh->num_indices, GL_UNSIGNED_INT, NULL);
 }
@@ -0,0 +1,297 @@
+#include "pak.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "bin.h"
+#include "hash.h"
+
+// MARK: - Macros
+
+/// The version of the pack file format.
+#define PAK_VERSION (1)
+
+/// The size of the header within a pack file, in bytes.
+///
+///  - ASCII `PAK` signature.
+///  - U8 version.
+///  - U32 entry count.
+///  - U64 table of contents pointer.
+#define PAK_HEADER_SIZE (16)
+
+/// The size of a single entry within the table of contents of a pack file, in bytes.
+///
+/// Entries are sorted by their name hash and then by their name, with no two entries having the same name.
+///  - U64 name hash, see `hash_fnv1a64_string`.
+///  - U64 contents pointer, aligned to `PAK_ALIGNMENT`.
+///  - U64 contents size.
+///  - U32 name pointer.
+///  - U32 name length, excluding the null terminator that follows it.
+#define PAK_ENTRY_SIZE (32)
+
+// MARK: - Data Structures
+
+/// A single entry being written to a pack file.
+struct pak_write_entry_t
+{
+    /// The 64-bit FNV-1a hash of this entry's name.
+    uint64_t name_hash;
+
+    /// The null-terminated name of this entry.
+    const char *name;
+
+    /// The index of this entry within the entries given to the writer.
+    unsigned int index;
+};
+
+// MARK: - Functions
+
+/// Get whether or not the given range is within the bounds of memory of the given size.
+/// @param offset The offset, in bytes, of the range.
+/// @param size The size, in bytes, of the range.
+/// @param bounds The total size, in bytes, of the memory to check the given range against.
+/// @return Whether or not the given range is within the given bounds.
+bool pak_range_is_valid(uint64_t offset, uint64_t size, size_t bounds)
+{
+    return offset <= bounds && size <= bounds - offset;
+}
+
+/// Compare the given name hashes and names for the ordering of entries within a pack file.
+/// @param a_hash The name hash of the first entry to compare.
+/// @param a_name The null-terminated name of the first entry to compare.
+/// @param b_hash The name hash of the second entry to compare.
+/// @param b_name The null-terminated name of the second entry to compare.
+/// @return The ordering of the given entries, as with `strcmp`.
+int pak_compare_names(uint64_t a_hash, const char *a_name, uint64_t b_hash, const char *b_name)
+{
+    if (a_hash != b_hash)
+        return (a_hash < b_hash) ? -1 : 1;
+
+    return strcmp(a_name, b_name);
+}
+
+/// Terminate the program due to the given pack file at the given filesystem path being invalid.
+/// @param path The filesystem path of the invalid pack file.
+/// @param reason A human readable description of why the pack file is invalid.
+void pak_throw_invalid(const char *path, const char *reason)
+{
+    fprintf(stderr, "PAK ERROR: invalid pak file at \"%s\" (%s)\n", path, reason);
+    exit(EXIT_FAILURE);
+}
+
+void pak_init(struct pak_t *pak, const char *path)
+{
+    // map the given file
+    struct map_t map;
+    map_init(&map, path);
+    const unsigned char *data = map.data;
+    size_t size = map.size;
+    struct bin_reader_t reader;
+    bin_reader_init(&reader, data, size);
+
+    // read the header
+    const unsigned char *signature = bin_reader_read_bytes(&reader, 3);
+    unsigned int version = bin_reader_read_u8(&reader);
+    unsigned int num_entries = bin_reader_read_u32(&reader);
+    uint64_t entries_pointer = bin_reader_read_u64(&reader);
+    if (reader.error || memcmp(signature, "PAK", 3) != 0)
+        pak_throw_invalid(path, "invalid signature");
+    if (version != PAK_VERSION)
+        pak_throw_invalid(path, "unsupported version");
+    if (!pak_range_is_valid(entries_pointer, (uint64_t)num_entries * PAK_ENTRY_SIZE, size))
+        pak_throw_invalid(path, "table of contents out of bounds");
+
+    // read the table of contents
+    // pointers are resolved once here so that lookups do not need to touch the file's table again
+    struct pak_entry_t *entries = malloc(num_entries * sizeof(struct pak_entry_t));
+    for (unsigned int i = 0; i < num_entries; i++)
+    {
+        bin_reader_seek(&reader, entries_pointer + ((size_t)i * PAK_ENTRY_SIZE));
+        uint64_t name_hash = bin_reader_read_u64(&reader);
+        uint64_t contents_pointer = bin_reader_read_u64(&reader);
+        uint64_t contents_size = bin_reader_read_u64(&reader);
+        uint64_t name_pointer = bin_reader_read_u32(&reader);
+        uint64_t name_length = bin_reader_read_u32(&reader);
+
+        // validate the entry
+        // the name must be followed by its null terminator so that it can be used in place
+        if (!pak_range_is_valid(contents_pointer, contents_size, size))
+            pak_throw_invalid(path, "entry contents out of bounds");
+        if (contents_pointer % PAK_ALIGNMENT != 0)
+            pak_throw_invalid(path, "entry contents are not aligned");
+        if (!pak_range_is_valid(name_pointer, name_length + 1, size) || data[name_pointer + name_length] != '\0')
+            pak_throw_invalid(path, "entry name out of bounds");
+
+        const char *name = (const char *)(data + name_pointer);
+        if (strlen(name) != name_length || hash_fnv1a64_string(name) != name_hash)
+            pak_throw_invalid(path, "entry name does not match its hash");
+
+        // ensure that the entries are in order, which also ensures that their names are unique
+        if (i > 0 && pak_compare_names(entries[i - 1].name_hash, entries[i - 1].name, name_hash, name) >= 0)
+            pak_throw_invalid(path, "table of contents is not sorted");
+
+        struct pak_entry_t *entry = &entries[i];
+        entry->name_hash = name_hash;
+        entry->name = name;
+        entry->data = data + contents_pointer;
+        entry->size = contents_size;
+    }
+
+    // initialize the given archive
+    pak->path = strdup(path);
+    pak->map = map;
+    pak->num_entries = num_entries;
+    pak->entries = entries;
+}
+
+void pak_deinit(struct pak_t *pak)
+{
+    free(pak->entries);
+    free(pak->path);
+    map_deinit(&pak->map);
+}
+
+const struct pak_entry_t *pak_find(const struct pak_t *pak, const char *name)
+{
+    // find the first entry with the given name's hash
+    uint64_t name_hash = hash_fnv1a64_string(name);
+    unsigned int low = 0, high = pak->num_entries;
+    while (low < high)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (pak->entries[middle].name_hash < name_hash)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    // compare the names of every entry with the same hash
+    for (unsigned int i = low; i < pak->num_entries && pak->entries[i].name_hash == name_hash; i++)
+    {
+        if (strcmp(pak->entries[i].name, name) == 0)
+            return &pak->entries[i];
+    }
+
+    return NULL;
+}
+
+const void *pak_get(const struct pak_t *pak, const char *name, size_t *size)
+{
+    const struct pak_entry_t *entry = pak_find(pak, name);
+    if (entry == NULL)
+    {
+        // the entry does not exist, print the details and terminate
+        fprintf(stderr, "PAK ERROR: no entry named \"%s\" within pak file at \"%s\"\n", name, pak->path);
+        exit(EXIT_FAILURE);
+    }
+
+    *size = entry->size;
+    return entry->data;
+}
+
+/// Compare the given entries being written for sorting.
+///
+/// This is used as the comparison function when sorting the table of contents of a pack file being written.
+/// @param a The pointer to the first entry to compare.
+/// @param b The pointer to the second entry to compare.
+/// @return The ordering of the given entries, as with `strcmp`.
+int pak_compare_write_entries(const void *a, const void *b)
+{
+    const struct pak_write_entry_t *a_entry = a;
+    const struct pak_write_entry_t *b_entry = b;
+    return pak_compare_names(a_entry->name_hash, a_entry->name, b_entry->name_hash, b_entry->name);
+}
+
+void pak_write(FILE *file,
+               unsigned int num_entries,
+               const char *const *names,
+               const void *const *data,
+               const size_t *sizes)
+{
+    // sort the entries
+    struct pak_write_entry_t *entries = malloc(num_entries * sizeof(struct pak_write_entry_t));
+    for (unsigned int i = 0; i < num_entries; i++)
+    {
+        entries[i].name_hash = hash_fnv1a64_string(names[i]);
+        entries[i].name = names[i];
+        entries[i].index = i;
+    }
+
+    qsort(entries, num_entries, sizeof(struct pak_write_entry_t), pak_compare_write_entries);
+    for (unsigned int i = 1; i < num_entries; i++)
+    {
+        if (pak_compare_write_entries(&entries[i - 1], &entries[i]) == 0)
+        {
+            // the names are not unique, print the details and terminate
+            fprintf(stderr, "PAK ERROR: multiple entries named \"%s\"\n", entries[i].name);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // calculate the pointers
+    // the names follow the table of contents, and each entry's contents follow the names in sorted order
+    uint64_t header_pointer = (uint64_t)ftell(file);
+    uint64_t entries_pointer = header_pointer + PAK_HEADER_SIZE;
+    uint64_t names_pointer = entries_pointer + ((uint64_t)num_entries * PAK_ENTRY_SIZE);
+
+    struct buffer_t buffer;
+    buffer_init(&buffer);
+
+    struct bin_writer_t writer;
+    bin_writer_init_buffer(&writer, &buffer);
+
+    // write the header
+    bin_writer_write_bytes(&writer, "PAK", 3);
+    bin_writer_write_u8(&writer, PAK_VERSION);
+    bin_writer_write_u32(&writer, num_entries);
+    bin_writer_write_u64(&writer, entries_pointer);
+
+    // write the table of contents
+    uint64_t name_pointer = names_pointer;
+    uint64_t contents_pointer = names_pointer;
+    for (unsigned int i = 0; i < num_entries; i++)
+        contents_pointer += strlen(entries[i].name) + 1;
+
+    uint64_t *contents_pointers = malloc(num_entries * sizeof(uint64_t));
+    for (unsigned int i = 0; i < num_entries; i++)
+    {
+        const struct pak_write_entry_t *entry = &entries[i];
+        size_t name_length = strlen(entry->name);
+        contents_pointer = (contents_pointer + PAK_ALIGNMENT - 1) & ~(uint64_t)(PAK_ALIGNMENT - 1);
+        contents_pointers[i] = contents_pointer;
+
+        bin_writer_write_u64(&writer, entry->name_hash);
+        bin_writer_write_u64(&writer, contents_pointer);
+        bin_writer_write_u64(&writer, sizes[entry->index]);
+        bin_writer_write_u32(&writer, name_pointer);
+        bin_writer_write_u32(&writer, name_length);
+
+        name_pointer += name_length + 1;
+        contents_pointer += sizes[entry->index];
+    }
+
+    // write the names
+    for (unsigned int i = 0; i < num_entries; i++)
+        bin_writer_write_bytes(&writer, entries[i].name, strlen(entries[i].name) + 1);
+
+    buffer_write(&buffer, file);
+    buffer_deinit(&buffer);
+
+    // write the contents of each entry, padding up to its aligned pointer
+    static const unsigned char padding[PAK_ALIGNMENT] = { 0 };
+    uint64_t pointer = name_pointer;
+    for (unsigned int i = 0; i < num_entries; i++)
+    {
+        const struct pak_write_entry_t *entry = &entries[i];
+        if (contents_pointers[i] > pointer)
+            fwrite(padding, contents_pointers[i] - pointer, 1, file);
+        if (sizes[entry->index] > 0)
+            fwrite(data[entry->index], sizes[entry->index], 1, file);
+
+        pointer = contents_pointers[i] + sizes[entry->index];
+    }
+
+    free(contents_pointers);
+    free(entries);
+}
@@ -0,0 +1,480 @@
+#include "pixel.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PIXEL_X86 1
+#include <immintrin.h>
+#else
+#define PIXEL_X86 0
+#endif
+
+// MARK: - Variables
+
+/// The kernel implementations which are currently used.
+///
+/// This is selected once on first use by `pixel_init_kernels`.
+static enum pixel_kernels_t pixel_kernels = PIXEL_KERNELS_SCALAR;
+
+/// The once control guarding the selection of `pixel_kernels`.
+static pthread_once_t pixel_kernels_once = PTHREAD_ONCE_INIT;
+
+// MARK: - Scalar Kernels
+
+/// Premultiply the given 8-bit channel by the given 8-bit alpha, rounding to the nearest value.
+///
+/// This is an exact division by 255, which the vector kernels perform identically on 16-bit lanes.
+/// @param channel The channel to premultiply.
+/// @param alpha The alpha to premultiply the given channel by.
+/// @return The premultiplied channel.
+uint8_t pixel_premultiply_channel(unsigned int channel, unsigned int alpha)
+{
+    unsigned int product = channel * alpha + 128;
+    return (product + (product >> 8)) >> 8;
+}
+
+void pixel_rgb_to_rgba_scalar(const uint8_t *source, uint8_t *destination, size_t num_pixels)
+{
+    for (size_t i = 0; i < num_pixels; i++, source += 3, destination += 4)
+    {
+        destination[0] = source[0];
+        destination[1] = source[1];
+        destination[2] = source[2];
+        destination[3] = 255;
+    }
+}
+
+void pixel_premultiply_alpha_scalar(uint8_t *data, size_t num_pixels)
+{
+    for (size_t i = 0; i < num_pixels; i++, data += 4)
+    {
+        unsigned int alpha = data[3];
+        data[0] = pixel_premultiply_channel(data[0], alpha);
+        data[1] = pixel_premultiply_channel(data[1], alpha);
+        data[2] = pixel_premultiply_channel(data[2], alpha);
+    }
+}
+
+void pixel_swap_scalar(uint8_t *a, uint8_t *b, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        uint8_t value = a[i];
+        a[i] = b[i];
+        b[i] = value;
+    }
+}
+
+void pixel_swizzle_scalar(const uint8_t *source, uint8_t *destination, size_t num_pixels, const unsigned char order[4])
+{
+    for (size_t i = 0; i < num_pixels; i++, source += 4, destination += 4)
+    {
+        uint8_t pixel[4] = { source[0], source[1], source[2], source[3] };
+        destination[0] = pixel[order[0]];
+        destination[1] = pixel[order[1]];
+        destination[2] = pixel[order[2]];
+        destination[3] = pixel[order[3]];
+    }
+}
+
+/// Quantize the given 8-bit channel to the given number of bits, rounding to the nearest value.
+/// @param channel The channel to quantize.
+/// @param num_bits The number of bits to quantize the given channel to.
+/// @return The quantized channel.
+uint16_t pixel_quantize_channel(unsigned int channel, unsigned int num_bits)
+{
+    unsigned int max = (1u << num_bits) - 1;
+    return (channel * max + 127) / 255;
+}
+
+/// Write the given 16-bit packed pixel to the given destination as a little-endian value.
+///
+/// The bytes are written individually, so the destination may be unaligned and the layout does not depend on the host.
+/// @param destination The first byte to write the given pixel to.
+/// @param value The packed pixel to write.
+void pixel_write_u16(uint8_t *destination, uint16_t value)
+{
+    destination[0] = value & 0xff;
+    destination[1] = value >> 8;
+}
+
+void pixel_pack_rgba_scalar(const uint8_t *source, uint8_t *destination, size_t num_pixels, enum pixel_packing_t packing)
+{
+    for (size_t i = 0; i < num_pixels; i++)
+    {
+        const uint8_t *rgba = &source[i * 4];
+        uint16_t packed;
+        switch (packing)
+        {
+            case PIXEL_PACKING_R8:
+                destination[i] = rgba[0];
+                break;
+            case PIXEL_PACKING_A8:
+                destination[i] = rgba[3];
+                break;
+            case PIXEL_PACKING_RG8:
+                destination[i * 2 + 0] = rgba[0];
+                destination[i * 2 + 1] = rgba[1];
+                break;
+            case PIXEL_PACKING_RGB565:
+                packed = (pixel_quantize_channel(rgba[0], 5) << 11) |
+                         (pixel_quantize_channel(rgba[1], 6) << 5) |
+                         pixel_quantize_channel(rgba[2], 5);
+                pixel_write_u16(&destination[i * 2], packed);
+                break;
+            case PIXEL_PACKING_RGBA4444:
+                packed = (pixel_quantize_channel(rgba[0], 4) << 12) |
+                         (pixel_quantize_channel(rgba[1], 4) << 8) |
+                         (pixel_quantize_channel(rgba[2], 4) << 4) |
+                         pixel_quantize_channel(rgba[3], 4);
+                pixel_write_u16(&destination[i * 2], packed);
+                break;
+            case PIXEL_PACKING_RGB5A1:
+                packed = (pixel_quantize_channel(rgba[0], 5) << 11) |
+                         (pixel_quantize_channel(rgba[1], 5) << 6) |
+                         (pixel_quantize_channel(rgba[2], 5) << 1) |
+                         (rgba[3] >= 128);
+                pixel_write_u16(&destination[i * 2], packed);
+                break;
+        }
+    }
+}
+
+// MARK: - SSE2 Kernels
+
+#if PIXEL_X86
+
+__attribute__((target("sse2")))
+size_t pixel_rgb_to_rgba_sse2(const uint8_t *source, uint8_t *destination, size_t num_pixels)
+{
+    // sse2 has no byte shuffle, so each pixel is read as an unaligned word which includes the next pixel's first byte
+    // the extra byte is replaced with opaque alpha, so the last pixel is left to the scalar kernel to avoid reading past the end
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    size_t i = 0;
+    for (; i + 5 <= num_pixels; i += 4, source += 12, destination += 16)
+    {
+        uint32_t words[4];
+        memcpy(&words[0], source + 0, 4);
+        memcpy(&words[1], source + 3, 4);
+        memcpy(&words[2], source + 6, 4);
+        memcpy(&words[3], source + 9, 4);
+
+        __m128i pixels = _mm_set_epi32(words[3], words[2], words[1], words[0]);
+        _mm_storeu_si128((__m128i *)destination, _mm_or_si128(pixels, alpha));
+    }
+
+    return i;
+}
+
+__attribute__((target("sse2")))
+size_t pixel_premultiply_alpha_sse2(uint8_t *data, size_t num_pixels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi16(128);
+    const __m128i alpha_mask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    size_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4, data += 16)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i *)data);
+        __m128i halves[2] =
+        {
+            _mm_unpacklo_epi8(pixels, zero),
+            _mm_unpackhi_epi8(pixels, zero),
+        };
+
+        for (int h = 0; h < 2; h++)
+        {
+            // broadcast each pixel's alpha across its four lanes, then divide the products by 255 exactly
+            __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(halves[h], 0xff), 0xff);
+            __m128i product = _mm_add_epi16(_mm_mullo_epi16(halves[h], alpha), rounding);
+            __m128i premultiplied = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+            halves[h] = _mm_or_si128(_mm_and_si128(alpha_mask, halves[h]), _mm_andnot_si128(alpha_mask, premultiplied));
+        }
+
+        _mm_storeu_si128((__m128i *)data, _mm_packus_epi16(halves[0], halves[1]));
+    }
+
+    return i;
+}
+
+__attribute__((target("sse2")))
+size_t pixel_swap_sse2(uint8_t *a, uint8_t *b, size_t size)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i a_bytes = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i b_bytes = _mm_loadu_si128((const __m128i *)(b + i));
+        _mm_storeu_si128((__m128i *)(a + i), b_bytes);
+        _mm_storeu_si128((__m128i *)(b + i), a_bytes);
+    }
+
+    return i;
+}
+
+__attribute__((target("sse2")))
+size_t pixel_swizzle_sse2(const uint8_t *source, uint8_t *destination, size_t num_pixels, const unsigned char order[4])
+{
+    // sse2 has no byte shuffle, so each destination channel is shifted out of its source channel within each pixel's word
+    const __m128i channel_mask = _mm_set1_epi32(0xff);
+    __m128i source_shifts[4], destination_shifts[4];
+    for (int c = 0; c < 4; c++)
+    {
+        source_shifts[c] = _mm_cvtsi32_si128(order[c] * 8);
+        destination_shifts[c] = _mm_cvtsi32_si128(c * 8);
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4, source += 16, destination += 16)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i *)source);
+        __m128i swizzled = _mm_setzero_si128();
+        for (int c = 0; c < 4; c++)
+        {
+            __m128i channel = _mm_and_si128(_mm_srl_epi32(pixels, source_shifts[c]), channel_mask);
+            swizzled = _mm_or_si128(swizzled, _mm_sll_epi32(channel, destination_shifts[c]));
+        }
+
+        _mm_storeu_si128((__m128i *)destination, swizzled);
+    }
+
+    return i;
+}
+
+// MARK: - AVX2 Kernels
+
+__attribute__((target("avx2")))
+size_t pixel_rgb_to_rgba_avx2(const uint8_t *source, uint8_t *destination, size_t num_pixels)
+{
+    // each iteration loads 32 bytes for 8 pixels, moving the second four pixels into the upper lane and then shuffling within lanes
+    // the load reads past the 24 bytes that are used, so the last few pixels are left to the narrower kernels
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                             0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32(0xff000000);
+    size_t i = 0;
+    for (; i + 11 <= num_pixels; i += 8, source += 24, destination += 32)
+    {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)source);
+        __m256i pixels = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(bytes, lanes), shuffle);
+        _mm256_storeu_si256((__m256i *)destination, _mm256_or_si256(pixels, alpha));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t pixel_premultiply_alpha_avx2(uint8_t *data, size_t num_pixels)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rounding = _mm256_set1_epi16(128);
+    const __m256i alpha_mask = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+    size_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8, data += 32)
+    {
+        // unpacking and packing both work within lanes, so the pixels end up back in their original order
+        __m256i pixels = _mm256_loadu_si256((const __m256i *)data);
+        __m256i halves[2] =
+        {
+            _mm256_unpacklo_epi8(pixels, zero),
+            _mm256_unpackhi_epi8(pixels, zero),
+        };
+
+        for (int h = 0; h < 2; h++)
+        {
+            __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(halves[h], 0xff), 0xff);
+            __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(halves[h], alpha), rounding);
+            __m256i premultiplied = _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+            halves[h] = _mm256_or_si256(_mm256_and_si256(alpha_mask, halves[h]), _mm256_andnot_si256(alpha_mask, premultiplied));
+        }
+
+        _mm256_storeu_si256((__m256i *)data, _mm256_packus_epi16(halves[0], halves[1]));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t pixel_swap_avx2(uint8_t *a, uint8_t *b, size_t size)
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i a_bytes = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i b_bytes = _mm256_loadu_si256((const __m256i *)(b + i));
+        _mm256_storeu_si256((__m256i *)(a + i), b_bytes);
+        _mm256_storeu_si256((__m256i *)(b + i), a_bytes);
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t pixel_swizzle_avx2(const uint8_t *source, uint8_t *destination, size_t num_pixels, const unsigned char order[4])
+{
+    // build the byte shuffle for the given order, which is the same for every pixel
+    uint8_t indices[32];
+    for (int b = 0; b < 32; b++)
+        indices[b] = ((b % 16) & ~3) + order[b % 4];
+
+    const __m256i shuffle = _mm256_loadu_si256((const __m256i *)indices);
+    size_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8, source += 32, destination += 32)
+    {
+        __m256i pixels = _mm256_loadu_si256((const __m256i *)source);
+        _mm256_storeu_si256((__m256i *)destination, _mm256_shuffle_epi8(pixels, shuffle));
+    }
+
+    return i;
+}
+
+#endif
+
+// MARK: - Functions
+
+/// Select the best kernel implementations supported by the host.
+///
+/// This is called once on first use through `pixel_kernels_once`.
+void pixel_init_kernels()
+{
+    if (pixel_kernels_are_supported(PIXEL_KERNELS_AVX2))
+        pixel_kernels = PIXEL_KERNELS_AVX2;
+    else if (pixel_kernels_are_supported(PIXEL_KERNELS_SSE2))
+        pixel_kernels = PIXEL_KERNELS_SSE2;
+    else
+        pixel_kernels = PIXEL_KERNELS_SCALAR;
+}
+
+bool pixel_kernels_are_supported(enum pixel_kernels_t kernels)
+{
+    switch (kernels)
+    {
+        case PIXEL_KERNELS_SCALAR:
+            return true;
+        #if PIXEL_X86
+        case PIXEL_KERNELS_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case PIXEL_KERNELS_AVX2:
+            return __builtin_cpu_supports("avx2");
+        #endif
+        default:
+            return false;
+    }
+}
+
+enum pixel_kernels_t pixel_get_kernels()
+{
+    pthread_once(&pixel_kernels_once, pixel_init_kernels);
+    return pixel_kernels;
+}
+
+void pixel_set_kernels(enum pixel_kernels_t kernels)
+{
+    assert(pixel_kernels_are_supported(kernels));
+    pthread_once(&pixel_kernels_once, pixel_init_kernels);
+    pixel_kernels = kernels;
+}
+
+void pixel_rgb_to_rgba(const void *source, void *destination, size_t num_pixels)
+{
+    // each vector kernel converts as many pixels as it can, and leaves the rest to the next narrowest kernel
+    const uint8_t *rgb = source;
+    uint8_t *rgba = destination;
+    size_t done = 0;
+    switch (pixel_get_kernels())
+    {
+        #if PIXEL_X86
+        case PIXEL_KERNELS_AVX2:
+            done = pixel_rgb_to_rgba_avx2(rgb, rgba, num_pixels);
+            // fallthrough
+        case PIXEL_KERNELS_SSE2:
+            done += pixel_rgb_to_rgba_sse2(rgb + done * 3, rgba + done * 4, num_pixels - done);
+            break;
+        #endif
+        default:
+            break;
+    }
+
+    pixel_rgb_to_rgba_scalar(rgb + done * 3, rgba + done * 4, num_pixels - done);
+}
+
+void pixel_premultiply_alpha(void *data, size_t num_pixels)
+{
+    uint8_t *rgba = data;
+    size_t done = 0;
+    switch (pixel_get_kernels())
+    {
+        #if PIXEL_X86
+        case PIXEL_KERNELS_AVX2:
+            done = pixel_premultiply_alpha_avx2(rgba, num_pixels);
+            // fallthrough
+        case PIXEL_KERNELS_SSE2:
+            done += pixel_premultiply_alpha_sse2(rgba + done * 4, num_pixels - done);
+            break;
+        #endif
+        default:
+            break;
+    }
+
+    pixel_premultiply_alpha_scalar(rgba + done * 4, num_pixels - done);
+}
+
+void pixel_flip_rows(void *data, size_t row_size, size_t num_rows)
+{
+    // swap each row in the top half with its mirror in the bottom half, the middle row of an odd count stays in place
+    enum pixel_kernels_t kernels = pixel_get_kernels();
+    uint8_t *rows = data;
+    for (size_t row = 0; row < num_rows / 2; row++)
+    {
+        uint8_t *a = rows + row * row_size;
+        uint8_t *b = rows + ((num_rows - 1) - row) * row_size;
+        size_t done = 0;
+        switch (kernels)
+        {
+            #if PIXEL_X86
+            case PIXEL_KERNELS_AVX2:
+                done = pixel_swap_avx2(a, b, row_size);
+                // fallthrough
+            case PIXEL_KERNELS_SSE2:
+                done += pixel_swap_sse2(a + done, b + done, row_size - done);
+                break;
+            #endif
+            default:
+                break;
+        }
+
+        pixel_swap_scalar(a + done, b + done, row_size - done);
+    }
+}
+
+void pixel_swizzle(const void *source, void *destination, size_t num_pixels, const unsigned char order[4])
+{
+    assert(order[0] < 4 && order[1] < 4 && order[2] < 4 && order[3] < 4);
+
+    const uint8_t *input = source;
+    uint8_t *output = destination;
+    size_t done = 0;
+    switch (pixel_get_kernels())
+    {
+        #if PIXEL_X86
+        case PIXEL_KERNELS_AVX2:
+            done = pixel_swizzle_avx2(input, output, num_pixels, order);
+            // fallthrough
+        case PIXEL_KERNELS_SSE2:
+            done += pixel_swizzle_sse2(input + done * 4, output + done * 4, num_pixels - done, order);
+            break;
+        #endif
+        default:
+            break;
+    }
+
+    pixel_swizzle_scalar(input + done * 4, output + done * 4, num_pixels - done, order);
+}
+
+void pixel_pack_rgba(const void *source, void *destination, size_t num_pixels, enum pixel_packing_t packing)
+{
+    pixel_pack_rgba_scalar(source, destination, num_pixels, packing);
+}
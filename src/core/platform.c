@@ -5,13 +5,32 @@
 #include <string.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <pthread.h>
 
 #ifdef WINDOWS
+#include <windows.h>
 #include <libloaderapi.h>
+#include <sysinfoapi.h>
 #elif LINUX
 #include <linux/limits.h>
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <time.h>
 #endif
 
+// MARK: - Variables
+
+/// The absolute filesystem path of the directory containing the running program's executable.
+///
+/// This is resolved once on first use by `platform_init_directory`, as the executable cannot move while it is running.
+/// Allocated.
+static char *platform_directory = NULL;
+
+/// The once control guarding the resolution of `platform_directory`,
+/// so that relative paths can be resolved concurrently from any thread.
+static pthread_once_t platform_directory_once = PTHREAD_ONCE_INIT;
+
 // MARK: - Functions
 
 char *platform_get_path()
@@ -23,8 +42,10 @@ char *platform_get_path()
     GetModuleFileName(NULL, buffer, sizeof(buffer));
     // linux
     #elif LINUX
+    // readlink does not null-terminate the path, so terminate it manually
     char buffer[PATH_MAX];
-    readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+    ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+    buffer[(length > 0) ? length : 0] = '\0';
     #endif
 
     // copy the path into an allocated buffer and return it
@@ -35,11 +56,21 @@ char *platform_get_path()
     return path;
 }
 
+/// Resolve `platform_directory` from the running program's executable path.
+///
+/// This is used as the once routine for `platform_directory_once`.
+void platform_init_directory()
+{
+    char *executable_path = platform_get_path();
+    platform_directory = strdup(dirname(executable_path));
+    free(executable_path);
+}
+
 char *platform_get_relative_path(const char *relative_path)
 {
     // get the directory containing the executable
-    char *executable_path = platform_get_path();
-    char *directory = dirname(executable_path);
+    pthread_once(&platform_directory_once, platform_init_directory);
+    const char *directory = platform_directory;
 
     // create the full path and return it
     // directory + slash + relative path + null terminator
@@ -47,4 +78,147 @@ char *platform_get_relative_path(const char *relative_path)
     char *path = (char *)malloc(path_size * sizeof(char));
     sprintf(path, "%s/%s", directory, relative_path);
     return path;
-}
\ No newline at end of file
+}
+
+unsigned int platform_get_num_processors()
+{
+    // read the processor count
+    // windows
+    #ifdef WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long count = (long)info.dwNumberOfProcessors;
+    // linux
+    #elif LINUX
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    #endif
+
+    // the count may be unavailable, in which case assume there is only one processor
+    return (count > 0) ? (unsigned int)count : 1;
+}
+
+double platform_get_time()
+{
+    // read the monotonic clock
+    // windows
+    #ifdef WINDOWS
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return ((double)counter.QuadPart * 1000.0) / (double)frequency.QuadPart;
+    // linux
+    #elif LINUX
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return ((double)time.tv_sec * 1000.0) + ((double)time.tv_nsec / 1000000.0);
+    #endif
+}
+
+/// Compare the two given file names for sorting.
+///
+/// This is used as the comparison function when sorting directory listings.
+/// @param a The pointer to the first file name to compare.
+/// @param b The pointer to the second file name to compare.
+/// @return The ordering of the given file names, as with `strcmp`.
+int platform_compare_file_names(const void *a, const void *b)
+{
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+/// Append a copy of the given file name to the given growable list of file names.
+/// @param files The pointer to the list of file names to append to, which may be reallocated.
+/// @param count The pointer to the total number of file names within the given list.
+/// @param capacity The pointer to the total number of file names that the given list can hold before reallocating.
+/// @param name The file name to append a copy of.
+void platform_append_file_name(char ***files,
+                               unsigned int *count,
+                               unsigned int *capacity,
+                               const char *name)
+{
+    if (*count >= *capacity)
+    {
+        *capacity *= 2;
+        *files = realloc(*files, *capacity * sizeof(char *));
+    }
+
+    (*files)[(*count)++] = strdup(name);
+}
+
+char **platform_get_directory_files(const char *path, unsigned int *num_files)
+{
+    unsigned int count = 0, capacity = 16;
+    char **files = malloc(capacity * sizeof(char *));
+
+    // read the file names
+    // windows
+    #ifdef WINDOWS
+    char pattern[MAX_PATH];
+    snprintf(pattern, sizeof(pattern), "%s\\*", path);
+
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        // the given path could not be opened, print the details and terminate
+        fprintf(stderr, "PLATFORM ERROR: unable to open directory at \"%s\" (0x%08lx)\n", path, GetLastError());
+        exit(EXIT_FAILURE);
+    }
+
+    do
+    {
+        if (!(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            platform_append_file_name(&files, &count, &capacity, entry.cFileName);
+    } while (FindNextFileA(find, &entry));
+
+    FindClose(find);
+    // linux
+    #elif LINUX
+    DIR *directory = opendir(path);
+    if (directory == NULL)
+    {
+        // the given path could not be opened, print the details and terminate
+        fprintf(stderr, "PLATFORM ERROR: unable to open directory at \"%s\" (%s)\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL)
+    {
+        // directory entries do not always report their type, so stat them to find regular files
+        char entry_path[PATH_MAX];
+        struct stat entry_stat;
+        snprintf(entry_path, sizeof(entry_path), "%s/%s", path, entry->d_name);
+        if (stat(entry_path, &entry_stat) == 0 && S_ISREG(entry_stat.st_mode))
+            platform_append_file_name(&files, &count, &capacity, entry->d_name);
+    }
+
+    closedir(directory);
+    #endif
+
+    // sort the names
+    qsort(files, count, sizeof(char *), platform_compare_file_names);
+
+    *num_files = count;
+    return files;
+}
+
+void platform_replace_file(const char *source_path, const char *destination_path)
+{
+    // windows
+    #ifdef WINDOWS
+    if (!MoveFileExA(source_path, destination_path, MOVEFILE_REPLACE_EXISTING))
+    {
+        // the file could not be replaced, print the details and terminate
+        fprintf(stderr, "PLATFORM ERROR: unable to replace file at \"%s\" (0x%08lx)\n", destination_path, GetLastError());
+        exit(EXIT_FAILURE);
+    }
+    // linux
+    #elif LINUX
+    if (rename(source_path, destination_path) != 0)
+    {
+        // the file could not be replaced, print the details and terminate
+        fprintf(stderr, "PLATFORM ERROR: unable to replace file at \"%s\" (%s)\n", destination_path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    #endif
+}
@@ -2,13 +2,252 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <zlib.h>
 #include <libpng16/png.h>
 
 #include "texture.h"
+#include "buffer.h"
+#include "pak.h"
+#include "jobs.h"
+
+// MARK: - Data Structures
+
+/// The source of a PNG file being read from memory.
+struct png_memory_source_t
+{
+    /// The first byte of the PNG file.
+    const unsigned char *data;
+
+    /// The total size of the PNG file, in bytes.
+    size_t size;
+
+    /// The offset, in bytes, of the next byte to read within the PNG file.
+    size_t offset;
+};
 
 // MARK: - Functions
 
+size_t png_get_pixel_size(enum png_format_t format)
+{
+    switch (format)
+    {
+        case PNG_RGBU8:  return 3;
+        case PNG_RGBAU8: return 4;
+    }
+}
+
+/// Read the given number of bytes from the given PNG reader's memory source into the given buffer.
+///
+/// This is used as the read function for readers of PNG files within memory.
+/// If there are not enough bytes remaining within the memory source then a PNG error is raised.
+/// @param reader The reader to read from.
+/// @param buffer The buffer to read the bytes into.
+/// @param length The total number of bytes to read.
+void png_memory_read(png_structp reader, png_bytep buffer, png_size_t length)
+{
+    struct png_memory_source_t *source = (struct png_memory_source_t *)png_get_io_ptr(reader);
+    if (length > source->size - source->offset)
+        png_error(reader, "read past the end of the memory source");
+
+    memcpy(buffer, source->data + source->offset, length);
+    source->offset += length;
+}
+
+/// Attempt to get the known format of the given PNG colour type, after the reader transforms have been applied.
+/// @param colour_type The libpng colour type to get the format of.
+/// @param format The pointer to set the value of to the format of the given colour type.
+/// @return Whether or not the given colour type can be converted to a known format.
+bool png_format_try_from_colour_type(int colour_type, enum png_format_t *format)
+{
+    switch (colour_type)
+    {
+        case PNG_COLOR_TYPE_RGB:  *format = PNG_RGBU8; return true;
+        case PNG_COLOR_TYPE_RGBA: *format = PNG_RGBAU8; return true;
+        default:                  return false;
+    }
+}
+
+/// Get the known format of the given PNG colour type, after the reader transforms have been applied.
+///
+/// If the given colour type cannot be converted to a known format then the program terminates.
+/// @param colour_type The libpng colour type to get the format of.
+/// @return The format of the given colour type.
+enum png_format_t png_format_from_colour_type(int colour_type)
+{
+    enum png_format_t format;
+    if (!png_format_try_from_colour_type(colour_type, &format))
+    {
+        // the colour type could not be converted to a texture format, print the details and terminate
+        fprintf(stderr, "TEXTURE ERROR: could not convert png colour type %i to texture format\n", colour_type);
+        exit(EXIT_FAILURE);
+    }
+
+    return format;
+}
+
+/// Read the chunks of the PNG file being read by the given reader up to its data,
+/// and configure the reader to decode the data to a known format.
+///
+/// The reader is configured to force conversion to 8-bit RGB(A):
+///  - Strip the second byte from 16-bit channels.
+///  - Use 1-byte channels for 1, 2, or 4-bit channels.
+///  - Expand data to 24-bit RGB/32-bit RGBA/8-bit greyscale/16-bit greyscale with alpha.
+///  - Deinterlace the data, so that every row is complete once all passes have been read.
+///
+/// It is expected that the given reader is within a frame that handles libpng errors.
+/// @param reader The reader to read with, which has already had its IO configured and signature consumed.
+/// @param info The info for the given reader.
+/// @param width The pointer to set the value of to the width of the PNG, in pixels.
+/// @param height The pointer to set the value of to the height of the PNG, in pixels.
+/// @param colour_type The pointer to set the value of to the libpng colour type of the PNG's data, after the transforms.
+/// @return The total number of passes that must be read over the rows of the PNG's data.
+int png_reader_read_colour_info(png_structp reader,
+                                png_infop info,
+                                unsigned int *width,
+                                unsigned int *height,
+                                int *colour_type)
+{
+    png_read_info(reader, info);
+    png_set_strip_16(reader);
+    png_set_packing(reader);
+    png_set_expand(reader);
+    int num_passes = png_set_interlace_handling(reader);
+    png_read_update_info(reader, info);
+
+    // only 8-bit depth should be possible
+    assert(png_get_bit_depth(reader, info) == 8);
+
+    *width = png_get_image_width(reader, info);
+    *height = png_get_image_height(reader, info);
+    *colour_type = png_get_color_type(reader, info);
+    return num_passes;
+}
+
+/// Read the chunks of the PNG file being read by the given reader up to its data, and configure the reader to decode the data to a known format.
+///
+/// See `png_reader_read_colour_info` for the transforms that are applied.
+/// It is expected that the given reader is within a frame that handles libpng errors.
+/// If the PNG file's colour type cannot be converted to a known format then the program terminates.
+/// @param reader The reader to read with, which has already had its IO configured and signature consumed.
+/// @param info The info for the given reader.
+/// @param width The pointer to set the value of to the width of the PNG, in pixels.
+/// @param height The pointer to set the value of to the height of the PNG, in pixels.
+/// @param format The pointer to set the value of to the format of the PNG's data.
+/// @return The total number of passes that must be read over the rows of the PNG's data.
+int png_reader_read_info(png_structp reader,
+                         png_infop info,
+                         unsigned int *width,
+                         unsigned int *height,
+                         enum png_format_t *format)
+{
+    int colour_type;
+    int num_passes = png_reader_read_colour_info(reader, info, width, height, &colour_type);
+    *format = png_format_from_colour_type(colour_type);
+    return num_passes;
+}
+
+/// Decode the data of the PNG file being read by the given reader into the given destination, and finish reading.
+///
+/// Rows are decoded one at a time directly into their final position, flipping them from top-to-bottom to bottom-to-top
+/// for easier usage in OpenGL, so the destination is written once per pass and never needs to be copied afterwards.
+/// It is expected that `png_reader_read_info` has already been called with the given reader,
+/// and that the given reader is within a frame that handles libpng errors.
+/// @param reader The reader to read with.
+/// @param num_passes The total number of passes to read, as returned by `png_reader_read_info`.
+/// @param height The height of the PNG, in pixels.
+/// @param row_size The size of a single row of the PNG's data, in bytes.
+/// @param destination The first byte of the memory to decode the PNG's data into.
+/// This must be at least the given height multiplied by the given row size, in bytes.
+void png_reader_read_rows(png_structp reader,
+                          int num_passes,
+                          unsigned int height,
+                          size_t row_size,
+                          void *destination)
+{
+    unsigned char *rows = destination;
+    for (int pass = 0; pass < num_passes; pass++)
+    {
+        for (unsigned int row = 0; row < height; row++)
+            png_read_row(reader, rows + (((size_t)(height - 1) - row) * row_size), NULL);
+    }
+
+    png_read_end(reader, NULL);
+}
+
+/// Open a reader for the PNG file within the given memory.
+///
+/// If there is no valid PNG signature at the start of the given memory then the program terminates.
+/// @param source The memory source to initialize for the new reader.
+/// It is expected that this source is available until the new reader is destroyed.
+/// @param data The first byte of the PNG file.
+/// @param size The total size of the PNG file, in bytes.
+/// @param info The pointer to set the value of to the info for the new reader.
+/// @return The new reader, which has had its IO configured and signature consumed.
+png_structp png_open_memory(struct png_memory_source_t *source, const void *data, size_t size, png_infop *info)
+{
+    // check the signature
+    png_byte signature[8];
+    if (size < sizeof(signature) || png_sig_cmp(data, 0, sizeof(signature) / sizeof(png_byte)))
+    {
+        // the signature check failed, print the details and terminate
+        fprintf(stderr, "PNG ERROR: invalid signature\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // open the png file for reading
+    source->data = data;
+    source->size = size;
+    source->offset = sizeof(signature);
+
+    png_structp reader = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    *info = png_create_info_struct(reader);
+    png_set_read_fn(reader, source, png_memory_read);
+    png_set_sig_bytes(reader, sizeof(signature));
+    return reader;
+}
+
+/// Initialize the given PNG using the given reader, which has already had its IO configured and signature consumed.
+///
+/// The PNG's data is allocated once and decoded directly into, rather than decoding into libpng's own rows and copying.
+/// The given reader and info are destroyed during this function.
+/// If there is an error while reading the PNG file then the program terminates.
+/// If the PNG file's colour type cannot be converted to a known format then the program terminates.
+/// @param png The PNG to initialize.
+/// @param reader The reader to read the PNG file with.
+/// @param info The info for the given reader.
+void png_init_reader(struct png_t *png, png_structp reader, png_infop info)
+{
+    // terminate on any errors raised by libpng
+    if (setjmp(png_jmpbuf(reader)))
+    {
+        fprintf(stderr, "PNG ERROR: unable to read png file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // read the header
+    unsigned int width, height;
+    enum png_format_t format;
+    int num_passes = png_reader_read_info(reader, info, &width, &height, &format);
+
+    // decode the png files data
+    size_t row_size = (size_t)width * png_get_pixel_size(format);
+    void *data = malloc(height * row_size);
+    png_reader_read_rows(reader, num_passes, height, row_size, data);
+
+    // initialize the given png
+    png->width = width;
+    png->height = height;
+    png->format = format;
+    png->data = data;
+
+    // close the png file
+    png_destroy_read_struct(&reader, &info, NULL);
+}
+
 void png_init_file(struct png_t *png, FILE *file)
 {
     // check the signature
@@ -24,54 +263,136 @@ void png_init_file(struct png_t *png, FILE *file)
     // open the png file for reading
     png_structp reader = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     png_infop info = png_create_info_struct(reader);
-    setjmp(png_jmpbuf(reader));
     png_init_io(reader, file);
     png_set_sig_bytes(reader, sizeof(signature));
 
     // read the png file
-    // setup transforms to force conversion to 8-bit rgb(a) when reading
-    //  - PNG_TRANSFORM_STRIP_16: strip the second byte from 16-bit channels
-    //  - PNG_TRANSFORM_PACKING: use 1-byte channels for 1, 2, or 4-bit channels
-    //  - PNG_TRANSFORM_EXPAND: expand data to 24-bit rgb/32-bit rgba/8-bit greyscale/16-bit greyscale with alpha
-    png_read_png(reader, info, PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_PACKING | PNG_TRANSFORM_EXPAND, NULL);
+    png_init_reader(png, reader, info);
+}
 
-    // read the header
-    png_uint_32 width, height;
-    int bit_depth, colour_type;
-    png_get_IHDR(reader, info, &width, &height, &bit_depth, &colour_type, NULL, NULL, NULL);
+void png_init_memory(struct png_t *png, const void *data, size_t size)
+{
+    // open the png file for reading
+    // the source only needs to live until the reader is destroyed at the end of the read
+    struct png_memory_source_t source;
+    png_infop info;
+    png_structp reader = png_open_memory(&source, data, size, &info);
 
-    // only 8-bit depth should be possible
-    assert(bit_depth == 8);
+    // read the png file
+    png_init_reader(png, reader, info);
+}
 
-    // convert the png files colour type to a known format
-    enum png_format_t format;
-    switch (colour_type)
+void png_init_pak(struct png_t *png, const struct pak_t *pak, const char *name)
+{
+    size_t size;
+    const void *data = pak_get(pak, name, &size);
+    png_init_memory(png, data, size);
+}
+
+void png_read_header_memory(const void *data,
+                            size_t size,
+                            unsigned int *width,
+                            unsigned int *height,
+                            enum png_format_t *format)
+{
+    // open the png file for reading
+    struct png_memory_source_t source;
+    png_infop info;
+    png_structp reader = png_open_memory(&source, data, size, &info);
+    if (setjmp(png_jmpbuf(reader)))
     {
-        case PNG_COLOR_TYPE_RGB:  format = PNG_RGBU8; break;
-        case PNG_COLOR_TYPE_RGBA: format = PNG_RGBAU8; break;
-        default:
-            // the colour type could not be converted to a texture format, print the details and terminate
-            fprintf(stderr, "TEXTURE ERROR: could not convert png colour type %i to texture format\n", colour_type);
-            exit(EXIT_FAILURE);
-            break;
+        fprintf(stderr, "PNG ERROR: unable to read png header\n");
+        exit(EXIT_FAILURE);
     }
 
-    // get the png files data
-    // flip the rows from top-to-bottom to bottom-to-top for easier usage in opengl
-    size_t row_size = png_get_rowbytes(reader, info);
-    void *data = malloc(height * row_size);
-    png_bytepp rows = png_get_rows(reader, info);
-    for (int row = 0; row < height; row++)
-        memcpy(data + (row * row_size), rows[(height - 1) - row], row_size);
+    // read the chunks up to the image data, applying the same transforms as a full read
+    // this allows the resulting format to be known without decoding anything
+    png_reader_read_info(reader, info, width, height, format);
 
-    // initialize the given png
-    png->width = width;
-    png->height = height;
-    png->format = format;
-    png->data = data;
+    // close the png file
+    png_destroy_read_struct(&reader, &info, NULL);
+}
+
+bool png_try_read_header_memory(const void *data,
+                                size_t size,
+                                unsigned int *width,
+                                unsigned int *height,
+                                enum png_format_t *format)
+{
+    // check the signature up front, as opening a reader terminates on an invalid signature
+    if (size < 8 || png_sig_cmp(data, 0, 8))
+        return false;
+
+    // open the png file for reading
+    struct png_memory_source_t source;
+    png_infop info;
+    png_structp reader = png_open_memory(&source, data, size, &info);
+    if (setjmp(png_jmpbuf(reader)))
+    {
+        png_destroy_read_struct(&reader, &info, NULL);
+        return false;
+    }
+
+    // read the chunks up to the image data, as within `png_read_header_memory`
+    int colour_type;
+    png_reader_read_colour_info(reader, info, width, height, &colour_type);
 
     // close the png file
     png_destroy_read_struct(&reader, &info, NULL);
+    return png_format_try_from_colour_type(colour_type, format);
+}
+
+void png_decode_memory(const void *data, size_t size, void *destination, size_t destination_size)
+{
+    // open the png file for reading
+    struct png_memory_source_t source;
+    png_infop info;
+    png_structp reader = png_open_memory(&source, data, size, &info);
+    if (setjmp(png_jmpbuf(reader)))
+    {
+        fprintf(stderr, "PNG ERROR: unable to read png file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // read the header and ensure that the data exactly fills the given destination
+    unsigned int width, height;
+    enum png_format_t format;
+    int num_passes = png_reader_read_info(reader, info, &width, &height, &format);
+    size_t row_size = (size_t)width * png_get_pixel_size(format);
+    if (height * row_size != destination_size)
+    {
+        fprintf(stderr, "PNG ERROR: png data is %zu bytes, expected %zu bytes\n", height * row_size, destination_size);
+        exit(EXIT_FAILURE);
+    }
+
+    // decode the png files data directly into the given destination
+    png_reader_read_rows(reader, num_passes, height, row_size, destination);
+
+    // close the png file
+    png_destroy_read_struct(&reader, &info, NULL);
+}
+
+/// Get the PNG representation of the given texture format.
+///
+/// Compressed and compact formats are represented by the format that they are decompressed or widened into when read.
+/// @param format The texture format to get the PNG representation of.
+/// @return The PNG representation of the given texture format.
+enum png_format_t png_format_from_texture(enum texture_format_t format)
+{
+    switch (format)
+    {
+        case TEXTURE_RGBU8:    return PNG_RGBU8;
+        case TEXTURE_RGBAU8:   return PNG_RGBAU8;
+        case TEXTURE_BC1:      return PNG_RGBU8;
+        case TEXTURE_BC3:      return PNG_RGBAU8;
+        case TEXTURE_BC7:      return PNG_RGBAU8;
+        case TEXTURE_R8:       return PNG_RGBU8;
+        case TEXTURE_A8:       return PNG_RGBU8;
+        case TEXTURE_RG8:      return PNG_RGBU8;
+        case TEXTURE_RGB565:   return PNG_RGBU8;
+        case TEXTURE_RGBA4444: return PNG_RGBAU8;
+        case TEXTURE_RGB5A1:   return PNG_RGBAU8;
+    }
 }
 
 void png_init_texture(struct png_t *png, const struct texture_t *texture)
@@ -83,30 +404,28 @@ void png_init_texture(struct png_t *png, const struct texture_t *texture)
     texture_bind(texture, TEXTURE_INIT_UNIT);
 
     // get the opengl and png representations and pixel size of the given textures format
+    // compressed textures are decompressed and compact textures are widened by the driver while they are read
     GLenum gl_format, gl_type;
-    enum png_format_t png_format;
-    size_t pixel_size;
-    switch (texture->format)
+    enum png_format_t png_format = png_format_from_texture(texture->format);
+    switch (png_format)
     {
-        case TEXTURE_RGBU8:
+        case PNG_RGBU8:
             gl_format = GL_RGB;
             gl_type = GL_UNSIGNED_BYTE;
-            png_format = PNG_RGBU8;
-            pixel_size = 3;
             break;
-        case TEXTURE_RGBAU8:
+        case PNG_RGBAU8:
             gl_format = GL_RGBA;
             gl_type = GL_UNSIGNED_BYTE;
-            png_format = PNG_RGBAU8;
-            pixel_size = 4;
             break;
     }
 
     // read the given textures image
+    // rows are packed without padding so that they match the png
     unsigned int width = texture->width;
     unsigned int height = texture->height;
-    size_t data_size = width * height * pixel_size;
+    size_t data_size = (size_t)width * height * png_get_pixel_size(png_format);
     void *data = malloc(data_size);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
     glGetTexImage(GL_TEXTURE_2D, 0, gl_format, gl_type, data);
 
     // initialize the given png
@@ -116,35 +435,161 @@ void png_init_texture(struct png_t *png, const struct texture_t *texture)
     png->data = data;
 }
 
+void png_init_readback(struct png_t *png, struct texture_readback_t *readback)
+{
+    // copy the contents out of the mapped buffer, as it is only valid for the lifetime of the readback
+    enum png_format_t format = png_format_from_texture(readback->format);
+    size_t data_size = (size_t)readback->width * readback->height * png_get_pixel_size(format);
+    void *data = malloc(data_size);
+    memcpy(data, texture_readback_map(readback), data_size);
+
+    // initialize the given png
+    png->width = readback->width;
+    png->height = readback->height;
+    png->format = format;
+    png->data = data;
+}
+
+/// Convert the given linear light channel value to an 8-bit sRGB channel value.
+/// @param value The linear light value, from `0` to `1`.
+/// @return The 8-bit sRGB representation of the given value.
+unsigned char png_linear_to_srgb(float value)
+{
+    float srgb = (value <= 0.0031308f) ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+    if (srgb <= 0)
+        return 0;
+    if (srgb >= 1)
+        return 255;
+
+    return (unsigned char)(srgb * 255.0f + 0.5f);
+}
+
+void png_init_mipmap(struct png_t *png,
+                     const struct png_t *source,
+                     unsigned int width,
+                     unsigned int height)
+{
+    // ensure the given size fits within the given source
+    assert(width >= 1 && width <= (source->width + 1) / 2);
+    assert(height >= 1 && height <= (source->height + 1) / 2);
+
+    // build the table to convert srgb channels to linear light
+    float linear[256];
+    for (int i = 0; i < 256; i++)
+    {
+        float value = i / 255.0f;
+        linear[i] = (value <= 0.04045f) ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    // filter each pixel from its block within the given source
+    // both the source and new rows are bottom-to-top, so blocks are aligned to the bottom-left like the mip levels of a texture
+    size_t pixel_size = png_get_pixel_size(source->format);
+    bool has_alpha = source->format == PNG_RGBAU8;
+    const unsigned char *source_data = source->data;
+    unsigned char *data = malloc((size_t)width * height * pixel_size);
+    for (unsigned int y = 0; y < height; y++)
+    {
+        for (unsigned int x = 0; x < width; x++)
+        {
+            float colour[3] = { 0, 0, 0 };
+            float weight = 0;
+            unsigned int num_samples = 0;
+            for (unsigned int source_y = y * 2; source_y < y * 2 + 2 && source_y < source->height; source_y++)
+            {
+                for (unsigned int source_x = x * 2; source_x < x * 2 + 2 && source_x < source->width; source_x++)
+                {
+                    const unsigned char *sample = source_data + ((size_t)source_y * source->width + source_x) * pixel_size;
+                    float sample_weight = (has_alpha) ? sample[3] / 255.0f : 1.0f;
+                    for (int i = 0; i < 3; i++)
+                        colour[i] += linear[sample[i]] * sample_weight;
+
+                    weight += sample_weight;
+                    num_samples++;
+                }
+            }
+
+            // fully transparent blocks have no colour to average, so they become transparent black
+            unsigned char *pixel = data + ((size_t)y * width + x) * pixel_size;
+            for (int i = 0; i < 3; i++)
+                pixel[i] = png_linear_to_srgb((weight > 0) ? colour[i] / weight : 0);
+
+            if (has_alpha)
+                pixel[3] = (unsigned char)((weight / num_samples) * 255.0f + 0.5f);
+        }
+    }
+
+    // initialize the given png
+    png->width = width;
+    png->height = height;
+    png->format = source->format;
+    png->data = data;
+}
+
 void png_deinit(struct png_t *png)
 {
     free(png->data);
 }
 
-void png_write(struct png_t *png, FILE *file)
+/// Get the libpng filter mask of the given write filter.
+/// @param filter The filter to get the libpng mask of.
+/// @return The libpng mask of the given filter.
+int png_write_filter_to_png(enum png_write_filter_t filter)
 {
-    // open the png file for writing
-    png_structp writer = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-    png_infop info = png_create_info_struct(writer);
-    setjmp(png_jmpbuf(writer));
-    png_init_io(writer, file);
+    switch (filter)
+    {
+        case PNG_WRITE_FILTER_ADAPTIVE: return PNG_ALL_FILTERS;
+        case PNG_WRITE_FILTER_NONE:     return PNG_FILTER_NONE;
+        case PNG_WRITE_FILTER_SUB:      return PNG_FILTER_SUB;
+        case PNG_WRITE_FILTER_UP:       return PNG_FILTER_UP;
+        case PNG_WRITE_FILTER_AVERAGE:  return PNG_FILTER_AVG;
+        case PNG_WRITE_FILTER_PAETH:    return PNG_FILTER_PAETH;
+    }
+}
 
-    // get the png representations of the given pngs format,
-    // and calculate the size of each row for it, in bytes
-    int bit_depth, colour_type;
-    size_t row_size;
-    switch (png->format)
+/// Get the zlib strategy of the given write strategy.
+/// @param strategy The strategy to get the zlib strategy of.
+/// @return The zlib strategy of the given strategy.
+int png_write_strategy_to_zlib(enum png_write_strategy_t strategy)
+{
+    switch (strategy)
     {
-        case PNG_RGBU8:
-            bit_depth = 8;
-            colour_type = PNG_COLOR_TYPE_RGB;
-            row_size = png->width * 3;
-            break;
-        case PNG_RGBAU8:
-            bit_depth = 8;
-            colour_type = PNG_COLOR_TYPE_RGBA;
-            row_size = png->width * 4;
-            break;
+        case PNG_WRITE_STRATEGY_DEFAULT:      return Z_DEFAULT_STRATEGY;
+        case PNG_WRITE_STRATEGY_FILTERED:     return Z_FILTERED;
+        case PNG_WRITE_STRATEGY_HUFFMAN_ONLY: return Z_HUFFMAN_ONLY;
+        case PNG_WRITE_STRATEGY_RLE:          return Z_RLE;
+    }
+}
+
+/// Get the PNG colour type of the given format.
+/// @param format The format to get the colour type of.
+/// @return The PNG colour type of the given format, which is always 8-bit.
+int png_format_to_colour_type(enum png_format_t format)
+{
+    switch (format)
+    {
+        case PNG_RGBU8:  return PNG_COLOR_TYPE_RGB;
+        case PNG_RGBAU8: return PNG_COLOR_TYPE_RGBA;
+    }
+}
+
+/// Write the given PNG using the given writer, which has already had its IO configured.
+///
+/// The given writer and info are destroyed during this function.
+/// @param png The PNG to write.
+/// @param options The options to encode the PNG file with, or `NULL` to use the libpng defaults.
+/// @param writer The writer to write the PNG file with.
+/// @param info The info for the given writer.
+void png_write_writer(const struct png_t *png,
+                      const struct png_write_options_t *options,
+                      png_structp writer,
+                      png_infop info)
+{
+    // configure the encoding
+    if (options != NULL)
+    {
+        png_set_compression_level(writer, options->compression_level);
+        png_set_filter(writer, PNG_FILTER_TYPE_BASE, png_write_filter_to_png(options->filter));
+        png_set_compression_strategy(writer, png_write_strategy_to_zlib(options->strategy));
     }
 
     // write the header
@@ -152,8 +597,8 @@ void png_write(struct png_t *png, FILE *file)
                  info,
                  png->width,
                  png->height,
-                 bit_depth,
-                 colour_type,
+                 8,
+                 png_format_to_colour_type(png->format),
                  PNG_INTERLACE_NONE,
                  PNG_COMPRESSION_TYPE_BASE,
                  PNG_FILTER_TYPE_BASE);
@@ -162,6 +607,7 @@ void png_write(struct png_t *png, FILE *file)
 
     // write the data
     // the rows need to be flipped back to top-to-bottom
+    size_t row_size = (size_t)png->width * png_get_pixel_size(png->format);
     for (int row = 0; row < png->height; row++)
         png_write_row(writer, png->data + (((png->height - 1) - row) * row_size));
 
@@ -171,3 +617,390 @@ void png_write(struct png_t *png, FILE *file)
     // close the png file
     png_destroy_write_struct(&writer, &info);
 }
+
+/// Get the Paeth predictor of the given neighbouring bytes.
+/// @param left The corresponding byte of the pixel to the left.
+/// @param above The corresponding byte of the pixel above.
+/// @param above_left The corresponding byte of the pixel above and to the left.
+/// @return Whichever of the given bytes is closest to `left + above - above_left`.
+unsigned char png_strip_paeth(int left, int above, int above_left)
+{
+    int estimate = left + above - above_left;
+    int left_distance = abs(estimate - left);
+    int above_distance = abs(estimate - above);
+    int above_left_distance = abs(estimate - above_left);
+    if (left_distance <= above_distance && left_distance <= above_left_distance)
+        return left;
+    else if (above_distance <= above_left_distance)
+        return above;
+    else
+        return above_left;
+}
+
+/// Filter the given row with the given filter.
+/// @param filter The filter to apply, which must not be `PNG_WRITE_FILTER_ADAPTIVE`.
+/// @param row The first byte of the row to filter.
+/// @param previous The first byte of the row above the given row, which is zeroed for the first row.
+/// @param row_size The size of the given row, in bytes.
+/// @param pixel_size The size of a single pixel within the given row, in bytes.
+/// @param output The memory to write the filtered row to, starting with its filter type byte.
+/// This must be at least one byte larger than the given row.
+void png_strip_filter_row(enum png_write_filter_t filter,
+                          const unsigned char *row,
+                          const unsigned char *previous,
+                          size_t row_size,
+                          size_t pixel_size,
+                          unsigned char *output)
+{
+    // the first pixel of each row is filtered as if the pixels to its left were zero
+    unsigned char *filtered = output + 1;
+    switch (filter)
+    {
+        case PNG_WRITE_FILTER_ADAPTIVE:
+        case PNG_WRITE_FILTER_NONE:
+            output[0] = PNG_FILTER_VALUE_NONE;
+            memcpy(filtered, row, row_size);
+            break;
+        case PNG_WRITE_FILTER_SUB:
+            output[0] = PNG_FILTER_VALUE_SUB;
+            for (size_t i = 0; i < pixel_size; i++)
+                filtered[i] = row[i];
+            for (size_t i = pixel_size; i < row_size; i++)
+                filtered[i] = row[i] - row[i - pixel_size];
+            break;
+        case PNG_WRITE_FILTER_UP:
+            output[0] = PNG_FILTER_VALUE_UP;
+            for (size_t i = 0; i < row_size; i++)
+                filtered[i] = row[i] - previous[i];
+            break;
+        case PNG_WRITE_FILTER_AVERAGE:
+            output[0] = PNG_FILTER_VALUE_AVG;
+            for (size_t i = 0; i < pixel_size; i++)
+                filtered[i] = row[i] - (previous[i] >> 1);
+            for (size_t i = pixel_size; i < row_size; i++)
+                filtered[i] = row[i] - ((row[i - pixel_size] + previous[i]) >> 1);
+            break;
+        case PNG_WRITE_FILTER_PAETH:
+            output[0] = PNG_FILTER_VALUE_PAETH;
+            for (size_t i = 0; i < pixel_size; i++)
+                filtered[i] = row[i] - previous[i];
+            for (size_t i = pixel_size; i < row_size; i++)
+                filtered[i] = row[i] - png_strip_paeth(row[i - pixel_size], previous[i], previous[i - pixel_size]);
+            break;
+    }
+}
+
+/// Get the sum of the absolute values of the given filtered row, treating each byte as signed.
+///
+/// This is the heuristic that libpng uses to select a filter, as lower sums typically compress better.
+/// @param filtered The first byte of the filtered row, after its filter type byte.
+/// @param row_size The size of the given row, in bytes.
+/// @return The sum of the absolute values of the given filtered row.
+size_t png_strip_get_filtered_sum(const unsigned char *filtered, size_t row_size)
+{
+    size_t sum = 0;
+    for (size_t i = 0; i < row_size; i++)
+        sum += abs((signed char)filtered[i]);
+
+    return sum;
+}
+
+/// The shared state of the jobs encoding the strips of a PNG file.
+struct png_strip_encode_t
+{
+    /// The PNG being encoded.
+    const struct png_t *png;
+
+    /// The options that the PNG is being encoded with.
+    const struct png_write_options_t *options;
+
+    /// The total number of strips that the PNG is split into.
+    unsigned int num_strips;
+
+    /// The compressed data of each strip, indexed by strip.
+    struct buffer_t *strips;
+
+    /// The Adler-32 checksum of the filtered data of each strip, indexed by strip.
+    uLong *checksums;
+
+    /// The size of the filtered data of each strip, in bytes, indexed by strip.
+    size_t *filtered_sizes;
+};
+
+/// Get the first row, in file order, of the strip at the given index within a PNG being encoded in strips.
+/// @param encode The state of the PNG being encoded.
+/// @param index The index of the strip to get the first row of.
+/// This may be the total number of strips, for the end of the last strip.
+/// @return The index of the first row of the given strip, counting from the top of the PNG.
+unsigned int png_strip_get_first_row(const struct png_strip_encode_t *encode, unsigned int index)
+{
+    return (unsigned int)(((uint64_t)encode->png->height * index) / encode->num_strips);
+}
+
+/// Filter and compress the strip at the given index of a PNG being encoded in strips.
+///
+/// This is the job function used to encode strips concurrently.
+/// Each strip is compressed as a raw deflate stream, which is flushed to a byte boundary without being finished
+/// unless it is the last strip, so that the strips can be joined into a single stream.
+/// Rows are filtered against the row above them even across strips, as the whole PNG is available to every job.
+/// @param data The pointer to the `png_strip_encode_t` of the PNG being encoded.
+/// @param index The index of the strip to encode.
+void png_encode_strip(void *data, unsigned int index)
+{
+    struct png_strip_encode_t *encode = (struct png_strip_encode_t *)data;
+    const struct png_t *png = encode->png;
+    const struct png_write_options_t *options = encode->options;
+    size_t pixel_size = png_get_pixel_size(png->format);
+    size_t row_size = (size_t)png->width * pixel_size;
+    unsigned int first_row = png_strip_get_first_row(encode, index);
+    unsigned int end_row = png_strip_get_first_row(encode, index + 1);
+    bool is_last = index == encode->num_strips - 1;
+
+    // open the compressor
+    // raw deflate streams have no header or checksum of their own, these are written once around the joined stream
+    z_stream stream = { 0 };
+    if (deflateInit2(&stream,
+                     options->compression_level,
+                     Z_DEFLATED,
+                     -MAX_WBITS,
+                     8,
+                     png_write_strategy_to_zlib(options->strategy)) != Z_OK)
+    {
+        fprintf(stderr, "PNG ERROR: unable to initialize compressor\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // compress directly into the strip's buffer, which is sized for the worst case
+    // the bound covers a finished stream, so a few more bytes are reserved for the flush marker of non-final strips
+    size_t filtered_size = (size_t)(end_row - first_row) * (row_size + 1);
+    size_t capacity = deflateBound(&stream, filtered_size) + 16;
+    struct buffer_t *strip = &encode->strips[index];
+    stream.next_out = buffer_extend(strip, capacity);
+    stream.avail_out = capacity;
+
+    // filter and compress each row
+    // adaptive filtering tries every filter into its own candidate row and keeps the best
+    unsigned char *candidates = malloc(5 * (row_size + 1));
+    unsigned char *zeros = calloc(row_size, 1);
+    uLong checksum = adler32(0, NULL, 0);
+    for (unsigned int y = first_row; y < end_row; y++)
+    {
+        // rows are stored bottom-to-top, so flip them back to top-to-bottom
+        const unsigned char *row = png->data + ((size_t)(png->height - 1) - y) * row_size;
+        const unsigned char *previous = (y > 0) ? row + row_size : zeros;
+
+        unsigned char *filtered = candidates;
+        if (options->filter == PNG_WRITE_FILTER_ADAPTIVE)
+        {
+            size_t best_sum = SIZE_MAX;
+            for (int i = 0; i < 5; i++)
+            {
+                unsigned char *candidate = candidates + i * (row_size + 1);
+                png_strip_filter_row(PNG_WRITE_FILTER_NONE + i, row, previous, row_size, pixel_size, candidate);
+                size_t sum = png_strip_get_filtered_sum(candidate + 1, row_size);
+                if (sum < best_sum)
+                {
+                    best_sum = sum;
+                    filtered = candidate;
+                }
+            }
+        }
+        else
+        {
+            png_strip_filter_row(options->filter, row, previous, row_size, pixel_size, filtered);
+        }
+
+        checksum = adler32(checksum, filtered, row_size + 1);
+        stream.next_in = filtered;
+        stream.avail_in = row_size + 1;
+        deflate(&stream, Z_NO_FLUSH);
+    }
+
+    deflate(&stream, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+    strip->size -= stream.avail_out;
+    deflateEnd(&stream);
+
+    encode->checksums[index] = checksum;
+    encode->filtered_sizes[index] = filtered_size;
+    free(zeros);
+    free(candidates);
+}
+
+/// Append a PNG chunk of the given type with the given contents to the end of the given buffer.
+/// @param buffer The buffer to append the chunk to.
+/// @param type The four character type of the chunk.
+/// @param data The first byte of the contents of the chunk.
+/// @param size The total size of the contents of the chunk, in bytes.
+void png_buffer_append_chunk(struct buffer_t *buffer, const char *type, const void *data, size_t size)
+{
+    unsigned char length[4] = { size >> 24, size >> 16, size >> 8, size };
+    buffer_append(buffer, length, sizeof(length));
+    buffer_append(buffer, type, 4);
+    buffer_append(buffer, data, size);
+
+    // zlib treats a null pointer as a request for the initial value, so empty chunks must not be passed through
+    uLong crc = crc32(0, (const Bytef *)type, 4);
+    if (size > 0)
+        crc = crc32(crc, data, size);
+    unsigned char crc_bytes[4] = { crc >> 24, crc >> 16, crc >> 8, crc };
+    buffer_append(buffer, crc_bytes, sizeof(crc_bytes));
+}
+
+/// Append the given data as one or more IDAT chunks to the end of the given buffer.
+///
+/// Chunks are limited to 2^31 - 1 bytes, so large data is split across several chunks.
+/// @param buffer The buffer to append the chunks to.
+/// @param data The first byte of the data to append.
+/// @param size The total size of the data to append, in bytes.
+void png_buffer_append_data_chunks(struct buffer_t *buffer, const unsigned char *data, size_t size)
+{
+    const size_t max_chunk_size = 0x40000000;
+    do
+    {
+        size_t chunk_size = (size < max_chunk_size) ? size : max_chunk_size;
+        png_buffer_append_chunk(buffer, "IDAT", data, chunk_size);
+        data += chunk_size;
+        size -= chunk_size;
+    }
+    while (size > 0);
+}
+
+/// Write the given PNG to the end of the given buffer by encoding horizontal strips of it concurrently.
+/// @param png The PNG to write.
+/// @param options The options to encode the PNG file with.
+/// @param buffer The buffer to append the PNG file to.
+void png_write_strips(const struct png_t *png,
+                      const struct png_write_options_t *options,
+                      struct buffer_t *buffer)
+{
+    // there cannot be more strips than rows
+    unsigned int num_strips = options->num_strips;
+    if (num_strips > png->height)
+        num_strips = png->height;
+
+    // filter and compress all the strips concurrently
+    struct png_strip_encode_t encode =
+    {
+        .png = png,
+        .options = options,
+        .num_strips = num_strips,
+        .strips = malloc(num_strips * sizeof(struct buffer_t)),
+        .checksums = malloc(num_strips * sizeof(uLong)),
+        .filtered_sizes = malloc(num_strips * sizeof(size_t)),
+    };
+
+    for (unsigned int i = 0; i < num_strips; i++)
+        buffer_init(&encode.strips[i]);
+
+    struct jobs_t jobs;
+    jobs_init(&jobs, num_strips, 0, png_encode_strip, &encode);
+    jobs_deinit(&jobs);
+
+    // write the signature and header
+    static const unsigned char signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+    buffer_append(buffer, signature, sizeof(signature));
+
+    unsigned char header[13] =
+    {
+        png->width >> 24, png->width >> 16, png->width >> 8, png->width,
+        png->height >> 24, png->height >> 16, png->height >> 8, png->height,
+        8,
+        png_format_to_colour_type(png->format),
+        PNG_COMPRESSION_TYPE_BASE,
+        PNG_FILTER_TYPE_BASE,
+        PNG_INTERLACE_NONE,
+    };
+
+    png_buffer_append_chunk(buffer, "IHDR", header, sizeof(header));
+
+    // write the joined stream
+    // it is wrapped in a zlib header and the combined checksum of every strip's filtered data
+    int level_flags = (options->compression_level <= 1) ? 0 : (options->compression_level <= 5) ? 1 : (options->compression_level == 6) ? 2 : 3;
+    unsigned char stream_header[2] = { 0x78, level_flags << 6 };
+    stream_header[1] += 31 - ((stream_header[0] << 8) | stream_header[1]) % 31;
+    png_buffer_append_chunk(buffer, "IDAT", stream_header, sizeof(stream_header));
+
+    uLong checksum = adler32(0, NULL, 0);
+    for (unsigned int i = 0; i < num_strips; i++)
+    {
+        png_buffer_append_data_chunks(buffer, encode.strips[i].data, encode.strips[i].size);
+        checksum = adler32_combine(checksum, encode.checksums[i], encode.filtered_sizes[i]);
+        buffer_deinit(&encode.strips[i]);
+    }
+
+    unsigned char checksum_bytes[4] = { checksum >> 24, checksum >> 16, checksum >> 8, checksum };
+    png_buffer_append_chunk(buffer, "IDAT", checksum_bytes, sizeof(checksum_bytes));
+
+    // write the footer
+    png_buffer_append_chunk(buffer, "IEND", NULL, 0);
+
+    free(encode.filtered_sizes);
+    free(encode.checksums);
+    free(encode.strips);
+}
+
+/// Append the given bytes to the given PNG writer's buffer.
+///
+/// This is used as the write function for writers of PNG files to buffers.
+/// @param writer The writer to write to.
+/// @param data The bytes to append.
+/// @param length The total number of bytes to append.
+void png_buffer_write(png_structp writer, png_bytep data, png_size_t length)
+{
+    struct buffer_t *buffer = (struct buffer_t *)png_get_io_ptr(writer);
+    buffer_append(buffer, data, length);
+}
+
+/// Flush the given PNG writer's buffer.
+///
+/// This is used as the flush function for writers of PNG files to buffers, where there is nothing to flush.
+/// @param writer The writer to flush.
+void png_buffer_flush(png_structp writer)
+{
+}
+
+void png_write_buffer(const struct png_t *png,
+                      const struct png_write_options_t *options,
+                      struct buffer_t *buffer)
+{
+    // encode large pngs in strips when requested
+    if (options != NULL && options->num_strips > 1)
+    {
+        png_write_strips(png, options, buffer);
+        return;
+    }
+
+    // open the png file for writing
+    png_structp writer = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png_create_info_struct(writer);
+    setjmp(png_jmpbuf(writer));
+    png_set_write_fn(writer, buffer, png_buffer_write, png_buffer_flush);
+
+    // write the png file
+    png_write_writer(png, options, writer, info);
+}
+
+void png_write(const struct png_t *png,
+               const struct png_write_options_t *options,
+               FILE *file)
+{
+    // strips are assembled in memory, so they are written through a buffer
+    if (options != NULL && options->num_strips > 1)
+    {
+        struct buffer_t buffer;
+        buffer_init(&buffer);
+        png_write_strips(png, options, &buffer);
+        buffer_write(&buffer, file);
+        buffer_deinit(&buffer);
+        return;
+    }
+
+    // open the png file for writing
+    png_structp writer = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png_create_info_struct(writer);
+    setjmp(png_jmpbuf(writer));
+    png_init_io(writer, file);
+
+    // write the png file
+    png_write_writer(png, options, writer, info);
+}
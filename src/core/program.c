@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "gl_state.h"
+
 // MARK: - Functions
 
 /// Attempt to locate the given named uniform within the given program, and return the result.
@@ -92,12 +94,13 @@ void program_deinit(struct program_t *program)
     for (int i = 0; i < program->num_cached_uniforms; i++)
         free(program->cached_uniforms[i].name);
 
+    gl_state_forget_program(program->id);
     glDeleteProgram(program->id);
 }
 
 void program_use(struct program_t *program)
 {
-    glUseProgram(program->id);
+    gl_state_use_program(program->id);
 }
 
 void program_set_sampler2D(struct program_t *program,
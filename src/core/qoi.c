@@ -0,0 +1,430 @@
+#include "qoi.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "buffer.h"
+
+// MARK: - Macros
+
+/// The size of the header of a QOI file, in bytes.
+///
+///  - ASCII `qoif` signature.
+///  - U32 big-endian width.
+///  - U32 big-endian height.
+///  - U8 channel count, `3` or `4`.
+///  - U8 colour space, `0` for sRGB with linear alpha or `1` for all channels linear.
+#define QOI_HEADER_SIZE (14)
+
+/// The size of the end marker of a QOI file, in bytes.
+///
+/// This is seven zero bytes followed by a single `1` byte.
+#define QOI_END_MARKER_SIZE (8)
+
+/// The maximum number of pixels within a QOI image, which bounds the size of decoded data from untrusted files.
+#define QOI_MAX_PIXELS (400000000)
+
+/// The number of recently seen pixels within the index of a QOI encoder or decoder.
+#define QOI_INDEX_SIZE (64)
+
+/// The maximum length of a single run chunk, in pixels.
+#define QOI_MAX_RUN (62)
+
+/// The chunk containing a full RGB pixel, keeping the previous alpha.
+#define QOI_OP_RGB (0xfe)
+
+/// The chunk containing a full RGBA pixel.
+#define QOI_OP_RGBA (0xff)
+
+/// The mask of the two bit tag of every other chunk.
+#define QOI_MASK_2 (0xc0)
+
+/// The chunk containing an index into the recently seen pixels.
+#define QOI_OP_INDEX (0x00)
+
+/// The chunk containing a small difference of each colour channel from the previous pixel.
+#define QOI_OP_DIFF (0x40)
+
+/// The chunk containing a green difference from the previous pixel, and red and blue differences relative to it.
+#define QOI_OP_LUMA (0x80)
+
+/// The chunk containing a run of the previous pixel.
+#define QOI_OP_RUN (0xc0)
+
+// MARK: - Data Structures
+
+/// A single RGBA pixel within a QOI encoder or decoder.
+struct qoi_pixel_t
+{
+    uint8_t r, g, b, a;
+};
+
+// MARK: - Functions
+
+/// Get the number of channels that the given format is stored with within a QOI file.
+/// @param format The format to get the number of channels of.
+/// @return The number of channels of the given format.
+unsigned int qoi_get_channels(enum png_format_t format)
+{
+    return (unsigned int)png_get_pixel_size(format);
+}
+
+/// Get the index of the given pixel within the recently seen pixels.
+/// @param pixel The pixel to get the index of.
+/// @return The index of the given pixel.
+unsigned int qoi_hash(struct qoi_pixel_t pixel)
+{
+    return (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % QOI_INDEX_SIZE;
+}
+
+/// Get whether or not the given pixels are identical.
+/// @param a The first pixel to compare.
+/// @param b The second pixel to compare.
+/// @return Whether or not the given pixels are identical.
+bool qoi_pixels_equal(struct qoi_pixel_t a, struct qoi_pixel_t b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+/// Terminate the program due to an invalid QOI file.
+/// @param reason A human readable description of why the file is invalid.
+void qoi_throw_invalid(const char *reason)
+{
+    fprintf(stderr, "QOI ERROR: invalid qoi file (%s)\n", reason);
+    exit(EXIT_FAILURE);
+}
+
+void qoi_read_header_memory(const void *data,
+                            size_t size,
+                            unsigned int *width,
+                            unsigned int *height,
+                            enum png_format_t *format)
+{
+    const unsigned char *bytes = data;
+    if (size < QOI_HEADER_SIZE + QOI_END_MARKER_SIZE || memcmp(bytes, "qoif", 4) != 0)
+        qoi_throw_invalid("invalid signature");
+
+    // the header is big-endian, unlike most binary files
+    uint32_t header_width = ((uint32_t)bytes[4] << 24) | ((uint32_t)bytes[5] << 16) | ((uint32_t)bytes[6] << 8) | bytes[7];
+    uint32_t header_height = ((uint32_t)bytes[8] << 24) | ((uint32_t)bytes[9] << 16) | ((uint32_t)bytes[10] << 8) | bytes[11];
+    unsigned int channels = bytes[12];
+    if (header_width == 0 || header_height == 0 || header_height >= QOI_MAX_PIXELS / header_width)
+        qoi_throw_invalid("invalid size");
+
+    switch (channels)
+    {
+        case 3: *format = PNG_RGBU8; break;
+        case 4: *format = PNG_RGBAU8; break;
+        default:
+            qoi_throw_invalid("unsupported channel count");
+    }
+
+    *width = header_width;
+    *height = header_height;
+}
+
+/// Decode the chunks of a QOI image with the given number of channels into the given destination.
+///
+/// Chunks are never read past the given size, and the end marker which follows them provides enough padding
+/// that the largest chunk can always be read in full once its first byte is within the given size.
+/// If the chunks end before every pixel has been decoded then the program terminates.
+/// @param chunks The first byte of the chunks to decode.
+/// @param chunks_size The total size of the given chunks, in bytes, excluding the end marker.
+/// @param width The width of the image, in pixels.
+/// @param height The height of the image, in pixels.
+/// @param channels The number of channels of the image, and of each pixel written to the given destination.
+/// @param destination The first byte of the memory to decode the image into, with rows ordered bottom-to-top.
+void qoi_decode_chunks(const unsigned char *chunks,
+                       size_t chunks_size,
+                       unsigned int width,
+                       unsigned int height,
+                       unsigned int channels,
+                       unsigned char *destination)
+{
+    struct qoi_pixel_t index[QOI_INDEX_SIZE] = { 0 };
+    struct qoi_pixel_t pixel = { .r = 0, .g = 0, .b = 0, .a = 255 };
+    size_t offset = 0;
+    unsigned int run = 0;
+    size_t row_size = (size_t)width * channels;
+    for (unsigned int y = 0; y < height; y++)
+    {
+        // qoi rows are top-to-bottom, so each is written to its flipped position
+        unsigned char *output = destination + ((size_t)(height - 1) - y) * row_size;
+        for (unsigned int x = 0; x < width; x++)
+        {
+            if (run > 0)
+            {
+                run--;
+            }
+            else
+            {
+                if (offset >= chunks_size)
+                    qoi_throw_invalid("unexpected end of data");
+
+                unsigned int op = chunks[offset++];
+                if (op == QOI_OP_RGB)
+                {
+                    pixel.r = chunks[offset++];
+                    pixel.g = chunks[offset++];
+                    pixel.b = chunks[offset++];
+                }
+                else if (op == QOI_OP_RGBA)
+                {
+                    pixel.r = chunks[offset++];
+                    pixel.g = chunks[offset++];
+                    pixel.b = chunks[offset++];
+                    pixel.a = chunks[offset++];
+                }
+                else
+                {
+                    switch (op & QOI_MASK_2)
+                    {
+                        case QOI_OP_INDEX:
+                            pixel = index[op];
+                            break;
+                        case QOI_OP_DIFF:
+                            pixel.r += ((op >> 4) & 0x03) - 2;
+                            pixel.g += ((op >> 2) & 0x03) - 2;
+                            pixel.b += (op & 0x03) - 2;
+                            break;
+                        case QOI_OP_LUMA:
+                        {
+                            unsigned int next = chunks[offset++];
+                            int green = (int)(op & 0x3f) - 32;
+                            pixel.r += green - 8 + ((next >> 4) & 0x0f);
+                            pixel.g += green;
+                            pixel.b += green - 8 + (next & 0x0f);
+                            break;
+                        }
+                        case QOI_OP_RUN:
+                            run = op & 0x3f;
+                            break;
+                    }
+                }
+
+                index[qoi_hash(pixel)] = pixel;
+            }
+
+            output[0] = pixel.r;
+            output[1] = pixel.g;
+            output[2] = pixel.b;
+            if (channels == 4)
+                output[3] = pixel.a;
+
+            output += channels;
+        }
+    }
+}
+
+void qoi_decode_memory(const void *data, size_t size, void *destination, size_t destination_size)
+{
+    // read the header and ensure that the data exactly fills the given destination
+    unsigned int width, height;
+    enum png_format_t format;
+    qoi_read_header_memory(data, size, &width, &height, &format);
+    size_t data_size = (size_t)width * height * png_get_pixel_size(format);
+    if (data_size != destination_size)
+    {
+        fprintf(stderr, "QOI ERROR: qoi data is %zu bytes, expected %zu bytes\n", data_size, destination_size);
+        exit(EXIT_FAILURE);
+    }
+
+    // decode the chunks directly into the given destination
+    const unsigned char *bytes = data;
+    qoi_decode_chunks(bytes + QOI_HEADER_SIZE,
+                      size - QOI_HEADER_SIZE - QOI_END_MARKER_SIZE,
+                      width,
+                      height,
+                      qoi_get_channels(format),
+                      destination);
+}
+
+void qoi_init_memory(struct png_t *png, const void *data, size_t size)
+{
+    // read the header
+    unsigned int width, height;
+    enum png_format_t format;
+    qoi_read_header_memory(data, size, &width, &height, &format);
+
+    // decode the qoi files data
+    size_t data_size = (size_t)width * height * png_get_pixel_size(format);
+    void *png_data = malloc(data_size);
+    qoi_decode_memory(data, size, png_data, data_size);
+
+    // initialize the given png
+    png->width = width;
+    png->height = height;
+    png->format = format;
+    png->data = png_data;
+}
+
+void qoi_init_file(struct png_t *png, FILE *file)
+{
+    // read the rest of the file into memory
+    long start = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long end = ftell(file);
+    fseek(file, start, SEEK_SET);
+    if (start < 0 || end < start)
+    {
+        fprintf(stderr, "QOI ERROR: unable to read qoi file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t size = end - start;
+    void *data = malloc(size);
+    if (fread(data, 1, size, file) != size)
+    {
+        fprintf(stderr, "QOI ERROR: unable to read qoi file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // decode the qoi file
+    qoi_init_memory(png, data, size);
+    free(data);
+}
+
+size_t qoi_get_max_size(unsigned int width, unsigned int height, enum png_format_t format)
+{
+    // every pixel is at worst a full rgb(a) chunk, which is one byte larger than the pixel
+    return QOI_HEADER_SIZE + (size_t)width * height * (qoi_get_channels(format) + 1) + QOI_END_MARKER_SIZE;
+}
+
+/// Encode the given PNG as a QOI file into the given memory.
+/// @param png The PNG to encode.
+/// @param output The first byte of the memory to write the QOI file to.
+/// This must be at least `qoi_get_max_size` bytes for the given PNG.
+/// @return The total size of the QOI file, in bytes.
+size_t qoi_encode(const struct png_t *png, unsigned char *output)
+{
+    unsigned char *start = output;
+    unsigned int width = png->width;
+    unsigned int height = png->height;
+    unsigned int channels = qoi_get_channels(png->format);
+
+    // write the header
+    memcpy(output, "qoif", 4);
+    output[4] = width >> 24;
+    output[5] = width >> 16;
+    output[6] = width >> 8;
+    output[7] = width;
+    output[8] = height >> 24;
+    output[9] = height >> 16;
+    output[10] = height >> 8;
+    output[11] = height;
+    output[12] = channels;
+    output[13] = 0;
+    output += QOI_HEADER_SIZE;
+
+    // write the chunks
+    struct qoi_pixel_t index[QOI_INDEX_SIZE] = { 0 };
+    struct qoi_pixel_t previous = { .r = 0, .g = 0, .b = 0, .a = 255 };
+    unsigned int run = 0;
+    size_t row_size = (size_t)width * channels;
+    for (unsigned int y = 0; y < height; y++)
+    {
+        // qoi rows are top-to-bottom, so each is read from its flipped position
+        const unsigned char *input = (const unsigned char *)png->data + ((size_t)(height - 1) - y) * row_size;
+        for (unsigned int x = 0; x < width; x++, input += channels)
+        {
+            struct qoi_pixel_t pixel =
+            {
+                .r = input[0],
+                .g = input[1],
+                .b = input[2],
+                .a = (channels == 4) ? input[3] : 255,
+            };
+
+            if (qoi_pixels_equal(pixel, previous))
+            {
+                // extend the current run, flushing it once it is as long as a chunk can hold
+                if (++run == QOI_MAX_RUN)
+                {
+                    *output++ = QOI_OP_RUN | (run - 1);
+                    run = 0;
+                }
+
+                continue;
+            }
+
+            if (run > 0)
+            {
+                *output++ = QOI_OP_RUN | (run - 1);
+                run = 0;
+            }
+
+            unsigned int hash = qoi_hash(pixel);
+            if (qoi_pixels_equal(index[hash], pixel))
+            {
+                *output++ = QOI_OP_INDEX | hash;
+            }
+            else
+            {
+                index[hash] = pixel;
+                if (pixel.a == previous.a)
+                {
+                    // differences wrap, matching the decoder's 8-bit arithmetic
+                    int8_t red = (int8_t)(pixel.r - previous.r);
+                    int8_t green = (int8_t)(pixel.g - previous.g);
+                    int8_t blue = (int8_t)(pixel.b - previous.b);
+                    int8_t red_green = red - green;
+                    int8_t blue_green = blue - green;
+                    if (red >= -2 && red <= 1 && green >= -2 && green <= 1 && blue >= -2 && blue <= 1)
+                    {
+                        *output++ = QOI_OP_DIFF | ((red + 2) << 4) | ((green + 2) << 2) | (blue + 2);
+                    }
+                    else if (red_green >= -8 && red_green <= 7 && green >= -32 && green <= 31 && blue_green >= -8 && blue_green <= 7)
+                    {
+                        *output++ = QOI_OP_LUMA | (green + 32);
+                        *output++ = ((red_green + 8) << 4) | (blue_green + 8);
+                    }
+                    else
+                    {
+                        *output++ = QOI_OP_RGB;
+                        *output++ = pixel.r;
+                        *output++ = pixel.g;
+                        *output++ = pixel.b;
+                    }
+                }
+                else
+                {
+                    *output++ = QOI_OP_RGBA;
+                    *output++ = pixel.r;
+                    *output++ = pixel.g;
+                    *output++ = pixel.b;
+                    *output++ = pixel.a;
+                }
+            }
+
+            previous = pixel;
+        }
+    }
+
+    if (run > 0)
+        *output++ = QOI_OP_RUN | (run - 1);
+
+    // write the end marker
+    static const unsigned char end_marker[QOI_END_MARKER_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    memcpy(output, end_marker, QOI_END_MARKER_SIZE);
+    output += QOI_END_MARKER_SIZE;
+    return output - start;
+}
+
+void qoi_write_buffer(const struct png_t *png, struct buffer_t *buffer)
+{
+    // encode into the worst case size, then shrink the buffer to the encoded size
+    size_t capacity = qoi_get_max_size(png->width, png->height, png->format);
+    unsigned char *output = buffer_extend(buffer, capacity);
+    buffer->size -= capacity - qoi_encode(png, output);
+}
+
+void qoi_write(const struct png_t *png, FILE *file)
+{
+    struct buffer_t buffer;
+    buffer_init(&buffer);
+    qoi_write_buffer(png, &buffer);
+    buffer_write(&buffer, file);
+    buffer_deinit(&buffer);
+}
@@ -1,11 +1,15 @@
 #include "texture.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <assert.h>
 
 #include "png.h"
+#include "bin.h"
+#include "pixel.h"
+#include "gl_state.h"
 
 // MARK: - Functions
 
@@ -43,6 +47,39 @@ void texture_scaling_to_gl(enum texture_scaling_t scaling,
     }
 }
 
+/// Get the OpenGL representation of the given texture wrap mode.
+/// @param wrap The wrap mode to get the OpenGL representation of.
+/// @return The OpenGL wrap mode for the given wrap mode.
+GLenum texture_wrap_to_gl(enum texture_wrap_t wrap)
+{
+    switch (wrap)
+    {
+        case TEXTURE_REPEAT: return GL_REPEAT;
+        case TEXTURE_CLAMP:  return GL_CLAMP_TO_EDGE;
+        default:
+            fprintf(stderr, "TEXTURE ERROR: unknown texture wrap mode %i\n", wrap);
+            exit(EXIT_FAILURE);
+    }
+}
+
+/// Get the OpenGL filters to sample a texture with the given scaling and number of mip levels with.
+///
+/// Mip levels are only sampled between when there are any to sample.
+/// @param scaling The scaling filter of the texture.
+/// @param num_levels The total number of mip levels of the texture, including the full size level.
+/// @param gl_min_filter The pointer to set the value of to the minification filter for the texture.
+/// @param gl_mag_filter The pointer to set the value of to the magnification filter for the texture.
+void texture_filters_to_gl(enum texture_scaling_t scaling,
+                           unsigned int num_levels,
+                           GLenum *gl_min_filter,
+                           GLenum *gl_mag_filter)
+{
+    texture_scaling_to_gl(scaling, gl_mag_filter);
+    *gl_min_filter = *gl_mag_filter;
+    if (num_levels > 1)
+        *gl_min_filter = (scaling == TEXTURE_LINEAR) ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+}
+
 /// Get the OpenGL representations of the given texture format.
 /// @param format The format to get the OpenGL representation of.
 /// @param gl_internal_format The pointer to set the value of to the internal texture format for the given type.
@@ -55,16 +92,60 @@ void texture_format_to_gl(enum texture_format_t format,
 {
     switch (format)
     {
+        // internal formats are always sized, as immutable storage requires them
         case TEXTURE_RGBU8:
-            *gl_internal_format = GL_RGB;
+            *gl_internal_format = GL_RGB8;
             *gl_format = GL_RGB;
             *gl_type = GL_UNSIGNED_BYTE;
             break;
         case TEXTURE_RGBAU8:
-            *gl_internal_format = GL_RGBA;
+            *gl_internal_format = GL_RGBA8;
             *gl_format = GL_RGBA;
             *gl_type = GL_UNSIGNED_BYTE;
             break;
+        // compressed formats are allocated and read back through their uncompressed counterparts
+        case TEXTURE_BC1:
+            *gl_internal_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            *gl_format = GL_RGB;
+            *gl_type = GL_UNSIGNED_BYTE;
+            break;
+        case TEXTURE_BC3:
+            *gl_internal_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            *gl_format = GL_RGBA;
+            *gl_type = GL_UNSIGNED_BYTE;
+            break;
+        case TEXTURE_BC7:
+            *gl_internal_format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+            *gl_format = GL_RGBA;
+            *gl_type = GL_UNSIGNED_BYTE;
+            break;
+        // a8 is stored as red, and only differs from r8 by its swizzle
+        case TEXTURE_R8:
+        case TEXTURE_A8:
+            *gl_internal_format = GL_R8;
+            *gl_format = GL_RED;
+            *gl_type = GL_UNSIGNED_BYTE;
+            break;
+        case TEXTURE_RG8:
+            *gl_internal_format = GL_RG8;
+            *gl_format = GL_RG;
+            *gl_type = GL_UNSIGNED_BYTE;
+            break;
+        case TEXTURE_RGB565:
+            *gl_internal_format = GL_RGB565;
+            *gl_format = GL_RGB;
+            *gl_type = GL_UNSIGNED_SHORT_5_6_5;
+            break;
+        case TEXTURE_RGBA4444:
+            *gl_internal_format = GL_RGBA4;
+            *gl_format = GL_RGBA;
+            *gl_type = GL_UNSIGNED_SHORT_4_4_4_4;
+            break;
+        case TEXTURE_RGB5A1:
+            *gl_internal_format = GL_RGB5_A1;
+            *gl_format = GL_RGBA;
+            *gl_type = GL_UNSIGNED_SHORT_5_5_5_1;
+            break;
     }
 }
 
@@ -82,75 +163,501 @@ enum texture_format_t texture_format_from_png(enum png_format_t png_format)
     }
 }
 
+/// Get the format that textures of the given format are read back as.
+///
+/// Compressed formats are decompressed and compact formats are widened, so this is always either `TEXTURE_RGBU8` or `TEXTURE_RGBAU8`.
+/// Swizzles are not applied when reading, so `TEXTURE_A8` is read as the red channel it is stored in.
+/// @param format The format to get the read back format of.
+/// @return The format that textures of the given format are read back as.
+enum texture_format_t texture_format_get_readback(enum texture_format_t format)
+{
+    switch (format)
+    {
+        case TEXTURE_RGBU8:
+        case TEXTURE_BC1:
+        case TEXTURE_R8:
+        case TEXTURE_A8:
+        case TEXTURE_RG8:
+        case TEXTURE_RGB565:
+            return TEXTURE_RGBU8;
+        case TEXTURE_RGBAU8:
+        case TEXTURE_BC3:
+        case TEXTURE_BC7:
+        case TEXTURE_RGBA4444:
+        case TEXTURE_RGB5A1:
+            return TEXTURE_RGBAU8;
+    }
+}
+
+/// Get the compact layout of the texture data of the given compact texture format.
+/// @param format The compact format to get the layout of.
+/// @return The layout of the texture data of the given format.
+enum pixel_packing_t texture_format_get_packing(enum texture_format_t format)
+{
+    switch (format)
+    {
+        case TEXTURE_R8:       return PIXEL_PACKING_R8;
+        case TEXTURE_A8:       return PIXEL_PACKING_A8;
+        case TEXTURE_RG8:      return PIXEL_PACKING_RG8;
+        case TEXTURE_RGB565:   return PIXEL_PACKING_RGB565;
+        case TEXTURE_RGBA4444: return PIXEL_PACKING_RGBA4444;
+        case TEXTURE_RGB5A1:   return PIXEL_PACKING_RGB5A1;
+        default:
+            assert(false);
+            return PIXEL_PACKING_R8;
+    }
+}
+
+/// Get the size of a single pixel in the given uncompressed texture format, in bytes.
+/// @param format The uncompressed format to get the pixel size of.
+/// @return The size of a single pixel in the given format, in bytes.
+size_t texture_get_pixel_size(enum texture_format_t format)
+{
+    switch (format)
+    {
+        case TEXTURE_R8:       return 1;
+        case TEXTURE_A8:       return 1;
+        case TEXTURE_RG8:      return 2;
+        case TEXTURE_RGB565:   return 2;
+        case TEXTURE_RGBA4444: return 2;
+        case TEXTURE_RGB5A1:   return 2;
+        case TEXTURE_RGBU8:    return 3;
+        default:               return 4;
+    }
+}
+
+/// Get the size of a single block in the given compressed texture format, in bytes.
+/// @param format The compressed format to get the block size of.
+/// @return The size of a single 4x4 block in the given format, in bytes.
+size_t texture_get_block_size(enum texture_format_t format)
+{
+    switch (format)
+    {
+        case TEXTURE_BC1: return 8;
+        case TEXTURE_BC3: return 16;
+        case TEXTURE_BC7: return 16;
+        default:          return 0;
+    }
+}
+
+/// Populate a region of the given mip level of the given layer within the given texture with the given texture data.
+///
+/// This is shared by all the ways of populating textures after they are created, as compressed data has to be uploaded differently.
+/// Compressed uploads are widened to whole blocks, but clamped to the level's size, as partial blocks are only allowed along its edges.
+/// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
+/// @param texture The texture to populate the region of.
+/// @param layer The index of the element to populate within the given texture, which must be `0` for 2D textures.
+/// @param level The mip level to populate, where `0` is the full size level.
+/// @param x The X offset of the region from the left of the given mip level, in pixels.
+/// This must be a multiple of four for compressed textures.
+/// @param y The Y offset of the region from the bottom of the given mip level, in pixels.
+/// This must be a multiple of four for compressed textures.
+/// @param width The width of the given texture data, in pixels.
+/// @param height The height of the given texture data, in pixels.
+/// @param format The format of the given texture data.
+/// @param data The first byte of the texture data, or the offset into the currently bound pixel unpack buffer.
+void texture_upload_region(struct texture_t *texture,
+                           unsigned int layer,
+                           unsigned int level,
+                           unsigned int x,
+                           unsigned int y,
+                           unsigned int width,
+                           unsigned int height,
+                           enum texture_format_t format,
+                           const void *data)
+{
+    // ensure the given texture has the given level and layer, and that the region is within it
+    unsigned int level_width = texture_get_level_size(texture->width, level);
+    unsigned int level_height = texture_get_level_size(texture->height, level);
+    assert(level < texture->num_levels);
+    assert(texture->type == TEXTURE_2D_ARRAY || layer == 0);
+    assert(x + width <= level_width && y + height <= level_height);
+
+    GLenum gl_target, gl_internal_format, gl_format, gl_type;
+    texture_type_to_gl(texture->type, &gl_target);
+    texture_format_to_gl(format, &gl_internal_format, &gl_format, &gl_type);
+    texture_bind(texture, TEXTURE_INIT_UNIT);
+    if (texture_format_is_compressed(texture->format))
+    {
+        // compressed data can only be uploaded in the texture's own format, at whole block offsets
+        assert(format == texture->format);
+        assert(x % 4 == 0 && y % 4 == 0);
+
+        unsigned int block_width = (width + 3) & ~3u;
+        unsigned int block_height = (height + 3) & ~3u;
+        if (block_width > level_width - x)
+            block_width = level_width - x;
+        if (block_height > level_height - y)
+            block_height = level_height - y;
+
+        GLsizei data_size = texture_get_data_size(format, width, height);
+        switch (texture->type)
+        {
+            case TEXTURE_2D:
+                glCompressedTexSubImage2D(gl_target, level, x, y, block_width, block_height, gl_internal_format, data_size, data);
+                break;
+            case TEXTURE_2D_ARRAY:
+                glCompressedTexSubImage3D(gl_target, level, x, y, layer, block_width, block_height, 1, gl_internal_format, data_size, data);
+                break;
+        }
+    }
+    else
+    {
+        // rows are tightly packed, which only matches the default alignment of four for rgba data
+        // 16-bit packed texels are always little-endian, while the driver reads them in host byte order
+        assert(!texture_format_is_compressed(format));
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (!BIN_HOST_IS_LITTLE_ENDIAN)
+            glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_TRUE);
+        switch (texture->type)
+        {
+            case TEXTURE_2D:
+                glTexSubImage2D(gl_target, level, x, y, width, height, gl_format, gl_type, data);
+                break;
+            case TEXTURE_2D_ARRAY:
+                glTexSubImage3D(gl_target, level, x, y, layer, width, height, 1, gl_format, gl_type, data);
+                break;
+        }
+    }
+}
+
+/// Wait for the graphics context to pass the given fence, a second at a time.
+///
+/// If the graphics context is unable to wait then the program terminates.
+/// @param fence The fence to wait for.
+/// @param description The description of what is being waited for, used in the error message.
+void texture_wait_fence(GLsync fence, const char *description)
+{
+    while (true)
+    {
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        if (result == GL_WAIT_FAILED)
+        {
+            fprintf(stderr, "TEXTURE ERROR: unable to wait for %s\n", description);
+            exit(EXIT_FAILURE);
+        }
+
+        if (result != GL_TIMEOUT_EXPIRED)
+            return;
+    }
+}
+
+/// Ensure that the given texture format is supported by the current graphics context, terminating the program if it is not.
+/// @param format The format to check.
+void texture_ensure_format_is_supported(enum texture_format_t format)
+{
+    if (!texture_format_is_supported(format))
+    {
+        // the format is not supported, print the details and terminate
+        const char *name;
+        switch (format)
+        {
+            case TEXTURE_BC1: name = "BC1"; break;
+            case TEXTURE_BC3: name = "BC3"; break;
+            case TEXTURE_BC7: name = "BC7"; break;
+            default:          name = "uncompressed"; break;
+        }
+
+        fprintf(stderr, "TEXTURE ERROR: %s textures are not supported by the graphics context\n", name);
+        exit(EXIT_FAILURE);
+    }
+}
+
 /// Activate the given indexed texture unit within the current graphics context.
 /// @param index The index of the texture unit to activate.
 void texture_activate_unit(unsigned int index)
 {
-    glActiveTexture(GL_TEXTURE0 + index);
+    gl_state_activate_unit(index);
 }
 
-/// Create a new unpopulated OpenGL texture from the given parameters.
+/// Create a new OpenGL texture from the given parameters, with no storage allocated.
 ///
-/// As the new texture is unpopulated is must be populated by the caller, then optionally have its mipmap generated.
+/// As the new texture has no storage the caller must allocate it with `texture_allocate_storage` and then populate it.
+/// Textures are sampled through pooled sampler objects bound by `texture_bind`, so the new texture's own filters are only a fallback
+/// for renderers which sample it without one bound, such as imgui.
 /// During this function `TEXTURE_INIT_UNIT` is activated and bound to.
 /// @param type The type of the new texture.
 /// @param scaling The scaling filter for the new texture to use.
+/// @param num_levels The total number of mip levels of the new texture, including the full size level.
+/// @param format The format of the new texture's data, used to swizzle formats whose channels are stored elsewhere.
 /// @return The unique OpenGL identifier of the new texture.
 GLuint texture_create(enum texture_type_t type,
-                      enum texture_scaling_t scaling)
+                      enum texture_scaling_t scaling,
+                      unsigned int num_levels,
+                      enum texture_format_t format)
 {
     // get the opengl representations of the new textures properties
-    GLenum gl_target, gl_filter;
+    GLenum gl_target, gl_min_filter, gl_mag_filter;
     texture_type_to_gl(type, &gl_target);
-    texture_scaling_to_gl(type, &gl_filter);
+    texture_filters_to_gl(scaling, num_levels, &gl_min_filter, &gl_mag_filter);
 
     // activate the init unit
     texture_activate_unit(TEXTURE_INIT_UNIT);
 
     // create and return the new texture
+    // the maximum level is set so that the texture is complete once the given levels are populated
     GLuint id;
     glGenTextures(1, &id);
-    glBindTexture(gl_target, id);
-    glTexParameteri(gl_target, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(gl_target, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(gl_target, GL_TEXTURE_MIN_FILTER, gl_filter);
-    glTexParameteri(gl_target, GL_TEXTURE_MAG_FILTER, gl_filter);
+    gl_state_bind_texture(gl_target, id);
+    glTexParameteri(gl_target, GL_TEXTURE_MIN_FILTER, gl_min_filter);
+    glTexParameteri(gl_target, GL_TEXTURE_MAG_FILTER, gl_mag_filter);
+    glTexParameteri(gl_target, GL_TEXTURE_MAX_LEVEL, num_levels - 1);
+    if (format == TEXTURE_A8)
+    {
+        const GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+        glTexParameteriv(gl_target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
     return id;
 }
 
-void texture_init_png(struct texture_t *texture,
-                      enum texture_scaling_t scaling,
-                      const struct png_t *png)
+/// Allocate the storage of every mip level of the texture bound to `TEXTURE_INIT_UNIT`, which was created by `texture_create`.
+///
+/// Where `ARB_texture_storage` is available the storage is allocated once as immutable,
+/// so the driver never has to validate the texture's levels for completeness when it is sampled.
+/// Otherwise each level is allocated separately, and the storage is undefined until it is populated.
+/// @param type The type of the texture.
+/// @param format The format of the texture's data.
+/// @param width The width of the texture, in pixels.
+/// @param height The height of the texture, in pixels.
+/// @param num_layers The total number of elements within the texture, which must be `1` for 2D textures.
+/// @param num_levels The total number of mip levels of the texture, including the full size level.
+void texture_allocate_storage(enum texture_type_t type,
+                              enum texture_format_t format,
+                              unsigned int width,
+                              unsigned int height,
+                              unsigned int num_layers,
+                              unsigned int num_levels)
 {
-    // get the opengl representations of the new textures properties
-    enum texture_type_t type = TEXTURE_2D;
-    enum texture_format_t format = texture_format_from_png(png->format);
     GLenum gl_target, gl_internal_format, gl_format, gl_type;
     texture_type_to_gl(type, &gl_target);
     texture_format_to_gl(format, &gl_internal_format, &gl_format, &gl_type);
+    if (GLEW_ARB_texture_storage)
+    {
+        switch (type)
+        {
+            case TEXTURE_2D:
+                glTexStorage2D(gl_target, num_levels, gl_internal_format, width, height);
+                break;
+            case TEXTURE_2D_ARRAY:
+                glTexStorage3D(gl_target, num_levels, gl_internal_format, width, height, num_layers);
+                break;
+        }
 
-    // create and populate the new texture
-    GLuint id = texture_create(type, scaling);
-    glTexImage2D(gl_target,
-                 0,
-                 gl_internal_format,
-                 png->width,
-                 png->height,
-                 0,
-                 gl_format,
-                 gl_type,
-                 png->data);
-
-    // generate the mipmap now that the texture is populated
-    glGenerateMipmap(gl_target);
+        return;
+    }
+
+    for (unsigned int level = 0; level < num_levels; level++)
+    {
+        unsigned int level_width = texture_get_level_size(width, level);
+        unsigned int level_height = texture_get_level_size(height, level);
+        switch (type)
+        {
+            case TEXTURE_2D:
+                glTexImage2D(gl_target, level, gl_internal_format, level_width, level_height, 0, gl_format, gl_type, NULL);
+                break;
+            case TEXTURE_2D_ARRAY:
+                glTexImage3D(gl_target, level, gl_internal_format, level_width, level_height, num_layers, 0, gl_format, gl_type, NULL);
+                break;
+        }
+    }
+}
+
+/// Get the total number of mip levels to give a texture of the given size and mip policy.
+/// @param width The width of the texture, in pixels.
+/// @param height The height of the texture, in pixels.
+/// @param mipmaps The mip policy of the texture.
+/// @return The total number of mip levels to give the texture, including the full size level.
+unsigned int texture_get_mipmaps_num_levels(unsigned int width,
+                                            unsigned int height,
+                                            enum texture_mipmaps_t mipmaps)
+{
+    switch (mipmaps)
+    {
+        case TEXTURE_MIPMAPS_NONE:
+            return 1;
+        case TEXTURE_MIPMAPS_GENERATED:
+        case TEXTURE_MIPMAPS_STORED:
+            return texture_get_num_levels(width, height);
+        default:
+            fprintf(stderr, "TEXTURE ERROR: unknown texture mip policy %i\n", mipmaps);
+            exit(EXIT_FAILURE);
+    }
+}
+
+enum texture_mipmaps_t texture_get_default_mipmaps(enum texture_scaling_t scaling)
+{
+    switch (scaling)
+    {
+        case TEXTURE_NEAREST:
+            return TEXTURE_MIPMAPS_NONE;
+        case TEXTURE_LINEAR:
+            return TEXTURE_MIPMAPS_GENERATED;
+        default:
+            fprintf(stderr, "TEXTURE ERROR: unknown texture scaling %i\n", scaling);
+            exit(EXIT_FAILURE);
+    }
+}
+
+unsigned int texture_get_num_levels(unsigned int width, unsigned int height)
+{
+    unsigned int size = (width > height) ? width : height;
+    unsigned int num_levels = 1;
+    while ((size >> num_levels) > 0)
+        num_levels++;
+
+    return num_levels;
+}
+
+unsigned int texture_get_level_size(unsigned int size, unsigned int level)
+{
+    unsigned int level_size = size >> level;
+    return (level_size > 0) ? level_size : 1;
+}
+
+bool texture_format_is_compressed(enum texture_format_t format)
+{
+    return texture_get_block_size(format) > 0;
+}
+
+bool texture_format_is_compact(enum texture_format_t format)
+{
+    switch (format)
+    {
+        case TEXTURE_R8:
+        case TEXTURE_A8:
+        case TEXTURE_RG8:
+        case TEXTURE_RGB565:
+        case TEXTURE_RGBA4444:
+        case TEXTURE_RGB5A1:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool texture_format_is_supported(enum texture_format_t format)
+{
+    switch (format)
+    {
+        case TEXTURE_RGBU8:
+        case TEXTURE_RGBAU8:
+        case TEXTURE_R8:
+        case TEXTURE_A8:
+        case TEXTURE_RG8:
+        case TEXTURE_RGB565:
+        case TEXTURE_RGBA4444:
+        case TEXTURE_RGB5A1:
+            return true;
+        case TEXTURE_BC1:
+        case TEXTURE_BC3:
+            return GLEW_EXT_texture_compression_s3tc;
+        case TEXTURE_BC7:
+            return GLEW_ARB_texture_compression_bptc;
+    }
+}
+
+size_t texture_get_data_size(enum texture_format_t format, unsigned int width, unsigned int height)
+{
+    if (texture_format_is_compressed(format))
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * texture_get_block_size(format);
+
+    return (size_t)width * height * texture_get_pixel_size(format);
+}
+
+void texture_convert_png(const struct png_t *png,
+                         enum texture_format_t format,
+                         void *destination)
+{
+    // ensure the given format can be converted into
+    enum texture_format_t png_format = texture_format_from_png(png->format);
+    assert(!texture_format_is_compressed(format));
+    assert(!(format == TEXTURE_RGBU8 && png_format == TEXTURE_RGBAU8));
+
+    size_t num_pixels = (size_t)png->width * png->height;
+    if (format == png_format)
+    {
+        memcpy(destination, png->data, texture_get_data_size(format, png->width, png->height));
+        return;
+    }
+
+    if (format == TEXTURE_RGBAU8)
+    {
+        pixel_rgb_to_rgba(png->data, destination, num_pixels);
+        return;
+    }
+
+    // compact formats are packed from rgba, so rgb pngs are expanded first
+    // greyscale masks are typically saved without alpha, so a8 takes the red channel of these instead of their opaque alpha
+    enum pixel_packing_t packing = texture_format_get_packing(format);
+    if (png_format == TEXTURE_RGBAU8)
+    {
+        pixel_pack_rgba(png->data, destination, num_pixels, packing);
+        return;
+    }
+
+    if (packing == PIXEL_PACKING_A8)
+        packing = PIXEL_PACKING_R8;
+
+    void *expanded_data = malloc(texture_get_data_size(TEXTURE_RGBAU8, png->width, png->height));
+    pixel_rgb_to_rgba(png->data, expanded_data, num_pixels);
+    pixel_pack_rgba(expanded_data, destination, num_pixels, packing);
+    free(expanded_data);
+}
+
+void texture_init_png(struct texture_t *texture,
+                      enum texture_scaling_t scaling,
+                      const struct png_t *png)
+{
+    texture_init_png_format(texture,
+                            scaling,
+                            texture_get_default_mipmaps(scaling),
+                            png,
+                            texture_format_from_png(png->format));
+}
+
+void texture_init_png_format(struct texture_t *texture,
+                             enum texture_scaling_t scaling,
+                             enum texture_mipmaps_t mipmaps,
+                             const struct png_t *png,
+                             enum texture_format_t format)
+{
+    // ensure the given format and mip policy are valid
+    assert(!texture_format_is_compressed(format));
+    assert(mipmaps != TEXTURE_MIPMAPS_STORED);
+
+    // convert the given pngs data into the given format, if it is not already
+    const void *data = png->data;
+    void *converted_data = NULL;
+    if (format != texture_format_from_png(png->format))
+    {
+        converted_data = malloc(texture_get_data_size(format, png->width, png->height));
+        texture_convert_png(png, format, converted_data);
+        data = converted_data;
+    }
+
+    // create the new texture and allocate each of its levels
+    enum texture_type_t type = TEXTURE_2D;
+    unsigned int num_levels = texture_get_mipmaps_num_levels(png->width, png->height, mipmaps);
+    GLuint id = texture_create(type, scaling, num_levels, format);
+    texture_allocate_storage(type, format, png->width, png->height, 1, num_levels);
 
     // initialize the given texture
     texture->width = png->width;
     texture->height = png->height;
     texture->type = type;
     texture->scaling = scaling;
+    texture->wrap = TEXTURE_REPEAT;
     texture->format = format;
+    texture->mipmaps = mipmaps;
+    texture->num_levels = num_levels;
     texture->id = id;
+
+    // populate the new texture, then generate the mipmap from it, if it has one
+    texture_upload_region(texture, 0, 0, 0, 0, png->width, png->height, format, data);
+    free(converted_data);
+    if (num_levels > 1)
+        texture_generate_mipmap(texture);
 }
 
 void texture_init_png_array(struct texture_t *texture,
@@ -161,7 +668,7 @@ void texture_init_png_array(struct texture_t *texture,
                             const struct png_t *pngs)
 {
     // get whether or not any of the given pngs has an alpha channel,
-    // to determine the internal format of the new array texture
+    // to determine the format of the new array texture
     bool any_has_alpha = false;
     for (int i = 0; i < num_pngs && !any_has_alpha; i++)
     {
@@ -176,110 +683,507 @@ void texture_init_png_array(struct texture_t *texture,
         }
     }
 
-    // get the opengl representations of the new array textures properties
-    enum texture_type_t type = TEXTURE_2D_ARRAY;
-    enum texture_format_t array_format = (any_has_alpha) ? TEXTURE_RGBAU8 : TEXTURE_RGBU8;
-    GLenum gl_target, gl_array_internal_format, gl_array_format, gl_array_type;
-    texture_type_to_gl(type, &gl_target);
-    texture_format_to_gl(array_format, &gl_array_internal_format, &gl_array_format, &gl_array_type);
-
     // create the new array texture
-    GLuint id = texture_create(type, scaling);
-    glTexImage3D(gl_target,
-                 0,
-                 gl_array_internal_format,
-                 width,
-                 height,
-                 num_pngs,
-                 0,
-                 gl_array_format,
-                 gl_array_type,
-                 NULL);
+    enum texture_format_t format = (any_has_alpha) ? TEXTURE_RGBAU8 : TEXTURE_RGBU8;
+    enum texture_mipmaps_t mipmaps = texture_get_default_mipmaps(scaling);
+    unsigned int num_levels = texture_get_mipmaps_num_levels(width, height, mipmaps);
+    texture_init_empty_array(texture, width, height, num_pngs, num_levels, mipmaps, scaling, format);
 
     // populate the new array texture
     for (int i = 0; i < num_pngs; i++)
-    {
-        const struct png_t *png = &pngs[i];
+        texture_set_array_png(texture, i, 0, &pngs[i]);
 
-        // get the opengl representations of the current textures properties
-        enum texture_format_t png_format = texture_format_from_png(png->format);
-        GLenum gl_png_internal_format, gl_png_format, gl_png_type;
-        texture_format_to_gl(png_format, &gl_png_internal_format, &gl_png_format, &gl_png_type);
-
-        // populate the current element in the array texture with the current pngs texture
-        glTexSubImage3D(gl_target,
-                        0,
-                        0,
-                        0,
-                        i,
-                        png->width,
-                        png->height,
-                        1,
-                        gl_png_format,
-                        gl_png_type,
-                        png->data);
-    }
-
-    // generate the mipmap now that the array texture is populated
-    glGenerateMipmap(gl_target);
+    // generate the mipmap now that the array texture is populated, if it has one
+    if (num_levels > 1)
+        texture_generate_mipmap(texture);
+}
+
+void texture_init_empty_array(struct texture_t *texture,
+                              unsigned int width,
+                              unsigned int height,
+                              unsigned int num_layers,
+                              unsigned int num_levels,
+                              enum texture_mipmaps_t mipmaps,
+                              enum texture_scaling_t scaling,
+                              enum texture_format_t format)
+{
+    // ensure the given level count, mip policy, and format are valid
+    assert(num_levels >= 1 && num_levels <= texture_get_num_levels(width, height));
+    assert(mipmaps != TEXTURE_MIPMAPS_NONE || num_levels == 1);
+    texture_ensure_format_is_supported(format);
+
+    // create the new array texture and allocate each of its levels
+    enum texture_type_t type = TEXTURE_2D_ARRAY;
+    GLuint id = texture_create(type, scaling, num_levels, format);
+    texture_allocate_storage(type, format, width, height, num_layers, num_levels);
 
     // initialize the given texture
     texture->width = width;
     texture->height = height;
     texture->type = type;
     texture->scaling = scaling;
-    texture->format = array_format;
+    texture->wrap = TEXTURE_REPEAT;
+    texture->format = format;
+    texture->mipmaps = mipmaps;
+    texture->num_levels = num_levels;
     texture->id = id;
 }
 
+void texture_set_array_png(struct texture_t *texture,
+                           unsigned int index,
+                           unsigned int level,
+                           const struct png_t *png)
+{
+    // ensure the given texture is an uncompressed array texture, compressed textures are populated from blocks
+    assert(texture->type == TEXTURE_2D_ARRAY);
+    assert(!texture_format_is_compressed(texture->format));
+
+    // convert pngs within compact array textures before uploading, as the driver cannot swizzle a8 from alpha
+    if (texture_format_is_compact(texture->format))
+    {
+        void *converted_data = malloc(texture_get_data_size(texture->format, png->width, png->height));
+        texture_convert_png(png, texture->format, converted_data);
+        texture_upload_region(texture, index, level, 0, 0, png->width, png->height, texture->format, converted_data);
+        free(converted_data);
+        return;
+    }
+
+    // populate the given element in the array texture with the given pngs texture
+    texture_set_array_data(texture, index, level, png->width, png->height, texture_format_from_png(png->format), png->data);
+}
+
+void texture_set_array_data(struct texture_t *texture,
+                            unsigned int index,
+                            unsigned int level,
+                            unsigned int width,
+                            unsigned int height,
+                            enum texture_format_t format,
+                            const void *data)
+{
+    // ensure the given texture is an uncompressed array texture, and that the given data is in a format it can be populated from
+    assert(texture->type == TEXTURE_2D_ARRAY);
+    assert(!texture_format_is_compressed(texture->format));
+    assert(format == texture->format || (format == TEXTURE_RGBU8 && texture->format == TEXTURE_RGBAU8));
+
+    // expand rgb data within rgba array textures to rgba before uploading
+    // otherwise the driver performs the same conversion itself, one pixel at a time, while the upload blocks
+    void *expanded_data = NULL;
+    if (format != texture->format)
+    {
+        expanded_data = malloc(texture_get_data_size(TEXTURE_RGBAU8, width, height));
+        pixel_rgb_to_rgba(data, expanded_data, (size_t)width * height);
+        format = TEXTURE_RGBAU8;
+        data = expanded_data;
+    }
+
+    // populate the given element in the array texture with the given data
+    texture_upload_region(texture, index, level, 0, 0, width, height, format, data);
+    free(expanded_data);
+}
+
+void texture_clear_array_region(struct texture_t *texture,
+                                unsigned int index,
+                                unsigned int level,
+                                unsigned int x,
+                                unsigned int y,
+                                unsigned int width,
+                                unsigned int height)
+{
+    // ensure the given texture is an uncompressed array texture, and that the region is within it
+    assert(texture->type == TEXTURE_2D_ARRAY);
+    assert(!texture_format_is_compressed(texture->format));
+    assert(level < texture->num_levels);
+    assert(x + width <= texture_get_level_size(texture->width, level) &&
+           y + height <= texture_get_level_size(texture->height, level));
+
+    if (width == 0 || height == 0)
+        return;
+
+    // clear the region within the graphics context when supported, otherwise upload zeros into it
+    if (GLEW_ARB_clear_texture)
+    {
+        GLenum gl_internal_format, gl_format, gl_type;
+        texture_format_to_gl(texture->format, &gl_internal_format, &gl_format, &gl_type);
+        glClearTexSubImage(texture->id, level, x, y, index, width, height, 1, gl_format, gl_type, NULL);
+    }
+    else
+    {
+        void *zeros = calloc(1, texture_get_data_size(texture->format, width, height));
+        texture_upload_region(texture, index, level, x, y, width, height, texture->format, zeros);
+        free(zeros);
+    }
+}
+
+void texture_set_array_blocks(struct texture_t *texture,
+                              unsigned int index,
+                              unsigned int level,
+                              unsigned int width,
+                              unsigned int height,
+                              const void *data)
+{
+    // ensure the given texture is a compressed array texture
+    assert(texture->type == TEXTURE_2D_ARRAY);
+    assert(texture_format_is_compressed(texture->format));
+
+    // populate the given element in the array texture with the given blocks
+    texture_upload_region(texture, index, level, 0, 0, width, height, texture->format, data);
+}
+
+void *texture_map_pixel_buffer(GLuint pixel_buffer_id, size_t size)
+{
+    // orphan the given pixel buffers storage and map the new storage
+    // orphaning allows the driver to hand back fresh memory while any previous upload from this buffer is still in flight
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_id);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    void *pixel_buffer = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                                          0,
+                                          size,
+                                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return pixel_buffer;
+}
+
+void texture_set_array_pixel_buffer(struct texture_t *texture,
+                                    unsigned int index,
+                                    unsigned int level,
+                                    unsigned int width,
+                                    unsigned int height,
+                                    enum texture_format_t format,
+                                    GLuint pixel_buffer_id)
+{
+    // populate the given element in the array texture from the given pixel buffer
+    // while a pixel unpack buffer is bound the data pointer is an offset into it
+    assert(texture->type == TEXTURE_2D_ARRAY);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_id);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    texture_upload_region(texture, index, level, 0, 0, width, height, format, (const void *)0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void texture_set_array_png_buffered(struct texture_t *texture,
+                                    unsigned int index,
+                                    unsigned int level,
+                                    const struct png_t *png,
+                                    GLuint pixel_buffer_id)
+{
+    // stage the given pngs data through the given pixel buffer, converting it as it is copied within compact textures
+    enum texture_format_t format = texture_format_from_png(png->format);
+    if (texture_format_is_compact(texture->format))
+        format = texture->format;
+
+    size_t data_size = texture_get_data_size(format, png->width, png->height);
+    void *pixel_buffer = texture_map_pixel_buffer(pixel_buffer_id, data_size);
+    texture_convert_png(png, format, pixel_buffer);
+    texture_set_array_pixel_buffer(texture,
+                                   index,
+                                   level,
+                                   png->width,
+                                   png->height,
+                                   format,
+                                   pixel_buffer_id);
+}
+
+void texture_generate_mipmap(struct texture_t *texture)
+{
+    // ensure the given texture is uncompressed, as compressed formats cannot be rendered into,
+    // and that its mip levels are meant to be generated
+    assert(!texture_format_is_compressed(texture->format));
+    assert(texture->mipmaps == TEXTURE_MIPMAPS_GENERATED);
+
+    GLenum gl_target;
+    texture_type_to_gl(texture->type, &gl_target);
+
+    texture_bind(texture, TEXTURE_INIT_UNIT);
+    glGenerateMipmap(gl_target);
+}
+
 void texture_init_empty(struct texture_t *texture,
                         unsigned int width,
                         unsigned int height,
                         enum texture_scaling_t scaling,
                         enum texture_format_t format)
 {
-    // get the opengl representations of the new textures properties
-    enum texture_type_t type = TEXTURE_2D;
-    GLenum gl_target, gl_internal_format, gl_format, gl_type;
-    texture_type_to_gl(type, &gl_target);
-    texture_format_to_gl(format, &gl_internal_format, &gl_format, &gl_type);
+    // ensure the given format is valid
+    texture_ensure_format_is_supported(format);
 
-    // create and populate the new texture
-    GLuint id = texture_create(type, scaling);
-    glTexImage2D(gl_target,
-                 0,
-                 gl_internal_format,
-                 width,
-                 height,
-                 0,
-                 gl_format,
-                 gl_type,
-                 NULL);
+    // create the new texture and allocate its only level
+    enum texture_type_t type = TEXTURE_2D;
+    GLuint id = texture_create(type, scaling, 1, format);
+    texture_allocate_storage(type, format, width, height, 1, 1);
 
     // initialize the given texture
     texture->width = width;
     texture->height = height;
     texture->type = type;
     texture->scaling = scaling;
+    texture->wrap = TEXTURE_REPEAT;
     texture->format = format;
+    texture->mipmaps = TEXTURE_MIPMAPS_NONE;
+    texture->num_levels = 1;
     texture->id = id;
 }
 
 void texture_deinit(struct texture_t *texture)
 {
+    gl_state_forget_texture(texture->id);
     glDeleteTextures(1, &texture->id);
 }
 
+void texture_set_wrap(struct texture_t *texture, enum texture_wrap_t wrap)
+{
+    texture->wrap = wrap;
+}
+
 void texture_bind(const struct texture_t *texture, unsigned int unit)
 {
     // ensure the given unit it valid
     assert(unit < TEXTURE_MAX_UNITS);
 
-    // get the opengl target for the given textures type
-    GLenum gl_target;
+    // get the opengl target and sampling parameters for the given texture
+    GLenum gl_target, gl_min_filter, gl_mag_filter;
     texture_type_to_gl(texture->type, &gl_target);
+    texture_filters_to_gl(texture->scaling, texture->num_levels, &gl_min_filter, &gl_mag_filter);
 
-    // activate and bind to the given unit
+    // activate and bind to the given unit, along with the matching sampler
     texture_activate_unit(unit);
-    glBindTexture(gl_target, texture->id);
+    gl_state_bind_texture(gl_target, texture->id);
+    gl_state_bind_sampler(unit, gl_min_filter, gl_mag_filter, texture_wrap_to_gl(texture->wrap));
+}
+
+void texture_readback_init(struct texture_readback_t *readback,
+                           const struct texture_t *texture)
+{
+    // ensure the given texture is a 2d texture
+    assert(texture->type == TEXTURE_2D);
+
+    // get the opengl representations of the format to read the given texture as
+    // compressed textures are decompressed and compact textures are widened by the driver while they are copied
+    enum texture_format_t format = texture_format_get_readback(texture->format);
+    GLenum gl_internal_format, gl_format, gl_type;
+    texture_format_to_gl(format, &gl_internal_format, &gl_format, &gl_type);
+
+    // copy the given texture into a new pixel buffer
+    // while a pixel pack buffer is bound the data pointer is an offset into it, so the copy does not wait for the gpu
+    // rows are packed without padding so that they match pngs
+    size_t data_size = texture_get_data_size(format, texture->width, texture->height);
+    GLuint pixel_buffer_id;
+    glGenBuffers(1, &pixel_buffer_id);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer_id);
+    glBufferData(GL_PIXEL_PACK_BUFFER, data_size, NULL, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    texture_bind(texture, TEXTURE_INIT_UNIT);
+    glGetTexImage(GL_TEXTURE_2D, 0, gl_format, gl_type, (void *)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // initialize the given readback
+    readback->width = texture->width;
+    readback->height = texture->height;
+    readback->format = format;
+    readback->pixel_buffer_id = pixel_buffer_id;
+    readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback->data = NULL;
+}
+
+void texture_readback_deinit(struct texture_readback_t *readback)
+{
+    // deleting a mapped buffer implicitly unmaps it
+    if (readback->fence != NULL)
+        glDeleteSync(readback->fence);
+
+    glDeleteBuffers(1, &readback->pixel_buffer_id);
+}
+
+bool texture_readback_is_ready(struct texture_readback_t *readback)
+{
+    if (readback->fence == NULL)
+        return true;
+
+    // flush so that the fence is guaranteed to be submitted, otherwise it may never be signalled
+    GLenum result = glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+        return false;
+
+    glDeleteSync(readback->fence);
+    readback->fence = NULL;
+    return true;
+}
+
+const void *texture_readback_map(struct texture_readback_t *readback)
+{
+    if (readback->data != NULL)
+        return readback->data;
+
+    // wait for the copy to complete
+    if (readback->fence != NULL)
+    {
+        texture_wait_fence(readback->fence, "texture readback");
+        glDeleteSync(readback->fence);
+        readback->fence = NULL;
+    }
+
+    // map the contents
+    size_t data_size = texture_get_data_size(readback->format, readback->width, readback->height);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pixel_buffer_id);
+    readback->data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, data_size, GL_MAP_READ_BIT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return readback->data;
+}
+
+void texture_upload_ring_init(struct texture_upload_ring_t *ring,
+                              unsigned int num_slots,
+                              size_t slot_size)
+{
+    // ensure the given slot count is valid
+    assert(num_slots >= 1);
+
+    // create the pixel buffer of each slot
+    // the storage of each buffer is allocated once and then mapped unsynchronized,
+    // as the slot fences already guarantee that no transfer is reading from it
+    GLuint *pixel_buffer_ids = malloc(num_slots * sizeof(GLuint));
+    struct texture_upload_slot_t *slots = malloc(num_slots * sizeof(struct texture_upload_slot_t));
+    glGenBuffers(num_slots, pixel_buffer_ids);
+    for (unsigned int i = 0; i < num_slots; i++)
+    {
+        struct texture_upload_slot_t *slot = &slots[i];
+        slot->pixel_buffer_id = pixel_buffer_ids[i];
+        slot->capacity = slot_size;
+        slot->fence = NULL;
+        slot->is_reserved = false;
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->pixel_buffer_id);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, slot_size, NULL, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    free(pixel_buffer_ids);
+
+    // initialize the given ring
+    ring->num_slots = num_slots;
+    ring->slots = slots;
+    ring->next_slot = 0;
+    ring->num_waits = 0;
+}
+
+void texture_upload_ring_deinit(struct texture_upload_ring_t *ring)
+{
+    // deleting a mapped buffer implicitly unmaps it
+    for (unsigned int i = 0; i < ring->num_slots; i++)
+    {
+        struct texture_upload_slot_t *slot = &ring->slots[i];
+        if (slot->fence != NULL)
+            glDeleteSync(slot->fence);
+
+        glDeleteBuffers(1, &slot->pixel_buffer_id);
+    }
+
+    free(ring->slots);
+}
+
+void texture_upload_ring_reserve(struct texture_upload_ring_t *ring,
+                                 size_t size,
+                                 struct texture_upload_t *upload)
+{
+    // find the least recently committed slot which is not reserved
+    // slots are committed in roughly the order they are reserved, so this is almost always the next slot
+    unsigned int index = ring->next_slot;
+    while (ring->slots[index].is_reserved)
+    {
+        index = (index + 1) % ring->num_slots;
+
+        // ensure that there is a slot available
+        assert(index != ring->next_slot);
+    }
+
+    // wait for the previous transfer from the slot to complete, if it has not already
+    struct texture_upload_slot_t *slot = &ring->slots[index];
+    if (slot->fence != NULL)
+    {
+        GLenum result = glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+        {
+            ring->num_waits++;
+            texture_wait_fence(slot->fence, "texture upload slot");
+        }
+
+        glDeleteSync(slot->fence);
+        slot->fence = NULL;
+    }
+
+    // grow the slots storage if it is too small, then map the reserved range
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->pixel_buffer_id);
+    if (size > slot->capacity)
+    {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        slot->capacity = size;
+    }
+
+    void *data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                                  0,
+                                  size,
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (data == NULL)
+    {
+        fprintf(stderr, "TEXTURE ERROR: unable to map %zu bytes of texture upload staging memory\n", size);
+        exit(EXIT_FAILURE);
+    }
+
+    // initialize the given reservation
+    slot->is_reserved = true;
+    ring->next_slot = (index + 1) % ring->num_slots;
+    upload->slot = index;
+    upload->size = size;
+    upload->data = data;
+}
+
+void texture_upload_ring_commit(struct texture_upload_ring_t *ring,
+                                const struct texture_upload_t *upload,
+                                struct texture_t *texture,
+                                unsigned int layer,
+                                unsigned int level,
+                                unsigned int x,
+                                unsigned int y,
+                                unsigned int width,
+                                unsigned int height,
+                                enum texture_format_t format)
+{
+    // ensure the given reservation is outstanding and large enough for the given texture data
+    struct texture_upload_slot_t *slot = &ring->slots[upload->slot];
+    assert(slot->is_reserved);
+    assert(upload->size >= texture_get_data_size(format, width, height));
+
+    // issue the transfer from the slot, then fence it so the slot is not reused until the transfer has completed
+    // while a pixel unpack buffer is bound the data pointer is an offset into it
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->pixel_buffer_id);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    texture_upload_region(texture, layer, level, x, y, width, height, format, (const void *)0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->is_reserved = false;
+}
+
+void texture_upload_ring_png(struct texture_upload_ring_t *ring,
+                             struct texture_t *texture,
+                             unsigned int layer,
+                             unsigned int level,
+                             unsigned int x,
+                             unsigned int y,
+                             const struct png_t *png)
+{
+    // ensure the given texture is uncompressed, compressed textures are populated from blocks
+    assert(!texture_format_is_compressed(texture->format));
+
+    // stage the given pngs data, converting it as it is copied when it is rgb within an rgba texture or within a compact texture
+    enum texture_format_t format = texture_format_from_png(png->format);
+    if ((format == TEXTURE_RGBU8 && texture->format == TEXTURE_RGBAU8) || texture_format_is_compact(texture->format))
+        format = texture->format;
+
+    struct texture_upload_t upload;
+    texture_upload_ring_reserve(ring, texture_get_data_size(format, png->width, png->height), &upload);
+    texture_convert_png(png, format, upload.data);
+
+    // upload the staged data
+    texture_upload_ring_commit(ring, &upload, texture, layer, level, x, y, png->width, png->height, format);
 }
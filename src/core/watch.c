@@ -0,0 +1,138 @@
+#include "watch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <libgen.h>
+
+#ifdef WINDOWS
+#include <windows.h>
+#elif LINUX
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+// MARK: - Functions
+
+#ifdef WINDOWS
+/// Get the last write time of the file at the given filesystem path.
+/// @param path The filesystem path of the file to get the last write time of.
+/// @return The last write time of the given file, or `0` if it does not exist.
+uint64_t watch_get_write_time(const char *path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
+        return 0;
+
+    return ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+}
+#endif
+
+void watch_init(struct watch_t *watch, const char *path)
+{
+    // split the given path into its directory and name
+    // both dirname and basename may modify their argument, so each is given its own copy
+    char *directory_path = strdup(path);
+    char *name_path = strdup(path);
+    const char *directory = dirname(directory_path);
+    char *name = strdup(basename(name_path));
+
+    int descriptor = -1;
+    void *notification_handle = NULL;
+    uint64_t write_time = 0;
+
+    // windows
+    #ifdef WINDOWS
+    HANDLE notification = FindFirstChangeNotificationA(directory,
+                                                       FALSE,
+                                                       FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE);
+
+    if (notification == INVALID_HANDLE_VALUE)
+    {
+        // the directory could not be watched, print the details and terminate
+        fprintf(stderr, "WATCH ERROR: unable to watch directory at \"%s\" (0x%08lx)\n", directory, GetLastError());
+        exit(EXIT_FAILURE);
+    }
+
+    notification_handle = notification;
+    write_time = watch_get_write_time(path);
+    // linux
+    #elif LINUX
+    // only closing a written file or moving a file into place are watched,
+    // as other events can occur while the file is still incomplete
+    descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (descriptor < 0 || inotify_add_watch(descriptor, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        // the directory could not be watched, print the details and terminate
+        fprintf(stderr, "WATCH ERROR: unable to watch directory at \"%s\" (%s)\n", directory, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    #endif
+
+    free(name_path);
+    free(directory_path);
+
+    // initialize the given watch
+    watch->path = strdup(path);
+    watch->name = name;
+    watch->descriptor = descriptor;
+    watch->notification_handle = notification_handle;
+    watch->write_time = write_time;
+}
+
+void watch_deinit(struct watch_t *watch)
+{
+    // windows
+    #ifdef WINDOWS
+    FindCloseChangeNotification(watch->notification_handle);
+    // linux
+    #elif LINUX
+    close(watch->descriptor);
+    #endif
+
+    free(watch->name);
+    free(watch->path);
+}
+
+bool watch_poll(struct watch_t *watch)
+{
+    bool is_changed = false;
+
+    // windows
+    #ifdef WINDOWS
+    // consume every pending directory notification,
+    // then check whether the file itself was written since the last check
+    bool is_notified = false;
+    while (WaitForSingleObject(watch->notification_handle, 0) == WAIT_OBJECT_0)
+    {
+        is_notified = true;
+        FindNextChangeNotification(watch->notification_handle);
+    }
+
+    if (is_notified)
+    {
+        uint64_t write_time = watch_get_write_time(watch->path);
+        is_changed = write_time != watch->write_time;
+        watch->write_time = write_time;
+    }
+    // linux
+    #elif LINUX
+    // read every pending event, only reporting those for the watched file
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    while ((length = read(watch->descriptor, buffer, sizeof(buffer))) > 0)
+    {
+        for (char *pointer = buffer; pointer < buffer + length;)
+        {
+            const struct inotify_event *event = (const struct inotify_event *)pointer;
+            if (event->len > 0 && strcmp(event->name, watch->name) == 0)
+                is_changed = true;
+
+            pointer += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    #endif
+
+    return is_changed;
+}
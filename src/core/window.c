@@ -2,6 +2,8 @@
 
 #include <stdlib.h>
 
+#include "gl_state.h"
+
 // MARK: - Functions
 
 void window_init(struct window_t *window,
@@ -18,6 +20,7 @@ void window_init(struct window_t *window,
     window->width = width;
     window->height = height;
     window->backing = glfwCreateWindow(width, height, title, NULL, NULL);
+    gl_state_init(&window->state);
 
     // configure the given windows graphics context
     window_set_current(window);
@@ -48,17 +51,23 @@ void window_init(struct window_t *window,
 
 void window_deinit(struct window_t *window)
 {
+    // destroying a current context also clears it, so its state cache must follow
+    if (gl_state_get_current() == &window->state)
+        gl_state_set_current(NULL);
+
     glfwDestroyWindow(window->backing);
 }
 
 void window_set_current(struct window_t *window)
 {
     glfwMakeContextCurrent(window->backing);
+    gl_state_set_current(&window->state);
 }
 
 void window_clear_current()
 {
     glfwMakeContextCurrent(NULL);
+    gl_state_set_current(NULL);
 }
 
 void window_set_background(struct window_t *window, struct colour4_t colour)
@@ -85,8 +94,8 @@ void window_begin_frame(struct window_t *window)
 
 void window_begin_final_pass(struct window_t *window)
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glViewport(0, 0, window->width, window->height);
+    gl_state_bind_framebuffer(0);
+    gl_state_set_viewport(0, 0, window->width, window->height);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
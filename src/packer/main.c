@@ -0,0 +1,410 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ast.h"
+#include "png.h"
+#include "jobs.h"
+#include "platform.h"
+#include "packer.h"
+
+///
+/// The atlas set packer, which packs a directory of PNG sprites into an atlas set file.
+///
+/// Usage: `packer [options] <input directory> <output file>`
+///
+/// Each PNG file directly within the input directory becomes a sprite, identified by its file name without the extension.
+/// Options:
+///  - `-padding <pixels>`: The number of empty pixels to leave around each sprite, defaults to `1`.
+///  - `-max-size <pixels>`: The maximum width and height of each atlas, defaults to `2048`.
+///  - `-power-of-two`: Round the width and height of each atlas up to a power of two.
+///  - `-nearest`: Scale the atlases with nearest neighbour filtering instead of linear filtering.
+///                Unless `-mipmaps` is also given the set is marked as not needing mip levels, as is typical of pixel art.
+///  - `-mipmaps`: Store a full prefiltered mip chain for each atlas, instead of having it generated when loading.
+///  - `-lz4`: Store the atlases as LZ4-compressed texels instead of PNGs.
+///  - `-qoi`: Store the atlases as QOI files instead of PNGs.
+///  - `-bc`: Store the atlases as BC1 blocks instead of PNGs, or BC3 blocks if any atlas has an alpha channel.
+///  - `-bc7`: Store the atlases as BC7 blocks instead of PNGs.
+///           Block compressed sets which would generate their mip levels store them instead, as they cannot be generated when loading.
+///  - `-format <format>`: Convert the atlases into a compact format, one of `r8`, `a8`, `rg8`, `rgb565`, `rgba4444`, or `rgb5a1`.
+///                        Compact formats can only be stored as LZ4-compressed texels, so this implies `-lz4`.
+///
+
+// MARK: - Macros
+
+/// The file extension of the sprite files within the input directory.
+#define PACKER_SPRITE_EXTENSION ".png"
+
+// MARK: - Data Structures
+
+/// The shared state of the jobs decoding the sprites within the input directory.
+struct packer_decode_t
+{
+    /// The path of the input directory.
+    const char *directory;
+
+    /// The file name of each sprite, indexed by sprite.
+    char **names;
+
+    /// The PNGs to decode each sprite into, indexed by sprite.
+    struct png_t *pngs;
+};
+
+/// The shared state of the jobs compositing the packed sprites into atlases.
+struct packer_composite_t
+{
+    /// The packed sprites.
+    const struct packer_t *packer;
+
+    /// The decoded PNG of each sprite, indexed by sprite.
+    const struct png_t *sprites;
+
+    /// The PNGs to composite each atlas into, indexed by atlas.
+    struct png_t *atlases;
+};
+
+// MARK: - Functions
+
+/// Print the usage of the packer and terminate.
+void packer_print_usage()
+{
+    fprintf(stderr, "usage: packer [-padding <pixels>] [-max-size <pixels>] [-power-of-two] [-nearest] [-mipmaps] [-lz4] [-qoi] [-bc] [-bc7] [-format <format>] <input directory> <output file>\n");
+    exit(EXIT_FAILURE);
+}
+
+/// Decode the sprite at the given index within the input directory.
+///
+/// This is the job function used to decode sprites concurrently.
+/// @param data The pointer to the `packer_decode_t` of the sprites being decoded.
+/// @param index The index of the sprite to decode.
+void packer_decode_sprite(void *data, unsigned int index)
+{
+    struct packer_decode_t *decode = (struct packer_decode_t *)data;
+
+    // open the sprite file
+    const char *name = decode->names[index];
+    size_t path_size = strlen(decode->directory) + 1 + strlen(name) + 1;
+    char path[path_size];
+    sprintf(path, "%s/%s", decode->directory, name);
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        // the file could not be opened, print the details and terminate
+        fprintf(stderr, "PACKER ERROR: unable to open sprite file at \"%s\"\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    // decode the sprite
+    png_init_file(&decode->pngs[index], file);
+    fclose(file);
+}
+
+/// Composite the sprites within the atlas at the given index.
+///
+/// This is the job function used to composite atlases concurrently,
+/// each job only writes its own atlas.
+/// @param data The pointer to the `packer_composite_t` of the atlases being composited.
+/// @param index The index of the atlas to composite.
+void packer_composite_atlas(void *data, unsigned int index)
+{
+    struct packer_composite_t *composite = (struct packer_composite_t *)data;
+    const struct packer_t *packer = composite->packer;
+    const struct packer_atlas_t *atlas = &packer->atlases[index];
+
+    // the atlas only needs an alpha channel if any of its sprites have one
+    enum png_format_t format = PNG_RGBU8;
+    for (unsigned int i = 0; i < packer->num_rects; i++)
+        if (packer->rects[i].atlas_index == index && composite->sprites[i].format == PNG_RGBAU8)
+            format = PNG_RGBAU8;
+
+    // empty space within the atlas is transparent, or black without an alpha channel
+    size_t pixel_size = png_get_pixel_size(format);
+    unsigned char *atlas_data = calloc((size_t)atlas->width * atlas->height, pixel_size);
+
+    // copy each sprite into its placement
+    // both the sprites and atlas rows are bottom-to-top, so rows map directly
+    for (unsigned int i = 0; i < packer->num_rects; i++)
+    {
+        const struct packer_rect_t *rect = &packer->rects[i];
+        if (rect->atlas_index != index)
+            continue;
+
+        const struct png_t *sprite = &composite->sprites[i];
+        size_t sprite_pixel_size = png_get_pixel_size(sprite->format);
+        for (unsigned int row = 0; row < sprite->height; row++)
+        {
+            const unsigned char *source = (const unsigned char *)sprite->data + ((size_t)row * sprite->width * sprite_pixel_size);
+            unsigned char *destination = atlas_data + ((((size_t)(rect->y + row) * atlas->width) + rect->x) * pixel_size);
+            if (sprite_pixel_size == pixel_size)
+            {
+                memcpy(destination, source, (size_t)sprite->width * pixel_size);
+                continue;
+            }
+
+            // sprites without an alpha channel are opaque within atlases with one
+            for (unsigned int column = 0; column < sprite->width; column++)
+            {
+                memcpy(&destination[column * pixel_size], &source[column * sprite_pixel_size], sprite_pixel_size);
+                destination[(column * pixel_size) + 3] = 0xff;
+            }
+        }
+    }
+
+    // initialize the atlas
+    struct png_t *png = &composite->atlases[index];
+    png->width = atlas->width;
+    png->height = atlas->height;
+    png->format = format;
+    png->data = atlas_data;
+}
+
+/// Parse the given compact texture format name, as given to the `-format` option.
+///
+/// If the given name is not a known compact format then the usage is printed and the program terminates.
+/// @param name The name of the compact format to parse.
+/// @return The compact format with the given name.
+enum texture_format_t packer_parse_format(const char *name)
+{
+    if (strcmp(name, "r8") == 0)
+        return TEXTURE_R8;
+    else if (strcmp(name, "a8") == 0)
+        return TEXTURE_A8;
+    else if (strcmp(name, "rg8") == 0)
+        return TEXTURE_RG8;
+    else if (strcmp(name, "rgb565") == 0)
+        return TEXTURE_RGB565;
+    else if (strcmp(name, "rgba4444") == 0)
+        return TEXTURE_RGBA4444;
+    else if (strcmp(name, "rgb5a1") == 0)
+        return TEXTURE_RGB5A1;
+
+    packer_print_usage();
+    return TEXTURE_RGBAU8;
+}
+
+int main(int argc, char **argv)
+{
+    // parse the arguments
+    struct packer_options_t options =
+    {
+        .max_size = 2048,
+        .padding = 1,
+        .power_of_two = false,
+    };
+
+    enum texture_scaling_t scaling = TEXTURE_LINEAR;
+    enum ast_payload_t payload = AST_PAYLOAD_PNG;
+    enum texture_format_t format = TEXTURE_RGBAU8;
+    bool store_mipmaps = false;
+    const char *input_path = NULL, *output_path = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        const char *argument = argv[i];
+        if (strcmp(argument, "-padding") == 0 && i + 1 < argc)
+            options.padding = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argument, "-max-size") == 0 && i + 1 < argc)
+            options.max_size = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argument, "-power-of-two") == 0)
+            options.power_of_two = true;
+        else if (strcmp(argument, "-nearest") == 0)
+            scaling = TEXTURE_NEAREST;
+        else if (strcmp(argument, "-mipmaps") == 0)
+            store_mipmaps = true;
+        else if (strcmp(argument, "-lz4") == 0)
+            payload = AST_PAYLOAD_LZ4;
+        else if (strcmp(argument, "-qoi") == 0)
+            payload = AST_PAYLOAD_QOI;
+        else if (strcmp(argument, "-bc") == 0)
+            payload = AST_PAYLOAD_BC1;
+        else if (strcmp(argument, "-bc7") == 0)
+            payload = AST_PAYLOAD_BC7;
+        else if (strcmp(argument, "-format") == 0 && i + 1 < argc)
+            format = packer_parse_format(argv[++i]);
+        else if (argument[0] == '-')
+            packer_print_usage();
+        else if (input_path == NULL)
+            input_path = argument;
+        else if (output_path == NULL)
+            output_path = argument;
+        else
+            packer_print_usage();
+    }
+
+    // atlas set sizes are stored as 16-bit values
+    if (input_path == NULL || output_path == NULL || options.max_size == 0 || options.max_size > UINT16_MAX)
+        packer_print_usage();
+
+    // compact texels are only ever stored raw
+    if (texture_format_is_compact(format))
+        payload = AST_PAYLOAD_LZ4;
+
+    enum ast_mipmaps_t mipmaps = AST_MIPMAPS_GENERATED;
+    if (store_mipmaps)
+        mipmaps = AST_MIPMAPS_STORED;
+    else if (scaling == TEXTURE_NEAREST)
+        mipmaps = AST_MIPMAPS_NONE;
+
+    // find the sprite files
+    unsigned int num_files;
+    char **files = platform_get_directory_files(input_path, &num_files);
+    unsigned int num_sprites = 0;
+    char **names = malloc(num_files * sizeof(char *));
+    for (unsigned int i = 0; i < num_files; i++)
+    {
+        size_t name_length = strlen(files[i]);
+        size_t extension_length = strlen(PACKER_SPRITE_EXTENSION);
+        if (name_length > extension_length && strcmp(files[i] + name_length - extension_length, PACKER_SPRITE_EXTENSION) == 0)
+            names[num_sprites++] = files[i];
+        else
+            free(files[i]);
+    }
+
+    free(files);
+
+    // decode all the sprites concurrently
+    struct png_t *sprite_pngs = malloc(num_sprites * sizeof(struct png_t));
+    struct packer_decode_t decode =
+    {
+        .directory = input_path,
+        .names = names,
+        .pngs = sprite_pngs,
+    };
+
+    struct jobs_t jobs;
+    jobs_init(&jobs, num_sprites, 0, packer_decode_sprite, &decode);
+    jobs_deinit(&jobs);
+
+    // create the sprites, ensuring each can be stored and packed
+    unsigned int max_rect_size = packer_get_max_rect_size(&options);
+    struct ast_sprite_t *sprites = calloc(num_sprites, sizeof(struct ast_sprite_t));
+    unsigned int *widths = malloc(num_sprites * sizeof(unsigned int));
+    unsigned int *heights = malloc(num_sprites * sizeof(unsigned int));
+    for (unsigned int i = 0; i < num_sprites; i++)
+    {
+        size_t id_length = strlen(names[i]) - strlen(PACKER_SPRITE_EXTENSION);
+        if (id_length >= AST_ID_MAX_SIZE)
+        {
+            fprintf(stderr, "PACKER ERROR: sprite identifier of \"%s\" exceeds %i characters\n", names[i], AST_ID_MAX_SIZE - 1);
+            exit(EXIT_FAILURE);
+        }
+
+        const struct png_t *png = &sprite_pngs[i];
+        if (png->width > max_rect_size || png->height > max_rect_size)
+        {
+            fprintf(stderr, "PACKER ERROR: sprite \"%s\" (%ux%u) does not fit within the maximum atlas size with padding (%ux%u)\n", names[i], png->width, png->height, max_rect_size, max_rect_size);
+            exit(EXIT_FAILURE);
+        }
+
+        memcpy(sprites[i].id, names[i], id_length);
+        widths[i] = png->width;
+        heights[i] = png->height;
+    }
+
+    // pack the sprites
+    struct packer_t packer;
+    packer_init(&packer, num_sprites, widths, heights, &options);
+    free(widths);
+    free(heights);
+
+    // sprites only store their atlas as an 8-bit index
+    if (packer.num_atlases > UINT8_MAX + 1)
+    {
+        fprintf(stderr, "PACKER ERROR: sprites require %u atlases, exceeding the maximum of %i\n", packer.num_atlases, UINT8_MAX + 1);
+        exit(EXIT_FAILURE);
+    }
+
+    // set the placement of each sprite, normalized to its atlas
+    for (unsigned int i = 0; i < num_sprites; i++)
+    {
+        const struct packer_rect_t *rect = &packer.rects[i];
+        const struct packer_atlas_t *atlas = &packer.atlases[rect->atlas_index];
+        sprites[i].atlas_index = rect->atlas_index;
+        sprites[i].bottom_left = uv((float)rect->x / atlas->width,
+                                    (float)rect->y / atlas->height);
+        sprites[i].top_right = uv((float)(rect->x + rect->width) / atlas->width,
+                                  (float)(rect->y + rect->height) / atlas->height);
+    }
+
+    // composite all the atlases concurrently
+    struct png_t *atlas_pngs = malloc(packer.num_atlases * sizeof(struct png_t));
+    struct packer_composite_t composite =
+    {
+        .packer = &packer,
+        .sprites = sprite_pngs,
+        .atlases = atlas_pngs,
+    };
+
+    jobs_init(&jobs, packer.num_atlases, 0, packer_composite_atlas, &composite);
+    jobs_deinit(&jobs);
+
+    // bc1 blocks are always opaque, so sets with any alpha channel use bc3 blocks instead
+    for (unsigned int i = 0; i < packer.num_atlases; i++)
+        if (payload == AST_PAYLOAD_BC1 && atlas_pngs[i].format == PNG_RGBAU8)
+            payload = AST_PAYLOAD_BC3;
+
+    // write the atlas set
+    // it is written beside the output file and then moved over it,
+    // so that programs hot reloading the output file never read a partially written set
+    size_t temporary_path_size = strlen(output_path) + strlen(".tmp") + 1;
+    char temporary_path[temporary_path_size];
+    sprintf(temporary_path, "%s.tmp", output_path);
+    FILE *file = fopen(temporary_path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "PACKER ERROR: unable to open output file at \"%s\"\n", temporary_path);
+        exit(EXIT_FAILURE);
+    }
+
+    ast_write_contents_png(file,
+                           scaling,
+                           payload,
+                           format,
+                           mipmaps,
+                           packer.num_atlases,
+                           atlas_pngs,
+                           num_sprites,
+                           sprites);
+
+    fclose(file);
+    platform_replace_file(temporary_path, output_path);
+
+    // report the result
+    // the array efficiency accounts for every layer of the atlas array texture being the size of the largest atlas
+    unsigned int array_width = 0, array_height = 0;
+    for (unsigned int i = 0; i < packer.num_atlases; i++)
+    {
+        printf("atlas %u: %ux%u\n", i, packer.atlases[i].width, packer.atlases[i].height);
+        if (packer.atlases[i].width > array_width)
+            array_width = packer.atlases[i].width;
+        if (packer.atlases[i].height > array_height)
+            array_height = packer.atlases[i].height;
+    }
+
+    uint64_t array_area = (uint64_t)array_width * array_height * packer.num_atlases;
+    printf("packed %u sprites into %u atlases\n", num_sprites, packer.num_atlases);
+    printf("atlas efficiency: %.2f%%\n", packer_get_efficiency(&packer) * 100.0f);
+    printf("array efficiency: %.2f%%\n", (array_area > 0) ? ((double)packer.used_area / (double)array_area) * 100.0 : 0.0);
+
+    // the wasted memory is measured from the written set, so that it accounts for its mip levels and payload format
+    struct ast_t ast;
+    ast_init(&ast, output_path);
+    printf("array waste: %zu bytes, %zu bytes split by size class\n", ast_get_texture_wasted_size(&ast), ast_get_arrays_wasted_size(&ast));
+    ast_deinit(&ast);
+
+    // release everything
+    for (unsigned int i = 0; i < packer.num_atlases; i++)
+        png_deinit(&atlas_pngs[i]);
+    for (unsigned int i = 0; i < num_sprites; i++)
+    {
+        png_deinit(&sprite_pngs[i]);
+        free(names[i]);
+    }
+
+    free(atlas_pngs);
+    free(sprite_pngs);
+    free(sprites);
+    free(names);
+    packer_deinit(&packer);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+#include "maxrects.h"
+
+#include <stdlib.h>
+#include <limits.h>
+
+// MARK: - Functions
+
+void maxrects_init(struct maxrects_t *bin,
+                   unsigned int width,
+                   unsigned int height)
+{
+    // the entire bin is initially a single free rectangle
+    bin->width = width;
+    bin->height = height;
+    bin->used_area = 0;
+    bin->num_free_rects = 1;
+    bin->free_rects_capacity = 16;
+    bin->free_rects = malloc(bin->free_rects_capacity * sizeof(struct maxrects_rect_t));
+    bin->free_rects[0] = (struct maxrects_rect_t)
+    {
+        .x = 0,
+        .y = 0,
+        .width = width,
+        .height = height,
+    };
+}
+
+void maxrects_deinit(struct maxrects_t *bin)
+{
+    free(bin->free_rects);
+}
+
+/// Append the given free rectangle to the given MaxRects bin.
+/// @param bin The bin to append the free rectangle to.
+/// @param rect The free rectangle to append.
+void maxrects_push_free_rect(struct maxrects_t *bin, struct maxrects_rect_t rect)
+{
+    if (bin->num_free_rects >= bin->free_rects_capacity)
+    {
+        bin->free_rects_capacity *= 2;
+        bin->free_rects = realloc(bin->free_rects, bin->free_rects_capacity * sizeof(struct maxrects_rect_t));
+    }
+
+    bin->free_rects[bin->num_free_rects++] = rect;
+}
+
+/// Score the placement of a rectangle of the given size at the bottom left of the given free rectangle.
+///
+/// The given rectangle must fit within the given free rectangle.
+/// @param free_rect The free rectangle to score the placement within.
+/// @param width The width of the rectangle being placed.
+/// @param height The height of the rectangle being placed.
+/// @param heuristic The heuristic to score the placement with.
+/// @param primary The pointer to set the value of to the primary score of the placement, where lower is better.
+/// @param secondary The pointer to set the value of to the score used to break ties in the primary score, where lower is better.
+void maxrects_score(const struct maxrects_rect_t *free_rect,
+                    unsigned int width,
+                    unsigned int height,
+                    enum maxrects_heuristic_t heuristic,
+                    uint64_t *primary,
+                    uint64_t *secondary)
+{
+    unsigned int leftover_x = free_rect->width - width;
+    unsigned int leftover_y = free_rect->height - height;
+    unsigned int short_side = (leftover_x < leftover_y) ? leftover_x : leftover_y;
+    unsigned int long_side = (leftover_x > leftover_y) ? leftover_x : leftover_y;
+    switch (heuristic)
+    {
+        case MAXRECTS_BEST_SHORT_SIDE_FIT:
+            *primary = short_side;
+            *secondary = long_side;
+            break;
+        case MAXRECTS_BEST_LONG_SIDE_FIT:
+            *primary = long_side;
+            *secondary = short_side;
+            break;
+        case MAXRECTS_BEST_AREA_FIT:
+            *primary = ((uint64_t)free_rect->width * free_rect->height) - ((uint64_t)width * height);
+            *secondary = short_side;
+            break;
+        case MAXRECTS_BOTTOM_LEFT:
+            *primary = free_rect->y + height;
+            *secondary = free_rect->x;
+            break;
+    }
+}
+
+/// Get whether or not the first given rectangle is entirely contained within the second.
+/// @param a The rectangle to check for containment.
+/// @param b The rectangle to check for containing the first.
+/// @return Whether or not rectangle `a` is entirely contained within rectangle `b`.
+bool maxrects_is_contained(const struct maxrects_rect_t *a, const struct maxrects_rect_t *b)
+{
+    return a->x >= b->x &&
+           a->y >= b->y &&
+           a->x + a->width <= b->x + b->width &&
+           a->y + a->height <= b->y + b->height;
+}
+
+/// Split every free rectangle within the given MaxRects bin which intersects the given placed rectangle.
+///
+/// Each intersecting free rectangle is replaced with up to four maximal free rectangles around the placed rectangle.
+/// @param bin The bin to split the free rectangles of.
+/// @param placed The rectangle which was placed.
+void maxrects_split(struct maxrects_t *bin, const struct maxrects_rect_t *placed)
+{
+    // only iterate the free rectangles which existed before splitting,
+    // as the new rectangles are appended and never intersect the placed rectangle
+    unsigned int num_free_rects = bin->num_free_rects;
+    unsigned int i = 0;
+    while (i < num_free_rects)
+    {
+        struct maxrects_rect_t free_rect = bin->free_rects[i];
+        if (placed->x >= free_rect.x + free_rect.width ||
+            placed->x + placed->width <= free_rect.x ||
+            placed->y >= free_rect.y + free_rect.height ||
+            placed->y + placed->height <= free_rect.y)
+        {
+            i++;
+            continue;
+        }
+
+        // remove the intersecting free rectangle by moving the last original free rectangle into its place,
+        // and the last new free rectangle into the place of that
+        num_free_rects--;
+        bin->free_rects[i] = bin->free_rects[num_free_rects];
+        bin->free_rects[num_free_rects] = bin->free_rects[--bin->num_free_rects];
+
+        // left
+        if (placed->x > free_rect.x)
+        {
+            struct maxrects_rect_t rect = free_rect;
+            rect.width = placed->x - free_rect.x;
+            maxrects_push_free_rect(bin, rect);
+        }
+
+        // right
+        if (placed->x + placed->width < free_rect.x + free_rect.width)
+        {
+            struct maxrects_rect_t rect = free_rect;
+            rect.x = placed->x + placed->width;
+            rect.width = (free_rect.x + free_rect.width) - rect.x;
+            maxrects_push_free_rect(bin, rect);
+        }
+
+        // bottom
+        if (placed->y > free_rect.y)
+        {
+            struct maxrects_rect_t rect = free_rect;
+            rect.height = placed->y - free_rect.y;
+            maxrects_push_free_rect(bin, rect);
+        }
+
+        // top
+        if (placed->y + placed->height < free_rect.y + free_rect.height)
+        {
+            struct maxrects_rect_t rect = free_rect;
+            rect.y = placed->y + placed->height;
+            rect.height = (free_rect.y + free_rect.height) - rect.y;
+            maxrects_push_free_rect(bin, rect);
+        }
+    }
+}
+
+/// Remove every free rectangle within the given MaxRects bin which is contained by another.
+/// @param bin The bin to prune the free rectangles of.
+void maxrects_prune(struct maxrects_t *bin)
+{
+    for (unsigned int i = 0; i < bin->num_free_rects; i++)
+    {
+        for (unsigned int j = i + 1; j < bin->num_free_rects; j++)
+        {
+            if (maxrects_is_contained(&bin->free_rects[i], &bin->free_rects[j]))
+            {
+                // remove i and re-check the rectangle moved into its place
+                bin->free_rects[i] = bin->free_rects[--bin->num_free_rects];
+                i--;
+                break;
+            }
+
+            if (maxrects_is_contained(&bin->free_rects[j], &bin->free_rects[i]))
+            {
+                // remove j and re-check the rectangle moved into its place
+                bin->free_rects[j] = bin->free_rects[--bin->num_free_rects];
+                j--;
+            }
+        }
+    }
+}
+
+bool maxrects_insert(struct maxrects_t *bin,
+                     unsigned int width,
+                     unsigned int height,
+                     enum maxrects_heuristic_t heuristic,
+                     struct maxrects_rect_t *rect)
+{
+    // find the best scoring free rectangle that fits the given size
+    int best_index = -1;
+    uint64_t best_primary = UINT64_MAX, best_secondary = UINT64_MAX;
+    for (int i = 0; i < bin->num_free_rects; i++)
+    {
+        const struct maxrects_rect_t *free_rect = &bin->free_rects[i];
+        if (free_rect->width < width || free_rect->height < height)
+            continue;
+
+        uint64_t primary, secondary;
+        maxrects_score(free_rect, width, height, heuristic, &primary, &secondary);
+        if (primary < best_primary || (primary == best_primary && secondary < best_secondary))
+        {
+            best_index = i;
+            best_primary = primary;
+            best_secondary = secondary;
+        }
+    }
+
+    if (best_index < 0)
+        return false;
+
+    // place the rectangle at the bottom left of the chosen free rectangle
+    struct maxrects_rect_t placed =
+    {
+        .x = bin->free_rects[best_index].x,
+        .y = bin->free_rects[best_index].y,
+        .width = width,
+        .height = height,
+    };
+
+    // update the free rectangles around the placed rectangle
+    maxrects_split(bin, &placed);
+    maxrects_prune(bin);
+
+    bin->used_area += (uint64_t)width * height;
+    *rect = placed;
+    return true;
+}
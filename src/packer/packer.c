@@ -0,0 +1,347 @@
+#include "packer.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "maxrects.h"
+#include "jobs.h"
+
+// MARK: - Macros
+
+/// The total number of rectangle orderings that packing is attempted with.
+#define PACKER_NUM_ORDERS (3)
+
+/// The total number of packing attempts, one for each combination of heuristic and ordering.
+#define PACKER_NUM_ATTEMPTS (MAXRECTS_NUM_HEURISTICS * PACKER_NUM_ORDERS)
+
+// MARK: - Data Structures
+
+/// The shared state of the jobs attempting to pack a set of rectangles.
+struct packer_attempts_t
+{
+    /// The rectangles being packed, with their sizes set.
+    const struct packer_rect_t *rects;
+
+    /// The total number of rectangles being packed.
+    unsigned int num_rects;
+
+    /// The options that the rectangles are being packed with.
+    const struct packer_options_t *options;
+
+    /// The result of each packing attempt, indexed by attempt.
+    struct packer_t *results;
+};
+
+// MARK: - Functions
+
+/// Get the largest power of two which is not above the given value.
+/// @param value The value to get the power of two for, which must be non-zero.
+/// @return The largest power of two which is not above the given value.
+unsigned int packer_floor_power_of_two(unsigned int value)
+{
+    unsigned int power = 1;
+    while (power <= value / 2)
+        power *= 2;
+
+    return power;
+}
+
+/// Get the smallest power of two which is not below the given value.
+/// @param value The value to get the power of two for.
+/// @return The smallest power of two which is not below the given value.
+unsigned int packer_ceil_power_of_two(unsigned int value)
+{
+    unsigned int power = 1;
+    while (power < value)
+        power *= 2;
+
+    return power;
+}
+
+/// Get the width and height that each atlas is packed within with the given options, including its padding.
+/// @param options The options to get the atlas size for.
+/// @return The width and height of each atlas before it is shrunk to its contents, in pixels.
+unsigned int packer_get_atlas_size(const struct packer_options_t *options)
+{
+    if (options->power_of_two)
+        return packer_floor_power_of_two(options->max_size);
+    else
+        return options->max_size;
+}
+
+unsigned int packer_get_max_rect_size(const struct packer_options_t *options)
+{
+    // each rectangle has padding on every side
+    unsigned int atlas_size = packer_get_atlas_size(options);
+    if (atlas_size <= options->padding * 2)
+        return 0;
+
+    return atlas_size - (options->padding * 2);
+}
+
+/// Compare the two given rectangles for sorting by descending area.
+/// @param a The first rectangle to compare.
+/// @param b The second rectangle to compare.
+/// @return The ordering of the given rectangles.
+int packer_compare_area(const struct packer_rect_t *a, const struct packer_rect_t *b)
+{
+    uint64_t area_a = (uint64_t)a->width * a->height;
+    uint64_t area_b = (uint64_t)b->width * b->height;
+    return (area_a < area_b) - (area_a > area_b);
+}
+
+/// Compare the two given rectangles for sorting by descending longest side.
+/// @param a The first rectangle to compare.
+/// @param b The second rectangle to compare.
+/// @return The ordering of the given rectangles.
+int packer_compare_long_side(const struct packer_rect_t *a, const struct packer_rect_t *b)
+{
+    unsigned int side_a = (a->width > a->height) ? a->width : a->height;
+    unsigned int side_b = (b->width > b->height) ? b->width : b->height;
+    if (side_a != side_b)
+        return (side_a < side_b) - (side_a > side_b);
+
+    return packer_compare_area(a, b);
+}
+
+/// Compare the two given rectangles for sorting by descending height.
+/// @param a The first rectangle to compare.
+/// @param b The second rectangle to compare.
+/// @return The ordering of the given rectangles.
+int packer_compare_height(const struct packer_rect_t *a, const struct packer_rect_t *b)
+{
+    if (a->height != b->height)
+        return (a->height < b->height) - (a->height > b->height);
+
+    return (a->width < b->width) - (a->width > b->width);
+}
+
+/// Sort the given rectangle indices by the given ordering of the rectangles they refer to.
+///
+/// A merge sort is used as the standard library has no portable way to sort with context,
+/// and it is stable so that ties keep their index order and every attempt is deterministic.
+/// @param order The index of the ordering to sort by.
+/// @param rects All the rectangles that the given indices refer to.
+/// @param num_indices The total number of given indices.
+/// @param indices The rectangle indices to sort.
+void packer_sort(unsigned int order,
+                 const struct packer_rect_t *rects,
+                 unsigned int num_indices,
+                 unsigned int *indices)
+{
+    int (*compare)(const struct packer_rect_t *, const struct packer_rect_t *);
+    switch (order)
+    {
+        case 0:  compare = packer_compare_area; break;
+        case 1:  compare = packer_compare_long_side; break;
+        default: compare = packer_compare_height; break;
+    }
+
+    // merge sort the indices bottom-up
+    if (num_indices < 2)
+        return;
+
+    unsigned int *scratch = malloc(num_indices * sizeof(unsigned int));
+    for (unsigned int width = 1; width < num_indices; width *= 2)
+    {
+        for (unsigned int start = 0; start < num_indices; start += width * 2)
+        {
+            unsigned int middle = (start + width < num_indices) ? start + width : num_indices;
+            unsigned int end = (start + (width * 2) < num_indices) ? start + (width * 2) : num_indices;
+            unsigned int left = start, right = middle, output = start;
+            while (left < middle && right < end)
+            {
+                if (compare(&rects[indices[right]], &rects[indices[left]]) < 0)
+                    scratch[output++] = indices[right++];
+                else
+                    scratch[output++] = indices[left++];
+            }
+
+            while (left < middle)
+                scratch[output++] = indices[left++];
+            while (right < end)
+                scratch[output++] = indices[right++];
+        }
+
+        for (unsigned int i = 0; i < num_indices; i++)
+            indices[i] = scratch[i];
+    }
+
+    free(scratch);
+}
+
+/// Pack a set of rectangles using the heuristic and ordering of the attempt at the given index.
+///
+/// This is the job function used to run packing attempts concurrently,
+/// each job only writes its own result.
+/// @param data The pointer to the `packer_attempts_t` of the rectangles being packed.
+/// @param index The index of the attempt to run.
+void packer_attempt(void *data, unsigned int index)
+{
+    struct packer_attempts_t *attempts = (struct packer_attempts_t *)data;
+    const struct packer_options_t *options = attempts->options;
+    enum maxrects_heuristic_t heuristic = index % MAXRECTS_NUM_HEURISTICS;
+    unsigned int order = index / MAXRECTS_NUM_HEURISTICS;
+
+    // copy the rectangles to place them within this attempts result
+    unsigned int num_rects = attempts->num_rects;
+    struct packer_rect_t *rects = malloc(num_rects * sizeof(struct packer_rect_t));
+    unsigned int *indices = malloc(num_rects * sizeof(unsigned int));
+    for (unsigned int i = 0; i < num_rects; i++)
+    {
+        rects[i] = attempts->rects[i];
+        indices[i] = i;
+    }
+
+    packer_sort(order, rects, num_rects, indices);
+
+    // place each rectangle within the first bin that fits it, opening a new bin when none do
+    // bins exclude the padding at their bottom and left edges, and each rectangle includes its padding at its top and right,
+    // so rectangles are always separated by exactly the padding
+    unsigned int bin_size = packer_get_atlas_size(options) - options->padding;
+    unsigned int num_bins = 0, bins_capacity = 4;
+    struct maxrects_t *bins = malloc(bins_capacity * sizeof(struct maxrects_t));
+    for (unsigned int i = 0; i < num_rects; i++)
+    {
+        struct packer_rect_t *rect = &rects[indices[i]];
+        unsigned int padded_width = rect->width + options->padding;
+        unsigned int padded_height = rect->height + options->padding;
+
+        struct maxrects_rect_t placed;
+        unsigned int bin_index;
+        for (bin_index = 0; bin_index < num_bins; bin_index++)
+            if (maxrects_insert(&bins[bin_index], padded_width, padded_height, heuristic, &placed))
+                break;
+
+        if (bin_index >= num_bins)
+        {
+            if (num_bins >= bins_capacity)
+            {
+                bins_capacity *= 2;
+                bins = realloc(bins, bins_capacity * sizeof(struct maxrects_t));
+            }
+
+            maxrects_init(&bins[num_bins++], bin_size, bin_size);
+            bool is_placed = maxrects_insert(&bins[bin_index], padded_width, padded_height, heuristic, &placed);
+            assert(is_placed);
+        }
+
+        rect->atlas_index = bin_index;
+        rect->x = placed.x + options->padding;
+        rect->y = placed.y + options->padding;
+    }
+
+    // shrink each atlas to the bounds of its rectangles and their trailing padding
+    struct packer_atlas_t *atlases = malloc(num_bins * sizeof(struct packer_atlas_t));
+    for (unsigned int i = 0; i < num_bins; i++)
+    {
+        atlases[i].width = 0;
+        atlases[i].height = 0;
+        maxrects_deinit(&bins[i]);
+    }
+
+    uint64_t used_area = 0;
+    for (unsigned int i = 0; i < num_rects; i++)
+    {
+        const struct packer_rect_t *rect = &rects[i];
+        struct packer_atlas_t *atlas = &atlases[rect->atlas_index];
+        if (rect->x + rect->width + options->padding > atlas->width)
+            atlas->width = rect->x + rect->width + options->padding;
+        if (rect->y + rect->height + options->padding > atlas->height)
+            atlas->height = rect->y + rect->height + options->padding;
+
+        used_area += (uint64_t)rect->width * rect->height;
+    }
+
+    uint64_t atlas_area = 0;
+    for (unsigned int i = 0; i < num_bins; i++)
+    {
+        struct packer_atlas_t *atlas = &atlases[i];
+        if (options->power_of_two)
+        {
+            atlas->width = packer_ceil_power_of_two(atlas->width);
+            atlas->height = packer_ceil_power_of_two(atlas->height);
+        }
+
+        atlas_area += (uint64_t)atlas->width * atlas->height;
+    }
+
+    free(bins);
+    free(indices);
+
+    // initialize this attempts result
+    struct packer_t *result = &attempts->results[index];
+    result->num_atlases = num_bins;
+    result->atlases = atlases;
+    result->num_rects = num_rects;
+    result->rects = rects;
+    result->used_area = used_area;
+    result->atlas_area = atlas_area;
+}
+
+void packer_init(struct packer_t *packer,
+                 unsigned int num_rects,
+                 const unsigned int *widths,
+                 const unsigned int *heights,
+                 const struct packer_options_t *options)
+{
+    // get the rectangles to pack
+    unsigned int max_rect_size = packer_get_max_rect_size(options);
+    struct packer_rect_t *rects = malloc(num_rects * sizeof(struct packer_rect_t));
+    for (unsigned int i = 0; i < num_rects; i++)
+    {
+        assert(widths[i] <= max_rect_size && heights[i] <= max_rect_size);
+        rects[i] = (struct packer_rect_t)
+        {
+            .width = widths[i],
+            .height = heights[i],
+            .atlas_index = 0,
+            .x = 0,
+            .y = 0,
+        };
+    }
+
+    // run every packing attempt concurrently
+    struct packer_t results[PACKER_NUM_ATTEMPTS];
+    struct packer_attempts_t attempts =
+    {
+        .rects = rects,
+        .num_rects = num_rects,
+        .options = options,
+        .results = results,
+    };
+
+    struct jobs_t jobs;
+    jobs_init(&jobs, PACKER_NUM_ATTEMPTS, 0, packer_attempt, &attempts);
+    jobs_deinit(&jobs);
+    free(rects);
+
+    // keep the attempt with the fewest atlases, then the least atlas area
+    unsigned int best = 0;
+    for (unsigned int i = 1; i < PACKER_NUM_ATTEMPTS; i++)
+    {
+        if (results[i].num_atlases < results[best].num_atlases ||
+            (results[i].num_atlases == results[best].num_atlases && results[i].atlas_area < results[best].atlas_area))
+            best = i;
+    }
+
+    for (unsigned int i = 0; i < PACKER_NUM_ATTEMPTS; i++)
+        if (i != best)
+            packer_deinit(&results[i]);
+
+    *packer = results[best];
+}
+
+void packer_deinit(struct packer_t *packer)
+{
+    free(packer->rects);
+    free(packer->atlases);
+}
+
+float packer_get_efficiency(const struct packer_t *packer)
+{
+    if (packer->atlas_area == 0)
+        return 0;
+
+    return (float)((double)packer->used_area / (double)packer->atlas_area);
+}
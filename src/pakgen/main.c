@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pak.h"
+#include "map.h"
+#include "platform.h"
+
+///
+/// The pack archive generator, which bundles a directory of asset files into a single pack file.
+///
+/// Usage: `pakgen <input directory> <output file>`
+///
+/// Each regular file directly within the input directory becomes an entry, named by its file name including the extension.
+/// The entries can then be opened by name with `pak_find`, or loaded directly with functions such as `ast_init_pak` and `png_init_pak`.
+///
+
+// MARK: - Functions
+
+/// Print the usage of the generator and terminate.
+void pakgen_print_usage()
+{
+    fprintf(stderr, "usage: pakgen <input directory> <output file>\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    // parse the arguments
+    if (argc != 3)
+        pakgen_print_usage();
+
+    const char *input_path = argv[1];
+    const char *output_path = argv[2];
+
+    // map every file within the input directory
+    unsigned int num_entries;
+    char **names = platform_get_directory_files(input_path, &num_entries);
+    struct map_t *maps = malloc(num_entries * sizeof(struct map_t));
+    const void **data = malloc(num_entries * sizeof(void *));
+    size_t *sizes = malloc(num_entries * sizeof(size_t));
+    size_t total_size = 0;
+    for (unsigned int i = 0; i < num_entries; i++)
+    {
+        size_t path_size = strlen(input_path) + 1 + strlen(names[i]) + 1;
+        char path[path_size];
+        sprintf(path, "%s/%s", input_path, names[i]);
+
+        map_init(&maps[i], path);
+        data[i] = maps[i].data;
+        sizes[i] = maps[i].size;
+        total_size += maps[i].size;
+    }
+
+    // write the archive
+    // it is written beside the output file and then moved over it,
+    // so that programs mapping the output file never read a partially written archive
+    size_t temporary_path_size = strlen(output_path) + strlen(".tmp") + 1;
+    char temporary_path[temporary_path_size];
+    sprintf(temporary_path, "%s.tmp", output_path);
+    FILE *file = fopen(temporary_path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "PAKGEN ERROR: unable to open output file at \"%s\"\n", temporary_path);
+        exit(EXIT_FAILURE);
+    }
+
+    pak_write(file, num_entries, (const char *const *)names, data, sizes);
+    long archive_size = ftell(file);
+    fclose(file);
+    platform_replace_file(temporary_path, output_path);
+
+    printf("packed %u entries (%zu bytes) into \"%s\" (%ld bytes)\n", num_entries, total_size, output_path, archive_size);
+
+    // release everything
+    for (unsigned int i = 0; i < num_entries; i++)
+    {
+        map_deinit(&maps[i]);
+        free(names[i]);
+    }
+
+    free(sizes);
+    free(data);
+    free(maps);
+    free(names);
+    return EXIT_SUCCESS;
+}
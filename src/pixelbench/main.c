@@ -0,0 +1,295 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pixel.h"
+#include "platform.h"
+
+///
+/// The pixel kernel benchmark, which times each pixel kernel implementation supported by the host against the scalar implementation.
+///
+/// Usage: `pixelbench [width] [height] [iterations]`
+///
+/// Each kernel is run over an image of the given size the given number of times per implementation, and the fastest run is reported.
+/// The output of every implementation is also compared against the scalar implementation's output, terminating if they differ.
+/// This comparison is also made over small images with odd widths before benchmarking, to cover the leftover pixels of each vector loop.
+///
+
+// MARK: - Macros
+
+/// The default width and height of the benchmarked image, in pixels.
+#define PIXELBENCH_DEFAULT_SIZE (2048)
+
+/// The default number of times to run each kernel implementation.
+#define PIXELBENCH_DEFAULT_ITERATIONS (20)
+
+/// The height of the images that implementations are checked against the scalar implementation with, in pixels.
+#define PIXELBENCH_CHECK_HEIGHT (3)
+
+/// The number of bytes following the destination of checked images, which are also compared to detect writes past the end of an image.
+#define PIXELBENCH_CHECK_GUARD_SIZE (64)
+
+// MARK: - Enumerations
+
+/// A kernel that can be benchmarked.
+enum pixelbench_kernel_t
+{
+    PIXELBENCH_RGB_TO_RGBA,
+    PIXELBENCH_PREMULTIPLY_ALPHA,
+    PIXELBENCH_FLIP_ROWS,
+    PIXELBENCH_SWIZZLE,
+    PIXELBENCH_NUM_KERNELS,
+};
+
+// MARK: - Data Structures
+
+/// The image that kernels are benchmarked against.
+struct pixelbench_image_t
+{
+    /// The width of this image, in pixels.
+    unsigned int width;
+
+    /// The height of this image, in pixels.
+    unsigned int height;
+
+    /// The randomized RGBA source pixels of this image, which are also read as RGB pixels.
+    ///
+    /// Allocated.
+    unsigned char *source;
+
+    /// The RGBA pixels that kernels write their output to.
+    ///
+    /// Allocated.
+    unsigned char *destination;
+};
+
+// MARK: - Variables
+
+/// All the kernel implementations, in the order that they are run.
+///
+/// The scalar implementation is first, so that its output is the expected output of the others.
+static const enum pixel_kernels_t pixelbench_all_kernels[3] = { PIXEL_KERNELS_SCALAR, PIXEL_KERNELS_SSE2, PIXEL_KERNELS_AVX2 };
+
+/// The widths of the images that implementations are checked against the scalar implementation with, in pixels.
+///
+/// These are smaller than, and not multiples of, the number of pixels that each vector implementation processes at once.
+static const unsigned int pixelbench_check_widths[5] = { 1, 3, 15, 17, 33 };
+
+// MARK: - Functions
+
+/// Print the usage of the benchmark and terminate.
+void pixelbench_print_usage()
+{
+    fprintf(stderr, "usage: pixelbench [width] [height] [iterations]\n");
+    exit(EXIT_FAILURE);
+}
+
+/// Get the human readable name of the given kernel.
+/// @param kernel The kernel to get the name of.
+/// @return The null-terminated name of the given kernel.
+const char *pixelbench_kernel_get_name(enum pixelbench_kernel_t kernel)
+{
+    switch (kernel)
+    {
+        case PIXELBENCH_RGB_TO_RGBA:       return "rgb to rgba";
+        case PIXELBENCH_PREMULTIPLY_ALPHA: return "premultiply alpha";
+        case PIXELBENCH_FLIP_ROWS:         return "flip rows";
+        case PIXELBENCH_SWIZZLE:           return "swizzle";
+        default:                           return "unknown";
+    }
+}
+
+/// Get the human readable name of the given kernel implementations.
+/// @param kernels The implementations to get the name of.
+/// @return The null-terminated name of the given implementations.
+const char *pixelbench_kernels_get_name(enum pixel_kernels_t kernels)
+{
+    switch (kernels)
+    {
+        case PIXEL_KERNELS_SCALAR: return "scalar";
+        case PIXEL_KERNELS_SSE2:   return "sse2";
+        case PIXEL_KERNELS_AVX2:   return "avx2";
+        default:                   return "unknown";
+    }
+}
+
+/// Run the given kernel once over the given image with the current kernel implementations.
+///
+/// Kernels that operate in place first copy the source into the destination, which is included in the timing of every implementation.
+/// @param kernel The kernel to run.
+/// @param image The image to run the given kernel over.
+void pixelbench_run(enum pixelbench_kernel_t kernel, struct pixelbench_image_t *image)
+{
+    static const unsigned char swizzle_order[4] = { 2, 1, 0, 3 };
+    size_t num_pixels = (size_t)image->width * image->height;
+    switch (kernel)
+    {
+        case PIXELBENCH_RGB_TO_RGBA:
+            pixel_rgb_to_rgba(image->source, image->destination, num_pixels);
+            break;
+        case PIXELBENCH_PREMULTIPLY_ALPHA:
+            memcpy(image->destination, image->source, num_pixels * 4);
+            pixel_premultiply_alpha(image->destination, num_pixels);
+            break;
+        case PIXELBENCH_FLIP_ROWS:
+            memcpy(image->destination, image->source, num_pixels * 4);
+            pixel_flip_rows(image->destination, (size_t)image->width * 4, image->height);
+            break;
+        case PIXELBENCH_SWIZZLE:
+            pixel_swizzle(image->source, image->destination, num_pixels, swizzle_order);
+            break;
+        default:
+            break;
+    }
+}
+
+/// Check that every implementation supported by the host produces the same output as the scalar implementation for every kernel,
+/// over an image of the given size, terminating if they differ.
+///
+/// The destination is filled before each run, and compared along with the guard bytes following it.
+/// @param width The width of the image to check with, in pixels.
+/// @param height The height of the image to check with, in pixels.
+void pixelbench_check(unsigned int width, unsigned int height)
+{
+    // create the image with reproducible contents
+    struct pixelbench_image_t image;
+    image.width = width;
+    image.height = height;
+    size_t data_size = (size_t)width * height * 4;
+    size_t destination_size = data_size + PIXELBENCH_CHECK_GUARD_SIZE;
+    image.source = malloc(data_size);
+    image.destination = malloc(destination_size);
+    unsigned char *expected = malloc(destination_size);
+
+    srand(width);
+    for (size_t i = 0; i < data_size; i++)
+        image.source[i] = rand() & 0xff;
+
+    // run each kernel once with each implementation, comparing against the scalar output
+    for (enum pixelbench_kernel_t kernel = 0; kernel < PIXELBENCH_NUM_KERNELS; kernel++)
+    {
+        for (int i = 0; i < sizeof(pixelbench_all_kernels) / sizeof(pixelbench_all_kernels[0]); i++)
+        {
+            enum pixel_kernels_t kernels = pixelbench_all_kernels[i];
+            if (!pixel_kernels_are_supported(kernels))
+                continue;
+
+            pixel_set_kernels(kernels);
+            memset(image.destination, 0xcd, destination_size);
+            pixelbench_run(kernel, &image);
+
+            if (kernels == PIXEL_KERNELS_SCALAR)
+            {
+                memcpy(expected, image.destination, destination_size);
+            }
+            else if (memcmp(expected, image.destination, destination_size) != 0)
+            {
+                fprintf(stderr,
+                        "PIXELBENCH ERROR: %s output of %s does not match scalar output at %ux%u pixels\n",
+                        pixelbench_kernels_get_name(kernels),
+                        pixelbench_kernel_get_name(kernel),
+                        width,
+                        height);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    // release everything
+    free(expected);
+    free(image.destination);
+    free(image.source);
+}
+
+int main(int argc, char **argv)
+{
+    // parse the arguments
+    if (argc > 4)
+        pixelbench_print_usage();
+
+    long arguments[3] = { PIXELBENCH_DEFAULT_SIZE, PIXELBENCH_DEFAULT_SIZE, PIXELBENCH_DEFAULT_ITERATIONS };
+    for (int i = 1; i < argc; i++)
+    {
+        char *end;
+        arguments[i - 1] = strtol(argv[i], &end, 10);
+        if (*end != '\0' || arguments[i - 1] <= 0)
+            pixelbench_print_usage();
+    }
+
+    unsigned int iterations = arguments[2];
+
+    // create the image with reproducible contents
+    struct pixelbench_image_t image;
+    image.width = arguments[0];
+    image.height = arguments[1];
+    size_t data_size = (size_t)image.width * image.height * 4;
+    image.source = malloc(data_size);
+    image.destination = malloc(data_size);
+    unsigned char *expected = malloc(data_size);
+
+    srand(0);
+    for (size_t i = 0; i < data_size; i++)
+        image.source[i] = rand() & 0xff;
+
+    printf("benchmarking %ux%u pixels, fastest of %u runs, %s selected\n",
+           image.width,
+           image.height,
+           iterations,
+           pixelbench_kernels_get_name(pixel_get_kernels()));
+
+    // check each implementation supported by the host at the widths that leave pixels after its vector loop
+    for (int i = 0; i < sizeof(pixelbench_check_widths) / sizeof(pixelbench_check_widths[0]); i++)
+        pixelbench_check(pixelbench_check_widths[i], PIXELBENCH_CHECK_HEIGHT);
+
+    // benchmark each kernel with each implementation supported by the host
+    for (enum pixelbench_kernel_t kernel = 0; kernel < PIXELBENCH_NUM_KERNELS; kernel++)
+    {
+        printf("%s:\n", pixelbench_kernel_get_name(kernel));
+        double scalar_time = 0;
+        for (int i = 0; i < sizeof(pixelbench_all_kernels) / sizeof(pixelbench_all_kernels[0]); i++)
+        {
+            enum pixel_kernels_t kernels = pixelbench_all_kernels[i];
+            if (!pixel_kernels_are_supported(kernels))
+                continue;
+
+            pixel_set_kernels(kernels);
+            double best_time = 0;
+            for (unsigned int iteration = 0; iteration < iterations; iteration++)
+            {
+                double start_time = platform_get_time();
+                pixelbench_run(kernel, &image);
+                double time = platform_get_time() - start_time;
+                if (iteration == 0 || time < best_time)
+                    best_time = time;
+            }
+
+            // the scalar implementation runs first, so its output is the expected output of the others
+            if (kernels == PIXEL_KERNELS_SCALAR)
+            {
+                memcpy(expected, image.destination, data_size);
+                scalar_time = best_time;
+            }
+            else if (memcmp(expected, image.destination, data_size) != 0)
+            {
+                fprintf(stderr,
+                        "PIXELBENCH ERROR: %s output of %s does not match scalar output\n",
+                        pixelbench_kernels_get_name(kernels),
+                        pixelbench_kernel_get_name(kernel));
+                exit(EXIT_FAILURE);
+            }
+
+            double megapixels = ((double)image.width * image.height) / 1000000.0;
+            printf("  %-6s %9.3f ms %9.1f MP/s %6.2fx\n",
+                   pixelbench_kernels_get_name(kernels),
+                   best_time,
+                   (best_time > 0) ? megapixels / (best_time / 1000.0) : 0,
+                   (best_time > 0) ? scalar_time / best_time : 0);
+        }
+    }
+
+    // release everything
+    free(expected);
+    free(image.destination);
+    free(image.source);
+    return EXIT_SUCCESS;
+}
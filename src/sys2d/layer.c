@@ -432,6 +432,36 @@ void layer_add_attachment(struct layer_t *layer,
     layer_render(layer);
 }
 
+struct layer_attachment_t layer_attachment_sprite(const struct ast_arrays_t *arrays,
+                                                  const struct ast_sprite_t *sprite)
+{
+    struct ast_placement_t placement;
+    ast_arrays_get_placement(arrays, sprite, &placement);
+    return (struct layer_attachment_t)
+    {
+        .type = LAYER_ATTACHMENT_TEXTURE,
+        .texture = placement.texture,
+        .texture_index = placement.layer,
+        .texture_bottom_left = placement.bottom_left,
+        .texture_top_right = placement.top_right,
+    };
+}
+
+struct layer_attachment_t layer_attachment_atlas_entry(struct atlas_t *atlas,
+                                                       unsigned int entry)
+{
+    struct atlas_placement_t placement;
+    atlas_get_placement(atlas, entry, &placement);
+    return (struct layer_attachment_t)
+    {
+        .type = LAYER_ATTACHMENT_TEXTURE,
+        .texture = placement.texture,
+        .texture_index = placement.layer,
+        .texture_bottom_left = placement.bottom_left,
+        .texture_top_right = placement.top_right,
+    };
+}
+
 void layer_remove_attachment(struct layer_t *layer,
                              unsigned int index)
 {